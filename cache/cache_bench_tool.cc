@@ -4,6 +4,13 @@
 //  (found in the LICENSE.Apache file in the root directory).
 
 #ifdef GFLAGS
+#ifdef OS_LINUX
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // OS_LINUX
+
 #include <cinttypes>
 #include <cstddef>
 #include <cstdio>
@@ -19,7 +26,9 @@
 #include "rocksdb/convenience.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
+#include "rocksdb/memory_allocator.h"
 #include "rocksdb/secondary_cache.h"
+#include "rocksdb/statistics.h"
 #include "rocksdb/system_clock.h"
 #include "rocksdb/table_properties.h"
 #include "table/block_based/block_based_table_reader.h"
@@ -76,7 +85,42 @@ DEFINE_string(secondary_cache_uri, "",
 static class std::shared_ptr<ROCKSDB_NAMESPACE::SecondaryCache> secondary_cache;
 #endif  // ROCKSDB_LITE
 
-DEFINE_bool(use_clock_cache, false, "");
+DEFINE_bool(use_compressed_secondary_cache, false,
+            "If true, put a CompressedSecondaryCache behind the LRUCache, "
+            "and report the hit rate across both tiers.");
+DEFINE_uint64(compressed_secondary_cache_size, 1 * GiB,
+              "(-use_compressed_secondary_cache) Number of bytes of "
+              "compressed data the secondary cache can hold.");
+DEFINE_string(compressed_secondary_cache_compression_type, "lz4",
+              "(-use_compressed_secondary_cache) Algorithm used to compress "
+              "the values in the secondary cache.");
+DEFINE_double(compression_ratio, 1.0,
+              "Arrange to generate values that shrink to this fraction of "
+              "their original size after compression.");
+
+DEFINE_bool(use_clock_cache, false, "Deprecated: use -cache_type=clock_cache");
+
+DEFINE_string(cache_type, "lru_cache",
+              "Type of cache to benchmark: lru_cache, clock_cache (requires "
+              "TBB) or hyper_clock_cache.");
+
+DEFINE_string(memory_allocator_uri, "",
+              "URI of the MemoryAllocator to allocate cache values with, "
+              "e.g. HugePageSlabAllocator (default: new[])");
+
+DEFINE_bool(report_tlb_misses, false,
+            "Report the data TLB misses of the benchmark threads (through "
+            "Linux perf events)");
+
+DEFINE_uint64(estimated_entry_charge, 0,
+              "For hyper_clock_cache, the estimated average charge of an "
+              "entry. 0 means -value_bytes.");
+
+DEFINE_string(thread_scaling, "",
+              "If non-empty, a comma-separated list of thread counts, e.g. "
+              "1,2,4,8,16,32,64,128. The benchmark is run for each count with "
+              "both lru_cache and hyper_clock_cache, followed by a summary of "
+              "throughput. Overrides -threads and -cache_type.");
 
 // ## BEGIN stress_cache_key sub-tool options ##
 DEFINE_bool(stress_cache_key, false,
@@ -160,6 +204,10 @@ struct ThreadState {
   SharedState* shared;
   HistogramImpl latency_ns_hist;
   uint64_t duration_us = 0;
+  uint64_t lookup_count = 0;
+  uint64_t lookup_hits = 0;
+  // -1 if not counted
+  int64_t tlb_misses = -1;
 
   ThreadState(uint32_t index, SharedState* _shared)
       : tid(index), rnd(1000 + index), shared(_shared) {}
@@ -195,15 +243,114 @@ struct KeyGen {
   }
 };
 
+// Allocator of the values, from -memory_allocator_uri, or nullptr for new[]
+MemoryAllocator* value_allocator = nullptr;
+
+char* allocateValue(size_t size) {
+  if (value_allocator != nullptr) {
+    return static_cast<char*>(value_allocator->Allocate(size));
+  }
+  return new char[size];
+}
+
+void freeValue(void* value) {
+  if (value_allocator != nullptr) {
+    value_allocator->Deallocate(value);
+  } else {
+    delete[] static_cast<char*>(value);
+  }
+}
+
+// Counts the data TLB misses of the calling thread, in user space
+class TlbMissCounter {
+ public:
+  TlbMissCounter() {
+#ifdef OS_LINUX
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0 /* pid */,
+                                   -1 /* cpu */, -1 /* group_fd */, 0));
+#endif  // OS_LINUX
+  }
+
+  ~TlbMissCounter() {
+#ifdef OS_LINUX
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+#endif  // OS_LINUX
+  }
+
+  void Start() {
+#ifdef OS_LINUX
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif  // OS_LINUX
+  }
+
+  // Misses since Start(), or -1 if they cannot be counted (e.g. not
+  // permitted by perf_event_paranoid)
+  int64_t Stop() {
+#ifdef OS_LINUX
+    uint64_t count = 0;
+    if (fd_ >= 0 && ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0) == 0 &&
+        read(fd_, &count, sizeof(count)) == sizeof(count)) {
+      return static_cast<int64_t>(count);
+    }
+#endif  // OS_LINUX
+    return -1;
+  }
+
+ private:
+  int fd_ = -1;
+};
+
 char* createValue(Random64& rnd) {
-  char* rv = new char[FLAGS_value_bytes];
-  // Fill with some filler data, and take some CPU time
+  char* rv = allocateValue(FLAGS_value_bytes);
+  // Fill with some filler data, and take some CPU time. Only a prefix of
+  // roughly compression_ratio of the value is random, and the rest repeats
+  // it, so that compressors can shrink the value accordingly.
+  uint32_t random_bytes =
+      static_cast<uint32_t>(FLAGS_value_bytes * FLAGS_compression_ratio);
+  random_bytes = std::max(std::min(random_bytes, FLAGS_value_bytes), 8U);
   for (uint32_t i = 0; i < FLAGS_value_bytes; i += 8) {
-    EncodeFixed64(rv + i, rnd.Next());
+    if (i < random_bytes) {
+      EncodeFixed64(rv + i, rnd.Next());
+    } else {
+      memcpy(rv + i, rv + (i % random_bytes), 8);
+    }
   }
   return rv;
 }
 
+CompressionType StringToCompressionType(const std::string& ctype) {
+  if (!strcasecmp(ctype.c_str(), "none")) {
+    return kNoCompression;
+  } else if (!strcasecmp(ctype.c_str(), "snappy")) {
+    return kSnappyCompression;
+  } else if (!strcasecmp(ctype.c_str(), "zlib")) {
+    return kZlibCompression;
+  } else if (!strcasecmp(ctype.c_str(), "lz4")) {
+    return kLZ4Compression;
+  } else if (!strcasecmp(ctype.c_str(), "lz4hc")) {
+    return kLZ4HCCompression;
+  } else if (!strcasecmp(ctype.c_str(), "zstd")) {
+    return kZSTD;
+  }
+  fprintf(stderr, "Cannot parse compression type '%s'\n", ctype.c_str());
+  exit(1);
+}
+
 // Callbacks for secondary cache
 size_t SizeFn(void* /*obj*/) { return FLAGS_value_bytes; }
 
@@ -214,15 +361,9 @@ Status SaveToFn(void* obj, size_t /*offset*/, size_t size, void* out) {
 
 // Different deleters to simulate using deleter to gather
 // stats on the code origin and kind of cache entries.
-void deleter1(const Slice& /*key*/, void* value) {
-  delete[] static_cast<char*>(value);
-}
-void deleter2(const Slice& /*key*/, void* value) {
-  delete[] static_cast<char*>(value);
-}
-void deleter3(const Slice& /*key*/, void* value) {
-  delete[] static_cast<char*>(value);
-}
+void deleter1(const Slice& /*key*/, void* value) { freeValue(value); }
+void deleter2(const Slice& /*key*/, void* value) { freeValue(value); }
+void deleter3(const Slice& /*key*/, void* value) { freeValue(value); }
 
 Cache::CacheItemHelper helper1(SizeFn, SaveToFn, deleter1);
 Cache::CacheItemHelper helper2(SizeFn, SaveToFn, deleter2);
@@ -258,16 +399,61 @@ class CacheBench {
       if (max_key > (static_cast<uint64_t>(1) << max_log_)) max_log_++;
     }
 
-    if (FLAGS_use_clock_cache) {
+    if (!FLAGS_memory_allocator_uri.empty()) {
+      Status s = MemoryAllocator::CreateFromString(
+          ConfigOptions(), FLAGS_memory_allocator_uri, &memory_allocator_);
+      if (!s.ok()) {
+        fprintf(stderr, "Cannot create memory allocator %s: %s\n",
+                FLAGS_memory_allocator_uri.c_str(), s.ToString().c_str());
+        exit(1);
+      }
+      value_allocator = memory_allocator_.get();
+    }
+
+    if (FLAGS_cache_type == "clock_cache") {
       cache_ = NewClockCache(FLAGS_cache_size, FLAGS_num_shard_bits);
       if (!cache_) {
         fprintf(stderr, "Clock cache not supported.\n");
         exit(1);
       }
-    } else {
-      LRUCacheOptions opts(FLAGS_cache_size, FLAGS_num_shard_bits, false, 0.5);
+    } else if (FLAGS_cache_type == "hyper_clock_cache") {
+      if (FLAGS_use_compressed_secondary_cache ||
+          !FLAGS_secondary_cache_uri.empty()) {
+        fprintf(stderr, "Secondary cache not supported by %s.\n",
+                FLAGS_cache_type.c_str());
+        exit(1);
+      }
+      cache_ = NewHyperClockCache(FLAGS_cache_size,
+                                  FLAGS_estimated_entry_charge > 0
+                                      ? FLAGS_estimated_entry_charge
+                                      : FLAGS_value_bytes,
+                                  FLAGS_num_shard_bits,
+                                  false /* strict_capacity_limit */,
+                                  kDefaultCacheMetadataChargePolicy,
+                                  memory_allocator_);
+      if (!cache_) {
+        fprintf(stderr, "Invalid options for hyper_clock_cache.\n");
+        exit(1);
+      }
+    } else if (FLAGS_cache_type == "lru_cache") {
+      LRUCacheOptions opts(FLAGS_cache_size, FLAGS_num_shard_bits, false, 0.5,
+                           memory_allocator_);
+      if (FLAGS_use_compressed_secondary_cache) {
+        CompressedSecondaryCacheOptions secondary_cache_opts(
+            FLAGS_compressed_secondary_cache_size, FLAGS_num_shard_bits, false,
+            0.5);
+        secondary_cache_opts.compression_type = StringToCompressionType(
+            FLAGS_compressed_secondary_cache_compression_type);
+        opts.secondary_cache = NewCompressedSecondaryCache(secondary_cache_opts);
+      }
 #ifndef ROCKSDB_LITE
       if (!FLAGS_secondary_cache_uri.empty()) {
+        if (FLAGS_use_compressed_secondary_cache) {
+          fprintf(stderr,
+                  "-secondary_cache_uri and -use_compressed_secondary_cache "
+                  "are mutually exclusive.\n");
+          exit(1);
+        }
         Status s = SecondaryCache::CreateFromString(
             ConfigOptions(), FLAGS_secondary_cache_uri, &secondary_cache);
         if (secondary_cache == nullptr) {
@@ -282,10 +468,19 @@ class CacheBench {
 #endif  // ROCKSDB_LITE
 
       cache_ = NewLRUCache(opts);
+    } else {
+      fprintf(stderr, "Cache type not supported: %s\n",
+              FLAGS_cache_type.c_str());
+      exit(1);
     }
+    stats_ = CreateDBStatistics();
   }
 
-  ~CacheBench() {}
+  ~CacheBench() {
+    // Values are freed by the cache
+    cache_.reset();
+    value_allocator = nullptr;
+  }
 
   void PopulateCache() {
     Random64 rnd(1);
@@ -351,6 +546,7 @@ class CacheBench {
     ops_per_sec = static_cast<uint32_t>(1.0 * FLAGS_threads *
                                         FLAGS_ops_per_thread / elapsed_secs);
     printf("Thread ops/sec = %u\n", ops_per_sec);
+    thread_ops_per_sec_ = ops_per_sec;
 
     printf("\nOperation latency (ns):\n");
     HistogramImpl combined;
@@ -359,6 +555,42 @@ class CacheBench {
     }
     printf("%s", combined.ToString().c_str());
 
+    uint64_t lookup_count = 0;
+    uint64_t lookup_hits = 0;
+    for (uint32_t i = 0; i < FLAGS_threads; i++) {
+      lookup_count += threads[i]->lookup_count;
+      lookup_hits += threads[i]->lookup_hits;
+    }
+    uint64_t secondary_hits = stats_->getTickerCount(SECONDARY_CACHE_HITS);
+    printf("\nLookups             : %" PRIu64 "\n", lookup_count);
+    printf("Lookup hit rate     : %.2f%%\n",
+           100.0 * lookup_hits / std::max(lookup_count, uint64_t{1}));
+    if (FLAGS_use_compressed_secondary_cache) {
+      printf("Primary hit rate    : %.2f%%\n",
+             100.0 * (lookup_hits - std::min(secondary_hits, lookup_hits)) /
+                 std::max(lookup_count, uint64_t{1}));
+      printf("Secondary hit rate  : %.2f%%\n",
+             100.0 * secondary_hits / std::max(lookup_count, uint64_t{1}));
+    }
+
+    if (FLAGS_report_tlb_misses) {
+      int64_t tlb_misses = 0;
+      for (uint32_t i = 0; i < FLAGS_threads && tlb_misses >= 0; i++) {
+        tlb_misses = threads[i]->tlb_misses < 0
+                         ? -1
+                         : tlb_misses + threads[i]->tlb_misses;
+      }
+      if (tlb_misses < 0) {
+        printf("DTLB misses         : not available\n");
+      } else {
+        printf("DTLB misses         : %" PRIi64 " (%.3f per op)\n",
+               tlb_misses,
+               1.0 * tlb_misses /
+                   std::max(uint64_t{FLAGS_threads} * FLAGS_ops_per_thread,
+                            uint64_t{1}));
+      }
+    }
+
     if (FLAGS_gather_stats) {
       printf("\nGather stats latency (us):\n");
       printf("%s", stats_hist.ToString().c_str());
@@ -369,8 +601,13 @@ class CacheBench {
     return true;
   }
 
+  // Throughput of the last Run(), from the total time in each thread
+  uint32_t GetThreadOpsPerSec() const { return thread_ops_per_sec_; }
+
  private:
+  std::shared_ptr<MemoryAllocator> memory_allocator_;
   std::shared_ptr<Cache> cache_;
+  std::shared_ptr<Statistics> stats_;
   const uint64_t max_key_;
   // Cumulative thresholds in the space of a random uint64_t
   const uint64_t lookup_insert_threshold_;
@@ -379,6 +616,7 @@ class CacheBench {
   const uint64_t erase_threshold_;
   const bool skewed_;
   int max_log_;
+  uint32_t thread_ops_per_sec_ = 0;
 
   // A benchmark version of gathering stats on an active block cache by
   // iterating over it. The primary purpose is to measure the impact of
@@ -482,6 +720,10 @@ class CacheBench {
     Cache::Handle* handle = nullptr;
     KeyGen gen;
     const auto clock = SystemClock::Default().get();
+    TlbMissCounter tlb_miss_counter;
+    if (FLAGS_report_tlb_misses) {
+      tlb_miss_counter.Start();
+    }
     uint64_t start_time = clock->NowMicros();
     StopWatchNano timer(clock);
 
@@ -491,7 +733,7 @@ class CacheBench {
       uint64_t random_op = thread->rnd.Next();
       Cache::CreateCallback create_cb =
           [](void* buf, size_t size, void** out_obj, size_t* charge) -> Status {
-        *out_obj = reinterpret_cast<void*>(new char[size]);
+        *out_obj = reinterpret_cast<void*>(allocateValue(size));
         memcpy(*out_obj, buf, size);
         *charge = size;
         return Status::OK();
@@ -504,8 +746,10 @@ class CacheBench {
         }
         // do lookup
         handle = cache_->Lookup(key, &helper2, create_cb, Cache::Priority::LOW,
-                                true);
+                                true, stats_.get());
+        thread->lookup_count++;
         if (handle) {
+          thread->lookup_hits++;
           // do something with the data
           result += NPHash64(static_cast<char*>(cache_->Value(handle)),
                              FLAGS_value_bytes);
@@ -529,8 +773,10 @@ class CacheBench {
         }
         // do lookup
         handle = cache_->Lookup(key, &helper2, create_cb, Cache::Priority::LOW,
-                                true);
+                                true, stats_.get());
+        thread->lookup_count++;
         if (handle) {
+          thread->lookup_hits++;
           // do something with the data
           result += NPHash64(static_cast<char*>(cache_->Value(handle)),
                              FLAGS_value_bytes);
@@ -554,10 +800,14 @@ class CacheBench {
       exit(1);
     }
     thread->duration_us = clock->NowMicros() - start_time;
+    if (FLAGS_report_tlb_misses) {
+      thread->tlb_misses = tlb_miss_counter.Stop();
+    }
   }
 
   void PrintEnv() const {
     printf("RocksDB version     : %d.%d\n", kMajorVersion, kMinorVersion);
+    printf("Cache type          : %s\n", FLAGS_cache_type.c_str());
     printf("Number of threads   : %u\n", FLAGS_threads);
     printf("Ops per thread      : %" PRIu64 "\n", FLAGS_ops_per_thread);
     printf("Cache size          : %s\n",
@@ -571,6 +821,14 @@ class CacheBench {
     printf("Insert percentage   : %u%%\n", FLAGS_insert_percent);
     printf("Lookup percentage   : %u%%\n", FLAGS_lookup_percent);
     printf("Erase percentage    : %u%%\n", FLAGS_erase_percent);
+    printf("Compression ratio   : %g\n", FLAGS_compression_ratio);
+    printf("Memory allocator    : %s\n",
+           memory_allocator_ ? memory_allocator_->Name() : "new[]");
+    if (FLAGS_use_compressed_secondary_cache) {
+      printf("Secondary cache     : %s, %s\n",
+             BytesToHumanString(FLAGS_compressed_secondary_cache_size).c_str(),
+             FLAGS_compressed_secondary_cache_compression_type.c_str());
+    }
     std::ostringstream stats;
     if (FLAGS_gather_stats) {
       stats << "enabled (" << FLAGS_gather_stats_sleep_ms << "ms, "
@@ -763,6 +1021,53 @@ class StressCacheKey {
   double multiplier_ = 0.0;
 };
 
+namespace {
+// Runs the benchmark for each thread count in -thread_scaling, against both
+// LRUCache and HyperClockCache, to compare how they scale with concurrency.
+int RunThreadScaling() {
+  std::vector<uint32_t> thread_counts;
+  for (const std::string& count : StringSplit(FLAGS_thread_scaling, ',')) {
+    uint32_t threads = ParseUint32(count);
+    if (threads == 0) {
+      fprintf(stderr, "Invalid thread count in -thread_scaling: %s\n",
+              count.c_str());
+      exit(1);
+    }
+    thread_counts.push_back(threads);
+  }
+  const std::vector<std::string> cache_types = {"lru_cache",
+                                                "hyper_clock_cache"};
+  // ops/sec indexed by [thread count][cache type]
+  std::vector<std::vector<uint32_t>> results(thread_counts.size());
+  for (size_t i = 0; i < thread_counts.size(); ++i) {
+    for (const std::string& cache_type : cache_types) {
+      FLAGS_threads = thread_counts[i];
+      FLAGS_cache_type = cache_type;
+      CacheBench bench;
+      if (FLAGS_populate_cache) {
+        bench.PopulateCache();
+      }
+      if (!bench.Run()) {
+        return 1;
+      }
+      results[i].push_back(bench.GetThreadOpsPerSec());
+      printf("============================\n");
+    }
+  }
+
+  printf("\nThread scaling (thread ops/sec):\n");
+  printf("%8s %18s %18s %8s\n", "threads", cache_types[0].c_str(),
+         cache_types[1].c_str(), "ratio");
+  for (size_t i = 0; i < thread_counts.size(); ++i) {
+    printf("%8u %18u %18u %8.2f\n", thread_counts[i], results[i][0],
+           results[i][1],
+           static_cast<double>(results[i][1]) /
+               std::max(results[i][0], uint32_t{1}));
+  }
+  return 0;
+}
+}  // namespace
+
 int cache_bench_tool(int argc, char** argv) {
   ParseCommandLineFlags(&argc, &argv, true);
 
@@ -772,6 +1077,14 @@ int cache_bench_tool(int argc, char** argv) {
     return 0;
   }
 
+  if (FLAGS_use_clock_cache) {
+    FLAGS_cache_type = "clock_cache";
+  }
+
+  if (!FLAGS_thread_scaling.empty()) {
+    return RunThreadScaling();
+  }
+
   if (FLAGS_threads <= 0) {
     fprintf(stderr, "threads number <= 0\n");
     exit(1);
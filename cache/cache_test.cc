@@ -9,15 +9,18 @@
 
 #include "rocksdb/cache.h"
 
+#include <atomic>
 #include <forward_list>
 #include <functional>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 #include "cache/clock_cache.h"
 #include "cache/lru_cache.h"
 #include "test_util/testharness.h"
 #include "util/coding.h"
+#include "util/random.h"
 #include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -39,6 +42,7 @@ static int DecodeValue(void* v) {
 
 const std::string kLRU = "lru";
 const std::string kClock = "clock";
+const std::string kHyperClock = "hyper_clock";
 
 void dumbDeleter(const Slice& /*key*/, void* /*value*/) {}
 
@@ -62,6 +66,9 @@ class CacheTest : public testing::TestWithParam<std::string> {
   static const int kCacheSize2 = 100;
   static const int kNumShardBits2 = 2;
 
+  // Only used for the default-sized caches, which hold realistic entries
+  static const size_t kHyperClockEntryCharge = 4096;
+
   std::vector<int> deleted_keys_;
   std::vector<int> deleted_values_;
   std::shared_ptr<Cache> cache_;
@@ -83,6 +90,9 @@ class CacheTest : public testing::TestWithParam<std::string> {
     if (type == kClock) {
       return NewClockCache(capacity);
     }
+    if (type == kHyperClock) {
+      return NewHyperClockCache(capacity, kHyperClockEntryCharge);
+    }
     return nullptr;
   }
 
@@ -103,6 +113,12 @@ class CacheTest : public testing::TestWithParam<std::string> {
       return NewClockCache(capacity, num_shard_bits, strict_capacity_limit,
                            charge_policy);
     }
+    if (type == kHyperClock) {
+      // Most tests use a charge of 1 per entry
+      return NewHyperClockCache(capacity, 1 /* estimated_entry_charge */,
+                                num_shard_bits, strict_capacity_limit,
+                                charge_policy);
+    }
     return nullptr;
   }
 
@@ -515,6 +531,74 @@ TEST_P(CacheTest, HeavyEntries) {
   ASSERT_LE(cached_weight, kCacheSize + kCacheSize/10);
 }
 
+namespace {
+std::atomic<int> concurrent_deleted_count{0};
+void CountingDeleter(const Slice& /*key*/, void* /*value*/) {
+  concurrent_deleted_count.fetch_add(1, std::memory_order_relaxed);
+}
+}  // namespace
+
+TEST_P(CacheTest, ConcurrentInsertLookupErase) {
+  // Every inserted entry must be deleted exactly once, no matter how
+  // operations on the same keys interleave.
+  constexpr int kNumThreads = 4;
+  constexpr int kOpsPerThread = 20000;
+  constexpr int kNumKeys = 3 * kCacheSize;
+  concurrent_deleted_count.store(0);
+  std::atomic<int> inserted_count{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      Random rnd(301 + t);
+      std::vector<Cache::Handle*> pinned;
+      for (int i = 0; i < kOpsPerThread; ++i) {
+        std::string key = EncodeKey(static_cast<int>(rnd.Uniform(kNumKeys)));
+        switch (rnd.Uniform(4)) {
+          case 0: {
+            Cache::Handle* h = nullptr;
+            ASSERT_OK(cache_->Insert(key, nullptr, 1, &CountingDeleter,
+                                     rnd.OneIn(2) ? &h : nullptr));
+            inserted_count.fetch_add(1, std::memory_order_relaxed);
+            if (h != nullptr) {
+              pinned.push_back(h);
+            }
+            break;
+          }
+          case 1:
+          case 2: {
+            Cache::Handle* h = cache_->Lookup(key);
+            if (h != nullptr) {
+              pinned.push_back(h);
+            }
+            break;
+          }
+          default:
+            cache_->Erase(key);
+            break;
+        }
+        if (pinned.size() > 8) {
+          for (Cache::Handle* h : pinned) {
+            cache_->Release(h, rnd.OneIn(8) /* force_erase */);
+          }
+          pinned.clear();
+        }
+      }
+      for (Cache::Handle* h : pinned) {
+        cache_->Release(h);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  ASSERT_EQ(0U, cache_->GetPinnedUsage());
+  cache_->EraseUnRefEntries();
+  ASSERT_EQ(0U, cache_->GetUsage());
+  ASSERT_EQ(inserted_count.load(), concurrent_deleted_count.load());
+}
+
 TEST_P(CacheTest, NewId) {
   uint64_t a = cache_->NewId();
   uint64_t b = cache_->NewId();
@@ -696,6 +780,24 @@ TEST_P(CacheTest, OverCapacity) {
   // Make sure eviction is triggered.
   cache->SetCapacity(n);
 
+  if (GetParam() == kHyperClock) {
+    // The clock hand evicts in small steps, so this can evict a few more
+    // entries than needed, and which ones depends on the position of the
+    // hand.
+    ASSERT_GE(n, cache->GetUsage());
+    size_t found = 0;
+    for (size_t i = 0; i < n + 1; i++) {
+      std::string key = ToString(i + 1);
+      auto h = cache->Lookup(key);
+      if (h) {
+        found++;
+        cache->Release(h);
+      }
+    }
+    ASSERT_EQ(cache->GetUsage(), found);
+    return;
+  }
+
   // cache is under capacity now since elements were released
   ASSERT_EQ(n, cache->GetUsage());
 
@@ -838,9 +940,10 @@ TEST_P(CacheTest, GetChargeAndDeleter) {
 std::shared_ptr<Cache> (*new_clock_cache_func)(
     size_t, int, bool, CacheMetadataChargePolicy) = NewClockCache;
 INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest,
-                        testing::Values(kLRU, kClock));
+                        testing::Values(kLRU, kClock, kHyperClock));
 #else
-INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest, testing::Values(kLRU));
+INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest,
+                        testing::Values(kLRU, kHyperClock));
 #endif  // SUPPORT_CLOCK_CACHE
 INSTANTIATE_TEST_CASE_P(CacheTestInstance, LRUCacheTest, testing::Values(kLRU));
 
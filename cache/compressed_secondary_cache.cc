@@ -0,0 +1,201 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/compressed_secondary_cache.h"
+
+#include <memory>
+
+#include "memory/memory_allocator.h"
+#include "util/compression.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+CompressedSecondaryCacheResultHandle::~CompressedSecondaryCacheResultHandle() {
+  if (handle_ != nullptr) {
+    // Never waited on, so just drop our reference on the compressed entry
+    cache_->cache_->Release(handle_);
+    handle_ = nullptr;
+  }
+}
+
+void CompressedSecondaryCacheResultHandle::Wait() {
+  if (handle_ != nullptr) {
+    cache_->Materialize(this);
+  }
+}
+
+CompressedSecondaryCache::CompressedSecondaryCache(
+    size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+    double high_pri_pool_ratio,
+    std::shared_ptr<MemoryAllocator> memory_allocator, bool use_adaptive_mutex,
+    CacheMetadataChargePolicy metadata_charge_policy,
+    CompressionType compression_type, uint32_t compress_format_version)
+    : cache_options_(capacity, num_shard_bits, strict_capacity_limit,
+                     high_pri_pool_ratio, memory_allocator, use_adaptive_mutex,
+                     metadata_charge_policy, compression_type,
+                     compress_format_version) {
+  cache_ = NewLRUCache(capacity, num_shard_bits, strict_capacity_limit,
+                       high_pri_pool_ratio, memory_allocator,
+                       use_adaptive_mutex, metadata_charge_policy);
+}
+
+CompressedSecondaryCache::~CompressedSecondaryCache() { cache_.reset(); }
+
+void CompressedSecondaryCache::DeleteCacheValue(const Slice& /*key*/,
+                                                void* value) {
+  delete static_cast<CacheValue*>(value);
+}
+
+Status CompressedSecondaryCache::Insert(const Slice& key, void* value,
+                                        const Cache::CacheItemHelper* helper) {
+  size_t size = (*helper->size_cb)(value);
+  MemoryAllocator* allocator = cache_options_.memory_allocator.get();
+  CacheAllocationPtr ptr = AllocateBlock(size, allocator);
+
+  Status s = (*helper->saveto_cb)(value, 0, size, ptr.get());
+  if (!s.ok()) {
+    return s;
+  }
+
+  CompressionType compression_type = cache_options_.compression_type;
+  if (compression_type != kNoCompression &&
+      CompressionTypeSupported(compression_type)) {
+    CompressionOptions compression_opts;
+    CompressionContext compression_context(compression_type);
+    constexpr uint64_t sample_for_compression = 0;
+    CompressionInfo compression_info(
+        compression_opts, compression_context, CompressionDict::GetEmptyDict(),
+        compression_type, sample_for_compression);
+
+    std::string compressed_val;
+    bool success =
+        CompressData(Slice(ptr.get(), size), compression_info,
+                     cache_options_.compress_format_version, &compressed_val);
+    if (success && compressed_val.size() < size) {
+      size = compressed_val.size();
+      ptr = AllocateBlock(size, allocator);
+      memcpy(ptr.get(), compressed_val.data(), size);
+    } else {
+      // Incompressible (or failed to compress): keep the raw bytes rather
+      // than paying for decompression without any space savings.
+      compression_type = kNoCompression;
+    }
+  } else {
+    compression_type = kNoCompression;
+  }
+
+  CacheValue* cache_value = new CacheValue{std::move(ptr), size,
+                                           compression_type};
+  return cache_->Insert(key, cache_value, size, DeleteCacheValue);
+}
+
+std::unique_ptr<SecondaryCacheResultHandle> CompressedSecondaryCache::Lookup(
+    const Slice& key, const Cache::CreateCallback& create_cb, bool wait) {
+  std::unique_ptr<SecondaryCacheResultHandle> handle;
+  Cache::Handle* lru_handle = cache_->Lookup(key);
+  if (lru_handle == nullptr) {
+    return handle;
+  }
+
+  std::unique_ptr<CompressedSecondaryCacheResultHandle> result(
+      new CompressedSecondaryCacheResultHandle(this, lru_handle, create_cb));
+  if (wait) {
+    Materialize(result.get());
+    if (result->Value() == nullptr) {
+      return handle;
+    }
+  }
+  handle = std::move(result);
+  return handle;
+}
+
+void CompressedSecondaryCache::Materialize(
+    CompressedSecondaryCacheResultHandle* handle) {
+  assert(handle->handle_ != nullptr);
+  Cache::Handle* lru_handle = handle->handle_;
+  handle->handle_ = nullptr;
+
+  const CacheValue* cache_value =
+      static_cast<const CacheValue*>(cache_->Value(lru_handle));
+  char* data = cache_value->data.get();
+  size_t size = cache_value->size;
+
+  CacheAllocationPtr uncompressed;
+  if (cache_value->compression_type != kNoCompression) {
+    UncompressionContext uncompression_context(cache_value->compression_type);
+    UncompressionInfo uncompression_info(uncompression_context,
+                                         UncompressionDict::GetEmptyDict(),
+                                         cache_value->compression_type);
+    size_t uncompressed_size = 0;
+    uncompressed = UncompressData(uncompression_info, data, size,
+                                  &uncompressed_size,
+                                  cache_options_.compress_format_version,
+                                  cache_options_.memory_allocator.get());
+    data = uncompressed.get();
+    size = uncompressed_size;
+  }
+
+  if (data != nullptr) {
+    Status s = handle->create_cb_(data, size, &handle->value_, &handle->size_);
+    if (!s.ok()) {
+      handle->value_ = nullptr;
+      handle->size_ = 0;
+    }
+  }
+
+  // Either the object now lives in the primary cache, or the entry is
+  // unusable. In both cases there is no point in keeping it around.
+  cache_->Release(lru_handle, /*force_erase=*/true);
+}
+
+void CompressedSecondaryCache::Erase(const Slice& key) { cache_->Erase(key); }
+
+void CompressedSecondaryCache::WaitAll(
+    std::vector<SecondaryCacheResultHandle*> handles) {
+  for (SecondaryCacheResultHandle* handle : handles) {
+    handle->Wait();
+  }
+}
+
+std::string CompressedSecondaryCache::GetPrintableOptions() const {
+  std::string ret;
+  ret.reserve(20000);
+  const int kBufferSize = 200;
+  char buffer[kBufferSize];
+  ret.append(cache_->GetPrintableOptions());
+  snprintf(buffer, kBufferSize, "    compression_type : %s\n",
+           CompressionTypeToString(cache_options_.compression_type).c_str());
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    compress_format_version : %u\n",
+           cache_options_.compress_format_version);
+  ret.append(buffer);
+  return ret;
+}
+
+std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+    double high_pri_pool_ratio,
+    std::shared_ptr<MemoryAllocator> memory_allocator, bool use_adaptive_mutex,
+    CacheMetadataChargePolicy metadata_charge_policy,
+    CompressionType compression_type, uint32_t compress_format_version) {
+  return std::make_shared<CompressedSecondaryCache>(
+      capacity, num_shard_bits, strict_capacity_limit, high_pri_pool_ratio,
+      memory_allocator, use_adaptive_mutex, metadata_charge_policy,
+      compression_type, compress_format_version);
+}
+
+std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts) {
+  // The secondary_cache is disabled for this LRUCache instance.
+  assert(opts.secondary_cache == nullptr);
+  return NewCompressedSecondaryCache(
+      opts.capacity, opts.num_shard_bits, opts.strict_capacity_limit,
+      opts.high_pri_pool_ratio, opts.memory_allocator, opts.use_adaptive_mutex,
+      opts.metadata_charge_policy, opts.compression_type,
+      opts.compress_format_version);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,125 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include "cache/lru_cache.h"
+#include "memory/memory_allocator.h"
+#include "rocksdb/secondary_cache.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CompressedSecondaryCache;
+
+// The result of a CompressedSecondaryCache lookup. The handle keeps a
+// reference on the compressed entry in the underlying LRUCache until it
+// has been materialized, i.e. uncompressed and handed to the create
+// callback. A synchronous lookup materializes the handle before returning
+// it, while an asynchronous one defers that work to Wait(), so that the
+// caller can batch it with other lookups (see WaitAll()).
+class CompressedSecondaryCacheResultHandle : public SecondaryCacheResultHandle {
+ public:
+  CompressedSecondaryCacheResultHandle(CompressedSecondaryCache* cache,
+                                       Cache::Handle* handle,
+                                       const Cache::CreateCallback& create_cb)
+      : cache_(cache),
+        handle_(handle),
+        create_cb_(create_cb),
+        value_(nullptr),
+        size_(0) {}
+  ~CompressedSecondaryCacheResultHandle() override;
+
+  CompressedSecondaryCacheResultHandle(
+      const CompressedSecondaryCacheResultHandle&) = delete;
+  CompressedSecondaryCacheResultHandle& operator=(
+      const CompressedSecondaryCacheResultHandle&) = delete;
+
+  bool IsReady() override { return handle_ == nullptr; }
+
+  void Wait() override;
+
+  void* Value() override { return value_; }
+
+  size_t Size() override { return size_; }
+
+ private:
+  friend class CompressedSecondaryCache;
+
+  CompressedSecondaryCache* cache_;
+  // Handle to the compressed entry in CompressedSecondaryCache::cache_.
+  // nullptr once the result has been materialized.
+  Cache::Handle* handle_;
+  Cache::CreateCallback create_cb_;
+  void* value_;
+  size_t size_;
+};
+
+// The CompressedSecondaryCache is a concrete implementation of
+// rocksdb::SecondaryCache.
+//
+// Users can also cast a pointer to it and call methods on
+// it directly, especially custom methods that may be added
+// in the future.  For example -
+// std::unique_ptr<rocksdb::SecondaryCache> cache =
+//      NewCompressedSecondaryCache(opts);
+// static_cast<CompressedSecondaryCache*>(cache.get())->Erase(key);
+
+class CompressedSecondaryCache : public SecondaryCache {
+ public:
+  CompressedSecondaryCache(
+      size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+      double high_pri_pool_ratio,
+      std::shared_ptr<MemoryAllocator> memory_allocator = nullptr,
+      bool use_adaptive_mutex = kDefaultToAdaptiveMutex,
+      CacheMetadataChargePolicy metadata_charge_policy =
+          kDefaultCacheMetadataChargePolicy,
+      CompressionType compression_type = CompressionType::kLZ4Compression,
+      uint32_t compress_format_version = 2);
+  virtual ~CompressedSecondaryCache() override;
+
+  const char* Name() const override { return "CompressedSecondaryCache"; }
+
+  Status Insert(const Slice& key, void* value,
+                const Cache::CacheItemHelper* helper) override;
+
+  std::unique_ptr<SecondaryCacheResultHandle> Lookup(
+      const Slice& key, const Cache::CreateCallback& create_cb,
+      bool wait) override;
+
+  void Erase(const Slice& key) override;
+
+  void WaitAll(std::vector<SecondaryCacheResultHandle*> handles) override;
+
+  std::string GetPrintableOptions() const override;
+
+ private:
+  friend class CompressedSecondaryCacheResultHandle;
+
+  // The object stored in cache_ for every inserted key.
+  struct CacheValue {
+    CacheAllocationPtr data;
+    size_t size;
+    // kNoCompression if the data could not be (usefully) compressed
+    CompressionType compression_type;
+  };
+
+  static void DeleteCacheValue(const Slice& key, void* value);
+
+  // Uncompress the entry referenced by handle and create the primary cache
+  // object from it. Releases the reference on the compressed entry and
+  // erases it whatever the outcome: either the object now lives in the
+  // primary cache, or the entry could not be used.
+  void Materialize(CompressedSecondaryCacheResultHandle* handle);
+
+  std::shared_ptr<Cache> cache_;
+  CompressedSecondaryCacheOptions cache_options_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,326 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/compressed_secondary_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "port/stack_trace.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "util/compression.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CompressedSecondaryCacheTest : public testing::Test {
+ public:
+  CompressedSecondaryCacheTest() : fail_create_(false) {}
+  ~CompressedSecondaryCacheTest() {}
+
+ protected:
+  class TestItem {
+   public:
+    TestItem(const char* buf, size_t size) : buf_(new char[size]), size_(size) {
+      memcpy(buf_.get(), buf, size);
+    }
+    ~TestItem() {}
+
+    char* Buf() { return buf_.get(); }
+    size_t Size() { return size_; }
+    std::string ToString() { return std::string(Buf(), Size()); }
+
+   private:
+    std::unique_ptr<char[]> buf_;
+    size_t size_;
+  };
+
+  static size_t SizeCallback(void* obj) {
+    return reinterpret_cast<TestItem*>(obj)->Size();
+  }
+
+  static Status SaveToCallback(void* from_obj, size_t from_offset,
+                               size_t length, void* out) {
+    TestItem* item = reinterpret_cast<TestItem*>(from_obj);
+    const char* buf = item->Buf();
+    EXPECT_EQ(length, item->Size());
+    EXPECT_EQ(from_offset, 0);
+    memcpy(out, buf, length);
+    return Status::OK();
+  }
+
+  static void DeletionCallback(const Slice& /*key*/, void* obj) {
+    delete reinterpret_cast<TestItem*>(obj);
+    obj = nullptr;
+  }
+
+  static Cache::CacheItemHelper helper_;
+
+  static Status SaveToCallbackFail(void* /*obj*/, size_t /*offset*/,
+                                   size_t /*size*/, void* /*out*/) {
+    return Status::NotSupported();
+  }
+
+  static Cache::CacheItemHelper helper_fail_;
+
+  Cache::CreateCallback test_item_creator = [&](void* buf, size_t size,
+                                                void** out_obj,
+                                                size_t* charge) -> Status {
+    if (fail_create_) {
+      return Status::NotSupported();
+    }
+    *out_obj = reinterpret_cast<void*>(new TestItem((char*)buf, size));
+    *charge = size;
+    return Status::OK();
+  };
+
+  void SetFailCreate(bool fail) { fail_create_ = fail; }
+
+  void BasicTest(CompressionType compression_type) {
+    CompressedSecondaryCacheOptions opts;
+    opts.capacity = 2048;
+    opts.num_shard_bits = 0;
+    opts.metadata_charge_policy = kDontChargeCacheMetadata;
+    opts.compression_type = compression_type;
+    std::shared_ptr<SecondaryCache> cache = NewCompressedSecondaryCache(opts);
+
+    // Lookup an non-existent key.
+    std::unique_ptr<SecondaryCacheResultHandle> handle0 =
+        cache->Lookup("k0", test_item_creator, true);
+    ASSERT_EQ(handle0, nullptr);
+
+    Random rnd(301);
+    // Insert and Lookup the first item.
+    std::string str1;
+    test::CompressibleString(&rnd, 0.25, 1000, &str1);
+    TestItem item1(str1.data(), str1.length());
+    ASSERT_OK(cache->Insert("k1", &item1,
+                            &CompressedSecondaryCacheTest::helper_));
+    std::unique_ptr<SecondaryCacheResultHandle> handle1 =
+        cache->Lookup("k1", test_item_creator, true);
+    ASSERT_NE(handle1, nullptr);
+    ASSERT_TRUE(handle1->IsReady());
+    std::unique_ptr<TestItem> val1 =
+        std::unique_ptr<TestItem>(static_cast<TestItem*>(handle1->Value()));
+    ASSERT_NE(val1, nullptr);
+    ASSERT_EQ(memcmp(val1->Buf(), item1.Buf(), item1.Size()), 0);
+
+    // The item was promoted, so it is no longer in the secondary cache.
+    handle1 = cache->Lookup("k1", test_item_creator, true);
+    ASSERT_EQ(handle1, nullptr);
+
+    // Insert and Lookup the second item, asynchronously.
+    std::string str2;
+    test::CompressibleString(&rnd, 0.5, 1000, &str2);
+    TestItem item2(str2.data(), str2.length());
+    ASSERT_OK(cache->Insert("k2", &item2,
+                            &CompressedSecondaryCacheTest::helper_));
+    std::unique_ptr<SecondaryCacheResultHandle> handle2 =
+        cache->Lookup("k2", test_item_creator, false);
+    ASSERT_NE(handle2, nullptr);
+    ASSERT_FALSE(handle2->IsReady());
+    handle2->Wait();
+    ASSERT_TRUE(handle2->IsReady());
+    std::unique_ptr<TestItem> val2 =
+        std::unique_ptr<TestItem>(static_cast<TestItem*>(handle2->Value()));
+    ASSERT_NE(val2, nullptr);
+    ASSERT_EQ(memcmp(val2->Buf(), item2.Buf(), item2.Size()), 0);
+
+    // An asynchronous handle that is never waited on leaves the entry in
+    // the cache.
+    ASSERT_OK(cache->Insert("k2", &item2,
+                            &CompressedSecondaryCacheTest::helper_));
+    handle2 = cache->Lookup("k2", test_item_creator, false);
+    ASSERT_NE(handle2, nullptr);
+    handle2.reset();
+    handle2 = cache->Lookup("k2", test_item_creator, true);
+    ASSERT_NE(handle2, nullptr);
+    val2.reset(static_cast<TestItem*>(handle2->Value()));
+    ASSERT_EQ(memcmp(val2->Buf(), item2.Buf(), item2.Size()), 0);
+
+    cache.reset();
+  }
+
+ private:
+  bool fail_create_;
+};
+
+Cache::CacheItemHelper CompressedSecondaryCacheTest::helper_(
+    CompressedSecondaryCacheTest::SizeCallback,
+    CompressedSecondaryCacheTest::SaveToCallback,
+    CompressedSecondaryCacheTest::DeletionCallback);
+
+Cache::CacheItemHelper CompressedSecondaryCacheTest::helper_fail_(
+    CompressedSecondaryCacheTest::SizeCallback,
+    CompressedSecondaryCacheTest::SaveToCallbackFail,
+    CompressedSecondaryCacheTest::DeletionCallback);
+
+TEST_F(CompressedSecondaryCacheTest, BasicTestWithNoCompression) {
+  BasicTest(kNoCompression);
+}
+
+TEST_F(CompressedSecondaryCacheTest, BasicTestWithLZ4Compression) {
+  if (!LZ4_Supported()) {
+    ROCKSDB_GTEST_SKIP("This test requires LZ4 support.");
+    return;
+  }
+  BasicTest(kLZ4Compression);
+}
+
+TEST_F(CompressedSecondaryCacheTest, BasicTestWithZSTDCompression) {
+  if (!ZSTD_Supported()) {
+    ROCKSDB_GTEST_SKIP("This test requires ZSTD support.");
+    return;
+  }
+  BasicTest(kZSTD);
+}
+
+TEST_F(CompressedSecondaryCacheTest, IncompressibleValue) {
+  // Whatever the configured compression, random data is kept uncompressed
+  // and must round trip unchanged.
+  std::shared_ptr<SecondaryCache> cache =
+      NewCompressedSecondaryCache(4096, 0, false, 0.5, nullptr,
+                                  kDefaultToAdaptiveMutex,
+                                  kDontChargeCacheMetadata, kLZ4Compression);
+  Random rnd(301);
+  std::string str1 = rnd.RandomString(1000);
+  TestItem item1(str1.data(), str1.length());
+  ASSERT_OK(cache->Insert("k1", &item1, &CompressedSecondaryCacheTest::helper_));
+  std::unique_ptr<SecondaryCacheResultHandle> handle1 =
+      cache->Lookup("k1", test_item_creator, true);
+  ASSERT_NE(handle1, nullptr);
+  std::unique_ptr<TestItem> val1(static_cast<TestItem*>(handle1->Value()));
+  ASSERT_NE(val1, nullptr);
+  ASSERT_EQ(val1->ToString(), str1);
+}
+
+TEST_F(CompressedSecondaryCacheTest, FailsTest) {
+  CompressedSecondaryCacheOptions opts;
+  opts.capacity = 1100;
+  opts.num_shard_bits = 0;
+  opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  opts.compression_type = kNoCompression;
+  std::shared_ptr<SecondaryCache> cache = NewCompressedSecondaryCache(opts);
+
+  Random rnd(301);
+  std::string str1(rnd.RandomString(1000));
+  TestItem item1(str1.data(), str1.length());
+  ASSERT_OK(cache->Insert("k1", &item1, &CompressedSecondaryCacheTest::helper_));
+
+  // Saving the item fails.
+  ASSERT_NOK(cache->Insert("k2", &item1,
+                           &CompressedSecondaryCacheTest::helper_fail_));
+  std::unique_ptr<SecondaryCacheResultHandle> handle2 =
+      cache->Lookup("k2", test_item_creator, true);
+  ASSERT_EQ(handle2, nullptr);
+
+  // Creating the primary cache object fails: the lookup misses, and the
+  // unusable entry is dropped.
+  SetFailCreate(true);
+  std::unique_ptr<SecondaryCacheResultHandle> handle1 =
+      cache->Lookup("k1", test_item_creator, true);
+  ASSERT_EQ(handle1, nullptr);
+  SetFailCreate(false);
+  handle1 = cache->Lookup("k1", test_item_creator, true);
+  ASSERT_EQ(handle1, nullptr);
+
+  // Same for an asynchronous lookup, which only learns about the failure
+  // once it is waited on.
+  ASSERT_OK(cache->Insert("k1", &item1, &CompressedSecondaryCacheTest::helper_));
+  SetFailCreate(true);
+  handle1 = cache->Lookup("k1", test_item_creator, false);
+  ASSERT_NE(handle1, nullptr);
+  handle1->Wait();
+  ASSERT_TRUE(handle1->IsReady());
+  ASSERT_EQ(handle1->Value(), nullptr);
+  SetFailCreate(false);
+
+  cache.reset();
+}
+
+TEST_F(CompressedSecondaryCacheTest, WaitAllWithLRUCache) {
+  CompressedSecondaryCacheOptions secondary_cache_opts;
+  secondary_cache_opts.capacity = 32 * 1024;
+  secondary_cache_opts.num_shard_bits = 0;
+  secondary_cache_opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  std::shared_ptr<SecondaryCache> secondary_cache =
+      NewCompressedSecondaryCache(secondary_cache_opts);
+
+  LRUCacheOptions opts(1024, 2, false, 0.5, nullptr, kDefaultToAdaptiveMutex,
+                       kDontChargeCacheMetadata);
+  opts.secondary_cache = secondary_cache;
+  std::shared_ptr<Cache> cache = NewLRUCache(opts);
+  std::shared_ptr<Statistics> stats = CreateDBStatistics();
+  const int num_keys = 16;
+
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < num_keys; ++i) {
+    std::string str;
+    test::CompressibleString(&rnd, 0.5, 1000, &str);
+    values.emplace_back(str);
+    TestItem* item = new TestItem(str.data(), str.length());
+    ASSERT_OK(cache->Insert("k" + std::to_string(i), item,
+                            &CompressedSecondaryCacheTest::helper_,
+                            str.length()));
+  }
+  // Force all entries to be evicted to the secondary cache
+  cache->SetCapacity(0);
+  cache->SetCapacity(32 * 1024);
+
+  std::vector<Cache::Handle*> results;
+  for (int i = 0; i < num_keys; ++i) {
+    results.emplace_back(cache->Lookup(
+        "k" + std::to_string(i), &CompressedSecondaryCacheTest::helper_,
+        test_item_creator, Cache::Priority::LOW, false, stats.get()));
+    ASSERT_NE(results.back(), nullptr);
+    ASSERT_FALSE(cache->IsReady(results.back()));
+  }
+  ASSERT_EQ(stats->getTickerCount(SECONDARY_CACHE_HITS),
+            static_cast<uint64_t>(num_keys));
+
+  // Wait on one handle individually, and the rest as a batch
+  cache->Wait(results[0]);
+  ASSERT_TRUE(cache->IsReady(results[0]));
+  cache->WaitAll(results);
+  for (int i = 0; i < num_keys; ++i) {
+    ASSERT_TRUE(cache->IsReady(results[i]));
+    TestItem* item = static_cast<TestItem*>(cache->Value(results[i]));
+    ASSERT_NE(item, nullptr);
+    ASSERT_EQ(item->ToString(), values[i]);
+    cache->Release(results[i]);
+  }
+
+  // Promoted entries are served from the primary cache from now on
+  Cache::Handle* handle = cache->Lookup(
+      "k1", &CompressedSecondaryCacheTest::helper_, test_item_creator,
+      Cache::Priority::LOW, true, stats.get());
+  ASSERT_NE(handle, nullptr);
+  cache->Release(handle);
+  ASSERT_EQ(stats->getTickerCount(SECONDARY_CACHE_HITS),
+            static_cast<uint64_t>(num_keys));
+
+  cache.reset();
+  secondary_cache.reset();
+}
+
+TEST_F(CompressedSecondaryCacheTest, GetPrintableOptions) {
+  std::shared_ptr<SecondaryCache> cache =
+      NewCompressedSecondaryCache(1024, 0, false, 0.5, nullptr,
+                                  kDefaultToAdaptiveMutex,
+                                  kDontChargeCacheMetadata, kZSTD, 2);
+  std::string options = cache->GetPrintableOptions();
+  ASSERT_NE(options.find("compression_type : ZSTD"), std::string::npos);
+  ASSERT_NE(options.find("compress_format_version : 2"), std::string::npos);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,817 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#include "cache/hyper_clock_cache.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "port/lang.h"
+#include "port/likely.h"
+#include "util/hash.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// See HyperClockHandle for the layout of the meta word.
+constexpr int kCounterNumBits = 30;
+constexpr uint64_t kCounterMask = (uint64_t{1} << kCounterNumBits) - 1;
+constexpr int kAcquireCounterShift = 0;
+constexpr uint64_t kAcquireIncrement = uint64_t{1} << kAcquireCounterShift;
+constexpr int kReleaseCounterShift = kCounterNumBits;
+constexpr uint64_t kReleaseIncrement = uint64_t{1} << kReleaseCounterShift;
+constexpr int kStateShift = 2 * kCounterNumBits;
+
+constexpr uint64_t kStateOccupiedBit = 0b100;
+constexpr uint64_t kStateShareableBit = 0b010;
+constexpr uint64_t kStateVisibleBit = 0b001;
+
+constexpr uint64_t kStateEmpty = 0b000;
+constexpr uint64_t kStateConstruction = kStateOccupiedBit;
+constexpr uint64_t kStateInvisible = kStateOccupiedBit | kStateShareableBit;
+constexpr uint64_t kStateVisible =
+    kStateOccupiedBit | kStateShareableBit | kStateVisibleBit;
+
+// Clock countdowns. An unreferenced entry survives up to kMaxCountdown
+// passes of the clock hand without being used.
+constexpr uint64_t kMaxCountdown = 3;
+constexpr uint64_t kHighCountdown = 3;
+constexpr uint64_t kLowCountdown = 2;
+
+// Target ratio of occupied slots, used for sizing the table.
+constexpr double kLoadFactor = 0.7;
+// Entries beyond this ratio of occupied slots are only inserted after
+// evicting another, to keep probe sequences short.
+constexpr double kStrictLoadFactor = 0.84;
+
+constexpr int kMinLengthBits = 4;
+// So that a slot index always fits the uint32_t state of ApplyToSomeEntries
+constexpr int kMaxLengthBits = 30;
+
+// Multipliers for deriving the probe sequence from the 32-bit hash, whose
+// low bits are already used to pick the shard.
+constexpr uint64_t kProbeBaseMultiplier = 0x9E3779B97F4A7C15ULL;
+constexpr uint64_t kProbeIncrementMultiplier = 0xC2B2AE3D27D4EB4FULL;
+
+inline uint64_t GetState(uint64_t meta) { return meta >> kStateShift; }
+
+inline uint64_t GetRefcount(uint64_t meta) {
+  return ((meta >> kAcquireCounterShift) - (meta >> kReleaseCounterShift)) &
+         kCounterMask;
+}
+
+inline void GetProbeSequence(uint32_t hash, size_t* base, size_t* increment) {
+  *base = Upper32of64(uint64_t{hash} * kProbeBaseMultiplier);
+  // Odd, so that the probe sequence covers the whole power-of-two table
+  *increment = Upper32of64(uint64_t{hash} * kProbeIncrementMultiplier) | 1U;
+}
+
+// The counters keep growing with every reference, and need to be brought
+// back down before the acquire counter overflows into the release counter.
+// Since acquire >= release (modulo references held), clearing the top bit of
+// both once the release counter has it set preserves the reference count.
+inline void CorrectNearOverflow(uint64_t old_meta,
+                                std::atomic<uint64_t>& meta) {
+  constexpr uint64_t kCounterTopBit = uint64_t{1} << (kCounterNumBits - 1);
+  constexpr uint64_t kClearBits = (kCounterTopBit << kAcquireCounterShift) |
+                                  (kCounterTopBit << kReleaseCounterShift);
+  if (UNLIKELY(old_meta & (kCounterTopBit << kReleaseCounterShift))) {
+    meta.fetch_and(~kClearBits, std::memory_order_relaxed);
+  }
+}
+
+int CalcLengthBits(size_t capacity, size_t estimated_entry_charge,
+                   CacheMetadataChargePolicy metadata_charge_policy) {
+  double entry_charge = static_cast<double>(estimated_entry_charge);
+  if (metadata_charge_policy == kFullChargeCacheMetadata) {
+    entry_charge += sizeof(HyperClockHandle);
+  }
+  double num_slots =
+      std::ceil(static_cast<double>(capacity) / entry_charge / kLoadFactor);
+  int length_bits = kMinLengthBits;
+  while (length_bits < kMaxLengthBits &&
+         static_cast<double>(uint64_t{1} << length_bits) < num_slots) {
+    ++length_bits;
+  }
+  return length_bits;
+}
+
+void FreeData(HyperClockHandle* h) {
+  if (h->deleter != nullptr) {
+    (*h->deleter)(h->key(), h->value);
+  }
+  if (h->HasHeapKey()) {
+    delete[] h->heap_key;
+  }
+}
+
+}  // namespace
+
+HyperClockCacheShard::HyperClockCacheShard(
+    size_t capacity, size_t estimated_entry_charge, bool strict_capacity_limit,
+    CacheMetadataChargePolicy metadata_charge_policy)
+    : length_bits_(CalcLengthBits(capacity, estimated_entry_charge,
+                                  metadata_charge_policy)),
+      length_bits_mask_((size_t{1} << length_bits_) - 1),
+      occupancy_limit_(std::max(
+          size_t{1}, static_cast<size_t>((length_bits_mask_ + 1) *
+                                         kStrictLoadFactor))),
+      estimated_entry_charge_(estimated_entry_charge),
+      array_(new HyperClockHandle[length_bits_mask_ + 1]()),
+      capacity_(capacity),
+      strict_capacity_limit_(strict_capacity_limit) {
+  set_metadata_charge_policy(metadata_charge_policy);
+}
+
+HyperClockCacheShard::~HyperClockCacheShard() {
+  // No outstanding references are allowed at this point
+  for (size_t i = 0; i <= length_bits_mask_; i++) {
+    HyperClockHandle* h = &array_[i];
+    uint64_t meta = h->meta.load(std::memory_order_relaxed);
+    if (GetState(meta) & kStateShareableBit) {
+      assert(GetRefcount(meta) == 0);
+      FreeData(h);
+    }
+  }
+}
+
+template <typename MatchFn, typename AbortFn, typename UpdateFn>
+inline HyperClockHandle* HyperClockCacheShard::FindSlot(
+    uint32_t hash, MatchFn match_fn, AbortFn abort_fn, UpdateFn update_fn,
+    size_t* probes) {
+  size_t base, increment;
+  GetProbeSequence(hash, &base, &increment);
+  size_t current = base & length_bits_mask_;
+  for (size_t count = 0; count <= length_bits_mask_; count++) {
+    HyperClockHandle* h = &array_[current];
+    if (match_fn(h)) {
+      *probes = count;
+      return h;
+    }
+    if (abort_fn(h)) {
+      *probes = count;
+      return nullptr;
+    }
+    update_fn(h);
+    current = (current + increment) & length_bits_mask_;
+  }
+  // Probed all slots
+  *probes = length_bits_mask_ + 1;
+  return nullptr;
+}
+
+void HyperClockCacheShard::Rollback(uint32_t hash, size_t probes) {
+  size_t base, increment;
+  GetProbeSequence(hash, &base, &increment);
+  size_t current = base & length_bits_mask_;
+  for (size_t count = 0; count < probes; count++) {
+    array_[current].displacements.fetch_sub(1, std::memory_order_relaxed);
+    current = (current + increment) & length_bits_mask_;
+  }
+}
+
+void HyperClockCacheShard::Rollback(uint32_t hash, const HyperClockHandle* h) {
+  size_t base, increment;
+  GetProbeSequence(hash, &base, &increment);
+  size_t current = base & length_bits_mask_;
+  for (size_t count = 0; count <= length_bits_mask_; count++) {
+    if (&array_[current] == h) {
+      return;
+    }
+    array_[current].displacements.fetch_sub(1, std::memory_order_relaxed);
+    current = (current + increment) & length_bits_mask_;
+  }
+  assert(false);
+}
+
+void HyperClockCacheShard::FreeEntry(HyperClockHandle* h) {
+  assert(GetState(h->meta.load(std::memory_order_relaxed)) ==
+         kStateConstruction);
+  uint32_t hash = h->hash;
+  FreeData(h);
+  // Stray increments from optimistic lookups are discarded here.
+  h->meta.store(0, std::memory_order_release);
+  occupancy_.fetch_sub(1U, std::memory_order_release);
+  Rollback(hash, h);
+}
+
+void HyperClockCacheShard::Evict(size_t requested_charge, size_t* freed_charge,
+                                 size_t* freed_count) {
+  assert(requested_charge > 0);
+  // Number of slots each thread claims from the clock hand at a time
+  constexpr size_t kStepSize = 4;
+
+  uint64_t old_clock_pointer =
+      clock_pointer_.fetch_add(kStepSize, std::memory_order_relaxed);
+  // Cap the eviction effort at this thread (along with those operating in
+  // parallel) circling through the whole table enough times for any
+  // unreferenced entry to count down to zero and be evicted.
+  uint64_t max_clock_pointer =
+      old_clock_pointer + ((kMaxCountdown + 1) << length_bits_);
+
+  for (;;) {
+    for (size_t i = 0; i < kStepSize; i++) {
+      HyperClockHandle* h =
+          &array_[static_cast<size_t>(old_clock_pointer + i) &
+                  length_bits_mask_];
+      uint64_t meta = h->meta.load(std::memory_order_relaxed);
+      if (!(GetState(meta) & kStateShareableBit)) {
+        // Only entries can be evicted
+        continue;
+      }
+      if (GetRefcount(meta) != 0) {
+        // Only unreferenced entries can be evicted or counted down
+        continue;
+      }
+      uint64_t countdown = (meta >> kAcquireCounterShift) & kCounterMask;
+      if (GetState(meta) == kStateVisible && countdown > 0) {
+        // Decrement the clock, but without trying too hard: losing a race
+        // with a lookup means the entry was just used.
+        uint64_t new_countdown = std::min(countdown - 1, kMaxCountdown - 1);
+        uint64_t new_meta = (kStateVisible << kStateShift) |
+                            (new_countdown << kReleaseCounterShift) |
+                            (new_countdown << kAcquireCounterShift);
+        h->meta.compare_exchange_strong(meta, new_meta,
+                                        std::memory_order_relaxed);
+        continue;
+      }
+      // Unreferenced and either expired or invisible: take ownership and
+      // evict.
+      if (h->meta.compare_exchange_strong(meta,
+                                          kStateConstruction << kStateShift,
+                                          std::memory_order_acquire)) {
+        *freed_charge += h->GetTotalCharge(metadata_charge_policy_);
+        *freed_count += 1;
+        uint32_t hash = h->hash;
+        FreeData(h);
+        h->meta.store(0, std::memory_order_release);
+        Rollback(hash, h);
+      }
+    }
+
+    if (*freed_charge >= requested_charge) {
+      return;
+    }
+    if (old_clock_pointer >= max_clock_pointer) {
+      return;
+    }
+    old_clock_pointer =
+        clock_pointer_.fetch_add(kStepSize, std::memory_order_relaxed);
+  }
+}
+
+Status HyperClockCacheShard::ChargeUsageMaybeEvictStrict(
+    size_t total_charge, size_t capacity, bool need_evict_for_occupancy) {
+  if (total_charge > capacity) {
+    return Status::Incomplete(
+        "Insert failed because entry is larger than the cache capacity.");
+  }
+  // Grab any available capacity, and free up any more required.
+  size_t old_usage = usage_.load(std::memory_order_relaxed);
+  size_t new_usage;
+  if (LIKELY(old_usage != capacity)) {
+    do {
+      new_usage = std::min(capacity, old_usage + total_charge);
+    } while (!usage_.compare_exchange_weak(old_usage, new_usage,
+                                           std::memory_order_relaxed));
+  } else {
+    new_usage = old_usage;
+  }
+  size_t need_evict_charge = old_usage + total_charge - new_usage;
+  size_t request_evict_charge = need_evict_charge;
+  if (UNLIKELY(need_evict_for_occupancy) && request_evict_charge == 0) {
+    // Require at least one eviction
+    request_evict_charge = 1;
+  }
+  if (request_evict_charge > 0) {
+    size_t evicted_charge = 0;
+    size_t evicted_count = 0;
+    Evict(request_evict_charge, &evicted_charge, &evicted_count);
+    occupancy_.fetch_sub(evicted_count, std::memory_order_release);
+    if (LIKELY(evicted_charge > need_evict_charge)) {
+      assert(evicted_count > 0);
+      // Evicted more than enough
+      usage_.fetch_sub(evicted_charge - need_evict_charge,
+                       std::memory_order_relaxed);
+    } else if (evicted_charge < need_evict_charge ||
+               (UNLIKELY(need_evict_for_occupancy) && evicted_count == 0)) {
+      // Roll back to old usage minus evicted
+      usage_.fetch_sub(evicted_charge + (new_usage - old_usage),
+                       std::memory_order_relaxed);
+      return Status::Incomplete("Insert failed due to cache being full.");
+    }
+  }
+  return Status::OK();
+}
+
+bool HyperClockCacheShard::ChargeUsageMaybeEvictNonStrict(
+    size_t total_charge, size_t capacity, bool need_evict_for_occupancy) {
+  // For simplicity, either the cache can accept the insert with no
+  // evictions, or we evict at least enough to make room for it. Since racing
+  // inserts can take us over capacity, evict a little extra in that case so
+  // that we get back under the limit, rather than every insert evicting just
+  // its own charge.
+  size_t old_usage = usage_.load(std::memory_order_relaxed);
+  size_t need_evict_charge;
+  // If total_charge > old_usage, there isn't enough to evict anyway (much of
+  // the usage is probably pinned by this thread), so don't bother.
+  if (old_usage + total_charge <= capacity || total_charge > old_usage) {
+    need_evict_charge = 0;
+  } else {
+    need_evict_charge = total_charge;
+    if (old_usage > capacity) {
+      need_evict_charge += std::min(capacity / 1024, total_charge) + 1;
+    }
+  }
+  if (UNLIKELY(need_evict_for_occupancy) && need_evict_charge == 0) {
+    need_evict_charge = 1;
+  }
+  size_t evicted_charge = 0;
+  size_t evicted_count = 0;
+  if (need_evict_charge > 0) {
+    Evict(need_evict_charge, &evicted_charge, &evicted_count);
+    if (UNLIKELY(need_evict_for_occupancy) && evicted_count == 0) {
+      assert(evicted_charge == 0);
+      // Can't meet occupancy requirement
+      return false;
+    }
+    occupancy_.fetch_sub(evicted_count, std::memory_order_release);
+  }
+  // Track new usage even if we weren't able to evict enough
+  if (total_charge >= evicted_charge) {
+    usage_.fetch_add(total_charge - evicted_charge, std::memory_order_relaxed);
+  } else {
+    usage_.fetch_sub(evicted_charge - total_charge, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+Status HyperClockCacheShard::Insert(const Slice& key, uint32_t hash,
+                                    void* value, size_t charge,
+                                    DeleterFn deleter, Cache::Handle** handle,
+                                    Cache::Priority priority) {
+  HyperClockHandle proto;
+  proto.value = value;
+  proto.deleter = deleter;
+  proto.charge = charge;
+  proto.hash = hash;
+  proto.key_length = static_cast<uint32_t>(key.size());
+  proto.detached = false;
+  const size_t total_charge = proto.GetTotalCharge(metadata_charge_policy_);
+  const size_t capacity = capacity_.load(std::memory_order_relaxed);
+
+  // Optimistically assume there is room in the table, and deal with it if
+  // there isn't.
+  size_t old_occupancy = occupancy_.fetch_add(1, std::memory_order_acquire);
+  bool need_evict_for_occupancy = old_occupancy >= occupancy_limit_;
+
+  bool use_detached_insert = false;
+  if (strict_capacity_limit_.load(std::memory_order_relaxed)) {
+    Status s = ChargeUsageMaybeEvictStrict(total_charge, capacity,
+                                           need_evict_for_occupancy);
+    if (!s.ok()) {
+      occupancy_.fetch_sub(1, std::memory_order_relaxed);
+      if (handle == nullptr) {
+        // Don't insert the entry but still return ok, as if the entry was
+        // inserted into cache and evicted immediately.
+        if (deleter != nullptr) {
+          (*deleter)(key, value);
+        }
+        return Status::OK();
+      }
+      *handle = nullptr;
+      return s;
+    }
+  } else if (!ChargeUsageMaybeEvictNonStrict(total_charge, capacity,
+                                             need_evict_for_occupancy)) {
+    occupancy_.fetch_sub(1, std::memory_order_relaxed);
+    if (handle == nullptr) {
+      if (deleter != nullptr) {
+        (*deleter)(key, value);
+      }
+      return Status::OK();
+    }
+    // The caller needs a handle; give it one that lives outside the table.
+    usage_.fetch_add(total_charge, std::memory_order_relaxed);
+    use_detached_insert = true;
+  }
+
+  const uint64_t initial_countdown =
+      priority == Cache::Priority::HIGH ? kHighCountdown : kLowCountdown;
+
+  HyperClockHandle* e = nullptr;
+  if (!use_detached_insert) {
+    // An insert replaces any existing entry for the key.
+    EraseImpl(key, hash);
+
+    size_t probes = 0;
+    e = FindSlot(
+        hash,
+        [&](HyperClockHandle* h) {
+          // Take ownership of the slot if it is empty (no effect on other
+          // states).
+          uint64_t old_meta = h->meta.fetch_or(
+              kStateOccupiedBit << kStateShift, std::memory_order_acq_rel);
+          return GetState(old_meta) == kStateEmpty;
+        },
+        [](HyperClockHandle* /*h*/) { return false; },
+        [](HyperClockHandle* h) {
+          h->displacements.fetch_add(1, std::memory_order_relaxed);
+        },
+        &probes);
+    if (e == nullptr) {
+      // Table full: occupancy_limit_ makes this extremely unlikely.
+      Rollback(hash, probes);
+      occupancy_.fetch_sub(1, std::memory_order_relaxed);
+      if (handle == nullptr) {
+        usage_.fetch_sub(total_charge, std::memory_order_relaxed);
+        if (deleter != nullptr) {
+          (*deleter)(key, value);
+        }
+        return Status::OK();
+      }
+      use_detached_insert = true;
+    }
+  }
+
+  if (use_detached_insert) {
+    e = new HyperClockHandle();
+    detached_usage_.fetch_add(total_charge, std::memory_order_relaxed);
+  }
+  e->value = proto.value;
+  e->deleter = proto.deleter;
+  e->charge = proto.charge;
+  e->hash = proto.hash;
+  e->key_length = proto.key_length;
+  e->detached = use_detached_insert;
+  if (e->HasHeapKey()) {
+    e->heap_key = new char[key.size()];
+    memcpy(e->heap_key, key.data(), key.size());
+  } else {
+    memcpy(e->inline_key, key.data(), key.size());
+  }
+
+  if (use_detached_insert) {
+    // Invisible, so that the entry is freed with the last reference.
+    e->meta.store((kStateInvisible << kStateShift) | kAcquireIncrement,
+                  std::memory_order_release);
+  } else {
+    // Publish. The handle returned to the caller (if any) holds a reference,
+    // which also counts as a use.
+    uint64_t acquire_count = initial_countdown + (handle != nullptr ? 1 : 0);
+    e->meta.store((kStateVisible << kStateShift) |
+                      (acquire_count << kAcquireCounterShift) |
+                      (initial_countdown << kReleaseCounterShift),
+                  std::memory_order_release);
+  }
+  if (handle != nullptr) {
+    *handle = reinterpret_cast<Cache::Handle*>(e);
+  }
+  return Status::OK();
+}
+
+Cache::Handle* HyperClockCacheShard::Lookup(const Slice& key, uint32_t hash) {
+  size_t probes = 0;
+  HyperClockHandle* e = FindSlot(
+      hash,
+      [&](HyperClockHandle* h) {
+        if (GetState(h->meta.load(std::memory_order_relaxed)) !=
+            kStateVisible) {
+          return false;
+        }
+        // Take a reference, so that the entry can be read safely
+        uint64_t old_meta =
+            h->meta.fetch_add(kAcquireIncrement, std::memory_order_acquire);
+        if (GetState(old_meta) == kStateVisible) {
+          if (h->hash == hash && h->key() == key) {
+            return true;
+          }
+          // Mismatch. Pretend we never took the reference.
+          h->meta.fetch_sub(kAcquireIncrement, std::memory_order_release);
+        } else if (GetState(old_meta) == kStateInvisible) {
+          // Pretend we never took the reference. In the rare case that this
+          // drops the last reference, the entry is left for eviction.
+          h->meta.fetch_sub(kAcquireIncrement, std::memory_order_release);
+        }
+        // For other states the slot changed hands concurrently, and the
+        // increment is discarded when the slot is next published or emptied.
+        return false;
+      },
+      [](HyperClockHandle* h) {
+        return h->displacements.load(std::memory_order_relaxed) == 0;
+      },
+      [](HyperClockHandle* /*h*/) {}, &probes);
+  return reinterpret_cast<Cache::Handle*>(e);
+}
+
+bool HyperClockCacheShard::Ref(Cache::Handle* handle) {
+  HyperClockHandle* h = reinterpret_cast<HyperClockHandle*>(handle);
+  // The caller already holds a reference, so the entry is shareable.
+  assert(GetState(h->meta.load(std::memory_order_relaxed)) &
+         kStateShareableBit);
+  h->meta.fetch_add(kAcquireIncrement, std::memory_order_relaxed);
+  return true;
+}
+
+bool HyperClockCacheShard::ReleaseImpl(HyperClockHandle* h, bool useful,
+                                       bool erase_if_last_ref) {
+  uint64_t old_meta;
+  if (useful) {
+    // Increment the release counter, which makes the use count for the clock
+    old_meta = h->meta.fetch_add(kReleaseIncrement, std::memory_order_release);
+  } else {
+    // Decrement the acquire counter, as if the reference was never taken
+    old_meta = h->meta.fetch_sub(kAcquireIncrement, std::memory_order_release);
+  }
+  assert(GetState(old_meta) & kStateShareableBit);
+  // No underflow
+  assert(GetRefcount(old_meta) != 0);
+
+  if (!erase_if_last_ref && GetState(old_meta) != kStateInvisible) {
+    CorrectNearOverflow(old_meta, h->meta);
+    return false;
+  }
+
+  // Update for the fetch_add/fetch_sub above
+  if (useful) {
+    old_meta += kReleaseIncrement;
+  } else {
+    old_meta -= kAcquireIncrement;
+  }
+  // Take ownership if there are no references left
+  do {
+    if (GetRefcount(old_meta) != 0) {
+      // Not the last reference
+      CorrectNearOverflow(old_meta, h->meta);
+      return false;
+    }
+    if (!(GetState(old_meta) & kStateShareableBit)) {
+      // Someone else took ownership
+      return false;
+    }
+  } while (!h->meta.compare_exchange_weak(old_meta,
+                                          kStateConstruction << kStateShift,
+                                          std::memory_order_acquire));
+
+  size_t total_charge = h->GetTotalCharge(metadata_charge_policy_);
+  if (UNLIKELY(h->detached)) {
+    FreeData(h);
+    delete h;
+    detached_usage_.fetch_sub(total_charge, std::memory_order_relaxed);
+  } else {
+    FreeEntry(h);
+  }
+  usage_.fetch_sub(total_charge, std::memory_order_relaxed);
+  return true;
+}
+
+bool HyperClockCacheShard::Release(Cache::Handle* handle, bool useful,
+                                   bool force_erase) {
+  if (handle == nullptr) {
+    return false;
+  }
+  return ReleaseImpl(reinterpret_cast<HyperClockHandle*>(handle), useful,
+                     force_erase);
+}
+
+void HyperClockCacheShard::EraseImpl(const Slice& key, uint32_t hash) {
+  size_t probes = 0;
+  FindSlot(
+      hash,
+      [&](HyperClockHandle* h) {
+        if (GetState(h->meta.load(std::memory_order_relaxed)) !=
+            kStateVisible) {
+          return false;
+        }
+        uint64_t old_meta =
+            h->meta.fetch_add(kAcquireIncrement, std::memory_order_acquire);
+        if (GetState(old_meta) == kStateVisible) {
+          if (h->hash == hash && h->key() == key) {
+            // Hide from lookups, then drop our reference, freeing the entry
+            // unless it is referenced elsewhere.
+            h->meta.fetch_and(~(kStateVisibleBit << kStateShift),
+                              std::memory_order_acq_rel);
+            ReleaseImpl(h, /*useful=*/false, /*erase_if_last_ref=*/true);
+            // Keep going: racing inserts of the same key can leave more
+            // than one Visible entry.
+            return false;
+          }
+          h->meta.fetch_sub(kAcquireIncrement, std::memory_order_release);
+        } else if (GetState(old_meta) == kStateInvisible) {
+          h->meta.fetch_sub(kAcquireIncrement, std::memory_order_release);
+        }
+        return false;
+      },
+      [](HyperClockHandle* h) {
+        return h->displacements.load(std::memory_order_relaxed) == 0;
+      },
+      [](HyperClockHandle* /*h*/) {}, &probes);
+}
+
+void HyperClockCacheShard::Erase(const Slice& key, uint32_t hash) {
+  EraseImpl(key, hash);
+}
+
+void HyperClockCacheShard::SetCapacity(size_t capacity) {
+  capacity_.store(capacity, std::memory_order_relaxed);
+  size_t usage = usage_.load(std::memory_order_relaxed);
+  if (usage > capacity) {
+    size_t evicted_charge = 0;
+    size_t evicted_count = 0;
+    Evict(usage - capacity, &evicted_charge, &evicted_count);
+    occupancy_.fetch_sub(evicted_count, std::memory_order_release);
+    usage_.fetch_sub(evicted_charge, std::memory_order_relaxed);
+  }
+}
+
+void HyperClockCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
+  strict_capacity_limit_.store(strict_capacity_limit,
+                               std::memory_order_relaxed);
+}
+
+size_t HyperClockCacheShard::GetUsage() const {
+  return usage_.load(std::memory_order_relaxed);
+}
+
+template <typename Func>
+void HyperClockCacheShard::ConstApplyToEntriesRange(Func func,
+                                                    size_t index_begin,
+                                                    size_t index_end) const {
+  for (size_t i = index_begin; i < index_end; i++) {
+    HyperClockHandle* h = &array_[i];
+    if (GetState(h->meta.load(std::memory_order_relaxed)) != kStateVisible) {
+      continue;
+    }
+    uint64_t old_meta =
+        h->meta.fetch_add(kAcquireIncrement, std::memory_order_acquire);
+    if (GetState(old_meta) & kStateShareableBit) {
+      if (GetState(old_meta) == kStateVisible) {
+        func(*h, GetRefcount(old_meta));
+      }
+      // As in Lookup, dropping the last reference to an Invisible entry
+      // leaves it for eviction.
+      h->meta.fetch_sub(kAcquireIncrement, std::memory_order_release);
+    }
+  }
+}
+
+size_t HyperClockCacheShard::GetPinnedUsage() const {
+  size_t pinned_usage = 0;
+  const CacheMetadataChargePolicy policy = metadata_charge_policy_;
+  ConstApplyToEntriesRange(
+      [&](const HyperClockHandle& h, uint64_t refcount) {
+        if (refcount > 0) {
+          pinned_usage += h.GetTotalCharge(policy);
+        }
+      },
+      0, length_bits_mask_ + 1);
+  // Detached entries only exist while referenced
+  return pinned_usage + detached_usage_.load(std::memory_order_relaxed);
+}
+
+void HyperClockCacheShard::ApplyToSomeEntries(
+    const std::function<void(const Slice& key, void* value, size_t charge,
+                             DeleterFn deleter)>& callback,
+    uint32_t average_entries_per_lock, uint32_t* state) {
+  // The table never changes size, so the state is simply the next slot
+  // index.
+  const size_t length = length_bits_mask_ + 1;
+  assert(average_entries_per_lock > 0);
+  size_t index_begin = *state;
+  size_t index_end = index_begin + average_entries_per_lock;
+  if (index_end >= length) {
+    index_end = length;
+    *state = UINT32_MAX;
+  } else {
+    *state = static_cast<uint32_t>(index_end);
+  }
+  ConstApplyToEntriesRange(
+      [&](const HyperClockHandle& h, uint64_t /*refcount*/) {
+        callback(h.key(), h.value, h.charge, h.deleter);
+      },
+      index_begin, index_end);
+}
+
+void HyperClockCacheShard::EraseUnRefEntries() {
+  for (size_t i = 0; i <= length_bits_mask_; i++) {
+    HyperClockHandle* h = &array_[i];
+    uint64_t meta = h->meta.load(std::memory_order_relaxed);
+    if ((GetState(meta) & kStateShareableBit) && GetRefcount(meta) == 0 &&
+        h->meta.compare_exchange_strong(meta,
+                                        kStateConstruction << kStateShift,
+                                        std::memory_order_acquire)) {
+      size_t total_charge = h->GetTotalCharge(metadata_charge_policy_);
+      FreeEntry(h);
+      usage_.fetch_sub(total_charge, std::memory_order_relaxed);
+    }
+  }
+}
+
+std::string HyperClockCacheShard::GetPrintableOptions() const {
+  const int kBufferSize = 200;
+  char buffer[kBufferSize];
+  snprintf(buffer, kBufferSize, "    estimated_entry_charge : %" ROCKSDB_PRIszt
+           "\n",
+           estimated_entry_charge_);
+  return std::string(buffer);
+}
+
+HyperClockCache::HyperClockCache(
+    size_t capacity, size_t estimated_entry_charge, int num_shard_bits,
+    bool strict_capacity_limit,
+    CacheMetadataChargePolicy metadata_charge_policy,
+    std::shared_ptr<MemoryAllocator> memory_allocator)
+    : ShardedCache(capacity, num_shard_bits, strict_capacity_limit,
+                   std::move(memory_allocator)) {
+  num_shards_ = 1 << num_shard_bits;
+  shards_ = reinterpret_cast<HyperClockCacheShard*>(
+      port::cacheline_aligned_alloc(sizeof(HyperClockCacheShard) *
+                                    num_shards_));
+  size_t per_shard = (capacity + (num_shards_ - 1)) / num_shards_;
+  for (int i = 0; i < num_shards_; i++) {
+    new (&shards_[i])
+        HyperClockCacheShard(per_shard, estimated_entry_charge,
+                             strict_capacity_limit, metadata_charge_policy);
+  }
+}
+
+HyperClockCache::~HyperClockCache() {
+  if (shards_ != nullptr) {
+    assert(num_shards_ > 0);
+    for (int i = 0; i < num_shards_; i++) {
+      shards_[i].~HyperClockCacheShard();
+    }
+    port::cacheline_aligned_free(shards_);
+  }
+}
+
+CacheShard* HyperClockCache::GetShard(uint32_t shard) {
+  return reinterpret_cast<CacheShard*>(&shards_[shard]);
+}
+
+const CacheShard* HyperClockCache::GetShard(uint32_t shard) const {
+  return reinterpret_cast<CacheShard*>(&shards_[shard]);
+}
+
+void* HyperClockCache::Value(Handle* handle) {
+  return reinterpret_cast<const HyperClockHandle*>(handle)->value;
+}
+
+size_t HyperClockCache::GetCharge(Handle* handle) const {
+  return reinterpret_cast<const HyperClockHandle*>(handle)->charge;
+}
+
+uint32_t HyperClockCache::GetHash(Handle* handle) const {
+  return reinterpret_cast<const HyperClockHandle*>(handle)->hash;
+}
+
+Cache::DeleterFn HyperClockCache::GetDeleter(Handle* handle) const {
+  return reinterpret_cast<const HyperClockHandle*>(handle)->deleter;
+}
+
+void HyperClockCache::DisownData() {
+  // Leak data only if that won't generate an ASAN/valgrind warning
+  if (!kMustFreeHeapAllocations) {
+    shards_ = nullptr;
+    num_shards_ = 0;
+  }
+}
+
+std::shared_ptr<Cache> NewHyperClockCache(
+    size_t capacity, size_t estimated_entry_charge, int num_shard_bits,
+    bool strict_capacity_limit,
+    CacheMetadataChargePolicy metadata_charge_policy,
+    std::shared_ptr<MemoryAllocator> memory_allocator) {
+  if (num_shard_bits >= 20) {
+    return nullptr;  // the cache cannot be sharded into too many fine pieces
+  }
+  if (estimated_entry_charge == 0) {
+    // The table size can't be derived without an estimate
+    return nullptr;
+  }
+  if (num_shard_bits < 0) {
+    num_shard_bits = GetDefaultCacheShardBits(capacity);
+  }
+  return std::make_shared<HyperClockCache>(
+      capacity, estimated_entry_charge, num_shard_bits, strict_capacity_limit,
+      metadata_charge_policy, std::move(memory_allocator));
+}
+
+std::shared_ptr<Cache> NewHyperClockCache(const HyperClockCacheOptions& opts) {
+  return NewHyperClockCache(opts.capacity, opts.estimated_entry_charge,
+                            opts.num_shard_bits, opts.strict_capacity_limit,
+                            opts.metadata_charge_policy,
+                            opts.memory_allocator);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,261 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "cache/sharded_cache.h"
+#include "port/lang.h"
+#include "port/port.h"
+#include "rocksdb/cache.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// HyperClockCache is a lock-free implementation of the CLOCK eviction
+// algorithm. Unlike LRUCache, no operation acquires a mutex: Lookup and
+// Release are each a small, bounded number of atomic read-modify-write
+// operations on a single 64-bit word, so that reads of hot entries scale with
+// the number of threads instead of serializing on the shard mutex.
+//
+// Each shard is a fixed-size, open-addressed hash table (double hashing) of
+// HyperClockHandle slots, sized up front from the shard capacity and the
+// estimated charge of an entry. Because the table never grows, the estimate
+// matters: too low wastes memory on empty slots, too high limits the number
+// of entries the shard can hold (entries are then evicted before the cache is
+// full by charge).
+//
+// Every slot has a `meta` word packing
+//   * an "acquire" counter (bits 0-29), incremented when a reference is taken,
+//   * a "release" counter (bits 30-59), incremented when one is released,
+//   * the slot state (bits 60-62).
+// The reference count is the difference of the two counters. When the entry
+// is unreferenced, the (equal) counter value doubles as the CLOCK countdown:
+// each pass of the clock hand decrements it, and an unreferenced entry whose
+// countdown reached zero is evicted. Every useful reference thus bumps the
+// countdown for free. Inserting at high priority starts with a higher
+// countdown than low priority.
+//
+// Slot states:
+//   Empty         - available for insertion
+//   Construction  - exclusively owned by one thread (being filled or freed)
+//   Visible       - a live entry that can be found by Lookup
+//   Invisible     - a live entry that was erased or replaced; it can't be
+//                   found anymore but might still be referenced
+// Only Visible and Invisible ("shareable") slots may be read, and only while
+// holding a reference; transitions out of the shareable states require a
+// compare-exchange that sees no outstanding references.
+//
+// Each slot also counts the number of entries whose probe sequence passes
+// over it ("displacements"), which lets Lookup and Erase stop probing at the
+// first slot that no entry has been displaced past.
+//
+// Not supported compared to LRUCache: secondary cache (entries are simply
+// deleted when evicted) and the high priority pool ratio.
+struct HyperClockHandle {
+  // Keys up to this size (e.g. block cache keys) are stored inline to avoid
+  // an allocation and a pointer chase on lookup.
+  static constexpr size_t kInlineKeySize = 16;
+
+  void* value;
+  Cache::DeleterFn deleter;
+  // Charge provided by the user, not including metadata
+  size_t charge;
+  uint32_t hash;
+  uint32_t key_length;
+  union {
+    char inline_key[kInlineKeySize];
+    char* heap_key;
+  };
+  std::atomic<uint64_t> meta;
+  // Number of entries whose probe sequence passes over this slot
+  std::atomic<uint32_t> displacements;
+  // Entry that did not fit in the table and is only owned by its handle
+  bool detached;
+
+  bool HasHeapKey() const { return key_length > kInlineKeySize; }
+
+  Slice key() const {
+    return Slice(HasHeapKey() ? heap_key : inline_key, key_length);
+  }
+
+  // Charge including metadata according to the given policy
+  size_t GetTotalCharge(CacheMetadataChargePolicy metadata_charge_policy) const {
+    size_t meta_charge = 0;
+    if (metadata_charge_policy == kFullChargeCacheMetadata) {
+      meta_charge += sizeof(HyperClockHandle);
+      if (HasHeapKey()) {
+        meta_charge += key_length;
+      }
+    }
+    return charge + meta_charge;
+  }
+};
+
+// A single shard of HyperClockCache. All operations are thread-safe and
+// lock-free.
+class ALIGN_AS(CACHE_LINE_SIZE) HyperClockCacheShard final : public CacheShard {
+ public:
+  HyperClockCacheShard(size_t capacity, size_t estimated_entry_charge,
+                       bool strict_capacity_limit,
+                       CacheMetadataChargePolicy metadata_charge_policy);
+  ~HyperClockCacheShard() override;
+
+  // Separate from constructor so caller can easily make an array of
+  // HyperClockCacheShard
+  void SetCapacity(size_t capacity) override;
+
+  void SetStrictCapacityLimit(bool strict_capacity_limit) override;
+
+  Status Insert(const Slice& key, uint32_t hash, void* value, size_t charge,
+                DeleterFn deleter, Cache::Handle** handle,
+                Cache::Priority priority) override;
+  // Secondary cache is not supported, so the helper is only used for its
+  // deleter.
+  Status Insert(const Slice& key, uint32_t hash, void* value,
+                const Cache::CacheItemHelper* helper, size_t charge,
+                Cache::Handle** handle, Cache::Priority priority) override {
+    return Insert(key, hash, value, charge, helper->del_cb, handle, priority);
+  }
+  Cache::Handle* Lookup(const Slice& key, uint32_t hash) override;
+  Cache::Handle* Lookup(const Slice& key, uint32_t hash,
+                        const Cache::CacheItemHelper* /*helper*/,
+                        const Cache::CreateCallback& /*create_cb*/,
+                        Cache::Priority /*priority*/, bool /*wait*/,
+                        Statistics* /*stats*/) override {
+    return Lookup(key, hash);
+  }
+  bool Release(Cache::Handle* handle, bool useful, bool force_erase) override;
+  bool Release(Cache::Handle* handle, bool force_erase) override {
+    return Release(handle, /*useful=*/true, force_erase);
+  }
+  bool IsReady(Cache::Handle* /*handle*/) override { return true; }
+  void Wait(Cache::Handle* /*handle*/) override {}
+  bool Ref(Cache::Handle* handle) override;
+  void Erase(const Slice& key, uint32_t hash) override;
+
+  size_t GetUsage() const override;
+  size_t GetPinnedUsage() const override;
+
+  void ApplyToSomeEntries(
+      const std::function<void(const Slice& key, void* value, size_t charge,
+                               DeleterFn deleter)>& callback,
+      uint32_t average_entries_per_lock, uint32_t* state) override;
+
+  void EraseUnRefEntries() override;
+
+  std::string GetPrintableOptions() const override;
+
+  size_t TEST_GetTableSize() const { return length_bits_mask_ + 1; }
+  size_t TEST_GetOccupancy() const {
+    return occupancy_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  friend class HyperClockCache;
+
+  // Probes the slots of the table in the order given by `hash`, calling
+  // match_fn on each until it returns true (returning that slot), or
+  // abort_fn returns true or all slots have been probed (returning nullptr).
+  // update_fn is called on each slot probed past, and *probes is set to the
+  // number of those slots.
+  template <typename MatchFn, typename AbortFn, typename UpdateFn>
+  HyperClockHandle* FindSlot(uint32_t hash, MatchFn match_fn,
+                             AbortFn abort_fn, UpdateFn update_fn,
+                             size_t* probes);
+
+  // Undoes the displacement increments of an insertion for `hash` that
+  // probed past `probes` slots.
+  void Rollback(uint32_t hash, size_t probes);
+  // Same, for an entry that ended up in slot h.
+  void Rollback(uint32_t hash, const HyperClockHandle* h);
+
+  // Reserves usage for an insertion, evicting entries as needed (and one
+  // more if need_evict_for_occupancy). With strict_capacity_limit, fails if
+  // the insertion does not fit; otherwise returns false only if an eviction
+  // for occupancy was needed and nothing could be evicted.
+  Status ChargeUsageMaybeEvictStrict(size_t total_charge, size_t capacity,
+                                     bool need_evict_for_occupancy);
+  bool ChargeUsageMaybeEvictNonStrict(size_t total_charge, size_t capacity,
+                                      bool need_evict_for_occupancy);
+
+  // Runs the clock hand until at least requested_charge has been freed, or
+  // every unreferenced entry had a chance to be evicted.
+  void Evict(size_t requested_charge, size_t* freed_charge,
+             size_t* freed_count);
+
+  // Hides any Visible entries for key from lookups, freeing those without
+  // outstanding references.
+  void EraseImpl(const Slice& key, uint32_t hash);
+
+  // Drops a reference on h, freeing the entry if it was the last reference
+  // and either erase_if_last_ref or the entry is no longer Visible.
+  bool ReleaseImpl(HyperClockHandle* h, bool useful, bool erase_if_last_ref);
+
+  // Frees the contents of h, which must be owned by this thread
+  // (Construction state), and returns the slot to the Empty state.
+  void FreeEntry(HyperClockHandle* h);
+
+  // Calls func(h, refcount) on the entries in slots [index_begin, index_end)
+  // that are Visible, while holding a reference on them.
+  template <typename Func>
+  void ConstApplyToEntriesRange(Func func, size_t index_begin,
+                                size_t index_end) const;
+
+  // Fixed table parameters
+  const int length_bits_;
+  const size_t length_bits_mask_;
+  // Maximum number of entries allowed in the table, to keep probe sequences
+  // short.
+  const size_t occupancy_limit_;
+  const size_t estimated_entry_charge_;
+  const std::unique_ptr<HyperClockHandle[]> array_;
+
+  // Frequently updated from multiple threads; keep them away from the table
+  // parameters above, which are only read.
+  ALIGN_AS(CACHE_LINE_SIZE)
+  std::atomic<uint64_t> clock_pointer_{0};
+  ALIGN_AS(CACHE_LINE_SIZE)
+  std::atomic<size_t> occupancy_{0};
+  ALIGN_AS(CACHE_LINE_SIZE)
+  std::atomic<size_t> usage_{0};
+  // Part of usage_ held by detached entries
+  std::atomic<size_t> detached_usage_{0};
+
+  std::atomic<size_t> capacity_;
+  std::atomic<bool> strict_capacity_limit_;
+};
+
+class HyperClockCache final : public ShardedCache {
+ public:
+  HyperClockCache(size_t capacity, size_t estimated_entry_charge,
+                  int num_shard_bits, bool strict_capacity_limit,
+                  CacheMetadataChargePolicy metadata_charge_policy,
+                  std::shared_ptr<MemoryAllocator> memory_allocator);
+  ~HyperClockCache() override;
+
+  const char* Name() const override { return "HyperClockCache"; }
+  CacheShard* GetShard(uint32_t shard) override;
+  const CacheShard* GetShard(uint32_t shard) const override;
+  void* Value(Handle* handle) override;
+  size_t GetCharge(Handle* handle) const override;
+  uint32_t GetHash(Handle* handle) const override;
+  DeleterFn GetDeleter(Handle* handle) const override;
+  void DisownData() override;
+  void WaitAll(std::vector<Handle*>& /*handles*/) override {}
+
+ private:
+  HyperClockCacheShard* shards_ = nullptr;
+  int num_shards_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
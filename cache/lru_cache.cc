@@ -622,6 +622,16 @@ bool LRUCacheShard::IsReady(Cache::Handle* handle) {
   return ready;
 }
 
+void LRUCacheShard::Wait(Cache::Handle* handle) {
+  LRUHandle* e = reinterpret_cast<LRUHandle*>(handle);
+  if (e->IsPending()) {
+    assert(secondary_cache_);
+    assert(e->sec_handle);
+    e->sec_handle->Wait();
+    Promote(e);
+  }
+}
+
 size_t LRUCacheShard::GetUsage() const {
   MutexLock l(&mutex_);
   return usage_;
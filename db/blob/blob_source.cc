@@ -0,0 +1,286 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/blob/blob_source.h"
+
+#include <cassert>
+#include <string>
+
+#include "db/blob/blob_file_cache.h"
+#include "db/blob/blob_file_reader.h"
+#include "db/blob/blob_log_format.h"
+#include "monitoring/statistics.h"
+#include "options/cf_options.h"
+#include "rocksdb/options.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+void DeleteCachedBlob(const Slice& /*key*/, void* value) {
+  delete static_cast<std::string*>(value);
+}
+
+void ReleaseCacheHandle(void* arg1, void* arg2) {
+  Cache* const cache = static_cast<Cache*>(arg1);
+  assert(cache);
+
+  Cache::Handle* const handle = static_cast<Cache::Handle*>(arg2);
+  assert(handle);
+
+  cache->Release(handle);
+}
+
+}  // anonymous namespace
+
+const std::string BlobSource::kUnknownDbId = "unknown";
+
+BlobSource::BlobSource(const ImmutableOptions* immutable_options,
+                       const std::string& db_session_id,
+                       BlobFileCache* blob_file_cache)
+    : db_session_id_(db_session_id),
+      statistics_(immutable_options->stats),
+      blob_file_cache_(blob_file_cache),
+      blob_cache_(immutable_options->blob_cache) {
+  assert(blob_file_cache_);
+}
+
+bool BlobSource::GetBlobFromCache(const Slice& cache_key,
+                                  PinnableSlice* value) const {
+  assert(blob_cache_);
+  assert(value);
+
+  Cache::Handle* const handle = blob_cache_->Lookup(cache_key, statistics_);
+  if (!handle) {
+    RecordTick(statistics_, BLOB_DB_CACHE_MISS);
+    return false;
+  }
+
+  const std::string* const blob =
+      static_cast<const std::string*>(blob_cache_->Value(handle));
+  assert(blob);
+
+  RecordTick(statistics_, BLOB_DB_CACHE_HIT);
+  RecordTick(statistics_, BLOB_DB_CACHE_BYTES_READ, blob->size());
+
+  // The cached value stays pinned (and is thus not evicted) until value is
+  // reset or destroyed.
+  if (value->IsPinned()) {
+    value->Reset();
+  }
+  value->PinSlice(Slice(*blob), &ReleaseCacheHandle, blob_cache_.get(),
+                  handle);
+
+  return true;
+}
+
+void BlobSource::PutBlobIntoCache(const Slice& cache_key,
+                                  const Slice& blob) const {
+  assert(blob_cache_);
+
+  std::string* const buf = new std::string(blob.data(), blob.size());
+
+  // Blobs are usually large and are only read once per query; insert them at
+  // low priority so that they do not push out index and filter blocks when
+  // the cache is shared with the block cache.
+  const Status s = blob_cache_->Insert(cache_key, buf, buf->size(),
+                                       &DeleteCachedBlob, nullptr /* handle */,
+                                       Cache::Priority::LOW);
+  if (s.ok()) {
+    RecordTick(statistics_, BLOB_DB_CACHE_ADD);
+    RecordTick(statistics_, BLOB_DB_CACHE_BYTES_WRITE, blob.size());
+  } else {
+    // The cache took ownership of buf and has already deleted it.
+    RecordTick(statistics_, BLOB_DB_CACHE_ADD_FAILURES);
+  }
+}
+
+Status BlobSource::GetBlob(const ReadOptions& read_options,
+                           const Slice& user_key, uint64_t file_number,
+                           uint64_t offset, uint64_t file_size,
+                           uint64_t value_size,
+                           CompressionType compression_type,
+                           FilePrefetchBuffer* prefetch_buffer,
+                           PinnableSlice* value, uint64_t* bytes_read) {
+  assert(value);
+
+  CacheKey cache_key;
+
+  if (blob_cache_) {
+    if (!IsValidBlobOffset(offset, user_key.size(), value_size, file_size)) {
+      return Status::Corruption("Invalid blob offset");
+    }
+
+    cache_key = GetCacheKey(file_number, file_size, offset);
+
+    if (GetBlobFromCache(cache_key.AsSlice(), value)) {
+      if (bytes_read) {
+        *bytes_read = 0;
+      }
+      return Status::OK();
+    }
+  }
+
+  if (read_options.read_tier == kBlockCacheTier) {
+    return Status::Incomplete("Cannot read blob: no disk I/O allowed");
+  }
+
+  CacheHandleGuard<BlobFileReader> blob_file_reader;
+
+  {
+    assert(blob_file_cache_);
+    const Status s =
+        blob_file_cache_->GetBlobFileReader(file_number, &blob_file_reader);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  assert(blob_file_reader.GetValue());
+
+  {
+    const Status s = blob_file_reader.GetValue()->GetBlob(
+        read_options, user_key, offset, value_size, compression_type,
+        prefetch_buffer, value, bytes_read);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  if (blob_cache_ && read_options.fill_cache) {
+    PutBlobIntoCache(cache_key.AsSlice(), *value);
+  }
+
+  return Status::OK();
+}
+
+void BlobSource::MultiGetBlobFromOneFile(const ReadOptions& read_options,
+                                         uint64_t file_number,
+                                         uint64_t file_size,
+                                         autovector<ReadRequest>& blob_reqs,
+                                         uint64_t* bytes_read) {
+  const size_t num_blobs = blob_reqs.size();
+  assert(num_blobs > 0);
+
+#ifndef NDEBUG
+  for (size_t i = 0; i < num_blobs - 1; ++i) {
+    assert(blob_reqs[i].offset <= blob_reqs[i + 1].offset);
+  }
+#endif  // !NDEBUG
+
+  // Requests that could not be served from the blob cache
+  autovector<ReadRequest*> misses;
+
+  if (blob_cache_) {
+    for (auto& req : blob_reqs) {
+      assert(req.value);
+      assert(req.status);
+
+      const CacheKey cache_key =
+          GetCacheKey(file_number, file_size, req.offset);
+      if (GetBlobFromCache(cache_key.AsSlice(), req.value)) {
+        *req.status = Status::OK();
+      } else {
+        misses.push_back(&req);
+      }
+    }
+  } else {
+    for (auto& req : blob_reqs) {
+      misses.push_back(&req);
+    }
+  }
+
+  if (bytes_read) {
+    *bytes_read = 0;
+  }
+
+  if (misses.empty()) {
+    return;
+  }
+
+  if (read_options.read_tier == kBlockCacheTier) {
+    for (ReadRequest* req : misses) {
+      *req->status =
+          Status::Incomplete("Cannot read blob(s): no disk I/O allowed");
+    }
+    return;
+  }
+
+  CacheHandleGuard<BlobFileReader> blob_file_reader;
+
+  {
+    assert(blob_file_cache_);
+    const Status s =
+        blob_file_cache_->GetBlobFileReader(file_number, &blob_file_reader);
+    if (!s.ok()) {
+      for (ReadRequest* req : misses) {
+        *req->status = s;
+      }
+      return;
+    }
+  }
+
+  assert(blob_file_reader.GetValue());
+  const CompressionType compression =
+      blob_file_reader.GetValue()->GetCompressionType();
+
+  autovector<ReadRequest*> to_read;
+  autovector<std::reference_wrapper<const Slice>> user_keys;
+  autovector<uint64_t> offsets;
+  autovector<uint64_t> value_sizes;
+  autovector<Status*> statuses;
+  autovector<PinnableSlice*> values;
+
+  for (ReadRequest* req : misses) {
+    if (req->compression != compression) {
+      *req->status =
+          Status::Corruption("Compression type mismatch when reading a blob");
+      continue;
+    }
+
+    to_read.push_back(req);
+    user_keys.emplace_back(std::cref(*req->user_key));
+    offsets.push_back(req->offset);
+    value_sizes.push_back(req->value_size);
+    statuses.push_back(req->status);
+    values.push_back(req->value);
+  }
+
+  if (to_read.empty()) {
+    return;
+  }
+
+  blob_file_reader.GetValue()->MultiGetBlob(read_options, user_keys, offsets,
+                                            value_sizes, statuses, values,
+                                            bytes_read);
+
+  if (blob_cache_ && read_options.fill_cache) {
+    for (ReadRequest* req : to_read) {
+      if (req->status->ok()) {
+        const CacheKey cache_key =
+            GetCacheKey(file_number, file_size, req->offset);
+        PutBlobIntoCache(cache_key.AsSlice(), *req->value);
+      }
+    }
+  }
+}
+
+bool BlobSource::TEST_BlobInCache(uint64_t file_number, uint64_t file_size,
+                                  uint64_t offset) const {
+  if (!blob_cache_) {
+    return false;
+  }
+
+  const CacheKey cache_key = GetCacheKey(file_number, file_size, offset);
+  Cache::Handle* const handle = blob_cache_->Lookup(cache_key.AsSlice());
+  if (!handle) {
+    return false;
+  }
+
+  blob_cache_->Release(handle);
+  return true;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,104 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cinttypes>
+#include <memory>
+#include <string>
+
+#include "cache/cache_key.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/compression_type.h"
+#include "rocksdb/rocksdb_namespace.h"
+#include "util/autovector.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct ImmutableOptions;
+struct ReadOptions;
+class Status;
+class Slice;
+class PinnableSlice;
+class FilePrefetchBuffer;
+class BlobFileCache;
+class Statistics;
+
+// BlobSource is the entry point for reading blob values on behalf of a column
+// family. It consults the (optional) blob cache, which holds uncompressed
+// blob values keyed by blob file number and offset, and falls back to reading
+// (and decompressing) the blob from the blob file, using the blob file reader
+// from BlobFileCache. Blobs read from the file are added to the blob cache if
+// ReadOptions::fill_cache is set.
+class BlobSource {
+ public:
+  // A request to read a single blob, as used by MultiGetBlobFromOneFile.
+  struct ReadRequest {
+    const Slice* user_key = nullptr;
+    uint64_t offset = 0;
+    uint64_t value_size = 0;
+    CompressionType compression = kNoCompression;
+    PinnableSlice* value = nullptr;
+    Status* status = nullptr;
+  };
+
+  // Cache keys are derived from db_session_id (the session that opened the
+  // blob files, not necessarily the one that wrote them), so cached blobs are
+  // not shared across DB instances or re-opens.
+  BlobSource(const ImmutableOptions* immutable_options,
+             const std::string& db_session_id, BlobFileCache* blob_file_cache);
+
+  BlobSource(const BlobSource&) = delete;
+  BlobSource& operator=(const BlobSource&) = delete;
+
+  // Reads the blob at the given offset of the blob file. file_size is the
+  // size of the blob file according to its metadata.
+  Status GetBlob(const ReadOptions& read_options, const Slice& user_key,
+                 uint64_t file_number, uint64_t offset, uint64_t file_size,
+                 uint64_t value_size, CompressionType compression_type,
+                 FilePrefetchBuffer* prefetch_buffer, PinnableSlice* value,
+                 uint64_t* bytes_read);
+
+  // Reads a batch of blobs from the same blob file. The requests must be
+  // sorted by offset in ascending order, and their offsets must have been
+  // validated against file_size by the caller. The result of each request is
+  // reported through its status.
+  void MultiGetBlobFromOneFile(const ReadOptions& read_options,
+                               uint64_t file_number, uint64_t file_size,
+                               autovector<ReadRequest>& blob_reqs,
+                               uint64_t* bytes_read);
+
+  bool TEST_BlobInCache(uint64_t file_number, uint64_t file_size,
+                        uint64_t offset) const;
+
+ private:
+  CacheKey GetCacheKey(uint64_t file_number, uint64_t file_size,
+                       uint64_t offset) const {
+    OffsetableCacheKey base_cache_key(kUnknownDbId, db_session_id_,
+                                      file_number, file_size);
+    return base_cache_key.WithOffset(offset);
+  }
+
+  // Looks up the blob in the blob cache; on a hit, pins the cached value in
+  // *value and returns true.
+  bool GetBlobFromCache(const Slice& cache_key, PinnableSlice* value) const;
+
+  // Adds a copy of the blob to the blob cache.
+  void PutBlobIntoCache(const Slice& cache_key, const Slice& blob) const;
+
+  static const std::string kUnknownDbId;
+
+  const std::string db_session_id_;
+
+  Statistics* statistics_;
+
+  // A cache to store blob file readers
+  BlobFileCache* blob_file_cache_;
+
+  // A cache to store uncompressed blob values; may be nullptr
+  std::shared_ptr<Cache> blob_cache_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -48,6 +48,173 @@ TEST_F(DBBlobBasicTest, GetBlob) {
                   .IsIncomplete());
 }
 
+TEST_F(DBBlobBasicTest, GetBlobFromCache) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+  options.statistics = CreateDBStatistics();
+
+  LRUCacheOptions co;
+  co.capacity = 1 << 20;
+  co.num_shard_bits = 0;
+  co.metadata_charge_policy = kDontChargeCacheMetadata;
+  options.blob_cache = NewLRUCache(co);
+
+  Reopen(options);
+
+  constexpr char key[] = "key";
+  constexpr char blob_value[] = "blob_value";
+
+  ASSERT_OK(Put(key, blob_value));
+
+  ASSERT_OK(Flush());
+
+  ReadOptions read_options;
+
+  // Not filling the cache: the blob is read from the file both times.
+  read_options.fill_cache = false;
+
+  for (int i = 0; i < 2; ++i) {
+    PinnableSlice result;
+    ASSERT_OK(db_->Get(read_options, db_->DefaultColumnFamily(), key, &result));
+    ASSERT_EQ(result, blob_value);
+  }
+
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_MISS), 2);
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_HIT), 0);
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_ADD), 0);
+  ASSERT_EQ(options.blob_cache->GetUsage(), 0);
+
+  read_options.read_tier = kBlockCacheTier;
+
+  {
+    PinnableSlice result;
+    ASSERT_TRUE(db_->Get(read_options, db_->DefaultColumnFamily(), key, &result)
+                    .IsIncomplete());
+  }
+
+  // Filling the cache: the first read adds the blob, the second one is served
+  // from the cache, even if no I/O is allowed.
+  read_options.fill_cache = true;
+  read_options.read_tier = kReadAllTier;
+
+  ASSERT_OK(options.statistics->Reset());
+
+  {
+    PinnableSlice result;
+    ASSERT_OK(db_->Get(read_options, db_->DefaultColumnFamily(), key, &result));
+    ASSERT_EQ(result, blob_value);
+  }
+
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_MISS), 1);
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_ADD), 1);
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_BYTES_WRITE),
+            sizeof(blob_value) - 1);
+  ASSERT_EQ(options.blob_cache->GetUsage(), sizeof(blob_value) - 1);
+
+  read_options.read_tier = kBlockCacheTier;
+
+  {
+    PinnableSlice result;
+    ASSERT_OK(db_->Get(read_options, db_->DefaultColumnFamily(), key, &result));
+    ASSERT_EQ(result, blob_value);
+
+    // The cached blob is pinned by result
+    ASSERT_EQ(options.blob_cache->GetPinnedUsage(), sizeof(blob_value) - 1);
+  }
+
+  ASSERT_EQ(options.blob_cache->GetPinnedUsage(), 0);
+
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_HIT), 1);
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_BYTES_READ),
+            sizeof(blob_value) - 1);
+}
+
+TEST_F(DBBlobBasicTest, MultiGetAndIterateBlobsFromCache) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+  options.statistics = CreateDBStatistics();
+  options.blob_cache = NewLRUCache(1 << 20);
+
+  Reopen(options);
+
+  constexpr size_t num_keys = 8;
+
+  std::array<std::string, num_keys> keys;
+  std::array<std::string, num_keys> values;
+
+  for (size_t i = 0; i < num_keys; ++i) {
+    keys[i] = "key" + std::to_string(i);
+    values[i] = "blob_value" + std::to_string(i);
+
+    ASSERT_OK(Put(keys[i], values[i]));
+
+    // Spread the blobs over two blob files
+    if (i == num_keys / 2 - 1) {
+      ASSERT_OK(Flush());
+    }
+  }
+
+  ASSERT_OK(Flush());
+
+  // Read half of the blobs to warm up the cache
+  for (size_t i = 0; i < num_keys; i += 2) {
+    ASSERT_EQ(Get(keys[i]), values[i]);
+  }
+
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_ADD),
+            num_keys / 2);
+
+  ASSERT_OK(options.statistics->Reset());
+
+  std::array<Slice, num_keys> key_slices;
+  for (size_t i = 0; i < num_keys; ++i) {
+    key_slices[i] = keys[i];
+  }
+
+  std::array<PinnableSlice, num_keys> results;
+  std::array<Status, num_keys> statuses;
+
+  db_->MultiGet(ReadOptions(), db_->DefaultColumnFamily(), num_keys,
+                key_slices.data(), results.data(), statuses.data());
+
+  for (size_t i = 0; i < num_keys; ++i) {
+    ASSERT_OK(statuses[i]);
+    ASSERT_EQ(results[i], values[i]);
+    results[i].Reset();
+  }
+
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_HIT),
+            num_keys / 2);
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_MISS),
+            num_keys / 2);
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_ADD),
+            num_keys / 2);
+
+  // Now every blob is cached, so an iterator with no I/O allowed can read all
+  // of them.
+  ASSERT_OK(options.statistics->Reset());
+
+  ReadOptions read_options;
+  read_options.read_tier = kBlockCacheTier;
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+
+  size_t i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_LT(i, num_keys);
+    ASSERT_EQ(iter->key(), keys[i]);
+    ASSERT_EQ(iter->value(), values[i]);
+    ++i;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(i, num_keys);
+
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_HIT), num_keys);
+  ASSERT_EQ(options.statistics->getTickerCount(BLOB_DB_CACHE_MISS), 0);
+}
+
 TEST_F(DBBlobBasicTest, MultiGetBlobs) {
   constexpr size_t min_blob_size = 6;
 
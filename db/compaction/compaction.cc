@@ -563,10 +563,6 @@ std::unique_ptr<SstPartitioner> Compaction::CreateSstPartitioner() const {
   return immutable_options_.sst_partitioner_factory->CreatePartitioner(context);
 }
 
-bool Compaction::IsOutputLevelEmpty() const {
-  return inputs_.back().level != output_level_ || inputs_.back().empty();
-}
-
 bool Compaction::ShouldFormSubcompactions() const {
   if (max_subcompactions_ <= 1 || cfd_ == nullptr) {
     return false;
@@ -580,8 +576,7 @@ bool Compaction::ShouldFormSubcompactions() const {
   }
 
   if (cfd_->ioptions()->compaction_style == kCompactionStyleLevel) {
-    return (start_level_ == 0 || is_manual_compaction_) && output_level_ > 0 &&
-           !IsOutputLevelEmpty();
+    return (start_level_ == 0 || is_manual_compaction_) && output_level_ > 0;
   } else if (cfd_->ioptions()->compaction_style == kCompactionStyleUniversal) {
     return number_levels_ > 1 && output_level_ > 0;
   } else {
@@ -261,9 +261,6 @@ class Compaction {
   // Create a SstPartitioner from sst_partitioner_factory
   std::unique_ptr<SstPartitioner> CreateSstPartitioner() const;
 
-  // Is the input level corresponding to output_level_ empty?
-  bool IsOutputLevelEmpty() const;
-
   // Should this compaction be broken up into smaller ones run in parallel?
   bool ShouldFormSubcompactions() const;
 
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <deque>
 #include <functional>
 #include <list>
 #include <memory>
@@ -26,6 +27,7 @@
 #include "db/blob/blob_garbage_meter.h"
 #include "db/builder.h"
 #include "db/compaction/clipping_iterator.h"
+#include "db/compaction/pipelined_input_iterator.h"
 #include "db/db_impl/db_impl.h"
 #include "db/db_iter.h"
 #include "db/dbformat.h"
@@ -39,6 +41,7 @@
 #include "db/merge_helper.h"
 #include "db/output_validator.h"
 #include "db/range_del_aggregator.h"
+#include "db/table_cache.h"
 #include "db/version_set.h"
 #include "file/filename.h"
 #include "file/read_write_util.h"
@@ -54,6 +57,7 @@
 #include "port/port.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
+#include "rocksdb/key_hotness_tracker.h"
 #include "rocksdb/sst_partitioner.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
@@ -62,6 +66,7 @@
 #include "table/block_based/block.h"
 #include "table/block_based/block_based_table_factory.h"
 #include "table/merging_iterator.h"
+#include "table/raw_data_block.h"
 #include "table/table_builder.h"
 #include "test_util/sync_point.h"
 #include "util/coding.h"
@@ -191,6 +196,9 @@ struct CompactionJob::SubcompactionState {
   uint64_t overlapped_bytes = 0;
   // A flag determine whether the key has been seen in ShouldStopBefore()
   bool seen_key = false;
+  // Whether the current output only holds keys that the key hotness tracker
+  // considers cold.
+  bool output_is_cold = false;
   // sub compaction job id, which is used to identify different sub-compaction
   // within the same compaction job.
   const uint32_t sub_job_id;
@@ -561,140 +569,95 @@ void CompactionJob::Prepare() {
   }
 }
 
-struct RangeWithSize {
-  Range range;
-  uint64_t size;
-
-  RangeWithSize(const Slice& a, const Slice& b, uint64_t s = 0)
-      : range(a, b), size(s) {}
-};
-
 void CompactionJob::GenSubcompactionBoundaries() {
+  // Splits the input into max_subcompactions ranges of about the same size.
+  // Each input file is sampled for anchor keys that split it into ranges of
+  // about the same size, from its index, so that the boundaries don't depend
+  // on how the input files overlap. The anchors of all input files are then
+  // merged by key, and a boundary is put where the accumulated range size
+  // reaches the next multiple of the target subcompaction size.
   auto* c = compact_->compaction;
   auto* cfd = c->column_family_data();
   const Comparator* cfd_comparator = cfd->user_comparator();
-  std::vector<Slice> bounds;
-  int start_lvl = c->start_level();
   int out_lvl = c->output_level();
 
-  // Add the starting and/or ending key of certain input files as a potential
-  // boundary
+  std::vector<TableReader::Anchor> all_anchors;
+  uint64_t total_size = 0;
   for (size_t lvl_idx = 0; lvl_idx < c->num_input_levels(); lvl_idx++) {
-    int lvl = c->level(lvl_idx);
-    if (lvl >= start_lvl && lvl <= out_lvl) {
-      const LevelFilesBrief* flevel = c->input_levels(lvl_idx);
-      size_t num_files = flevel->num_files;
-
-      if (num_files == 0) {
-        continue;
+    for (size_t i = 0; i < c->num_input_files(lvl_idx); i++) {
+      const FileMetaData* f = c->input(lvl_idx, i);
+      std::vector<TableReader::Anchor> anchors;
+      // Sampling the anchors may need to open the table file and read its
+      // index. Unlock db mutex to reduce contention
+      db_mutex_->Unlock();
+      Status s = cfd->table_cache()->ApproximateKeyAnchors(
+          ReadOptions(), cfd->internal_comparator(), f->fd, anchors);
+      db_mutex_->Lock();
+      if (!s.ok() || anchors.empty()) {
+        // Fall back to the whole file as one range
+        anchors.clear();
+        anchors.emplace_back(f->largest.user_key(), f->fd.GetFileSize());
       }
-
-      if (lvl == 0) {
-        // For level 0 add the starting and ending key of each file since the
-        // files may have greatly differing key ranges (not range-partitioned)
-        for (size_t i = 0; i < num_files; i++) {
-          bounds.emplace_back(flevel->files[i].smallest_key);
-          bounds.emplace_back(flevel->files[i].largest_key);
-        }
-      } else {
-        // For all other levels add the smallest/largest key in the level to
-        // encompass the range covered by that level
-        bounds.emplace_back(flevel->files[0].smallest_key);
-        bounds.emplace_back(flevel->files[num_files - 1].largest_key);
-        if (lvl == out_lvl) {
-          // For the last level include the starting keys of all files since
-          // the last level is the largest and probably has the widest key
-          // range. Since it's range partitioned, the ending key of one file
-          // and the starting key of the next are very close (or identical).
-          for (size_t i = 1; i < num_files; i++) {
-            bounds.emplace_back(flevel->files[i].smallest_key);
-          }
-        }
+      for (auto& anchor : anchors) {
+        total_size += anchor.range_size;
+        all_anchors.emplace_back(std::move(anchor));
       }
     }
   }
 
-  std::sort(bounds.begin(), bounds.end(),
-            [cfd_comparator](const Slice& a, const Slice& b) -> bool {
-              return cfd_comparator->Compare(ExtractUserKey(a),
-                                             ExtractUserKey(b)) < 0;
+  std::sort(all_anchors.begin(), all_anchors.end(),
+            [cfd_comparator](const TableReader::Anchor& a,
+                             const TableReader::Anchor& b) -> bool {
+              return cfd_comparator->Compare(a.user_key, b.user_key) < 0;
             });
-  // Remove duplicated entries from bounds
-  bounds.erase(
-      std::unique(bounds.begin(), bounds.end(),
-                  [cfd_comparator](const Slice& a, const Slice& b) -> bool {
-                    return cfd_comparator->Compare(ExtractUserKey(a),
-                                                   ExtractUserKey(b)) == 0;
-                  }),
-      bounds.end());
-
-  // Combine consecutive pairs of boundaries into ranges with an approximate
-  // size of data covered by keys in that range
-  uint64_t sum = 0;
-  std::vector<RangeWithSize> ranges;
-  // Get input version from CompactionState since it's already referenced
-  // earlier in SetInputVersioCompaction::SetInputVersion and will not change
-  // when db_mutex_ is released below
-  auto* v = compact_->compaction->input_version();
-  for (auto it = bounds.begin();;) {
-    const Slice a = *it;
-    ++it;
-
-    if (it == bounds.end()) {
-      break;
-    }
 
-    const Slice b = *it;
-
-    // ApproximateSize could potentially create table reader iterator to seek
-    // to the index block and may incur I/O cost in the process. Unlock db
-    // mutex to reduce contention
-    db_mutex_->Unlock();
-    uint64_t size = versions_->ApproximateSize(SizeApproximationOptions(), v, a,
-                                               b, start_lvl, out_lvl + 1,
-                                               TableReaderCaller::kCompaction);
-    db_mutex_->Lock();
-    ranges.emplace_back(a, b, size);
-    sum += size;
-  }
-
-  // Group the ranges into subcompactions
+  // Group the anchors into subcompactions. Each subcompaction is expected to
+  // fill its output files to at least min_file_fill_percent, so that splitting
+  // a compaction does not cut output files smaller than a single compaction
+  // would.
   const double min_file_fill_percent = 4.0 / 5;
-  int base_level = v->storage_info()->base_level();
-  uint64_t max_output_files = static_cast<uint64_t>(std::ceil(
-      sum / min_file_fill_percent /
-      MaxFileSizeForLevel(
-          *(c->mutable_cf_options()), out_lvl,
-          c->immutable_options()->compaction_style, base_level,
-          c->immutable_options()->level_compaction_dynamic_level_bytes)));
+  int base_level = c->input_version()->storage_info()->base_level();
+  uint64_t max_output_files = std::max(
+      uint64_t{1},
+      static_cast<uint64_t>(std::floor(
+          total_size / min_file_fill_percent /
+          MaxFileSizeForLevel(
+              *(c->mutable_cf_options()), out_lvl,
+              c->immutable_options()->compaction_style, base_level,
+              c->immutable_options()->level_compaction_dynamic_level_bytes))));
   uint64_t subcompactions =
-      std::min({static_cast<uint64_t>(ranges.size()),
+      std::min({static_cast<uint64_t>(all_anchors.size()),
                 static_cast<uint64_t>(c->max_subcompactions()),
                 max_output_files});
 
   if (subcompactions > 1) {
-    double mean = sum * 1.0 / subcompactions;
-    // Greedily add ranges to the subcompaction until the sum of the ranges'
+    double mean = total_size * 1.0 / subcompactions;
+    // Greedily add anchors to the subcompaction until the sum of their range
     // sizes becomes >= the expected mean size of a subcompaction
-    sum = 0;
-    for (size_t i = 0; i + 1 < ranges.size(); i++) {
-      sum += ranges[i].size;
-      if (subcompactions == 1) {
-        // If there's only one left to schedule then it goes to the end so no
-        // need to put an end boundary
+    uint64_t sum = 0;
+    // The last anchor is at or after the largest input key, so it is never a
+    // boundary. Anchors with the same key can't be split either.
+    for (size_t i = 0; i + 1 < all_anchors.size(); i++) {
+      sum += all_anchors[i].range_size;
+      if (boundary_keys_.size() + 1 == subcompactions) {
+        // The last subcompaction goes to the end so no need to put an end
+        // boundary
         continue;
       }
-      if (sum >= mean) {
-        boundaries_.emplace_back(ExtractUserKey(ranges[i].range.limit));
+      if (sum >= mean &&
+          cfd_comparator->Compare(all_anchors[i].user_key,
+                                  all_anchors[i + 1].user_key) != 0) {
+        boundary_keys_.emplace_back(std::move(all_anchors[i].user_key));
         sizes_.emplace_back(sum);
-        subcompactions--;
         sum = 0;
       }
     }
-    sizes_.emplace_back(sum + ranges.back().size);
+    sizes_.emplace_back(sum + all_anchors.back().range_size);
   } else {
-    // Only one range so its size is the total sum of sizes computed above
-    sizes_.emplace_back(sum);
+    sizes_.emplace_back(total_size);
+  }
+  for (const auto& key : boundary_keys_) {
+    boundaries_.emplace_back(key);
   }
 }
 
@@ -1211,6 +1174,533 @@ CompactionJob::ProcessKeyValueCompactionWithCompactionService(
 }
 #endif  // !ROCKSDB_LITE
 
+namespace {
+// Size of the batches of input keys and values read ahead by
+// DBOptions::pipelined_compaction, and maximum number of batches read ahead
+const size_t kPipelineBatchBytes = 256 << 10;
+const size_t kPipelineMaxBatches = 4;
+
+// Maximum stored size of the data blocks of a raw block run, which are kept
+// in memory from when the run is found until it is copied. Longer runs are
+// split.
+const size_t kRawBlockRunMaxBytes = 1 << 20;
+
+// Returns whether an input file of the compaction has range tombstones, or
+// its table properties could not be read.
+bool InputHasRangeDeletions(const Compaction* compaction) {
+  for (size_t i = 0; i < compaction->num_input_levels(); i++) {
+    for (const FileMetaData* f : *compaction->inputs(i)) {
+      std::shared_ptr<const TableProperties> props;
+      Status s = compaction->input_version()->GetTableProperties(&props, f);
+      if (!s.ok() || props == nullptr || props->num_range_deletions > 0) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+}  // namespace
+
+// The user keys of an input file in the range of a subcompaction that no
+// other input file has keys in: those after `lower` and before `upper`, when
+// they are set.
+struct CompactionJob::RawBlockGap {
+  const FileMetaData* file;
+  Slice lower;
+  bool has_lower;
+  Slice upper;
+  bool has_upper;
+};
+
+struct CompactionJob::RawBlockRun {
+  // The first and last internal keys of the run
+  std::string first_key;
+  std::string last_key;
+  // The blocks of the run, as read when it was found
+  std::vector<std::unique_ptr<RawDataBlock>> blocks;
+  // Stored size of the blocks
+  size_t data_size = 0;
+};
+
+// Finds the raw block runs in the gaps one after the other, reading each data
+// block of the gaps once: the blocks of the runs are kept for the copy.
+class CompactionJob::RawBlockRunFinder {
+ public:
+  RawBlockRunFinder(SubcompactionState* sub_compact,
+                    const ReadOptions& read_options,
+                    const std::vector<SequenceNumber>& existing_snapshots,
+                    std::vector<RawBlockGap>&& gaps)
+      : sub_compact_(sub_compact),
+        cfd_(sub_compact->compaction->column_family_data()),
+        ucmp_(cfd_->user_comparator()),
+        read_options_(read_options),
+        // CompactionIterator zeroes the sequence numbers of the keys visible
+        // to all snapshots at the bottommost level, so the blocks with such
+        // keys are not copied.
+        zero_seqnos_(sub_compact->compaction->bottommost_level() &&
+                     !cfd_->ioptions()->allow_ingest_behind),
+        earliest_snapshot_(existing_snapshots.empty()
+                               ? kMaxSequenceNumber
+                               : existing_snapshots.front()),
+        gaps_(std::move(gaps)) {}
+
+  // Sets `*run` to the next run, or to nullptr past the last one.
+  Status FindNextRun(std::unique_ptr<RawBlockRun>* run) {
+    run->reset();
+    while (status_.ok() && *run == nullptr) {
+      if (iter_ == nullptr) {
+        if (next_gap_ == gaps_.size()) {
+          break;
+        }
+        OpenGap(gaps_[next_gap_++]);
+      } else if (!iter_->Valid()) {
+        status_ = iter_->status();
+        EndGap(run);
+      } else {
+        ScanBlock(run);
+      }
+    }
+    if (!status_.ok()) {
+      run->reset();
+    }
+    return status_;
+  }
+
+ private:
+  void OpenGap(const RawBlockGap& gap) {
+    gap_ = &gap;
+    status_ = cfd_->table_cache()->NewRawDataBlockIterator(
+        read_options_, cfd_->internal_comparator(), gap.file->fd, &iter_);
+    if (!status_.ok() || iter_ == nullptr) {
+      iter_.reset();
+      return;
+    }
+    // The entries before the first block read have smaller user keys
+    IterKey seek_key;
+    if (gap.has_lower) {
+      seek_key.SetInternalKey(gap.lower, 0, kTypeDeletion);
+      iter_->Seek(seek_key.GetInternalKey());
+    } else if (sub_compact_->start) {
+      seek_key.SetInternalKey(*sub_compact_->start, kMaxSequenceNumber,
+                              kValueTypeForSeek);
+      iter_->Seek(seek_key.GetInternalKey());
+    } else {
+      iter_->SeekToFirst();
+    }
+    has_prev_ = false;
+  }
+
+  void EndGap(std::unique_ptr<RawBlockRun>* run) {
+    EndRun(run);
+    iter_.reset();
+  }
+
+  // Sets `*run` to the current run, if it has blocks, and starts a new one.
+  void EndRun(std::unique_ptr<RawBlockRun>* run) {
+    assert(*run == nullptr || pending_.blocks.empty());
+    if (!pending_.blocks.empty()) {
+      run->reset(new RawBlockRun(std::move(pending_)));
+      pending_ = RawBlockRun();
+    }
+  }
+
+  bool PastGap(const Slice& user_key) const {
+    return (gap_->has_upper && ucmp_->Compare(user_key, gap_->upper) >= 0) ||
+           (sub_compact_->end &&
+            ucmp_->Compare(user_key, *sub_compact_->end) >= 0);
+  }
+
+  // Adds the current block of iter_ to the current run if its keys can be
+  // copied, or ends the run, then moves iter_ to the next block of the gap.
+  void ScanBlock(std::unique_ptr<RawBlockRun>* run) {
+    InternalIterator* entries = iter_->block().entries;
+    entries->SeekToFirst();
+    if (!entries->Valid()) {
+      status_ = entries->status();
+      return;
+    }
+    // A block of keys past the gap ends the scan.
+    if (PastGap(ExtractUserKey(entries->key()))) {
+      EndGap(run);
+      return;
+    }
+
+    bool copyable = true;
+    bool past_gap = false;
+    if (has_prev_ &&
+        ucmp_->Compare(ExtractUserKey(entries->key()), prev_user_key_) == 0) {
+      // The versions of a user key span the two blocks, so the previous block
+      // cannot end the run either.
+      copyable = false;
+      if (!pending_.blocks.empty()) {
+        pending_.data_size -= pending_.blocks.back()->contents.size();
+        pending_.blocks.pop_back();
+        pending_.last_key = prev_last_key_;
+      }
+    }
+    const Slice* const lower = gap_->has_lower ? &gap_->lower : nullptr;
+    const Slice* const start = sub_compact_->start;
+    for (; entries->Valid(); entries->Next()) {
+      ParsedInternalKey ikey;
+      if (!ParseInternalKey(entries->key(), &ikey, /*log_err_key=*/false)
+               .ok()) {
+        copyable = false;
+        continue;
+      }
+      if (PastGap(ikey.user_key)) {
+        copyable = false;
+        past_gap = true;
+      }
+      if ((lower && ucmp_->Compare(ikey.user_key, *lower) <= 0) ||
+          (start && ucmp_->Compare(ikey.user_key, *start) < 0) ||
+          (has_prev_ && ucmp_->Compare(ikey.user_key, prev_user_key_) <= 0) ||
+          ikey.type != kTypeValue ||
+          (zero_seqnos_ && ikey.sequence != 0 &&
+           ikey.sequence <= earliest_snapshot_)) {
+        copyable = false;
+      }
+      prev_user_key_.assign(ikey.user_key.data(), ikey.user_key.size());
+      has_prev_ = true;
+    }
+    status_ = entries->status();
+    if (!status_.ok()) {
+      return;
+    }
+
+    if (copyable) {
+      // The blocks are kept until the run is copied, so long runs are split.
+      if (pending_.data_size >= kRawBlockRunMaxBytes) {
+        EndRun(run);
+      }
+      entries->SeekToFirst();
+      if (pending_.blocks.empty()) {
+        pending_.first_key = entries->key().ToString();
+      } else {
+        prev_last_key_ = pending_.last_key;
+      }
+      entries->SeekToLast();
+      pending_.last_key = entries->key().ToString();
+      pending_.blocks.push_back(iter_->ReleaseBlock());
+      pending_.data_size += pending_.blocks.back()->contents.size();
+    } else {
+      EndRun(run);
+    }
+    if (past_gap) {
+      EndGap(run);
+    } else {
+      iter_->Next();
+    }
+  }
+
+  SubcompactionState* const sub_compact_;
+  ColumnFamilyData* const cfd_;
+  const Comparator* const ucmp_;
+  const ReadOptions read_options_;
+  const bool zero_seqnos_;
+  const SequenceNumber earliest_snapshot_;
+  const std::vector<RawBlockGap> gaps_;
+
+  size_t next_gap_ = 0;
+  const RawBlockGap* gap_ = nullptr;
+  // Reads the blocks of gap_, or nullptr between gaps
+  std::unique_ptr<RawDataBlockIterator> iter_;
+  // The run being built
+  RawBlockRun pending_;
+  // The last key of the block before the last one of pending_
+  std::string prev_last_key_;
+  // The last user key of the blocks of gap_ scanned so far
+  std::string prev_user_key_;
+  bool has_prev_ = false;
+  Status status_;
+};
+
+// Hides the keys of the raw block runs from CompactionIterator but the first
+// one, which CompactionIterator returns unchanged, telling the compaction to
+// copy the run there. As no other input file has keys in the range of a run,
+// the keys after it are found by seeking past its last key. The runs are found
+// as the input reaches them.
+class CompactionJob::RawBlockRunSkippingIterator : public InternalIterator {
+ public:
+  RawBlockRunSkippingIterator(InternalIterator* iter,
+                              std::unique_ptr<RawBlockRunFinder>&& finder,
+                              const InternalKeyComparator* icmp)
+      : iter_(iter), finder_(std::move(finder)), icmp_(icmp) {}
+
+  bool Valid() const override { return status_.ok() && iter_->Valid(); }
+  void SeekToFirst() override {
+    at_run_ = false;
+    iter_->SeekToFirst();
+    SkipRuns();
+  }
+  // The runs are found in key order, so seeks may only move forward.
+  void Seek(const Slice& target) override {
+    at_run_ = false;
+    iter_->Seek(target);
+    SkipRuns();
+  }
+  void Next() override {
+    if (at_run_) {
+      at_run_ = false;
+      iter_->Seek(run_last_key_);
+      if (iter_->Valid() && icmp_->Compare(iter_->key(), run_last_key_) == 0) {
+        iter_->Next();
+      }
+    } else {
+      iter_->Next();
+    }
+    SkipRuns();
+  }
+  Slice key() const override { return iter_->key(); }
+  Slice value() const override { return iter_->value(); }
+  Status status() const override {
+    return status_.ok() ? iter_->status() : status_;
+  }
+
+  // Unused InternalIterator methods
+  void SeekToLast() override { assert(false); }
+  void SeekForPrev(const Slice& /*target*/) override { assert(false); }
+  void Prev() override { assert(false); }
+
+  // The first run reached and not copied yet, if any
+  const RawBlockRun* ReachedRun() const {
+    return reached_runs_.empty() ? nullptr : reached_runs_.front().get();
+  }
+
+  // Frees the run returned by ReachedRun(), once copied.
+  void PopReachedRun() {
+    assert(!reached_runs_.empty());
+    reached_runs_.pop_front();
+  }
+
+ private:
+  void SkipRuns() {
+    while (status_.ok() && iter_->Valid()) {
+      if (next_run_ == nullptr) {
+        if (finder_ == nullptr) {
+          return;
+        }
+        status_ = finder_->FindNextRun(&next_run_);
+        if (!status_.ok()) {
+          return;
+        }
+        if (next_run_ == nullptr) {
+          finder_.reset();
+          return;
+        }
+      }
+      const int cmp = icmp_->Compare(iter_->key(), next_run_->first_key);
+      if (cmp < 0) {
+        return;
+      }
+      if (cmp == 0) {
+        at_run_ = true;
+        run_last_key_ = next_run_->last_key;
+        reached_runs_.push_back(std::move(next_run_));
+        return;
+      }
+      // A seek went past the start of the run, whose keys are then compacted
+      // like the others.
+      next_run_.reset();
+    }
+  }
+
+  InternalIterator* const iter_;
+  std::unique_ptr<RawBlockRunFinder> finder_;
+  const InternalKeyComparator* const icmp_;
+  // The next run found, not reached by iter_ yet
+  std::unique_ptr<RawBlockRun> next_run_;
+  // Whether iter_ is at the first key of the last run reached, which ends
+  // with run_last_key_
+  bool at_run_ = false;
+  std::string run_last_key_;
+  std::deque<std::unique_ptr<RawBlockRun>> reached_runs_;
+  Status status_;
+};
+
+void CompactionJob::FindRawBlockGaps(SubcompactionState* sub_compact,
+                                     std::vector<RawBlockGap>* gaps) {
+  const Compaction* compaction = sub_compact->compaction;
+  const Comparator* ucmp = compaction->column_family_data()->user_comparator();
+  const Slice* const start = sub_compact->start;
+  const Slice* const end = sub_compact->end;
+
+  // The user key ranges of the input files in the range of the subcompaction,
+  // clipped to its start, and whether they have keys up to its end
+  struct InputFile {
+    const FileMetaData* file;
+    Slice smallest;
+    Slice largest;
+    bool reaches_end;
+  };
+  std::vector<InputFile> files;
+  for (size_t i = 0; i < compaction->num_input_levels(); i++) {
+    for (const FileMetaData* f : *compaction->inputs(i)) {
+      Slice smallest = f->smallest.user_key();
+      const Slice largest = f->largest.user_key();
+      if ((start && ucmp->Compare(largest, *start) < 0) ||
+          (end && ucmp->Compare(smallest, *end) >= 0)) {
+        continue;
+      }
+      if (start && ucmp->Compare(smallest, *start) < 0) {
+        smallest = *start;
+      }
+      files.push_back(
+          {f, smallest, largest, end && ucmp->Compare(largest, *end) >= 0});
+    }
+  }
+  std::sort(files.begin(), files.end(),
+            [&](const InputFile& a, const InputFile& b) {
+              return ucmp->Compare(a.smallest, b.smallest) < 0;
+            });
+
+  // Whether all keys of `file` are at or before `key`
+  auto ends_by = [&](const InputFile& file, const Slice& key) {
+    return !file.reaches_end && ucmp->Compare(file.largest, key) <= 0;
+  };
+  auto add_gap = [&](const InputFile& file, const Slice* lower,
+                     const Slice* upper) {
+    gaps->push_back({file.file, lower ? *lower : Slice(), lower != nullptr,
+                     upper ? *upper : Slice(), upper != nullptr});
+  };
+
+  // The gaps of each file between the ranges of the other files. The gaps
+  // exclude the smallest and largest keys of those files. `prev` is the file
+  // that ends last among the files starting before the current one.
+  const InputFile* prev = nullptr;
+  for (size_t i = 0; i < files.size(); i++) {
+    const InputFile& file = files[i];
+    const Slice* lower = prev != nullptr ? &prev->largest : nullptr;
+    bool covered = prev != nullptr && (prev->reaches_end ||
+                                       ends_by(file, prev->largest));
+    for (size_t j = i + 1; !covered && j < files.size(); j++) {
+      const InputFile& other = files[j];
+      if (!file.reaches_end &&
+          ucmp->Compare(other.smallest, file.largest) > 0) {
+        break;
+      }
+      if (ucmp->Compare(other.smallest, file.smallest) > 0 &&
+          (lower == nullptr || ucmp->Compare(other.smallest, *lower) > 0)) {
+        add_gap(file, lower, &other.smallest);
+      }
+      if (other.reaches_end) {
+        covered = true;
+      } else {
+        if (lower == nullptr || ucmp->Compare(other.largest, *lower) > 0) {
+          lower = &other.largest;
+        }
+        covered = ends_by(file, *lower);
+      }
+    }
+    if (!covered) {
+      add_gap(file, lower, nullptr);
+    }
+
+    if (prev == nullptr ||
+        (!prev->reaches_end &&
+         (file.reaches_end ||
+          ucmp->Compare(file.largest, prev->largest) > 0))) {
+      prev = &file;
+    }
+  }
+
+  // Gaps do not overlap, so they are ordered by their lower bounds. Only the
+  // first one may have none.
+  std::sort(gaps->begin(), gaps->end(),
+            [&](const RawBlockGap& a, const RawBlockGap& b) {
+              return !a.has_lower ? b.has_lower
+                                  : b.has_lower &&
+                                        ucmp->Compare(a.lower, b.lower) < 0;
+            });
+}
+
+Status CompactionJob::CopyRawBlockRun(
+    SubcompactionState* sub_compact, const RawBlockRun& run,
+    CompactionRangeDelAggregator* range_del_agg) {
+  Status s;
+  uint64_t num_copied_blocks = 0;
+  // CompactionIterator read the first key of the run.
+  bool first_key_of_run = true;
+  for (const auto& block : run.blocks) {
+    InternalIterator* entries = block->entries;
+    entries->SeekToFirst();
+    assert(entries->Valid());
+    const Slice first_key = entries->key();
+    if (sub_compact->compaction->output_level() != 0 &&
+        sub_compact->ShouldStopBefore(first_key,
+                                      sub_compact->current_output_file_size) &&
+        sub_compact->builder != nullptr) {
+      CompactionIterationStats range_del_out_stats;
+      s = FinishCompactionOutputFile(s, sub_compact, range_del_agg,
+                                     &range_del_out_stats, &first_key);
+      RecordDroppedKeys(range_del_out_stats,
+                        &sub_compact->compaction_job_stats);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    if (sub_compact->builder == nullptr) {
+      sub_compact->output_is_cold = false;
+      s = OpenCompactionOutputFile(sub_compact);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+
+    // The entries of a block that is not copied are added one by one.
+    const bool copied = sub_compact->builder->AddRawDataBlock(*block);
+    if (copied) {
+      num_copied_blocks++;
+    }
+    auto* output = sub_compact->current_output();
+    for (entries->SeekToFirst(); entries->Valid(); entries->Next()) {
+      const Slice key = entries->key();
+      const Slice value = entries->value();
+      s = copied ? output->validator.Add(key, value)
+                 : sub_compact->AddToBuilder(key, value);
+      if (s.ok()) {
+        ParsedInternalKey ikey;
+        s = ParseInternalKey(key, &ikey, db_options_.allow_data_in_errors);
+        if (s.ok()) {
+          output->meta.UpdateBoundaries(key, value, ikey.sequence, ikey.type);
+        }
+      }
+      if (!s.ok()) {
+        return s;
+      }
+      sub_compact->num_output_records++;
+      if (!first_key_of_run) {
+        sub_compact->compaction_job_stats.total_input_raw_key_bytes +=
+            key.size();
+        sub_compact->compaction_job_stats.total_input_raw_value_bytes +=
+            value.size();
+      }
+      first_key_of_run = false;
+    }
+    s = entries->status();
+    if (!s.ok()) {
+      return s;
+    }
+
+    sub_compact->current_output_file_size =
+        sub_compact->builder->EstimatedFileSize();
+    if (sub_compact->compaction->output_level() != 0 &&
+        sub_compact->current_output_file_size >=
+            sub_compact->compaction->max_output_file_size()) {
+      CompactionIterationStats range_del_out_stats;
+      s = FinishCompactionOutputFile(s, sub_compact, range_del_agg,
+                                     &range_del_out_stats);
+      RecordDroppedKeys(range_del_out_stats,
+                        &sub_compact->compaction_job_stats);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+  }
+  TEST_SYNC_POINT_CALLBACK("CompactionJob::CopyRawBlockRun:Copied",
+                           &num_copied_blocks);
+  return s;
+}
+
 void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   assert(sub_compact);
   assert(sub_compact->compaction);
@@ -1299,6 +1789,56 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     input = clip.get();
   }
 
+  // The range tombstones of the input files are added to range_del_agg as
+  // the files are opened, which it does not support from another thread.
+  std::unique_ptr<InternalIterator> pipeline;
+  if (db_options_.pipelined_compaction &&
+      !InputHasRangeDeletions(sub_compact->compaction)) {
+    pipeline.reset(new PipelinedInputIterator(input, kPipelineBatchBytes,
+                                              kPipelineMaxBatches));
+    input = pipeline.get();
+    TEST_SYNC_POINT("CompactionJob::ProcessKeyValueCompaction:Pipelined");
+  }
+
+  // The data blocks of an input file with no keys of the other input files in
+  // their range, and whose keys all survive the compaction unchanged, are
+  // copied to the output as stored. CompactionIterator only sees the first key
+  // of each run of such blocks.
+  std::unique_ptr<RawBlockRunSkippingIterator> raw_block_run_skipper;
+  if (sub_compact->compaction->mutable_cf_options()
+          ->compaction_block_passthrough &&
+      compaction_filter == nullptr && !db_options_.pipelined_compaction &&
+      !sub_compact->compaction->mutable_cf_options()->enable_blob_files &&
+      !sub_compact->compaction->DoesInputReferenceBlobFiles() &&
+      sub_compact->compaction->mutable_cf_options()->cold_key_temperature ==
+          Temperature::kUnknown &&
+      cfd->ioptions()->sst_partitioner_factory == nullptr &&
+      cfd->user_comparator()->timestamp_size() == 0 &&
+      full_history_ts_low_.empty() && snapshot_checker_ == nullptr &&
+      !InputHasRangeDeletions(sub_compact->compaction)) {
+    std::vector<RawBlockGap> gaps;
+    FindRawBlockGaps(sub_compact, &gaps);
+    if (!gaps.empty()) {
+      std::unique_ptr<RawBlockRunFinder> finder(new RawBlockRunFinder(
+          sub_compact, read_options, existing_snapshots_, std::move(gaps)));
+      raw_block_run_skipper.reset(new RawBlockRunSkippingIterator(
+          input, std::move(finder), &cfd->internal_comparator()));
+      input = raw_block_run_skipper.get();
+    }
+  }
+  // The next raw block run to copy, if it starts before or at `key`
+  auto raw_block_run_first = [&](const Slice& key) -> const RawBlockRun* {
+    const RawBlockRun* run = raw_block_run_skipper
+                                 ? raw_block_run_skipper->ReachedRun()
+                                 : nullptr;
+    return run != nullptr &&
+                   cfd->internal_comparator().Compare(run->first_key, key) <= 0
+               ? run
+               : nullptr;
+  };
+  // Whether the last key of c_iter was the first key of a raw block run
+  bool raw_block_run_copied = false;
+
   std::unique_ptr<InternalIterator> blob_counter;
 
   if (sub_compact->compaction->DoesInputReferenceBlobFiles()) {
@@ -1377,12 +1917,19 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
       manual_compaction_canceled_, db_options_.info_log, full_history_ts_low));
   auto c_iter = sub_compact->c_iter.get();
   c_iter->SeekToFirst();
-  if (c_iter->Valid() && sub_compact->compaction->output_level() != 0) {
+  if ((c_iter->Valid() ||
+       (raw_block_run_skipper && raw_block_run_skipper->ReachedRun())) &&
+      sub_compact->compaction->output_level() != 0) {
     sub_compact->FillFilesToCutForTtl();
     // ShouldStopBefore() maintains state based on keys processed so far. The
     // compaction loop always calls it on the "next" key, thus won't tell it the
     // first key. So we do that here.
-    sub_compact->ShouldStopBefore(c_iter->key(),
+    // A raw block run is copied before the key of c_iter if it starts first.
+    const Slice first_key =
+        c_iter->Valid() && !raw_block_run_first(c_iter->key())
+            ? c_iter->key()
+            : Slice(raw_block_run_skipper->ReachedRun()->first_key);
+    sub_compact->ShouldStopBefore(first_key,
                                   sub_compact->current_output_file_size);
   }
   const auto& c_iter_stats = c_iter->iter_stats();
@@ -1393,6 +1940,30 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
           : sub_compact->compaction->CreateSstPartitioner();
   std::string last_key_for_partitioner;
 
+  // With a key hotness tracker, outputs are cut where the keys turn from hot
+  // to cold or back, so that the cold keys are written to files with
+  // cold_key_temperature. Versions of the same user key stay together.
+  KeyHotnessTracker* const hotness_tracker =
+      sub_compact->compaction->output_level() != 0 &&
+              mutable_cf_options->cold_key_temperature != Temperature::kUnknown
+          ? cfd->ioptions()->key_hotness_tracker.get()
+          : nullptr;
+  const size_t ts_sz = cfd->user_comparator()->timestamp_size();
+  bool key_is_cold = false;
+  std::string last_key_for_hotness;
+  auto update_key_is_cold = [&]() {
+    Slice user_key = c_iter->user_key();
+    if (last_key_for_hotness.empty() ||
+        cfd->user_comparator()->Compare(user_key, last_key_for_hotness) != 0) {
+      key_is_cold =
+          !hotness_tracker->IsHot(StripTimestampFromUserKey(user_key, ts_sz));
+      last_key_for_hotness.assign(user_key.data(), user_key.size());
+    }
+  };
+  if (hotness_tracker != nullptr && c_iter->Valid()) {
+    update_key_is_cold();
+  }
+
   while (status.ok() && !cfd->IsDropped() && c_iter->Valid()) {
     // Invariant: c_iter.status() is guaranteed to be OK if c_iter->Valid()
     // returns true.
@@ -1402,6 +1973,41 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     assert(!end ||
            cfd->user_comparator()->Compare(c_iter->user_key(), *end) < 0);
 
+    if (raw_block_run_first(key) || raw_block_run_copied) {
+      bool key_copied = false;
+      const RawBlockRun* run;
+      while (status.ok() && (run = raw_block_run_first(key)) != nullptr) {
+        key_copied =
+            cfd->internal_comparator().Compare(run->first_key, key) == 0;
+        status = CopyRawBlockRun(sub_compact, *run, &range_del_agg);
+        raw_block_run_skipper->PopReachedRun();
+      }
+      // The first key of a run was copied with it. The next key checks
+      // whether it starts the next file.
+      raw_block_run_copied = key_copied;
+      if (status.ok() && key_copied) {
+        c_iter->Next();
+        if (c_iter->status().IsManualCompactionPaused()) {
+          break;
+        }
+        continue;
+      }
+      if (status.ok() && sub_compact->compaction->output_level() != 0 &&
+          sub_compact->ShouldStopBefore(
+              key, sub_compact->current_output_file_size) &&
+          sub_compact->builder != nullptr) {
+        CompactionIterationStats range_del_out_stats;
+        status = FinishCompactionOutputFile(input->status(), sub_compact,
+                                            &range_del_agg,
+                                            &range_del_out_stats, &key);
+        RecordDroppedKeys(range_del_out_stats,
+                          &sub_compact->compaction_job_stats);
+      }
+      if (!status.ok()) {
+        break;
+      }
+    }
+
     if (c_iter_stats.num_input_records % kRecordStatsEvery ==
         kRecordStatsEvery - 1) {
       RecordDroppedKeys(c_iter_stats, &sub_compact->compaction_job_stats);
@@ -1411,6 +2017,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
 
     // Open output file if necessary
     if (sub_compact->builder == nullptr) {
+      sub_compact->output_is_cold = key_is_cold;
       status = OpenCompactionOutputFile(sub_compact);
       if (!status.ok()) {
         break;
@@ -1461,14 +2068,22 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     if (c_iter->status().IsManualCompactionPaused()) {
       break;
     }
-    if (!output_file_ended && c_iter->Valid()) {
+    if (hotness_tracker != nullptr && c_iter->Valid()) {
+      update_key_is_cold();
+    }
+    // A raw block run copied before or at the next key checks whether it
+    // starts the next file.
+    if (!output_file_ended && c_iter->Valid() &&
+        !raw_block_run_first(c_iter->key())) {
       if (((partitioner.get() &&
             partitioner->ShouldPartition(PartitionerRequest(
                 last_key_for_partitioner, c_iter->user_key(),
                 sub_compact->current_output_file_size)) == kRequired) ||
            (sub_compact->compaction->output_level() != 0 &&
             sub_compact->ShouldStopBefore(
-                c_iter->key(), sub_compact->current_output_file_size))) &&
+                c_iter->key(), sub_compact->current_output_file_size)) ||
+           (hotness_tracker != nullptr &&
+            key_is_cold != sub_compact->output_is_cold)) &&
           sub_compact->builder != nullptr) {
         // (2) this key belongs to the next file. For historical reasons, the
         // iterator status after advancing will be given to
@@ -1478,8 +2093,12 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     }
     if (output_file_ended) {
       const Slice* next_key = nullptr;
-      if (c_iter->Valid()) {
+      Slice raw_block_run_key;
+      if (c_iter->Valid() && !raw_block_run_first(c_iter->key())) {
         next_key = &c_iter->key();
+      } else if (raw_block_run_skipper && raw_block_run_skipper->ReachedRun()) {
+        raw_block_run_key = raw_block_run_skipper->ReachedRun()->first_key;
+        next_key = &raw_block_run_key;
       }
       CompactionIterationStats range_del_out_stats;
       status = FinishCompactionOutputFile(input->status(), sub_compact,
@@ -1490,6 +2109,15 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     }
   }
 
+  // The raw block runs after the last key of c_iter
+  while (status.ok() && !cfd->IsDropped() && c_iter->status().ok() &&
+         input->status().ok() && raw_block_run_skipper &&
+         raw_block_run_skipper->ReachedRun()) {
+    status = CopyRawBlockRun(sub_compact, *raw_block_run_skipper->ReachedRun(),
+                             &range_del_agg);
+    raw_block_run_skipper->PopReachedRun();
+  }
+
   sub_compact->compaction_job_stats.num_blobs_read =
       c_iter_stats.num_blobs_read;
   sub_compact->compaction_job_stats.total_blob_bytes_read =
@@ -1604,6 +2232,8 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
 
   sub_compact->c_iter.reset();
   blob_counter.reset();
+  pipeline.reset();
+  raw_block_run_skipper.reset();
   clip.reset();
   raw_input.reset();
   sub_compact->status = status;
@@ -2100,6 +2730,10 @@ Status CompactionJob::OpenCompactionOutputFile(
     temperature =
         sub_compact->compaction->mutable_cf_options()->bottommost_temperature;
   }
+  if (sub_compact->output_is_cold) {
+    temperature =
+        sub_compact->compaction->mutable_cf_options()->cold_key_temperature;
+  }
   fo_copy.temperature = temperature;
 
   Status s;
@@ -2181,11 +2815,18 @@ Status CompactionJob::OpenCompactionOutputFile(
       db_options_.file_checksum_gen_factory.get(),
       tmp_set.Contains(FileType::kTableFile), false));
 
+  CompressionOptions compression_opts =
+      sub_compact->compaction->output_compression_opts();
+  if (db_options_.pipelined_compaction) {
+    // Blocks are compressed and written by threads of the table builder
+    compression_opts.parallel_threads =
+        std::max(compression_opts.parallel_threads, uint32_t{2});
+  }
   TableBuilderOptions tboptions(
       *cfd->ioptions(), *(sub_compact->compaction->mutable_cf_options()),
       cfd->internal_comparator(), cfd->int_tbl_prop_collector_factories(),
-      sub_compact->compaction->output_compression(),
-      sub_compact->compaction->output_compression_opts(), cfd->GetID(),
+      sub_compact->compaction->output_compression(), compression_opts,
+      cfd->GetID(),
       cfd->GetName(), sub_compact->compaction->output_level(),
       bottommost_level_, TableFileCreationReason::kCompaction,
       oldest_ancester_time, 0 /* oldest_key_time */, current_time, db_id_,
@@ -148,6 +148,24 @@ class CompactionJob {
   CompactionServiceJobStatus ProcessKeyValueCompactionWithCompactionService(
       SubcompactionState* sub_compact);
 
+  // A run of consecutive data blocks of an input file that the compaction
+  // copies to its outputs as stored, per compaction_block_passthrough, and the
+  // range of keys, or gap, that the runs are found in.
+  struct RawBlockRun;
+  struct RawBlockGap;
+  class RawBlockRunFinder;
+  class RawBlockRunSkippingIterator;
+
+  // Finds the ranges of user keys of the input files, in the range of the
+  // subcompaction, that no other input file overlaps. The data blocks of the
+  // runs are in those gaps. The gaps are in key order.
+  void FindRawBlockGaps(SubcompactionState* sub_compact,
+                        std::vector<RawBlockGap>* gaps);
+  // Adds the data blocks of the run to the outputs of the subcompaction.
+  Status CopyRawBlockRun(SubcompactionState* sub_compact,
+                         const RawBlockRun& run,
+                         CompactionRangeDelAggregator* range_del_agg);
+
   // update the thread status for starting a compaction.
   void ReportStartedCompaction(Compaction* compaction);
   void AllocateCompactionOutputFileNumbers();
@@ -210,7 +228,9 @@ class CompactionJob {
 
   bool paranoid_file_checks_;
   bool measure_io_stats_;
-  // Stores the Slices that designate the boundaries for each subcompaction
+  // Stores the user keys that designate the boundaries for each
+  // subcompaction, and Slices of them
+  std::vector<std::string> boundary_keys_;
   std::vector<Slice> boundaries_;
   // Stores the approx size of keys covered in the range of each subcompaction
   std::vector<uint64_t> sizes_;
@@ -0,0 +1,106 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/key_hotness_tracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "port/port.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/system_clock.h"
+#include "util/fastrange.h"
+#include "util/hash.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Tracks the last read time of key ranges in a fixed-size sketch: each range
+// maps to one slot in each of kNumRows rows, by a different hash per row, and
+// each slot holds the latest read time of the ranges mapped to it. A range was
+// read no later than the earliest time in its slots, so ranges sharing slots
+// with hot ranges may look hot, but hot ranges never look cold. Recording a
+// read takes no lock and allocates nothing.
+class KeyRangeHotnessTracker : public KeyHotnessTracker {
+ public:
+  explicit KeyRangeHotnessTracker(const KeyHotnessTrackerOptions& options)
+      : options_(options),
+        clock_(options.clock ? options.clock.get()
+                             : SystemClock::Default().get()),
+        start_secs_(clock_->NowMicros() / kMicrosPerSecond),
+        num_slots_(static_cast<uint32_t>(std::min(
+            std::max(options.max_tracked_ranges, size_t{1}),
+            size_t{port::kMaxUint32}))),
+        slots_(new std::atomic<uint32_t>[size_t{kNumRows} * num_slots_]) {
+    for (size_t i = 0; i < size_t{kNumRows} * num_slots_; i++) {
+      slots_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  const char* Name() const override { return "KeyRangeHotnessTracker"; }
+
+  void RecordRead(const Slice& user_key) override {
+    const uint32_t now = Now();
+    const uint64_t hash = HashOf(user_key);
+    for (uint32_t row = 0; row < kNumRows; row++) {
+      // Reads of a hot range within the same second write nothing, so that
+      // readers on different cores do not contend for its cache lines.
+      std::atomic<uint32_t>& slot = Slot(hash, row);
+      if (slot.load(std::memory_order_relaxed) < now) {
+        slot.store(now, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool IsHot(const Slice& user_key) override {
+    const uint32_t now = Now();
+    const uint64_t hash = HashOf(user_key);
+    for (uint32_t row = 0; row < kNumRows; row++) {
+      const uint32_t last_read = Slot(hash, row).load(std::memory_order_relaxed);
+      if (last_read == 0 || last_read + options_.hot_seconds < now) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  static constexpr uint32_t kNumRows = 2;
+  static constexpr uint64_t kMicrosPerSecond = 1000000;
+
+  // Seconds since the tracker was created, plus one so that 0 means never
+  uint32_t Now() const {
+    return static_cast<uint32_t>(clock_->NowMicros() / kMicrosPerSecond -
+                                 start_secs_ + 1);
+  }
+
+  uint64_t HashOf(const Slice& user_key) const {
+    return GetSliceHash64(Slice(
+        user_key.data(),
+        std::min(user_key.size(), options_.range_prefix_length)));
+  }
+
+  // The rows use the low and the high half of the hash
+  std::atomic<uint32_t>& Slot(uint64_t hash, uint32_t row) {
+    const uint32_t row_hash = static_cast<uint32_t>(hash >> (32 * row));
+    return slots_[size_t{row} * num_slots_ + FastRange32(row_hash, num_slots_)];
+  }
+
+  const KeyHotnessTrackerOptions options_;
+  SystemClock* const clock_;
+  const uint64_t start_secs_;
+  // Per row
+  const uint32_t num_slots_;
+  std::unique_ptr<std::atomic<uint32_t>[]> slots_;
+};
+}  // namespace
+
+std::shared_ptr<KeyHotnessTracker> NewKeyHotnessTracker(
+    const KeyHotnessTrackerOptions& options) {
+  return std::make_shared<KeyRangeHotnessTracker>(options);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,160 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/compaction/pipelined_input_iterator.h"
+
+#include <cassert>
+
+#include "monitoring/iostats_context_imp.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+PipelinedInputIterator::PipelinedInputIterator(InternalIterator* iter,
+                                               size_t batch_bytes,
+                                               size_t max_batches)
+    : iter_(iter),
+      batch_bytes_(batch_bytes),
+      max_batches_(max_batches == 0 ? 1 : max_batches),
+      cv_(&mutex_) {
+  assert(iter_);
+  thread_ = port::Thread(&PipelinedInputIterator::BackgroundThread, this);
+}
+
+PipelinedInputIterator::~PipelinedInputIterator() {
+  {
+    MutexLock l(&mutex_);
+    stop_ = true;
+    cv_.SignalAll();
+  }
+  thread_.join();
+}
+
+void PipelinedInputIterator::Next() {
+  assert(Valid());
+  pos_++;
+  if (pos_ == batch_.entries.size()) {
+    if (batch_.last) {
+      status_ = batch_.status;
+    } else {
+      ReadNextBatch();
+    }
+  }
+}
+
+Slice PipelinedInputIterator::key() const {
+  assert(Valid());
+  const Entry& entry = batch_.entries[pos_];
+  return Slice(batch_.data.data() + entry.key_offset, entry.key_size);
+}
+
+Slice PipelinedInputIterator::value() const {
+  assert(Valid());
+  const Entry& entry = batch_.entries[pos_];
+  return Slice(batch_.data.data() + entry.key_offset + entry.key_size,
+               entry.value_size);
+}
+
+void PipelinedInputIterator::Restart(const Slice* target) {
+  {
+    MutexLock l(&mutex_);
+    generation_++;
+    restart_ = true;
+    seek_to_target_ = target != nullptr;
+    if (target != nullptr) {
+      seek_target_.assign(target->data(), target->size());
+    }
+    reading_ = false;
+    queue_.clear();
+    cv_.SignalAll();
+  }
+  status_ = Status::OK();
+  ReadNextBatch();
+}
+
+void PipelinedInputIterator::ReadNextBatch() {
+  {
+    MutexLock l(&mutex_);
+    while (queue_.empty()) {
+      cv_.Wait();
+    }
+    batch_ = std::move(queue_.front());
+    queue_.pop_front();
+    cv_.SignalAll();
+  }
+  pos_ = 0;
+  IOSTATS_ADD(bytes_read, batch_.bytes_read);
+  if (batch_.entries.empty()) {
+    assert(batch_.last);
+    status_ = batch_.status;
+  }
+}
+
+void PipelinedInputIterator::NotSupported() {
+  assert(false);
+  batch_ = Batch();
+  pos_ = 0;
+  status_ = Status::NotSupported(
+      "PipelinedInputIterator only supports forward iteration");
+}
+
+void PipelinedInputIterator::BackgroundThread() {
+  MutexLock l(&mutex_);
+  while (true) {
+    while (!stop_ && !restart_ &&
+           !(reading_ && queue_.size() < max_batches_)) {
+      cv_.Wait();
+    }
+    if (stop_) {
+      return;
+    }
+    if (restart_) {
+      restart_ = false;
+      const bool seek_to_target = seek_to_target_;
+      const std::string target = seek_target_;
+      mutex_.Unlock();
+      if (seek_to_target) {
+        iter_->Seek(target);
+      } else {
+        iter_->SeekToFirst();
+      }
+      mutex_.Lock();
+      // If restarted again meanwhile, the next iteration seeks again
+      reading_ = true;
+      continue;
+    }
+
+    const uint64_t generation = generation_;
+    Batch batch;
+    mutex_.Unlock();
+    FillBatch(&batch);
+    mutex_.Lock();
+    if (generation == generation_) {
+      reading_ = !batch.last;
+      queue_.push_back(std::move(batch));
+      cv_.SignalAll();
+    }
+  }
+}
+
+void PipelinedInputIterator::FillBatch(Batch* batch) {
+  const uint64_t prev_bytes_read = IOSTATS(bytes_read);
+  while (iter_->Valid() && batch->data.size() < batch_bytes_ &&
+         iter_->PrepareValue()) {
+    const Slice key = iter_->key();
+    const Slice value = iter_->value();
+    batch->entries.push_back({batch->data.size(), key.size(), value.size()});
+    batch->data.append(key.data(), key.size());
+    batch->data.append(value.data(), value.size());
+    iter_->Next();
+  }
+  if (!iter_->Valid()) {
+    batch->last = true;
+    batch->status = iter_->status();
+  }
+  batch->bytes_read = IOSTATS(bytes_read) - prev_bytes_read;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
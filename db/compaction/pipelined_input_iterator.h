@@ -0,0 +1,107 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/status.h"
+#include "table/internal_iterator.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// An internal iterator that runs another one on a thread of its own, ahead of
+// its consumer: the key-value pairs of the wrapped iterator are copied in
+// batches that are handed over through a bounded queue. Compactions use it so
+// that reading, decompressing and merging their inputs overlaps with
+// CompactionIterator and the table builder.
+//
+// Only forward iteration is supported. Seek() discards the batches read ahead
+// and restarts the wrapped iterator. The wrapped iterator must not be used by
+// the caller while the pipelined iterator exists, and its side effects (e.g.
+// range tombstones added to a range deletion aggregator) happen on the
+// pipeline thread.
+class PipelinedInputIterator : public InternalIterator {
+ public:
+  // Batches are cut once they hold batch_bytes of keys and values, and at
+  // most max_batches of them are read ahead.
+  PipelinedInputIterator(InternalIterator* iter, size_t batch_bytes,
+                         size_t max_batches);
+  ~PipelinedInputIterator() override;
+
+  // No copying allowed
+  PipelinedInputIterator(const PipelinedInputIterator&) = delete;
+  void operator=(const PipelinedInputIterator&) = delete;
+
+  bool Valid() const override { return pos_ < batch_.entries.size(); }
+  void SeekToFirst() override { Restart(nullptr); }
+  void Seek(const Slice& target) override { Restart(&target); }
+  void Next() override;
+  Slice key() const override;
+  Slice value() const override;
+  Status status() const override { return status_; }
+
+  void SeekToLast() override { NotSupported(); }
+  void SeekForPrev(const Slice& /*target*/) override { NotSupported(); }
+  void Prev() override { NotSupported(); }
+
+ private:
+  struct Entry {
+    size_t key_offset;
+    size_t key_size;
+    size_t value_size;
+  };
+
+  struct Batch {
+    // Keys and values, back to back
+    std::string data;
+    std::vector<Entry> entries;
+    // Whether the wrapped iterator is exhausted after this batch, and its
+    // status then
+    bool last = false;
+    Status status;
+    // Read by the pipeline thread for this batch, which is added to the
+    // IOStatsContext of the consumer
+    uint64_t bytes_read = 0;
+  };
+
+  void Restart(const Slice* target);
+  void ReadNextBatch();
+  void NotSupported();
+  void BackgroundThread();
+  void FillBatch(Batch* batch);
+
+  InternalIterator* const iter_;
+  const size_t batch_bytes_;
+  const size_t max_batches_;
+
+  // Owned by the consumer
+  Batch batch_;
+  size_t pos_ = 0;
+  Status status_;
+
+  // Shared with the pipeline thread
+  port::Mutex mutex_;
+  port::CondVar cv_;
+  std::deque<Batch> queue_;
+  // Incremented by each restart, so that the pipeline thread drops the batch
+  // it was reading.
+  uint64_t generation_ = 0;
+  bool restart_ = false;
+  bool seek_to_target_ = false;
+  std::string seek_target_;
+  // Whether the pipeline thread reads ahead, i.e. the wrapped iterator is
+  // positioned and not exhausted
+  bool reading_ = false;
+  bool stop_ = false;
+
+  port::Thread thread_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
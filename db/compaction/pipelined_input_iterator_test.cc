@@ -0,0 +1,110 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/compaction/pipelined_input_iterator.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/comparator.h"
+#include "test_util/testharness.h"
+#include "util/vector_iterator.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Parameters: the batch size in bytes, and the number of batches read ahead
+class PipelinedInputIteratorTest
+    : public ::testing::Test,
+      public ::testing::WithParamInterface<std::tuple<size_t, size_t>> {
+ protected:
+  void SetUp() override {
+    for (int i = 0; i < kNumKeys; i++) {
+      char buf[16];
+      snprintf(buf, sizeof(buf), "key%05d", i);
+      keys_.push_back(buf);
+      values_.push_back("value" + std::to_string(i));
+    }
+  }
+
+  static constexpr int kNumKeys = 1000;
+  std::vector<std::string> keys_;
+  std::vector<std::string> values_;
+};
+
+TEST_P(PipelinedInputIteratorTest, ForwardIteration) {
+  VectorIterator input(keys_, values_, BytewiseComparator());
+  PipelinedInputIterator iter(&input, std::get<0>(GetParam()),
+                              std::get<1>(GetParam()));
+  ASSERT_FALSE(iter.Valid());
+
+  iter.SeekToFirst();
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_TRUE(iter.Valid());
+    ASSERT_EQ(keys_[i], iter.key().ToString());
+    ASSERT_EQ(values_[i], iter.value().ToString());
+    iter.Next();
+  }
+  ASSERT_FALSE(iter.Valid());
+  ASSERT_OK(iter.status());
+
+  // Iterating again reads from the start
+  iter.SeekToFirst();
+  ASSERT_TRUE(iter.Valid());
+  ASSERT_EQ(keys_[0], iter.key().ToString());
+}
+
+TEST_P(PipelinedInputIteratorTest, Seek) {
+  VectorIterator input(keys_, values_, BytewiseComparator());
+  PipelinedInputIterator iter(&input, std::get<0>(GetParam()),
+                              std::get<1>(GetParam()));
+
+  // Seeks forward while batches are read ahead, as compaction filters
+  // skipping keys do, and backward
+  iter.SeekToFirst();
+  for (int target : {10, 500, 501, 990, 3}) {
+    iter.Seek(keys_[target]);
+    for (int i = target; i < target + 5; i++) {
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(keys_[i], iter.key().ToString());
+      ASSERT_EQ(values_[i], iter.value().ToString());
+      iter.Next();
+    }
+  }
+
+  iter.Seek("key99999");
+  ASSERT_FALSE(iter.Valid());
+  ASSERT_OK(iter.status());
+
+  // Seeks to a key that does not exist
+  iter.Seek("key00499a");
+  ASSERT_TRUE(iter.Valid());
+  ASSERT_EQ(keys_[500], iter.key().ToString());
+}
+
+TEST_P(PipelinedInputIteratorTest, EmptyInput) {
+  VectorIterator input({}, {}, BytewiseComparator());
+  PipelinedInputIterator iter(&input, std::get<0>(GetParam()),
+                              std::get<1>(GetParam()));
+  iter.SeekToFirst();
+  ASSERT_FALSE(iter.Valid());
+  ASSERT_OK(iter.status());
+  iter.Seek("key");
+  ASSERT_FALSE(iter.Valid());
+  ASSERT_OK(iter.status());
+}
+
+INSTANTIATE_TEST_CASE_P(
+    PipelinedInputIteratorTest, PipelinedInputIteratorTest,
+    ::testing::Combine(::testing::Values(size_t{1}, size_t{100},
+                                         size_t{1} << 20),
+                       ::testing::Values(size_t{1}, size_t{4})));
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1406,6 +1406,85 @@ TEST_P(DBMultiGetTestWithParam, MultiGetMultiCFUnsorted) {
 INSTANTIATE_TEST_CASE_P(DBMultiGetTestWithParam, DBMultiGetTestWithParam,
                         testing::Bool());
 
+TEST_F(DBBasicTest, GetPinned) {
+  Options options = CurrentOptions();
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  options.compression = kNoCompression;
+  Reopen(options);
+
+  Random rnd(301);
+  std::string large_value = rnd.RandomString(64 << 10);
+  ASSERT_OK(Put("flushed", large_value));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("in_memtable", "v"));
+  // E.g. pinned by the table reader
+  size_t base_pinned_usage = table_options.block_cache->GetPinnedUsage();
+
+  std::shared_ptr<const PinnableSlice> value;
+  ASSERT_OK(db_->GetPinned(ReadOptions(), db_->DefaultColumnFamily(),
+                           "flushed", &value));
+  ASSERT_TRUE(value->IsPinned());
+  ASSERT_EQ(*value, large_value);
+  ASSERT_GE(table_options.block_cache->GetPinnedUsage(),
+            base_pinned_usage + large_value.size());
+
+  std::shared_ptr<const PinnableSlice> memtable_value;
+  ASSERT_OK(db_->GetPinned(ReadOptions(), db_->DefaultColumnFamily(),
+                           "in_memtable", &memtable_value));
+  ASSERT_EQ(*memtable_value, "v");
+  ASSERT_TRUE(db_->GetPinned(ReadOptions(), db_->DefaultColumnFamily(),
+                             "missing", &memtable_value)
+                  .IsNotFound());
+  ASSERT_EQ(memtable_value, nullptr);
+
+  // The handle is released by another thread
+  port::Thread release_thread([&value, &large_value]() {
+    ASSERT_EQ(*value, large_value);
+    value.reset();
+  });
+  release_thread.join();
+  ASSERT_EQ(table_options.block_cache->GetPinnedUsage(), base_pinned_usage);
+}
+
+TEST_F(DBBasicTest, MultiGetPinned) {
+  Options options = CurrentOptions();
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  ASSERT_OK(Put("k1", "v1"));
+  ASSERT_OK(Put("k2", "v2"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("k3", "v3"));
+  size_t base_pinned_usage = table_options.block_cache->GetPinnedUsage();
+
+  std::vector<Slice> keys({"k1", "k2", "k3", "no_key"});
+  std::vector<std::shared_ptr<const PinnableSlice>> values(keys.size());
+  std::vector<Status> statuses(keys.size());
+  db_->MultiGetPinned(ReadOptions(), db_->DefaultColumnFamily(), keys.size(),
+                      keys.data(), values.data(), statuses.data());
+  ASSERT_OK(statuses[0]);
+  ASSERT_EQ(*values[0], "v1");
+  ASSERT_TRUE(values[0]->IsPinned());
+  ASSERT_OK(statuses[1]);
+  ASSERT_EQ(*values[1], "v2");
+  ASSERT_OK(statuses[2]);
+  ASSERT_EQ(*values[2], "v3");
+  ASSERT_TRUE(statuses[3].IsNotFound());
+  ASSERT_EQ(values[3], nullptr);
+
+  // Each handle pins the block on its own
+  ASSERT_GT(table_options.block_cache->GetPinnedUsage(), base_pinned_usage);
+  values[0].reset();
+  ASSERT_GT(table_options.block_cache->GetPinnedUsage(), base_pinned_usage);
+  ASSERT_EQ(*values[1], "v2");
+  values.clear();
+  ASSERT_EQ(table_options.block_cache->GetPinnedUsage(), base_pinned_usage);
+}
+
 TEST_F(DBBasicTest, MultiGetBatchedSimpleUnsorted) {
   do {
     CreateAndReopenWithCF({"pikachu"}, CurrentOptions());
@@ -1618,6 +1697,86 @@ TEST_F(DBBasicTest, MultiGetBatchedMultiLevel) {
   }
 }
 
+TEST_F(DBBasicTest, MultiGetBatchedMultiLevelAsyncIO) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  Reopen(options);
+
+  // A few files on L2 and L1 each, so that the lookups in several files of a
+  // level are batched
+  for (int i = 0; i < 128; ++i) {
+    ASSERT_OK(Put(Key(i), "val_l2_" + std::to_string(i)));
+    if (i % 32 == 31) {
+      ASSERT_OK(Flush());
+    }
+  }
+  MoveFilesToLevel(2);
+  for (int i = 0; i < 128; i += 3) {
+    ASSERT_OK(Put(Key(i), "val_l1_" + std::to_string(i)));
+    if (i % 48 == 45) {
+      ASSERT_OK(Flush());
+    }
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  for (int i = 0; i < 128; i += 5) {
+    ASSERT_OK(Put(Key(i), "val_l0_" + std::to_string(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(Delete(Key(7)));
+
+  std::vector<int> key_ids;
+  std::vector<std::string> key_strs;
+  for (int i = 0; i < 140; i += 2) {
+    key_ids.push_back(i);
+  }
+  key_ids.push_back(7);
+  for (int i : key_ids) {
+    key_strs.push_back(Key(i));
+  }
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+
+  size_t max_async_lookups = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "Version::MultiGet:AsyncLookups", [&](void* arg) {
+        max_async_lookups =
+            std::max(max_async_lookups, *static_cast<size_t*>(arg));
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  for (bool async_io : {false, true}) {
+    ReadOptions ro;
+    ro.async_io = async_io;
+    std::vector<PinnableSlice> values(keys.size());
+    std::vector<Status> statuses(keys.size());
+    db_->MultiGet(ro, dbfull()->DefaultColumnFamily(), keys.size(),
+                  keys.data(), values.data(), statuses.data());
+    for (size_t j = 0; j < keys.size(); ++j) {
+      int key = key_ids[j];
+      if (key >= 128 || key == 7) {
+        ASSERT_TRUE(statuses[j].IsNotFound());
+        continue;
+      }
+      ASSERT_OK(statuses[j]);
+      if (key % 5 == 0) {
+        ASSERT_EQ(values[j], "val_l0_" + std::to_string(key));
+      } else if (key % 3 == 0) {
+        ASSERT_EQ(values[j], "val_l1_" + std::to_string(key));
+      } else {
+        ASSERT_EQ(values[j], "val_l2_" + std::to_string(key));
+      }
+    }
+    if (async_io) {
+      ASSERT_GT(max_async_lookups, 1);
+    } else {
+      ASSERT_EQ(max_async_lookups, 0);
+    }
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBBasicTest, MultiGetBatchedMultiLevelMerge) {
   Options options = CurrentOptions();
   options.disable_auto_compactions = true;
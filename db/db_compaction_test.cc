@@ -3009,6 +3009,45 @@ TEST_P(DBCompactionTestWithParam, DeleteMovedFileAfterCompaction) {
   }
 }
 
+TEST_P(DBCompactionTestWithParam, SubcompactionsOfOverlappingL0Files) {
+  // Overlapping L0 files compacted into an empty L1 are split into
+  // subcompactions at keys sampled from the input files.
+  Options options = CurrentOptions();
+  options.compression = kNoCompression;
+  options.level0_file_num_compaction_trigger = 2;
+  options.target_file_size_base = 256 << 10;
+  options.max_subcompactions = max_subcompactions_;
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 100; ++j) {
+      const std::string value = rnd.RandomString(10 * 1024);
+      ASSERT_OK(Put(Key(i * 50 + j), value));
+      expected[Key(i * 50 + j)] = value;
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  ASSERT_GT(NumTableFilesAtLevel(1), 1);
+
+  HistogramData subcompactions;
+  options.statistics->histogramData(NUM_SUBCOMPACTIONS_SCHEDULED,
+                                    &subcompactions);
+  if (max_subcompactions_ > 1) {
+    ASSERT_EQ(subcompactions.count, 1);
+    ASSERT_EQ(subcompactions.max, max_subcompactions_);
+  } else {
+    ASSERT_EQ(subcompactions.count, 0);
+  }
+  for (const auto& kv : expected) {
+    ASSERT_EQ(kv.second, Get(kv.first));
+  }
+}
+
 TEST_P(DBCompactionTestWithParam, CompressLevelCompaction) {
   if (!Zlib_Supported()) {
     return;
@@ -6924,6 +6963,43 @@ TEST_F(DBCompactionTest,
   ASSERT_TRUE(callback_completed);
 }
 
+TEST_F(DBCompactionTest, SubcompactionsSplitOverlappingFiles) {
+  // Input files that all span the same key range, with an empty output level,
+  // are still split into max_subcompactions subcompactions.
+  const int kNumFiles = 4;
+  for (auto style : {kCompactionStyleLevel, kCompactionStyleUniversal}) {
+    Options options = CurrentOptions();
+    options.compaction_style = style;
+    options.compression = kNoCompression;
+    options.disable_auto_compactions = true;
+    options.max_subcompactions = 4;
+    options.target_file_size_base = 32 << 10;
+    options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+    DestroyAndReopen(options);
+
+    Random rnd(301);
+    for (int file = 0; file < kNumFiles; file++) {
+      for (int i = 0; i < 100; i++) {
+        ASSERT_OK(Put(Key(i * kNumFiles + file), rnd.RandomString(1000)));
+      }
+      ASSERT_OK(Flush());
+    }
+    ASSERT_EQ(ToString(kNumFiles), FilesPerLevel());
+
+    ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+    HistogramData subcompactions;
+    options.statistics->histogramData(NUM_SUBCOMPACTIONS_SCHEDULED,
+                                      &subcompactions);
+    ASSERT_EQ(subcompactions.count, 1);
+    ASSERT_EQ(subcompactions.max, options.max_subcompactions);
+
+    ASSERT_EQ(0, NumTableFilesAtLevel(0));
+    for (int i = 0; i < 100 * kNumFiles; i++) {
+      ASSERT_EQ(1000, Get(Key(i)).size());
+    }
+  }
+}
+
 TEST_F(DBCompactionTest, ChangeLevelConflictsWithManual) {
   Options options = CurrentOptions();
   options.num_levels = 3;
@@ -7059,6 +7135,232 @@ TEST_F(DBCompactionTest, BottomPriCompactionCountsTowardConcurrencyLimit) {
   compact_range_thread.join();
 }
 
+TEST_F(DBCompactionTest, PipelinedCompaction) {
+  Options options = CurrentOptions();
+  options.pipelined_compaction = true;
+  options.disable_auto_compactions = true;
+  options.max_subcompactions = 2;
+  DestroyAndReopen(options);
+
+  int num_pipelined = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::ProcessKeyValueCompaction:Pipelined",
+      [&](void* /*arg*/) { num_pipelined++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Overlapping files that overwrite and delete each other's keys
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 1000; j++) {
+      const std::string key = Key(static_cast<int>(rnd.Uniform(2000)));
+      if (rnd.OneIn(4)) {
+        ASSERT_OK(Delete(key));
+        expected.erase(key);
+      } else {
+        const std::string value = rnd.RandomString(100);
+        ASSERT_OK(Put(key, value));
+        expected[key] = value;
+      }
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel());
+  ASSERT_GT(num_pipelined, 0);
+
+  auto verify = [&]() {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    auto it = expected.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+      ASSERT_TRUE(it != expected.end());
+      ASSERT_EQ(it->first, iter->key().ToString());
+      ASSERT_EQ(it->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(it == expected.end());
+  };
+  verify();
+
+  // Compactions of files with range tombstones read their input on the
+  // compaction thread
+  num_pipelined = 0;
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(100), Key(200)));
+  ASSERT_OK(Flush());
+  expected.erase(expected.lower_bound(Key(100)),
+                 expected.lower_bound(Key(200)));
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(0, num_pipelined);
+  verify();
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(DBCompactionTest, CompactionBlockPassthrough) {
+  Options options = CurrentOptions();
+  options.compaction_block_passthrough = true;
+  options.compression = kNoCompression;
+  options.disable_auto_compactions = true;
+  options.num_levels = 3;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  uint64_t num_copied_blocks = 0;
+  int num_runs = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::CopyRawBlockRun:Copied", [&](void* arg) {
+        num_copied_blocks += *static_cast<uint64_t*>(arg);
+        num_runs++;
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // The bottommost file, whose keys have their sequence numbers zeroed
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < 3000; i++) {
+    const std::string value = rnd.RandomString(100);
+    ASSERT_OK(Put(Key(i), value));
+    expected[Key(i)] = value;
+  }
+  ASSERT_OK(Flush());
+  CompactRangeOptions cro;
+  cro.change_level = true;
+  cro.target_level = 2;
+  cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  ASSERT_EQ("0,0,1", FilesPerLevel());
+
+  // Two files overwriting and deleting keys in the middle of its range
+  for (int start : {1000, 2000}) {
+    for (int i = start; i < start + 200; i++) {
+      if (i % 5 == 0) {
+        ASSERT_OK(Delete(Key(i)));
+        expected.erase(Key(i));
+      } else {
+        const std::string value = rnd.RandomString(100);
+        ASSERT_OK(Put(Key(i), value));
+        expected[Key(i)] = value;
+      }
+    }
+    ASSERT_OK(Flush());
+    MoveFilesToLevel(1);
+  }
+  ASSERT_EQ("0,2,1", FilesPerLevel());
+
+  num_copied_blocks = 0;
+  num_runs = 0;
+  ASSERT_OK(dbfull()->TEST_CompactRange(1, nullptr, nullptr));
+  ASSERT_EQ("0,0,1", FilesPerLevel());
+  // The blocks of the bottommost file before, between and after the other
+  // files are copied.
+  ASSERT_EQ(3, num_runs);
+  ASSERT_GT(num_copied_blocks, uint64_t{100});
+
+  auto verify = [&]() {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    auto it = expected.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+      ASSERT_TRUE(it != expected.end());
+      ASSERT_EQ(it->first, iter->key().ToString());
+      ASSERT_EQ(it->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(it == expected.end());
+    for (int i = 0; i < 3000; i++) {
+      auto found = expected.find(Key(i));
+      ASSERT_EQ(found == expected.end() ? "NOT_FOUND" : found->second,
+                Get(Key(i)));
+    }
+  };
+  verify();
+  Reopen(options);
+  verify();
+
+  // Compactions of files with range tombstones do not copy blocks
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(100), Key(200)));
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  expected.erase(expected.lower_bound(Key(100)),
+                 expected.lower_bound(Key(200)));
+  num_copied_blocks = 0;
+  ASSERT_OK(dbfull()->TEST_CompactRange(1, nullptr, nullptr));
+  ASSERT_EQ(uint64_t{0}, num_copied_blocks);
+  verify();
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(DBCompactionTest, CompactionBlockPassthroughIntoCompressedLevel) {
+  CompressionType compression = kNoCompression;
+  for (CompressionType type : GetSupportedCompressions()) {
+    if (type != kNoCompression) {
+      compression = type;
+      break;
+    }
+  }
+  if (compression == kNoCompression) {
+    ROCKSDB_GTEST_SKIP("Test requires a compression library");
+    return;
+  }
+
+  Options options = CurrentOptions();
+  options.compaction_block_passthrough = true;
+  options.disable_auto_compactions = true;
+  options.num_levels = 3;
+  options.compression_per_level = {kNoCompression, kNoCompression,
+                                   compression};
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  uint64_t num_copied_blocks = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::CopyRawBlockRun:Copied", [&](void* arg) {
+        num_copied_blocks += *static_cast<uint64_t*>(arg);
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // A compressed file in L2 in the middle of the range of an uncompressed
+  // file in L1. The snapshot keeps the sequence numbers of the keys of the L1
+  // file from being zeroed, so that their blocks could be copied as stored.
+  ASSERT_OK(Put(Key(500), "value"));
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(2);
+  ManagedSnapshot snapshot(db_);
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_OK(Put(Key(i), std::string(100, static_cast<char>('a' + i % 26))));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  ASSERT_EQ("0,1,1", FilesPerLevel());
+
+  ASSERT_OK(dbfull()->TEST_CompactRange(1, nullptr, nullptr));
+  ASSERT_EQ("0,0,1", FilesPerLevel());
+  // The uncompressed blocks are compressed instead of copied
+  ASSERT_EQ(uint64_t{0}, num_copied_blocks);
+  TablePropertiesCollection all_props;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&all_props));
+  ASSERT_EQ(1U, all_props.size());
+  const TableProperties& props = *all_props.begin()->second;
+  ASSERT_EQ(CompressionTypeToString(compression), props.compression_name);
+  ASSERT_LT(props.data_size, props.raw_value_size / 2);
+
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ(std::string(100, static_cast<char>('a' + i % 26)), Get(Key(i)));
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 #endif  // !defined(ROCKSDB_LITE)
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -523,6 +523,11 @@ void DBImpl::CancelAllBackgroundWork(bool wait) {
 }
 
 Status DBImpl::CloseHelper() {
+  // Commit the staged writes while the DB is still fully open
+  if (staged_write_queue_ != nullptr) {
+    staged_write_queue_->Stop();
+  }
+
   // Guarantee that there is no background error recovery in progress before
   // continuing with the shutdown
   mutex_.Lock();
@@ -2929,6 +2934,25 @@ bool DBImpl::KeyMayExist(const ReadOptions& read_options,
   return s.ok() || s.IsIncomplete();
 }
 
+namespace {
+// ReadOptions::value_columns needs a splitter to split the values with
+Status ValidateValueColumns(const ReadOptions& read_options,
+                            const ColumnFamilyData* cfd) {
+  if (read_options.value_columns == nullptr) {
+    return Status::OK();
+  }
+  const auto* table_options =
+      cfd->ioptions()->table_factory->GetOptions<BlockBasedTableOptions>();
+  if (table_options == nullptr ||
+      table_options->value_column_splitter == nullptr) {
+    return Status::InvalidArgument(
+        "value_columns requires a block-based table factory with a "
+        "value_column_splitter");
+  }
+  return Status::OK();
+}
+}  // namespace
+
 Iterator* DBImpl::NewIterator(const ReadOptions& read_options,
                               ColumnFamilyHandle* column_family) {
   if (read_options.managed) {
@@ -2959,6 +2983,10 @@ Iterator* DBImpl::NewIterator(const ReadOptions& read_options,
   auto cfh = static_cast_with_check<ColumnFamilyHandleImpl>(column_family);
   ColumnFamilyData* cfd = cfh->cfd();
   assert(cfd != nullptr);
+  Status s = ValidateValueColumns(read_options, cfd);
+  if (!s.ok()) {
+    return NewErrorIterator(s);
+  }
   ReadCallback* read_callback = nullptr;  // No read callback provided.
   if (read_options.tailing) {
 #ifdef ROCKSDB_LITE
@@ -3082,6 +3110,13 @@ Status DBImpl::NewIterators(
     return Status::NotSupported(
         "ReadTier::kPersistedData is not yet supported in iterators.");
   }
+  for (auto cfh : column_families) {
+    auto cfd = static_cast_with_check<ColumnFamilyHandleImpl>(cfh)->cfd();
+    Status s = ValidateValueColumns(read_options, cfd);
+    if (!s.ok()) {
+      return s;
+    }
+  }
   ReadCallback* read_callback = nullptr;  // No read callback provided.
   iterators->clear();
   iterators->reserve(column_families.size());
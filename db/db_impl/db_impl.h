@@ -38,6 +38,7 @@
 #include "db/read_callback.h"
 #include "db/snapshot_checker.h"
 #include "db/snapshot_impl.h"
+#include "db/staged_write_queue.h"
 #include "db/trim_history_scheduler.h"
 #include "db/version_edit.h"
 #include "db/wal_manager.h"
@@ -168,6 +169,9 @@ class DBImpl : public DB {
   using DB::Write;
   virtual Status Write(const WriteOptions& options,
                        WriteBatch* updates) override;
+  virtual Status WriteAsync(
+      const WriteOptions& options, WriteBatch* updates,
+      const std::function<void(const Status&)>& callback) override;
 
   using DB::Get;
   virtual Status Get(const ReadOptions& options,
@@ -2097,6 +2101,10 @@ class DBImpl : public DB {
   // in 2PC to batch the prepares separately from the serial commit.
   WriteThread nonmem_write_thread_;
 
+  // The write path of DBOptions::enable_staged_writes, if set. Started once
+  // the DB is open and stopped on close.
+  std::unique_ptr<StagedWriteQueue> staged_write_queue_;
+
   WriteController write_controller_;
 
   // Size of the last batch group. In slowdown mode, next write needs to
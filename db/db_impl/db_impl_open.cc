@@ -7,6 +7,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include <cinttypes>
+#include <deque>
 
 #include "db/builder.h"
 #include "db/db_impl/db_impl.h"
@@ -803,6 +804,127 @@ Status DBImpl::InitPersistStatsColumnFamily() {
   return s;
 }
 
+namespace {
+// Inserts the write batches read from the WALs into the memtables on a pool
+// of threads, while the thread running RecoverLogFiles() keeps reading the
+// WALs. Batches are inserted with concurrent_memtable_writes, in no
+// particular order; as every entry carries its own sequence number, the
+// memtables end up the same as with serial replay.
+class WalReplayThreadPool {
+ public:
+  WalReplayThreadPool(int num_threads, ColumnFamilySet* column_family_set,
+                      FlushScheduler* flush_scheduler,
+                      TrimHistoryScheduler* trim_history_scheduler, DB* db,
+                      bool batch_per_txn)
+      : column_family_set_(column_family_set),
+        flush_scheduler_(flush_scheduler),
+        trim_history_scheduler_(trim_history_scheduler),
+        db_(db),
+        batch_per_txn_(batch_per_txn),
+        max_queued_batches_(4 * static_cast<size_t>(num_threads)),
+        work_cv_(&mu_),
+        done_cv_(&mu_) {
+    for (int i = 0; i < num_threads; ++i) {
+      threads_.emplace_back([this]() { Work(); });
+    }
+  }
+
+  ~WalReplayThreadPool() {
+    {
+      MutexLock l(&mu_);
+      shutting_down_ = true;
+      work_cv_.SignalAll();
+    }
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  // Queues batch, read from WAL wal_number, for insertion. Blocks while too
+  // many batches are queued. Returns, and resets, the first error
+  // encountered by a previously queued batch, if any.
+  Status Schedule(std::unique_ptr<WriteBatch>&& batch, uint64_t wal_number) {
+    MutexLock l(&mu_);
+    while (queue_.size() >= max_queued_batches_) {
+      done_cv_.Wait();
+    }
+    queue_.emplace_back(std::move(batch), wal_number);
+    ++pending_batches_;
+    work_cv_.Signal();
+    Status s = status_;
+    status_ = Status::OK();
+    return s;
+  }
+
+  // Waits until all the queued batches have been inserted. Returns the first
+  // error encountered by any of them, and resets it.
+  Status WaitForInserts() {
+    MutexLock l(&mu_);
+    while (pending_batches_ > 0) {
+      done_cv_.Wait();
+    }
+    Status s = status_;
+    status_ = Status::OK();
+    return s;
+  }
+
+ private:
+  void Work() {
+    // ColumnFamilyMemTablesImpl caches the last column family looked up, so
+    // every thread needs its own instance.
+    ColumnFamilyMemTablesImpl column_family_memtables(column_family_set_);
+    while (true) {
+      std::pair<std::unique_ptr<WriteBatch>, uint64_t> job;
+      {
+        MutexLock l(&mu_);
+        while (queue_.empty() && !shutting_down_) {
+          work_cv_.Wait();
+        }
+        if (queue_.empty()) {
+          return;
+        }
+        job = std::move(queue_.front());
+        queue_.pop_front();
+        done_cv_.SignalAll();
+      }
+
+      Status s = WriteBatchInternal::InsertInto(
+          job.first.get(), &column_family_memtables, flush_scheduler_,
+          trim_history_scheduler_, true /* ignore_missing_column_families */,
+          job.second, db_, true /* concurrent_memtable_writes */,
+          nullptr /* next_seq */, nullptr /* has_valid_writes */,
+          false /* seq_per_batch */, batch_per_txn_);
+
+      MutexLock l(&mu_);
+      if (!s.ok() && status_.ok()) {
+        status_ = s;
+      }
+      --pending_batches_;
+      done_cv_.SignalAll();
+    }
+  }
+
+  ColumnFamilySet* const column_family_set_;
+  FlushScheduler* const flush_scheduler_;
+  TrimHistoryScheduler* const trim_history_scheduler_;
+  DB* const db_;
+  const bool batch_per_txn_;
+  const size_t max_queued_batches_;
+
+  port::Mutex mu_;
+  // Signaled when a batch is queued, or on shutdown
+  port::CondVar work_cv_;
+  // Signaled when a batch is dequeued, or has been inserted
+  port::CondVar done_cv_;
+  std::deque<std::pair<std::unique_ptr<WriteBatch>, uint64_t>> queue_;
+  // Batches queued or being inserted
+  size_t pending_batches_ = 0;
+  Status status_;
+  bool shutting_down_ = false;
+  std::vector<port::Thread> threads_;
+};
+}  // namespace
+
 // REQUIRES: wal_numbers are sorted in ascending order
 Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
                                SequenceNumber* next_sequence, bool read_only,
@@ -859,11 +981,70 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
   }
 #endif
 
+  std::unique_ptr<WalReplayThreadPool> replay_thread_pool;
+  if (immutable_db_options_.wal_recovery_threads > 1 && !wal_numbers.empty() &&
+      !seq_per_batch_ && !immutable_db_options_.allow_2pc) {
+    bool concurrent_inserts_supported = true;
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (!cfd->ioptions()->memtable_factory->IsInsertConcurrentlySupported() ||
+          cfd->ioptions()->inplace_update_support ||
+          cfd->GetLatestMutableCFOptions()->max_successive_merges > 0) {
+        concurrent_inserts_supported = false;
+        break;
+      }
+    }
+    if (concurrent_inserts_supported) {
+      ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                     "Inserting WAL records into memtables with %d threads",
+                     immutable_db_options_.wal_recovery_threads);
+      replay_thread_pool.reset(new WalReplayThreadPool(
+          immutable_db_options_.wal_recovery_threads,
+          versions_->GetColumnFamilySet(), &flush_scheduler_,
+          &trim_history_scheduler_, this, batch_per_txn_));
+    } else {
+      ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                     "Replaying WALs serially: the memtables of some column "
+                     "families do not support concurrent inserts");
+    }
+  }
+  TEST_SYNC_POINT_CALLBACK("DBImpl::RecoverLogFiles:ReplayThreadPool",
+                           replay_thread_pool.get());
+
   bool stop_replay_by_wal_filter = false;
   bool stop_replay_for_corruption = false;
   bool flushed = false;
   uint64_t corrupted_wal_number = kMaxSequenceNumber;
   uint64_t min_wal_number = MinLogNumberToKeep();
+
+  // Flushes the memtables that have been scheduled for flush by the inserts
+  // of the WAL records, and replaces them with new memtables.
+  auto flush_scheduled_memtables = [&](uint64_t wal_number) -> Status {
+    // we can do this because this is called before client has access to the
+    // DB and there is only a single thread operating on DB
+    ColumnFamilyData* cfd;
+
+    while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
+      cfd->UnrefAndTryDelete();
+      // If this asserts, it means that InsertInto failed in
+      // filtering updates to already-flushed column families
+      assert(cfd->GetLogNumber() <= wal_number);
+      auto iter = version_edits.find(cfd->GetID());
+      assert(iter != version_edits.end());
+      VersionEdit* edit = &iter->second;
+      Status s = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
+      if (!s.ok()) {
+        // Reflect errors immediately so that conditions like full
+        // file-systems cause the DB::Open() to fail.
+        return s;
+      }
+      flushed = true;
+
+      cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
+                             *next_sequence);
+    }
+    return Status::OK();
+  };
+
   for (auto wal_number : wal_numbers) {
     if (wal_number < min_wal_number) {
       ROCKS_LOG_INFO(immutable_db_options_.info_log,
@@ -1059,12 +1240,36 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
       // we just ignore the update.
       // That's why we set ignore missing column families to true
       bool has_valid_writes = false;
-      status = WriteBatchInternal::InsertInto(
-          &batch, column_family_memtables_.get(), &flush_scheduler_,
-          &trim_history_scheduler_, true, wal_number, this,
-          false /* concurrent_memtable_writes */, next_sequence,
-          &has_valid_writes, seq_per_batch_, batch_per_txn_);
-      MaybeIgnoreError(&status);
+      if (replay_thread_pool != nullptr) {
+        // Every entry of the batch consumes a sequence number, whether it is
+        // inserted or not (seq_per_batch is not used here)
+        *next_sequence = sequence + WriteBatchInternal::Count(&batch);
+        status = replay_thread_pool->Schedule(
+            std::unique_ptr<WriteBatch>(new WriteBatch(std::move(batch))),
+            wal_number);
+        if (status.ok() && !read_only && !flush_scheduler_.Empty()) {
+          // A memtable is full. It can only be flushed once all the batches
+          // queued so far have been inserted.
+          status = replay_thread_pool->WaitForInserts();
+          has_valid_writes = true;
+        }
+        if (!status.ok()) {
+          MaybeIgnoreError(&status);
+          if (!status.ok() && immutable_db_options_.wal_recovery_mode ==
+                                  WALRecoveryMode::kPointInTimeRecovery) {
+            // Later batches may have been inserted already, so recovery
+            // cannot stop right before the failed batch
+            return status;
+          }
+        }
+      } else {
+        status = WriteBatchInternal::InsertInto(
+            &batch, column_family_memtables_.get(), &flush_scheduler_,
+            &trim_history_scheduler_, true, wal_number, this,
+            false /* concurrent_memtable_writes */, next_sequence,
+            &has_valid_writes, seq_per_batch_, batch_per_txn_);
+        MaybeIgnoreError(&status);
+      }
       if (!status.ok()) {
         // We are treating this as a failure while reading since we read valid
         // blocks that do not form coherent data
@@ -1073,28 +1278,33 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
       }
 
       if (has_valid_writes && !read_only) {
-        // we can do this because this is called before client has access to the
-        // DB and there is only a single thread operating on DB
-        ColumnFamilyData* cfd;
-
-        while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
-          cfd->UnrefAndTryDelete();
-          // If this asserts, it means that InsertInto failed in
-          // filtering updates to already-flushed column families
-          assert(cfd->GetLogNumber() <= wal_number);
-          auto iter = version_edits.find(cfd->GetID());
-          assert(iter != version_edits.end());
-          VersionEdit* edit = &iter->second;
-          status = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
-          if (!status.ok()) {
-            // Reflect errors immediately so that conditions like full
-            // file-systems cause the DB::Open() to fail.
-            return status;
-          }
-          flushed = true;
+        status = flush_scheduled_memtables(wal_number);
+        if (!status.ok()) {
+          return status;
+        }
+      }
+    }
 
-          cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
-                                 *next_sequence);
+    if (replay_thread_pool != nullptr) {
+      // All the batches read from the WAL need to be in the memtables before
+      // moving on
+      Status insert_status = replay_thread_pool->WaitForInserts();
+      MaybeIgnoreError(&insert_status);
+      if (!insert_status.ok()) {
+        if (immutable_db_options_.wal_recovery_mode ==
+            WALRecoveryMode::kPointInTimeRecovery) {
+          return insert_status;
+        }
+        ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                       "%s: failed to insert a record into memtables; %s",
+                       fname.c_str(), insert_status.ToString().c_str());
+        if (status.ok()) {
+          status = insert_status;
+        }
+      } else if (!read_only) {
+        insert_status = flush_scheduled_memtables(wal_number);
+        if (!insert_status.ok()) {
+          return insert_status;
         }
       }
     }
@@ -1880,6 +2090,17 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
   }
   if (s.ok()) {
     impl->StartPeriodicWorkScheduler();
+    if (impl->immutable_db_options_.enable_staged_writes &&
+        !impl->seq_per_batch_ && !impl->two_write_queues_) {
+      DBImpl* db = impl;
+      impl->staged_write_queue_.reset(new StagedWriteQueue(
+          [db](const WriteOptions& write_options, WriteBatch* batch) {
+            return db->WriteImpl(write_options, batch, nullptr, nullptr);
+          },
+          impl->immutable_db_options_.enable_write_thread_adaptive_yield
+              ? impl->immutable_db_options_.write_thread_max_yield_usec
+              : 0));
+    }
   } else {
     for (auto* h : *handles) {
       delete h;
@@ -788,8 +788,10 @@ Status DB::OpenAndCompact(
       override_options.compaction_filter_factory;
   compaction_input.column_family.options.prefix_extractor =
       override_options.prefix_extractor;
-  compaction_input.column_family.options.table_factory =
-      override_options.table_factory;
+  if (override_options.table_factory) {
+    compaction_input.column_family.options.table_factory =
+        override_options.table_factory;
+  }
   compaction_input.column_family.options.sst_partitioner_factory =
       override_options.sst_partitioner_factory;
 
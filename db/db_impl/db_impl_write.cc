@@ -51,9 +51,30 @@ void DBImpl::SetRecoverableStatePreReleaseCallback(
 }
 
 Status DBImpl::Write(const WriteOptions& write_options, WriteBatch* my_batch) {
+  Status s;
+  if (staged_write_queue_ != nullptr && my_batch != nullptr &&
+      StagedWriteQueue::CanStage(write_options) &&
+      staged_write_queue_->Write(write_options, my_batch, &s)) {
+    return s;
+  }
   return WriteImpl(write_options, my_batch, nullptr, nullptr);
 }
 
+Status DBImpl::WriteAsync(const WriteOptions& write_options,
+                          WriteBatch* my_batch,
+                          const std::function<void(const Status&)>& callback) {
+  if (!callback) {
+    return Status::InvalidArgument("WriteAsync() needs a callback");
+  }
+  if (staged_write_queue_ != nullptr && my_batch != nullptr &&
+      StagedWriteQueue::CanStage(write_options) &&
+      staged_write_queue_->WriteAsync(write_options, my_batch, callback)) {
+    return Status::OK();
+  }
+  callback(WriteImpl(write_options, my_batch, nullptr, nullptr));
+  return Status::OK();
+}
+
 #ifndef ROCKSDB_LITE
 Status DBImpl::WriteWithCallback(const WriteOptions& write_options,
                                  WriteBatch* my_batch,
@@ -26,6 +26,7 @@
 #include "rocksdb/merge_operator.h"
 #include "rocksdb/options.h"
 #include "rocksdb/system_clock.h"
+#include "rocksdb/table.h"
 #include "table/internal_iterator.h"
 #include "table/iterator_wrapper.h"
 #include "trace_replay/trace_replay.h"
@@ -81,7 +82,9 @@ DBIter::DBIter(Env* _env, const ReadOptions& read_options,
       start_seqnum_(read_options.iter_start_seqnum),
       timestamp_ub_(read_options.timestamp),
       timestamp_lb_(read_options.iter_start_ts),
-      timestamp_size_(timestamp_ub_ ? timestamp_ub_->size() : 0) {
+      timestamp_size_(timestamp_ub_ ? timestamp_ub_->size() : 0),
+      value_columns_(read_options.value_columns),
+      value_column_splitter_(nullptr) {
   RecordTick(statistics_, NO_ITERATOR_CREATED);
   if (pin_thru_lifetime_) {
     pinned_iters_mgr_.StartPinning();
@@ -90,6 +93,40 @@ DBIter::DBIter(Env* _env, const ReadOptions& read_options,
     iter_.iter()->SetPinnedItersMgr(&pinned_iters_mgr_);
   }
   assert(timestamp_size_ == user_comparator_.timestamp_size());
+  if (value_columns_ != nullptr && ioptions.table_factory != nullptr) {
+    const auto* table_options =
+        ioptions.table_factory->GetOptions<BlockBasedTableOptions>();
+    if (table_options != nullptr) {
+      value_column_splitter_ = table_options->value_column_splitter.get();
+    }
+  }
+}
+
+Slice DBIter::ProjectValue() const {
+  assert(value_columns_ != nullptr);
+  if (expose_blob_index_ && is_blob_) {
+    // Blob indexes are not split
+    return UnprojectedValue();
+  }
+  projected_value_.clear();
+  if (!is_blob_ && !current_entry_is_merged_ && direction_ == kForward &&
+      iter_.ProjectValue(*value_columns_, &projected_value_)) {
+    // Read from value columns, without assembling the other columns
+    return projected_value_;
+  }
+  Slice value = UnprojectedValue();
+  split_buffer_.clear();
+  if (value_column_splitter_ == nullptr ||
+      !value_column_splitter_->Split(value, &split_buffer_).ok()) {
+    return value;
+  }
+  for (uint32_t column : *value_columns_) {
+    if (column < split_buffer_.size()) {
+      projected_value_.append(split_buffer_[column].data(),
+                              split_buffer_[column].size());
+    }
+  }
+  return projected_value_;
 }
 
 Status DBIter::GetProperty(std::string prop_name, std::string* prop) {
@@ -10,6 +10,7 @@
 #pragma once
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "db/db_impl/db_impl.h"
 #include "db/range_del_aggregator.h"
@@ -22,6 +23,7 @@
 
 namespace ROCKSDB_NAMESPACE {
 class Version;
+class ValueColumnSplitter;
 
 // This file declares the factory functions of DBIter, in its original form
 // or a wrapped form with class ArenaWrappedDBIter, which is defined here.
@@ -161,17 +163,10 @@ class DBIter final : public Iterator {
   Slice value() const override {
     assert(valid_);
 
-    if (!expose_blob_index_ && is_blob_) {
-      return blob_value_;
-    } else if (current_entry_is_merged_) {
-      // If pinned_value_ is set then the result of merge operator is one of
-      // the merge operands and we should return it.
-      return pinned_value_.data() ? pinned_value_ : saved_value_;
-    } else if (direction_ == kReverse) {
-      return pinned_value_;
-    } else {
-      return iter_.value();
+    if (value_columns_ != nullptr) {
+      return ProjectValue();
     }
+    return UnprojectedValue();
   }
   Status status() const override {
     if (status_.ok()) {
@@ -248,6 +243,23 @@ class DBIter final : public Iterator {
   bool IsVisible(SequenceNumber sequence, const Slice& ts,
                  bool* more_recent = nullptr);
 
+  // The value of the current entry, before projecting value_columns_
+  Slice UnprojectedValue() const {
+    if (!expose_blob_index_ && is_blob_) {
+      return blob_value_;
+    } else if (current_entry_is_merged_) {
+      // If pinned_value_ is set then the result of merge operator is one of
+      // the merge operands and we should return it.
+      return pinned_value_.data() ? pinned_value_ : saved_value_;
+    } else if (direction_ == kReverse) {
+      return pinned_value_;
+    } else {
+      return iter_.value();
+    }
+  }
+  // The columns value_columns_ of the current value
+  Slice ProjectValue() const;
+
   // Temporarily pin the blocks that we encounter until ReleaseTempPinnedData()
   // is called
   void TempPinData() {
@@ -378,6 +390,12 @@ class DBIter final : public Iterator {
   const Slice* const timestamp_lb_;
   const size_t timestamp_size_;
   std::string saved_timestamp_;
+  // See ReadOptions::value_columns
+  const std::vector<uint32_t>* const value_columns_;
+  const ValueColumnSplitter* value_column_splitter_;
+  // Buffers for the projected value, and for the columns of a split value
+  mutable std::string projected_value_;
+  mutable std::vector<Slice> split_buffer_;
 };
 
 // Return a new iterator that converts internal keys (yielded by
@@ -3053,6 +3053,151 @@ TEST_P(DBIteratorTest, Blob) {
   ASSERT_EQ(IterStatus(iter), "b->vb3");
 }
 
+// Splits values after each ','
+class CommaSplitter : public ValueColumnSplitter {
+ public:
+  const char* Name() const override { return "CommaSplitter"; }
+  Status Split(const Slice& value,
+               std::vector<Slice>* columns) const override {
+    size_t start = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+      if (value[i] == ',') {
+        columns->emplace_back(value.data() + start, i + 1 - start);
+        start = i + 1;
+      }
+    }
+    if (start < value.size()) {
+      columns->emplace_back(value.data() + start, value.size() - start);
+    }
+    return Status::OK();
+  }
+};
+
+TEST_P(DBIteratorTest, ValueColumns) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator(',');
+  BlockBasedTableOptions table_options;
+  table_options.format_version = 6;
+  table_options.block_size = 256;
+  table_options.value_column_splitter = std::make_shared<CommaSplitter>();
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // Rows of an SST file, overwritten or merged in part by the memtable
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < 100; ++i) {
+    std::string value = "a" + ToString(i) + ",b" + ToString(i) + ",c";
+    ASSERT_OK(Put(Key(i), value));
+    expected[Key(i)] = value;
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 100; i += 3) {
+    ASSERT_OK(Put(Key(i), "x,y"));
+    expected[Key(i)] = "x,y";
+  }
+  ASSERT_OK(Merge(Key(10), "m"));
+  expected[Key(10)] += ",m";
+
+  auto project = [](const std::string& value,
+                    const std::vector<uint32_t>& columns) {
+    std::vector<Slice> split;
+    EXPECT_OK(CommaSplitter().Split(value, &split));
+    std::string projected;
+    for (uint32_t column : columns) {
+      if (column < split.size()) {
+        projected += split[column].ToString();
+      }
+    }
+    return projected;
+  };
+
+  for (bool pin_data : {false, true}) {
+    std::vector<uint32_t> columns = {3, 1};
+    ReadOptions ro;
+    ro.pin_data = pin_data;
+    ro.value_columns = &columns;
+    std::unique_ptr<Iterator> iter(NewIterator(ro));
+    auto it = expected.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+      ASSERT_EQ(iter->key().ToString(), it->first);
+      ASSERT_EQ(iter->value().ToString(), project(it->second, columns));
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(it == expected.end());
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+      --it;
+      ASSERT_EQ(iter->key().ToString(), it->first);
+      ASSERT_EQ(iter->value().ToString(), project(it->second, columns));
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(it == expected.begin());
+  }
+
+  // Whole values are still returned without a projection
+  std::unique_ptr<Iterator> iter(NewIterator(ReadOptions()));
+  auto it = expected.begin();
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+    ASSERT_EQ(iter->value().ToString(), it->second);
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(Get(Key(1)), expected[Key(1)]);
+  iter.reset();
+
+  // A projection requires a splitter
+  table_options.value_column_splitter = nullptr;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  std::vector<uint32_t> columns = {0};
+  ReadOptions ro;
+  ro.value_columns = &columns;
+  iter.reset(db_->NewIterator(ro));
+  ASSERT_TRUE(iter->status().IsInvalidArgument());
+}
+
+TEST_P(DBIteratorTest, ValueColumnsPinData) {
+  Options options = CurrentOptions();
+  BlockBasedTableOptions table_options;
+  table_options.format_version = 6;
+  table_options.block_size = 256;
+  table_options.value_column_splitter = std::make_shared<CommaSplitter>();
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  const int kNumKeys = 100;
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(Put(Key(i), "a" + ToString(i) + ",b" + ToString(i) + ",c"));
+  }
+  ASSERT_OK(Flush());
+
+  std::atomic<int> num_copies{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTableIterator::PinAssembledValue",
+      [&](void* /*arg*/) { num_copies++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Values assembled from columns are copied to be pinned, but only once
+  // however often the same entry is read
+  ReadOptions ro;
+  ro.pin_data = true;
+  std::unique_ptr<Iterator> iter(NewIterator(ro));
+  int i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++i) {
+    std::string expected = "a" + ToString(i) + ",b" + ToString(i) + ",c";
+    Slice value = iter->value();
+    ASSERT_EQ(value.ToString(), expected);
+    for (int j = 0; j < 3; ++j) {
+      ASSERT_EQ(iter->value().data(), value.data());
+      ASSERT_EQ(iter->value().ToString(), expected);
+    }
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(i, kNumKeys);
+  ASSERT_EQ(num_copies.load(), kNumKeys);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 INSTANTIATE_TEST_CASE_P(DBIteratorTestInstance, DBIteratorTest,
                         testing::Values(true, false));
 
@@ -276,6 +276,95 @@ TEST_F(DBMemTableTest, ConcurrentMergeWrite) {
   delete mem;
 }
 
+#ifndef ROCKSDB_LITE
+// Concurrent inserts into the prefix hash memtables, with few enough prefixes
+// that the hash linked list buckets are converted to skip lists while the
+// writers race with each other.
+TEST_F(DBMemTableTest, ConcurrentWriteHashMemTables) {
+  const int kNumThreads = 4;
+  const int kKeysPerThread = 500;
+  std::vector<std::shared_ptr<MemTableRepFactory>> factories = {
+      std::shared_ptr<MemTableRepFactory>(NewHashSkipListRepFactory(16)),
+      std::shared_ptr<MemTableRepFactory>(NewHashLinkListRepFactory(
+          16, 0 /* huge_page_tlb_size */,
+          4096 /* bucket_entries_logging_threshold */,
+          false /* if_log_bucket_dist_when_flash */,
+          3 /* threshold_use_skiplist */))};
+
+  for (auto& factory : factories) {
+    ASSERT_TRUE(factory->IsInsertConcurrentlySupported());
+
+    Options options;
+    options.memtable_factory = factory;
+    options.prefix_extractor.reset(NewFixedPrefixTransform(3));
+    options.allow_concurrent_memtable_write = true;
+    InternalKeyComparator cmp(BytewiseComparator());
+    ImmutableOptions ioptions(options);
+    WriteBufferManager wb(options.db_write_buffer_size);
+    MemTable* mem = new MemTable(cmp, ioptions, MutableCFOptions(options), &wb,
+                                 kMaxSequenceNumber, 0 /* column_family_id */);
+
+    auto key_of = [](int thread, int i) {
+      char buf[32];
+      snprintf(buf, sizeof(buf), "p%02d%04d", (thread + i) % 8, i * 10 + thread);
+      return std::string(buf);
+    };
+
+    std::vector<port::Thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.emplace_back([&, t]() {
+        MemTablePostProcessInfo post_process_info;
+        for (int i = 0; i < kKeysPerThread; ++i) {
+          SequenceNumber seq = t * kKeysPerThread + i + 1;
+          ASSERT_OK(mem->Add(seq, kTypeValue, key_of(t, i), key_of(t, i),
+                             nullptr /* kv_prot_info */,
+                             true /* allow_concurrent */, &post_process_info));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    // Serial inserts after concurrent ones are allowed as well
+    ASSERT_OK(mem->Add(kNumThreads * kKeysPerThread + 1, kTypeValue,
+                       key_of(kNumThreads, 0), "serial",
+                       nullptr /* kv_prot_info */));
+
+    ReadOptions roptions;
+    for (int t = 0; t <= kNumThreads; ++t) {
+      for (int i = 0; i < (t < kNumThreads ? kKeysPerThread : 1); ++i) {
+        std::string value;
+        Status status;
+        MergeContext merge_context;
+        SequenceNumber max_covering_tombstone_seq = 0;
+        LookupKey lkey(key_of(t, i), kMaxSequenceNumber);
+        ASSERT_TRUE(mem->Get(lkey, &value, /*timestamp=*/nullptr, &status,
+                             &merge_context, &max_covering_tombstone_seq,
+                             roptions));
+        ASSERT_OK(status);
+        ASSERT_EQ(t < kNumThreads ? key_of(t, i) : "serial", value);
+      }
+    }
+
+    roptions.total_order_seek = true;
+    Arena arena;
+    ScopedArenaIterator iter(mem->NewIterator(roptions, &arena));
+    int count = 0;
+    std::string prev_key;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      std::string key = ExtractUserKey(iter->key()).ToString();
+      ASSERT_LT(prev_key, key);
+      prev_key = key;
+      ++count;
+    }
+    ASSERT_EQ(kNumThreads * kKeysPerThread + 1, count);
+    iter.set(nullptr);
+
+    delete mem;
+  }
+}
+#endif  // ROCKSDB_LITE
+
 TEST_F(DBMemTableTest, InsertWithHint) {
   Options options;
   options.allow_concurrent_memtable_write = false;
@@ -18,6 +18,7 @@
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/iostats_context.h"
+#include "rocksdb/key_hotness_tracker.h"
 #include "rocksdb/persistent_cache.h"
 #include "rocksdb/trace_record.h"
 #include "rocksdb/trace_record_result.h"
@@ -6734,6 +6735,64 @@ TEST_F(DBTest2, BottommostTemperatureUniversal) {
       &prop));
   ASSERT_EQ(std::atoi(prop.c_str()), 0);
 }
+
+TEST_F(DBTest2, ColdKeyTemperature) {
+  Options options = CurrentOptions();
+  KeyHotnessTrackerOptions tracker_options;
+  tracker_options.range_prefix_length = 1;
+  options.key_hotness_tracker = NewKeyHotnessTracker(tracker_options);
+  options.cold_key_temperature = Temperature::kWarm;
+  options.disable_auto_compactions = true;
+  Reopen(options);
+
+  for (char range : {'a', 'b', 'c'}) {
+    for (int i = 0; i < 10; i++) {
+      ASSERT_OK(Put(std::string(1, range) + ToString(i), "value"));
+    }
+  }
+  ASSERT_OK(Flush());
+
+  CompactRangeOptions cro;
+  cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
+  auto get_temperatures = [&]() {
+    std::vector<Temperature> temperatures;
+    ColumnFamilyMetaData metadata;
+    db_->GetColumnFamilyMetaData(&metadata);
+    for (const auto& level : metadata.levels) {
+      for (const auto& file : level.files) {
+        temperatures.push_back(file.temperature);
+      }
+    }
+    return temperatures;
+  };
+
+  // No key was read, so they are all cold
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  ASSERT_EQ(std::vector<Temperature>({Temperature::kWarm}),
+            get_temperatures());
+
+  // Reading a key makes its range hot, and the hot range is cut out to a
+  // file of its own.
+  ASSERT_EQ("value", Get("b5"));
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  ASSERT_EQ(std::vector<Temperature>({Temperature::kWarm, Temperature::kUnknown,
+                                      Temperature::kWarm}),
+            get_temperatures());
+
+  // Iterators make the ranges of the blocks they read hot too
+  {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    iter->Seek("c");
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("c0", iter->key());
+  }
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  ASSERT_EQ(
+      std::vector<Temperature>({Temperature::kWarm, Temperature::kUnknown}),
+      get_temperatures());
+  ASSERT_EQ("value", Get("a0"));
+  ASSERT_EQ("value", Get("c9"));
+}
 #endif  // ROCKSDB_LITE
 
 // WAL recovery mode is WALRecoveryMode::kPointInTimeRecovery.
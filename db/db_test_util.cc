@@ -169,6 +169,11 @@ bool DBTestBase::ShouldSkipOptions(int option_config, int skip_mask) {
     if ((skip_mask & kSkipMmapReads) && option_config == kWalDirAndMmapReads) {
       return true;
     }
+    // Staged writes bypass the write thread, which tests iterating over
+    // option configs hook with sync points. DBWriteTest covers them.
+    if (option_config == kStagedWrite) {
+      return true;
+    }
     return false;
 }
 
@@ -565,6 +570,10 @@ Options DBTestBase::GetOptions(
       options.unordered_write = false;
       break;
     }
+    case kStagedWrite: {
+      options.enable_staged_writes = true;
+      break;
+    }
 
     default:
       break;
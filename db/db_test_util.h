@@ -871,6 +871,7 @@ class DBTestBase : public testing::Test {
     kPartitionedFilterWithNewTableReaderForCompactions,
     kUniversalSubcompactions,
     kUnorderedWrite,
+    kStagedWrite,
     // This must be the last line
     kEnd,
   };
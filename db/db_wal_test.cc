@@ -1045,6 +1045,106 @@ TEST_F(DBWALTest, RecoverWithLargeLog) {
   } while (ChangeWalOptions());
 }
 
+TEST_F(DBWALTest, ParallelRecovery) {
+  Options options = CurrentOptions();
+  options.write_buffer_size = 4 << 20;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  CreateAndReopenWithCF({"pikachu", "eevee"}, options);
+
+  // Overwrite, merge into and delete a small set of keys many times, so that
+  // the result depends on the order of the writes to each key
+  std::vector<std::map<std::string, std::string>> expected(3);
+  Random rnd(301);
+  for (int i = 0; i < 3000; ++i) {
+    WriteBatch batch;
+    for (int j = 0; j < 4; ++j) {
+      const int cf = rnd.Uniform(3);
+      const std::string key = Key(rnd.Uniform(200));
+      const std::string value = rnd.RandomString(rnd.Uniform(100) + 1);
+      switch (rnd.Uniform(4)) {
+        case 0:
+        case 1:
+          ASSERT_OK(batch.Put(handles_[cf], key, value));
+          expected[cf][key] = value;
+          break;
+        case 2: {
+          ASSERT_OK(batch.Merge(handles_[cf], key, value));
+          auto iter = expected[cf].find(key);
+          if (iter == expected[cf].end()) {
+            expected[cf][key] = value;
+          } else {
+            iter->second += "," + value;
+          }
+          break;
+        }
+        default:
+          ASSERT_OK(batch.Delete(handles_[cf], key));
+          expected[cf].erase(key);
+          break;
+      }
+    }
+    ASSERT_OK(db_->Write(WriteOptions(), &batch));
+    if (i == 1000) {
+      // Move on to a new WAL
+      ASSERT_OK(Flush(2));
+    }
+  }
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), handles_[1], Key(50), Key(100)));
+  expected[1].erase(expected[1].lower_bound(Key(50)),
+                    expected[1].lower_bound(Key(100)));
+
+  bool parallel_replay = false;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::RecoverLogFiles:ReplayThreadPool",
+      [&](void* arg) { parallel_replay = arg != nullptr; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  auto verify = [&]() {
+    for (int cf = 0; cf < 3; ++cf) {
+      std::unique_ptr<Iterator> iter(
+          db_->NewIterator(ReadOptions(), handles_[cf]));
+      auto expected_iter = expected[cf].begin();
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        ASSERT_TRUE(expected_iter != expected[cf].end());
+        ASSERT_EQ(expected_iter->first, iter->key().ToString());
+        ASSERT_EQ(expected_iter->second, iter->value().ToString());
+        ++expected_iter;
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_TRUE(expected_iter == expected[cf].end());
+    }
+  };
+
+  // Memtables fill up during recovery and are flushed in between
+  options.write_buffer_size = 64 << 10;
+  options.disable_auto_compactions = true;
+  options.wal_recovery_threads = 4;
+  ReopenWithColumnFamilies({"default", "pikachu", "eevee"}, options);
+  ASSERT_TRUE(parallel_replay);
+  ASSERT_GT(NumTableFilesAtLevel(0, 0), 0);
+  verify();
+
+  // The WALs of the previous open were flushed; write them again
+  Close();
+  DestroyAndReopen(options);
+  CreateAndReopenWithCF({"pikachu", "eevee"}, options);
+  for (int cf = 0; cf < 3; ++cf) {
+    for (const auto& kv : expected[cf]) {
+      ASSERT_OK(Put(cf, kv.first, kv.second));
+    }
+  }
+
+  // Memtables that do not support concurrent inserts are replayed serially
+  options.memtable_factory.reset(new VectorRepFactory());
+  options.allow_concurrent_memtable_write = false;
+  ReopenWithColumnFamilies({"default", "pikachu", "eevee"}, options);
+  ASSERT_FALSE(parallel_replay);
+  verify();
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 // In https://reviews.facebook.net/D20661 we change
 // recovery behavior: previously for each log file each column family
 // memtable was flushed, even it was empty. Now it's changed:
@@ -163,6 +163,10 @@ TEST_P(DBWriteTest, WriteStallRemoveNoSlowdownWrite) {
 }
 
 TEST_P(DBWriteTest, WriteThreadHangOnWriteStall) {
+  if (GetParam() == kStagedWrite) {
+    ROCKSDB_GTEST_BYPASS("Staged writes do not join the write thread");
+    return;
+  }
   Options options = GetOptions();
   options.level0_stop_writes_trigger = options.level0_slowdown_writes_trigger = 4;
   std::vector<port::Thread> threads;
@@ -260,6 +264,10 @@ TEST_P(DBWriteTest, WriteThreadHangOnWriteStall) {
 }
 
 TEST_P(DBWriteTest, IOErrorOnWALWritePropagateToWriteThreadFollower) {
+  if (GetParam() == kStagedWrite) {
+    ROCKSDB_GTEST_BYPASS("Staged writes do not join the write thread");
+    return;
+  }
   constexpr int kNumThreads = 5;
   std::unique_ptr<FaultInjectionTestEnv> mock_env(
       new FaultInjectionTestEnv(env_));
@@ -451,10 +459,137 @@ TEST_P(DBWriteTest, ConcurrentlyDisabledWAL) {
     ASSERT_LE(bytes_num, 1024 * 100);
 }
 
+TEST_P(DBWriteTest, StagedWritesCommitTogether) {
+  if (GetParam() != kStagedWrite) {
+    ROCKSDB_GTEST_BYPASS("Only for staged writes");
+    return;
+  }
+  constexpr int kNumThreads = 4;
+  Options options = GetOptions();
+  options.avoid_flush_during_shutdown = true;
+  Reopen(options);
+
+  // Hold the first commit until all writers are staged, so that the others
+  // are committed together
+  std::atomic<int> num_staged{0};
+  std::atomic<size_t> max_commit_writers{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "StagedWriteQueue::Write:Staged", [&](void*) { num_staged++; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "StagedWriteQueue::Commit", [&](void* arg) {
+        size_t num_writers = *static_cast<size_t*>(arg);
+        if (num_writers > max_commit_writers.load()) {
+          max_commit_writers.store(num_writers);
+        }
+      });
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"DBWriteTest::StagedWritesCommitTogether:AllStaged",
+        "StagedWriteQueue::Commit"}});
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  std::vector<port::Thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&, i] {
+      WriteOptions write_options;
+      write_options.sync = i == 0;
+      ASSERT_OK(dbfull()->Put(write_options, Key(i), "v" + ToString(i)));
+    });
+  }
+  while (num_staged.load() < kNumThreads) {
+    std::this_thread::yield();
+  }
+  TEST_SYNC_POINT("DBWriteTest::StagedWritesCommitTogether:AllStaged");
+  for (auto& t : threads) {
+    t.join();
+  }
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_GE(max_commit_writers.load(), 2);
+
+  // Writes that cannot be staged go through the write thread
+  WriteOptions no_wal;
+  no_wal.disableWAL = true;
+  ASSERT_OK(dbfull()->Put(no_wal, "no_wal", "v"));
+  ASSERT_EQ("v", Get("no_wal"));
+
+  // The staged writes were logged, unlike the other write
+  Reopen(options);
+  for (int i = 0; i < kNumThreads; i++) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+  ASSERT_EQ("NOT_FOUND", Get("no_wal"));
+}
+
+TEST_P(DBWriteTest, WriteAsync) {
+  constexpr int kNumWrites = 10;
+  Options options = GetOptions();
+  options.statistics = CreateDBStatistics();
+  Reopen(options);
+  const bool staged = options.enable_staged_writes;
+
+  port::Mutex mutex;
+  port::CondVar cv(&mutex);
+  // Protected by mutex
+  int num_done = 0;
+  std::vector<WriteBatch> batches(kNumWrites);
+  if (staged) {
+    // Hold the commits until all writes are submitted, which must not wait
+    SyncPoint::GetInstance()->LoadDependency(
+        {{"DBWriteTest::WriteAsync:Submitted", "StagedWriteQueue::Commit"}});
+    SyncPoint::GetInstance()->EnableProcessing();
+  }
+  const uint64_t num_syncs =
+      options.statistics->getTickerCount(WAL_FILE_SYNCED);
+  WriteOptions write_options;
+  write_options.sync = true;
+  for (int i = 0; i < kNumWrites; i++) {
+    ASSERT_OK(batches[i].Put(Key(i), "v" + ToString(i)));
+    ASSERT_OK(db_->WriteAsync(write_options, &batches[i],
+                              [&, i](const Status& s) {
+                                ASSERT_OK(s);
+                                if (i == kNumWrites - 1) {
+                                  // Writes from a callback do not wait for
+                                  // the committer
+                                  ASSERT_OK(Put("from_callback", "v"));
+                                }
+                                MutexLock l(&mutex);
+                                num_done++;
+                                cv.SignalAll();
+                              }));
+  }
+  {
+    MutexLock l(&mutex);
+    ASSERT_EQ(num_done, staged ? 0 : kNumWrites);
+  }
+  TEST_SYNC_POINT("DBWriteTest::WriteAsync:Submitted");
+  {
+    MutexLock l(&mutex);
+    while (num_done < kNumWrites) {
+      cv.Wait();
+    }
+  }
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  for (int i = 0; i < kNumWrites; i++) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+  ASSERT_EQ("v", Get("from_callback"));
+  if (staged) {
+    // The first write, and then all the others together
+    ASSERT_LE(options.statistics->getTickerCount(WAL_FILE_SYNCED),
+              num_syncs + 2);
+  }
+
+  ASSERT_TRUE(db_->WriteAsync(write_options, &batches[0], nullptr)
+                  .IsInvalidArgument());
+}
+
 INSTANTIATE_TEST_CASE_P(DBWriteTestInstance, DBWriteTest,
                         testing::Values(DBTestBase::kDefault,
                                         DBTestBase::kConcurrentWALWrites,
-                                        DBTestBase::kPipelinedWrite));
+                                        DBTestBase::kPipelinedWrite,
+                                        DBTestBase::kStagedWrite));
 
 }  // namespace ROCKSDB_NAMESPACE
 
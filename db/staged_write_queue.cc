@@ -0,0 +1,241 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/staged_write_queue.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "db/write_batch_internal.h"
+#include "test_util/sync_point.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+StagedWriteQueue::StagedWriteQueue(CommitFunction commit,
+                                   uint64_t max_yield_usec)
+    : commit_(std::move(commit)),
+      max_yield_usec_(max_yield_usec),
+      closed_(nullptr, false),
+      committer_cv_(&mutex_),
+      writers_cv_(&mutex_),
+      committer_([this] { CommitterLoop(); }) {
+  committer_id_ = committer_.get_id();
+}
+
+StagedWriteQueue::~StagedWriteQueue() { Stop(); }
+
+bool StagedWriteQueue::CanStage(const WriteOptions& write_options) {
+  return !write_options.disableWAL &&
+         !write_options.ignore_missing_column_families &&
+         !write_options.no_slowdown && !write_options.low_pri &&
+         !write_options.memtable_insert_hint_per_batch &&
+         write_options.timestamp == nullptr;
+}
+
+bool StagedWriteQueue::Stage(Writer* w) {
+  Stack* stack = stacks_.Access();
+  Writer* head = stack->head.load(std::memory_order_relaxed);
+  do {
+    if (head == &closed_) {
+      return false;
+    }
+    w->next = head;
+  } while (!stack->head.compare_exchange_weak(head, w));
+  TEST_SYNC_POINT("StagedWriteQueue::Write:Staged");
+
+  // Pairs with the committer setting committer_waiting_ before it checks the
+  // stacks, so that either it sees this write or it is woken up
+  if (committer_waiting_.load()) {
+    MutexLock l(&mutex_);
+    committer_cv_.Signal();
+  }
+  return true;
+}
+
+bool StagedWriteQueue::Write(const WriteOptions& write_options,
+                             WriteBatch* batch, Status* status) {
+  assert(CanStage(write_options));
+  if (std::this_thread::get_id() == committer_id_) {
+    // It would wait for itself
+    return false;
+  }
+  Writer w(batch, write_options.sync);
+  if (!Stage(&w)) {
+    return false;
+  }
+  AwaitDone(&w);
+  *status = w.status;
+  return true;
+}
+
+bool StagedWriteQueue::WriteAsync(
+    const WriteOptions& write_options, WriteBatch* batch,
+    const std::function<void(const Status&)>& callback) {
+  assert(CanStage(write_options));
+  assert(callback);
+  std::unique_ptr<Writer> w(new Writer(batch, write_options.sync));
+  w->callback = callback;
+  if (!Stage(w.get())) {
+    return false;
+  }
+  w.release();
+  return true;
+}
+
+void StagedWriteQueue::AwaitDone(Writer* w) {
+  // A commit takes about as long as a WAL write, so spin briefly and then
+  // yield for a while before blocking
+  for (int i = 0; i < 200; ++i) {
+    if (w->done.load(std::memory_order_acquire)) {
+      return;
+    }
+    port::AsmVolatilePause();
+  }
+  if (max_yield_usec_ > 0) {
+    auto yield_begin = std::chrono::steady_clock::now();
+    while (!w->done.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+      if (std::chrono::steady_clock::now() - yield_begin >
+          std::chrono::microseconds(max_yield_usec_)) {
+        break;
+      }
+    }
+  }
+  if (w->done.load(std::memory_order_acquire)) {
+    return;
+  }
+  MutexLock l(&mutex_);
+  ++num_blocked_writers_;
+  while (!w->done.load(std::memory_order_acquire)) {
+    writers_cv_.Wait();
+  }
+  --num_blocked_writers_;
+}
+
+void StagedWriteQueue::Stop() {
+  {
+    MutexLock l(&mutex_);
+    stop_ = true;
+    committer_cv_.Signal();
+  }
+  if (committer_.joinable()) {
+    committer_.join();
+  }
+}
+
+bool StagedWriteQueue::HasStagedWrites() const {
+  for (size_t i = 0; i < stacks_.Size(); ++i) {
+    Writer* head = stacks_.AccessAtCore(i)->head.load();
+    if (head != nullptr && head != &closed_) {
+      return true;
+    }
+  }
+  return false;
+}
+
+StagedWriteQueue::Writer* StagedWriteQueue::TakeStagedWrites(bool close) {
+  Writer* first = nullptr;
+  Writer** last_next = &first;
+  for (size_t i = 0; i < stacks_.Size(); ++i) {
+    Writer* head = stacks_.AccessAtCore(i)->head.exchange(
+        close ? &closed_ : nullptr, std::memory_order_acq_rel);
+    if (head == &closed_) {
+      continue;
+    }
+    // Reverse the stack, to commit the writes of a core in staging order
+    Writer* reversed = nullptr;
+    Writer* reversed_last = head;
+    while (head != nullptr) {
+      Writer* next = head->next;
+      head->next = reversed;
+      reversed = head;
+      head = next;
+    }
+    if (reversed != nullptr) {
+      *last_next = reversed;
+      last_next = &reversed_last->next;
+    }
+  }
+  return first;
+}
+
+void StagedWriteQueue::Commit(Writer* writers) {
+  WriteOptions write_options;
+  size_t num_writers = 0;
+  size_t merged_size = 0;
+  for (Writer* w = writers; w != nullptr; w = w->next) {
+    write_options.sync |= w->sync;
+    merged_size += w->batch->GetDataSize();
+    ++num_writers;
+  }
+  WriteBatch merged_batch(num_writers > 1 ? merged_size : 0);
+  WriteBatch* batch = writers->batch;
+  if (num_writers > 1) {
+    // Merge the batches, as the write group leader does for the WAL
+    for (Writer* w = writers; w != nullptr; w = w->next) {
+      Status s = WriteBatchInternal::Append(&merged_batch, w->batch);
+      assert(s.ok());
+      s.PermitUncheckedError();
+    }
+    batch = &merged_batch;
+  }
+  TEST_SYNC_POINT_CALLBACK("StagedWriteQueue::Commit", &num_writers);
+  Status s = commit_(write_options, batch);
+
+  // Release the waiting writers before running the callbacks
+  Writer* async_writers = nullptr;
+  Writer** async_last_next = &async_writers;
+  Writer* w = writers;
+  while (w != nullptr) {
+    // The writer may return as soon as it is done
+    Writer* next = w->next;
+    if (w->callback) {
+      *async_last_next = w;
+      async_last_next = &w->next;
+    } else {
+      w->status = s;
+      w->done.store(true, std::memory_order_release);
+    }
+    w = next;
+  }
+  *async_last_next = nullptr;
+  {
+    MutexLock l(&mutex_);
+    if (num_blocked_writers_ > 0) {
+      writers_cv_.SignalAll();
+    }
+  }
+  while (async_writers != nullptr) {
+    std::unique_ptr<Writer> async_writer(async_writers);
+    async_writers = async_writers->next;
+    async_writer->callback(s);
+  }
+}
+
+void StagedWriteQueue::CommitterLoop() {
+  bool stopping = false;
+  while (true) {
+    Writer* writers = TakeStagedWrites(stopping /* close */);
+    if (writers != nullptr) {
+      Commit(writers);
+      continue;
+    }
+    if (stopping) {
+      // The stacks are closed and empty
+      break;
+    }
+    MutexLock l(&mutex_);
+    committer_waiting_.store(true);
+    while (!stop_ && !HasStagedWrites()) {
+      committer_cv_.Wait();
+    }
+    committer_waiting_.store(false);
+    stopping = stop_;
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
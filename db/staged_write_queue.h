@@ -0,0 +1,134 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "port/port.h"
+#include "rocksdb/options.h"
+#include "rocksdb/status.h"
+#include "rocksdb/write_batch.h"
+#include "util/core_local.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The write path of DBOptions::enable_staged_writes.
+//
+// Writers do not join the WriteThread, where each of them waits on its own
+// state until the group leader wakes it up. Instead, a writer pushes its batch
+// onto a stack of the core it runs on with a single compare-and-swap. A
+// dedicated committer thread repeatedly takes the stacks of all cores, merges
+// the staged batches into one batch, commits it (one WAL record and one
+// memtable insert) and marks the writers done. Writers spin, then yield, and
+// only then block on a condition variable that all of them share, which the
+// committer signals at most once per commit. Asynchronous writers
+// (DB::WriteAsync()) do not wait at all: the committer calls their callbacks
+// once their batches are committed.
+//
+// The batches committed together succeed or fail together.
+class StagedWriteQueue {
+ public:
+  // Commits a merged batch, e.g. with DBImpl::WriteImpl()
+  using CommitFunction =
+      std::function<Status(const WriteOptions&, WriteBatch*)>;
+
+  // Starts the committer thread. Writers yield for up to `max_yield_usec`
+  // before they block.
+  StagedWriteQueue(CommitFunction commit, uint64_t max_yield_usec);
+  // Stops the queue
+  ~StagedWriteQueue();
+
+  // No copying allowed
+  StagedWriteQueue(const StagedWriteQueue&) = delete;
+  StagedWriteQueue& operator=(const StagedWriteQueue&) = delete;
+
+  // Whether a write with `write_options` can be staged. Options that apply to
+  // a single write (disableWAL, no_slowdown, low_pri, ...) are not supported.
+  static bool CanStage(const WriteOptions& write_options);
+
+  // Stages `batch` and waits until the committer has committed it, setting
+  // *status to the result. Returns false without writing anything if the
+  // queue is stopped, or if called by the committer (i.e. from a callback).
+  bool Write(const WriteOptions& write_options, WriteBatch* batch,
+             Status* status);
+
+  // Stages `batch` and returns. The committer calls `callback` with the
+  // result once it has committed the batch, which must stay valid until
+  // then. Returns false without writing anything if the queue is stopped.
+  bool WriteAsync(const WriteOptions& write_options, WriteBatch* batch,
+                  const std::function<void(const Status&)>& callback);
+
+  // Commits the staged writes and stops the committer thread. Later writes
+  // are not staged.
+  void Stop();
+
+ private:
+  // A staged write, on the stack of the writer, or allocated by WriteAsync()
+  struct Writer {
+    Writer(WriteBatch* _batch, bool _sync) : batch(_batch), sync(_sync) {}
+
+    WriteBatch* batch;
+    bool sync;
+    // Set for asynchronous writes, which are deleted once it is called
+    std::function<void(const Status&)> callback;
+    // Next (earlier) writer on the same stack
+    Writer* next = nullptr;
+    // Set by the committer once `status` is set
+    std::atomic<bool> done{false};
+    Status status;
+  };
+
+  // Staged writes of a core, newest first. Padded to a cache line so that
+  // writers on different cores do not contend.
+  struct Stack {
+    std::atomic<Writer*> head{nullptr};
+    char padding[CACHE_LINE_SIZE - sizeof(std::atomic<Writer*>)];
+  };
+
+  void CommitterLoop();
+
+  // Pushes `w` onto the stack of the current core. Returns false if the stack
+  // is closed.
+  bool Stage(Writer* w);
+
+  // Whether any stack has a staged write
+  bool HasStagedWrites() const;
+
+  // Takes the staged writes of all stacks and returns them in staging order
+  // (per core). With `close`, the stacks are closed for later writes.
+  Writer* TakeStagedWrites(bool close);
+
+  // Commits `writers` and marks them done
+  void Commit(Writer* writers);
+
+  // Waits until `w` is done
+  void AwaitDone(Writer* w);
+
+  const CommitFunction commit_;
+  const uint64_t max_yield_usec_;
+  CoreLocalArray<Stack> stacks_;
+  // Head of a closed stack
+  Writer closed_;
+
+  port::Mutex mutex_;
+  // Signaled when there are writes to commit, or to stop
+  port::CondVar committer_cv_;
+  // Signaled once writers are done, if any of them is blocked
+  port::CondVar writers_cv_;
+  // Whether the committer is (about to be) waiting on committer_cv_
+  std::atomic<bool> committer_waiting_{false};
+  // Protected by mutex_
+  bool stop_ = false;
+  int num_blocked_writers_ = 0;
+
+  port::Thread committer_;
+  std::thread::id committer_id_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -19,6 +19,7 @@
 #include "monitoring/perf_context_imp.h"
 #include "rocksdb/advanced_options.h"
 #include "rocksdb/statistics.h"
+#include "table/block_based/block_based_table_factory.h"
 #include "table/block_based/block_based_table_reader.h"
 #include "table/get_context.h"
 #include "table/internal_iterator.h"
@@ -97,14 +98,13 @@ void TableCache::ReleaseHandle(Cache::Handle* handle) {
   cache_->Release(handle);
 }
 
-Status TableCache::GetTableReader(
+TableCache::PrefetchedTableFile::~PrefetchedTableFile() {}
+
+Status TableCache::OpenTableFile(
     const ReadOptions& ro, const FileOptions& file_options,
-    const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
-    bool sequential_mode, bool record_read_stats, HistogramImpl* file_read_hist,
-    std::unique_ptr<TableReader>* table_reader,
-    const SliceTransform* prefix_extractor, bool skip_filters, int level,
-    bool prefetch_index_and_filter_in_cache,
-    size_t max_file_size_for_l0_meta_pin, Temperature file_temperature) {
+    const FileDescriptor& fd, bool sequential_mode, bool record_read_stats,
+    HistogramImpl* file_read_hist, Temperature file_temperature,
+    std::unique_ptr<RandomAccessFileReader>* file_reader) {
   std::string fname =
       TableFileName(ioptions_.cf_paths, fd.GetNumber(), fd.GetPathId());
   std::unique_ptr<FSRandomAccessFile> file;
@@ -129,22 +129,71 @@ Status TableCache::GetTableReader(
     if (!sequential_mode && ioptions_.advise_random_on_open) {
       file->Hint(FSRandomAccessFile::kRandom);
     }
+    file_reader->reset(new RandomAccessFileReader(
+        std::move(file), fname, ioptions_.clock, io_tracer_,
+        record_read_stats ? ioptions_.stats : nullptr, SST_READ_MICROS,
+        file_read_hist, ioptions_.rate_limiter.get(), ioptions_.listeners,
+        file_temperature));
+  }
+  return s;
+}
+
+Status TableCache::PrefetchTableFile(
+    const ReadOptions& ro, const FileOptions& file_options,
+    const FileDescriptor& fd, bool record_read_stats,
+    HistogramImpl* file_read_hist, int level,
+    bool prefetch_index_and_filter_in_cache, Temperature file_temperature,
+    std::unique_ptr<PrefetchedTableFile>* prefetched) {
+  const auto* table_factory =
+      ioptions_.table_factory->CheckedCast<BlockBasedTableFactory>();
+  if (table_factory == nullptr || ioptions_.allow_mmap_reads) {
+    return Status::NotSupported("Tail prefetch not supported");
+  }
+  std::unique_ptr<PrefetchedTableFile> file(new PrefetchedTableFile);
+  Status s = OpenTableFile(ro, file_options, fd, false /* sequential mode */,
+                           record_read_stats, file_read_hist, file_temperature,
+                           &file->file_reader);
+  if (s.ok()) {
+    TEST_SYNC_POINT("TableCache::PrefetchTableFile");
+    table_factory->SubmitTailPrefetch(
+        ro, file->file_reader.get(), fd.GetFileSize(),
+        prefetch_index_and_filter_in_cache, level, ioptions_.fs.get(),
+        &file->tail_prefetch_buffer);
+    *prefetched = std::move(file);
+  }
+  return s;
+}
+
+Status TableCache::GetTableReader(
+    const ReadOptions& ro, const FileOptions& file_options,
+    const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
+    bool sequential_mode, bool record_read_stats, HistogramImpl* file_read_hist,
+    std::unique_ptr<TableReader>* table_reader,
+    const SliceTransform* prefix_extractor, bool skip_filters, int level,
+    bool prefetch_index_and_filter_in_cache,
+    size_t max_file_size_for_l0_meta_pin, Temperature file_temperature,
+    PrefetchedTableFile* prefetched) {
+  std::unique_ptr<RandomAccessFileReader> file_reader;
+  FilePrefetchBuffer* tail_prefetch_buffer = nullptr;
+  Status s;
+  if (prefetched != nullptr && prefetched->file_reader != nullptr) {
+    file_reader = std::move(prefetched->file_reader);
+    tail_prefetch_buffer = prefetched->tail_prefetch_buffer.get();
+  } else {
+    s = OpenTableFile(ro, file_options, fd, sequential_mode, record_read_stats,
+                      file_read_hist, file_temperature, &file_reader);
+  }
+  if (s.ok()) {
     StopWatch sw(ioptions_.clock, ioptions_.stats, TABLE_OPEN_IO_MICROS);
-    std::unique_ptr<RandomAccessFileReader> file_reader(
-        new RandomAccessFileReader(
-            std::move(file), fname, ioptions_.clock, io_tracer_,
-            record_read_stats ? ioptions_.stats : nullptr, SST_READ_MICROS,
-            file_read_hist, ioptions_.rate_limiter.get(), ioptions_.listeners,
-            file_temperature));
+    TableReaderOptions table_reader_options(
+        ioptions_, prefix_extractor, file_options, internal_comparator,
+        skip_filters, immortal_tables_, false /* force_direct_prefetch */,
+        level, fd.largest_seqno, block_cache_tracer_,
+        max_file_size_for_l0_meta_pin, db_session_id_, fd.GetNumber());
+    table_reader_options.tail_prefetch_buffer = tail_prefetch_buffer;
     s = ioptions_.table_factory->NewTableReader(
-        ro,
-        TableReaderOptions(
-            ioptions_, prefix_extractor, file_options, internal_comparator,
-            skip_filters, immortal_tables_, false /* force_direct_prefetch */,
-            level, fd.largest_seqno, block_cache_tracer_,
-            max_file_size_for_l0_meta_pin, db_session_id_, fd.GetNumber()),
-        std::move(file_reader), fd.GetFileSize(), table_reader,
-        prefetch_index_and_filter_in_cache);
+        ro, table_reader_options, std::move(file_reader), fd.GetFileSize(),
+        table_reader, prefetch_index_and_filter_in_cache);
     TEST_SYNC_POINT("TableCache::GetTableReader:0");
   }
   return s;
@@ -163,7 +212,8 @@ Status TableCache::FindTable(
     Cache::Handle** handle, const SliceTransform* prefix_extractor,
     const bool no_io, bool record_read_stats, HistogramImpl* file_read_hist,
     bool skip_filters, int level, bool prefetch_index_and_filter_in_cache,
-    size_t max_file_size_for_l0_meta_pin, Temperature file_temperature) {
+    size_t max_file_size_for_l0_meta_pin, Temperature file_temperature,
+    PrefetchedTableFile* prefetched) {
   PERF_TIMER_GUARD_WITH_CLOCK(find_table_nanos, ioptions_.clock);
   uint64_t number = fd.GetNumber();
   Slice key = GetSliceForFileNumber(&number);
@@ -187,7 +237,7 @@ Status TableCache::FindTable(
         ro, file_options, internal_comparator, fd, false /* sequential mode */,
         record_read_stats, file_read_hist, &table_reader, prefix_extractor,
         skip_filters, level, prefetch_index_and_filter_in_cache,
-        max_file_size_for_l0_meta_pin, file_temperature);
+        max_file_size_for_l0_meta_pin, file_temperature, prefetched);
     if (!s.ok()) {
       assert(table_reader == nullptr);
       RecordTick(ioptions_.stats, NO_FILE_ERRORS);
@@ -545,18 +595,7 @@ Status TableCache::MultiGet(const ReadOptions& options,
       }
     }
     if (s.ok() && !options.ignore_range_deletions) {
-      std::unique_ptr<FragmentedRangeTombstoneIterator> range_del_iter(
-          t->NewRangeTombstoneIterator(options));
-      if (range_del_iter != nullptr) {
-        for (auto iter = table_range.begin(); iter != table_range.end();
-             ++iter) {
-          SequenceNumber* max_covering_tombstone_seq =
-              iter->get_context->max_covering_tombstone_seq();
-          *max_covering_tombstone_seq = std::max(
-              *max_covering_tombstone_seq,
-              range_del_iter->MaxCoveringTombstoneSeqnum(iter->ukey_with_ts));
-        }
-      }
+      UpdateMaxCoveringTombstoneSeq(options, t, table_range);
     }
     if (s.ok()) {
       t->MultiGet(options, &table_range, prefix_extractor, skip_filters);
@@ -608,6 +647,90 @@ Status TableCache::MultiGet(const ReadOptions& options,
   return s;
 }
 
+void TableCache::StartMultiGet(const ReadOptions& options,
+                               const InternalKeyComparator& internal_comparator,
+                               const FileMetaData& file_meta,
+                               const MultiGetContext::Range* mget_range,
+                               const SliceTransform* prefix_extractor,
+                               HistogramImpl* file_read_hist,
+                               bool skip_filters, int level,
+                               PendingMultiGet* pending) {
+  assert(pending->table_state == nullptr);
+#ifndef ROCKSDB_LITE
+  if (ioptions_.row_cache) {
+    // The row cache entries are filled in while the keys are resolved, which
+    // MultiGet() does in one go.
+    pending->status =
+        MultiGet(options, internal_comparator, file_meta, mget_range,
+                 prefix_extractor, file_read_hist, skip_filters, level);
+    return;
+  }
+#endif  // ROCKSDB_LITE
+
+  auto& fd = file_meta.fd;
+  Status s;
+  TableReader* t = fd.table_reader;
+  if (t == nullptr) {
+    s = FindTable(options, file_options_, internal_comparator, fd,
+                  &pending->handle, prefix_extractor,
+                  options.read_tier == kBlockCacheTier /* no_io */,
+                  true /* record_read_stats */, file_read_hist, skip_filters,
+                  level, true /* prefetch_index_and_filter_in_cache */,
+                  0 /*max_file_size_for_l0_meta_pin*/, file_meta.temperature);
+    TEST_SYNC_POINT_CALLBACK("TableCache::MultiGet:FindTable", &s);
+    if (s.ok()) {
+      t = GetTableReaderFromHandle(pending->handle);
+      assert(t);
+    }
+  }
+  if (s.ok() && !options.ignore_range_deletions) {
+    UpdateMaxCoveringTombstoneSeq(options, t, *mget_range);
+  }
+  if (s.ok()) {
+    pending->table_reader = t;
+    pending->table_state =
+        t->StartMultiGet(options, mget_range, prefix_extractor, skip_filters);
+  } else if (options.read_tier == kBlockCacheTier && s.IsIncomplete()) {
+    for (auto iter = mget_range->begin(); iter != mget_range->end(); ++iter) {
+      Status* status = iter->s;
+      if (status->IsIncomplete()) {
+        // Couldn't find Table in cache but treat as kFound if no_io set
+        iter->get_context->MarkKeyMayExist();
+        s = Status::OK();
+      }
+    }
+  }
+  pending->status = s;
+}
+
+Status TableCache::FinishMultiGet(PendingMultiGet* pending) {
+  if (pending->table_state != nullptr) {
+    pending->table_reader->FinishMultiGet(pending->table_state.get());
+    pending->table_state.reset();
+  }
+  if (pending->handle != nullptr) {
+    ReleaseHandle(pending->handle);
+    pending->handle = nullptr;
+  }
+  return pending->status;
+}
+
+void TableCache::UpdateMaxCoveringTombstoneSeq(
+    const ReadOptions& options, TableReader* t,
+    const MultiGetContext::Range& table_range) {
+  std::unique_ptr<FragmentedRangeTombstoneIterator> range_del_iter(
+      t->NewRangeTombstoneIterator(options));
+  if (range_del_iter != nullptr) {
+    for (auto iter = table_range.begin(); iter != table_range.end(); ++iter) {
+      SequenceNumber* max_covering_tombstone_seq =
+          iter->get_context->max_covering_tombstone_seq();
+      *max_covering_tombstone_seq = std::max(
+          *max_covering_tombstone_seq,
+          range_del_iter->MaxCoveringTombstoneSeqnum(iter->ukey_with_ts));
+    }
+  }
+}
+
 Status TableCache::GetTableProperties(
     const FileOptions& file_options,
     const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
@@ -724,4 +847,51 @@ uint64_t TableCache::ApproximateSize(
 
   return result;
 }
+
+Status TableCache::ApproximateKeyAnchors(
+    const ReadOptions& ro, const InternalKeyComparator& internal_comparator,
+    const FileDescriptor& fd, std::vector<TableReader::Anchor>& anchors) {
+  Status s;
+  TableReader* t = fd.table_reader;
+  Cache::Handle* handle = nullptr;
+  if (t == nullptr) {
+    s = FindTable(ro, file_options_, internal_comparator, fd, &handle);
+    if (s.ok()) {
+      t = GetTableReaderFromHandle(handle);
+    }
+  }
+  if (s.ok() && t != nullptr) {
+    s = t->ApproximateKeyAnchors(ro, anchors);
+  }
+  if (handle != nullptr) {
+    ReleaseHandle(handle);
+  }
+  return s;
+}
+
+Status TableCache::NewRawDataBlockIterator(
+    const ReadOptions& ro, const InternalKeyComparator& internal_comparator,
+    const FileDescriptor& fd, std::unique_ptr<RawDataBlockIterator>* result) {
+  result->reset();
+  Status s;
+  TableReader* t = fd.table_reader;
+  Cache::Handle* handle = nullptr;
+  if (t == nullptr) {
+    s = FindTable(ro, file_options_, internal_comparator, fd, &handle);
+    if (s.ok()) {
+      t = GetTableReaderFromHandle(handle);
+    }
+  }
+  if (s.ok() && t != nullptr) {
+    result->reset(t->NewRawDataBlockIterator(ro));
+  }
+  if (handle != nullptr) {
+    if (*result != nullptr) {
+      (*result)->RegisterCleanup(&UnrefEntry, cache_, handle);
+    } else {
+      ReleaseHandle(handle);
+    }
+  }
+  return s;
+}
 }  // namespace ROCKSDB_NAMESPACE
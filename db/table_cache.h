@@ -30,8 +30,10 @@ namespace ROCKSDB_NAMESPACE {
 class Env;
 class Arena;
 struct FileDescriptor;
+class FilePrefetchBuffer;
 class GetContext;
 class HistogramImpl;
+class RandomAccessFileReader;
 
 // Manages caching for TableReader objects for a column family. The actual
 // cache is allocated separately and passed to the constructor. TableCache
@@ -122,6 +124,28 @@ class TableCache {
                   HistogramImpl* file_read_hist = nullptr,
                   bool skip_filters = false, int level = -1);
 
+  // A lookup started by StartMultiGet()
+  struct PendingMultiGet {
+    Status status;
+    Cache::Handle* handle = nullptr;
+    TableReader* table_reader = nullptr;
+    std::unique_ptr<TableReader::MultiGetState> table_state;
+  };
+
+  // Split-phase variant of MultiGet(), which lets the caller overlap the
+  // data block reads of several files; see TableReader::StartMultiGet().
+  // FinishMultiGet() must be called with *pending, and returns the status
+  // MultiGet() would have returned. With a row cache, StartMultiGet() does
+  // the whole lookup.
+  void StartMultiGet(const ReadOptions& options,
+                     const InternalKeyComparator& internal_comparator,
+                     const FileMetaData& file_meta,
+                     const MultiGetContext::Range* mget_range,
+                     const SliceTransform* prefix_extractor,
+                     HistogramImpl* file_read_hist, bool skip_filters,
+                     int level, PendingMultiGet* pending);
+  Status FinishMultiGet(PendingMultiGet* pending);
+
   // Evict any entry for the specified file number
   static void Evict(Cache* cache, uint64_t file_number);
 
@@ -132,9 +156,33 @@ class TableCache {
   // Used in DB close, or the file is not live anymore.
   void EraseHandle(const FileDescriptor& fd, Cache::Handle* handle);
 
+  // A table file opened by PrefetchTableFile(), whose tail is being read
+  struct PrefetchedTableFile {
+    ~PrefetchedTableFile();
+
+    std::unique_ptr<RandomAccessFileReader> file_reader;
+    // Destroyed first, which waits for the read
+    std::unique_ptr<FilePrefetchBuffer> tail_prefetch_buffer;
+  };
+
+  // Opens the file of `file_fd` and submits an asynchronous read of the tail
+  // that opening its table reader reads first, so that the tails of many
+  // files can be read together. Pass the result to FindTable(), with the
+  // same arguments, to open the table reader. Returns Status::NotSupported()
+  // unless the table factory is block-based.
+  Status PrefetchTableFile(const ReadOptions& ro, const FileOptions& toptions,
+                           const FileDescriptor& file_fd,
+                           bool record_read_stats,
+                           HistogramImpl* file_read_hist, int level,
+                           bool prefetch_index_and_filter_in_cache,
+                           Temperature file_temperature,
+                           std::unique_ptr<PrefetchedTableFile>* prefetched);
+
   // Find table reader
   // @param skip_filters Disables loading/accessing the filter block
   // @param level == -1 means not specified
+  // @param prefetched if not null, the file prefetched by PrefetchTableFile(),
+  //    which is used if the table reader is not in the cache
   Status FindTable(const ReadOptions& ro, const FileOptions& toptions,
                    const InternalKeyComparator& internal_comparator,
                    const FileDescriptor& file_fd, Cache::Handle**,
@@ -144,7 +192,8 @@ class TableCache {
                    bool skip_filters = false, int level = -1,
                    bool prefetch_index_and_filter_in_cache = true,
                    size_t max_file_size_for_l0_meta_pin = 0,
-                   Temperature file_temperature = Temperature::kUnknown);
+                   Temperature file_temperature = Temperature::kUnknown,
+                   PrefetchedTableFile* prefetched = nullptr);
 
   // Get TableReader from a cache handle.
   TableReader* GetTableReaderFromHandle(Cache::Handle* handle);
@@ -183,6 +232,21 @@ class TableCache {
                            const InternalKeyComparator& internal_comparator,
                            const SliceTransform* prefix_extractor = nullptr);
 
+  // Samples keys that split the file represented by fd into ranges of about
+  // the same size. See TableReader::ApproximateKeyAnchors().
+  Status ApproximateKeyAnchors(const ReadOptions& ro,
+                               const InternalKeyComparator& internal_comparator,
+                               const FileDescriptor& fd,
+                               std::vector<TableReader::Anchor>& anchors);
+
+  // Returns an iterator over the data blocks of the file represented by fd as
+  // stored, which keeps the table reader alive, or sets *result to nullptr if
+  // its table format does not support it. See
+  // TableReader::NewRawDataBlockIterator().
+  Status NewRawDataBlockIterator(
+      const ReadOptions& ro, const InternalKeyComparator& internal_comparator,
+      const FileDescriptor& fd, std::unique_ptr<RawDataBlockIterator>* result);
+
   // Release the handle from a cache
   void ReleaseHandle(Cache::Handle* handle);
 
@@ -201,6 +265,13 @@ class TableCache {
   }
 
  private:
+  // Open the file of a table reader
+  Status OpenTableFile(const ReadOptions& ro, const FileOptions& file_options,
+                       const FileDescriptor& fd, bool sequential_mode,
+                       bool record_read_stats, HistogramImpl* file_read_hist,
+                       Temperature file_temperature,
+                       std::unique_ptr<RandomAccessFileReader>* file_reader);
+
   // Build a table reader
   Status GetTableReader(const ReadOptions& ro, const FileOptions& file_options,
                         const InternalKeyComparator& internal_comparator,
@@ -211,7 +282,8 @@ class TableCache {
                         bool skip_filters = false, int level = -1,
                         bool prefetch_index_and_filter_in_cache = true,
                         size_t max_file_size_for_l0_meta_pin = 0,
-                        Temperature file_temperature = Temperature::kUnknown);
+                        Temperature file_temperature = Temperature::kUnknown,
+                        PrefetchedTableFile* prefetched = nullptr);
 
   // Create a key prefix for looking up the row cache. The prefix is of the
   // format row_cache_id + fd_number + seq_no. Later, the user key can be
@@ -226,6 +298,11 @@ class TableCache {
   bool GetFromRowCache(const Slice& user_key, IterKey& row_cache_key,
                        size_t prefix_size, GetContext* get_context);
 
+  // Raises the max covering tombstone sequence number of the keys in
+  // table_range to that of the range tombstones in t.
+  void UpdateMaxCoveringTombstoneSeq(const ReadOptions& options, TableReader* t,
+                                     const MultiGetContext::Range& table_range);
+
   const ImmutableOptions& ioptions_;
   const FileOptions& file_options_;
   Cache* const cache_;
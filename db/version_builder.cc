@@ -1144,6 +1144,7 @@ class VersionBuilder::Rep {
   }
 
   Status LoadTableHandlers(InternalStats* internal_stats, int max_threads,
+                           int batch_size,
                            bool prefetch_index_and_filter_in_cache,
                            bool is_initial_load,
                            const SliceTransform* prefix_extractor,
@@ -1201,28 +1202,52 @@ class VersionBuilder::Rep {
       }
     }
 
+    const size_t batch = static_cast<size_t>(std::max(batch_size, 1));
     std::atomic<size_t> next_file_meta_idx(0);
     std::function<void()> load_handlers_func([&]() {
+      std::vector<std::unique_ptr<TableCache::PrefetchedTableFile>> prefetched;
       while (true) {
-        size_t file_idx = next_file_meta_idx.fetch_add(1);
-        if (file_idx >= files_meta.size()) {
+        size_t begin_idx = next_file_meta_idx.fetch_add(batch);
+        if (begin_idx >= files_meta.size()) {
           break;
         }
+        size_t end_idx = std::min(begin_idx + batch, files_meta.size());
+
+        // Have the tail reads of the batch in flight together. If a file
+        // cannot be prefetched, FindTable() opens it as usual.
+        prefetched.clear();
+        prefetched.resize(end_idx - begin_idx);
+        if (batch > 1) {
+          for (size_t file_idx = begin_idx; file_idx < end_idx; ++file_idx) {
+            auto* file_meta = files_meta[file_idx].first;
+            int level = files_meta[file_idx].second;
+            Status s = table_cache_->PrefetchTableFile(
+                ReadOptions(), file_options_, file_meta->fd,
+                true /* record_read_stats */,
+                internal_stats->GetFileReadHist(level), level,
+                prefetch_index_and_filter_in_cache, file_meta->temperature,
+                &prefetched[file_idx - begin_idx]);
+            s.PermitUncheckedError();
+          }
+        }
 
-        auto* file_meta = files_meta[file_idx].first;
-        int level = files_meta[file_idx].second;
-        statuses[file_idx] = table_cache_->FindTable(
-            ReadOptions(), file_options_,
-            *(base_vstorage_->InternalComparator()), file_meta->fd,
-            &file_meta->table_reader_handle, prefix_extractor, false /*no_io */,
-            true /* record_read_stats */,
-            internal_stats->GetFileReadHist(level), false, level,
-            prefetch_index_and_filter_in_cache, max_file_size_for_l0_meta_pin,
-            file_meta->temperature);
-        if (file_meta->table_reader_handle != nullptr) {
-          // Load table_reader
-          file_meta->fd.table_reader = table_cache_->GetTableReaderFromHandle(
-              file_meta->table_reader_handle);
+        for (size_t file_idx = begin_idx; file_idx < end_idx; ++file_idx) {
+          auto* file_meta = files_meta[file_idx].first;
+          int level = files_meta[file_idx].second;
+          statuses[file_idx] = table_cache_->FindTable(
+              ReadOptions(), file_options_,
+              *(base_vstorage_->InternalComparator()), file_meta->fd,
+              &file_meta->table_reader_handle, prefix_extractor,
+              false /*no_io */, true /* record_read_stats */,
+              internal_stats->GetFileReadHist(level), false, level,
+              prefetch_index_and_filter_in_cache,
+              max_file_size_for_l0_meta_pin, file_meta->temperature,
+              prefetched[file_idx - begin_idx].get());
+          if (file_meta->table_reader_handle != nullptr) {
+            // Load table_reader
+            file_meta->fd.table_reader = table_cache_->GetTableReaderFromHandle(
+                file_meta->table_reader_handle);
+          }
         }
       }
     });
@@ -1270,13 +1295,14 @@ Status VersionBuilder::SaveTo(VersionStorageInfo* vstorage) const {
 }
 
 Status VersionBuilder::LoadTableHandlers(
-    InternalStats* internal_stats, int max_threads,
+    InternalStats* internal_stats, int max_threads, int batch_size,
     bool prefetch_index_and_filter_in_cache, bool is_initial_load,
     const SliceTransform* prefix_extractor,
     size_t max_file_size_for_l0_meta_pin) {
   return rep_->LoadTableHandlers(
-      internal_stats, max_threads, prefetch_index_and_filter_in_cache,
-      is_initial_load, prefix_extractor, max_file_size_for_l0_meta_pin);
+      internal_stats, max_threads, batch_size,
+      prefetch_index_and_filter_in_cache, is_initial_load, prefix_extractor,
+      max_file_size_for_l0_meta_pin);
 }
 
 uint64_t VersionBuilder::GetMinOldestBlobFileNumber() const {
@@ -39,7 +39,10 @@ class VersionBuilder {
   bool CheckConsistencyForNumLevels();
   Status Apply(const VersionEdit* edit);
   Status SaveTo(VersionStorageInfo* vstorage) const;
+  // Each of the max_threads threads opens batch_size files together (see
+  // DBOptions::file_opening_batch_size).
   Status LoadTableHandlers(InternalStats* internal_stats, int max_threads,
+                           int batch_size,
                            bool prefetch_index_and_filter_in_cache,
                            bool is_initial_load,
                            const SliceTransform* prefix_extractor,
@@ -13,6 +13,7 @@
 #include <array>
 #include <cinttypes>
 #include <cstdio>
+#include <deque>
 #include <list>
 #include <map>
 #include <set>
@@ -22,6 +23,7 @@
 
 #include "db/blob/blob_fetcher.h"
 #include "db/blob/blob_file_cache.h"
+#include "db/blob/blob_source.h"
 #include "db/blob/blob_file_reader.h"
 #include "db/blob/blob_index.h"
 #include "db/blob/blob_log_format.h"
@@ -349,6 +351,7 @@ class FilePickerMultiGet {
         current_level_range_(*range, range->begin(), range->end()),
         current_file_range_(*range, range->begin(), range->end()),
         level_files_brief_(file_levels),
+        level_exhausted_(false),
         is_hit_file_last_in_level_(false),
         curr_file_level_(nullptr),
         file_indexer_(file_indexer),
@@ -503,8 +506,28 @@ class FilePickerMultiGet {
     return file_hit;
   }
 
-  FdWithKeyRange* GetNextFile() {
+  FdWithKeyRange* GetNextFile() { return GetNextFile(false); }
+
+  // Like GetNextFile(), but only returns a file of the current level, and
+  // only if the keys to look up in it do not depend on the result of the
+  // lookup in the previously returned file. Otherwise returns nullptr, and
+  // GetNextFile() carries on from there once that result is known.
+  FdWithKeyRange* GetNextFileInLevel() {
+    if (search_ended_ || level_exhausted_ || maybe_repeat_key_ ||
+        batch_iter_ == current_level_range_.end()) {
+      return nullptr;
+    }
+    return GetNextFile(true);
+  }
+
+ private:
+  FdWithKeyRange* GetNextFile(bool in_level_only) {
     while (!search_ended_) {
+      if (level_exhausted_) {
+        level_exhausted_ = false;
+        search_ended_ = !PrepareNextLevel();
+        continue;
+      }
       // Start searching next level.
       if (batch_iter_ == current_level_range_.end()) {
         search_ended_ = !PrepareNextLevel();
@@ -539,6 +562,12 @@ class FilePickerMultiGet {
       bool is_last_key_in_file;
       if (!GetNextFileInLevelWithKeys(&next_file_range, &curr_file_index, &f,
                                       &is_last_key_in_file)) {
+        if (in_level_only) {
+          // The next level may only be prepared once the results of the
+          // lookups in this level are known
+          level_exhausted_ = true;
+          return nullptr;
+        }
         search_ended_ = !PrepareNextLevel();
       } else {
         if (is_last_key_in_file) {
@@ -567,6 +596,7 @@ class FilePickerMultiGet {
     return nullptr;
   }
 
+ public:
   // getter for current file level
   // for GET_HIT_L0, GET_HIT_L1 & GET_HIT_L2_AND_UP counts
   unsigned int GetHitFileLevel() { return hit_file_level_; }
@@ -612,6 +642,8 @@ class FilePickerMultiGet {
   MultiGetRange current_file_range_;
   autovector<LevelFilesBrief>* level_files_brief_;
   bool search_ended_;
+  // Set when GetNextFileInLevel() ran out of files in the current level
+  bool level_exhausted_;
   bool is_hit_file_last_in_level_;
   LevelFilesBrief* curr_file_level_;
   FileIndexer* file_indexer_;
@@ -945,6 +977,12 @@ class LevelIterator final : public InternalIterator {
            file_iter_.iter() && file_iter_.IsValuePinned();
   }
 
+  bool ProjectValue(const std::vector<uint32_t>& columns,
+                    std::string* projected) const override {
+    assert(Valid());
+    return file_iter_.ProjectValue(columns, projected);
+  }
+
  private:
   // Return true if at least one invalid file is seen and skipped.
   bool SkipEmptyFileForward();
@@ -1765,7 +1803,7 @@ Version::Version(ColumnFamilyData* column_family_data, VersionSet* vset,
       info_log_((cfd_ == nullptr) ? nullptr : cfd_->ioptions()->logger),
       db_statistics_((cfd_ == nullptr) ? nullptr : cfd_->ioptions()->stats),
       table_cache_((cfd_ == nullptr) ? nullptr : cfd_->table_cache()),
-      blob_file_cache_(cfd_ ? cfd_->blob_file_cache() : nullptr),
+      blob_source_(cfd_ ? cfd_->blob_source() : nullptr),
       merge_operator_(
           (cfd_ == nullptr) ? nullptr : cfd_->ioptions()->merge_operator.get()),
       storage_info_(
@@ -1812,10 +1850,6 @@ Status Version::GetBlob(const ReadOptions& read_options, const Slice& user_key,
                         PinnableSlice* value, uint64_t* bytes_read) const {
   assert(value);
 
-  if (read_options.read_tier == kBlockCacheTier) {
-    return Status::Incomplete("Cannot read blob: no disk I/O allowed");
-  }
-
   if (blob_index.HasTTL() || blob_index.IsInlined()) {
     return Status::Corruption("Unexpected TTL/inlined blob index");
   }
@@ -1829,50 +1863,25 @@ Status Version::GetBlob(const ReadOptions& read_options, const Slice& user_key,
     return Status::Corruption("Invalid blob file number");
   }
 
-  CacheHandleGuard<BlobFileReader> blob_file_reader;
-
-  {
-    assert(blob_file_cache_);
-    const Status s = blob_file_cache_->GetBlobFileReader(blob_file_number,
-                                                         &blob_file_reader);
-    if (!s.ok()) {
-      return s;
-    }
-  }
-
-  assert(blob_file_reader.GetValue());
-  const Status s = blob_file_reader.GetValue()->GetBlob(
-      read_options, user_key, blob_index.offset(), blob_index.size(),
-      blob_index.compression(), prefetch_buffer, value, bytes_read);
+  assert(it->second);
+  const uint64_t blob_file_size = it->second->GetBlobFileSize();
 
-  return s;
+  assert(blob_source_);
+  return blob_source_->GetBlob(read_options, user_key, blob_file_number,
+                               blob_index.offset(), blob_file_size,
+                               blob_index.size(), blob_index.compression(),
+                               prefetch_buffer, value, bytes_read);
 }
 
 void Version::MultiGetBlob(
     const ReadOptions& read_options, MultiGetRange& range,
     std::unordered_map<uint64_t, BlobReadRequests>& blob_rqs) {
-  if (read_options.read_tier == kBlockCacheTier) {
-    Status s = Status::Incomplete("Cannot read blob(s): no disk I/O allowed");
-    for (const auto& elem : blob_rqs) {
-      for (const auto& blob_rq : elem.second) {
-        const KeyContext& key_context = blob_rq.second;
-        assert(key_context.s);
-        assert(key_context.s->ok());
-        *(key_context.s) = s;
-        assert(key_context.get_context);
-        auto& get_context = *(key_context.get_context);
-        get_context.MarkKeyMayExist();
-      }
-    }
-    return;
-  }
-
   assert(!blob_rqs.empty());
-  Status status;
   const auto& blob_files = storage_info_.GetBlobFiles();
   for (auto& elem : blob_rqs) {
     uint64_t blob_file_number = elem.first;
-    if (blob_files.find(blob_file_number) == blob_files.end()) {
+    const auto it = blob_files.find(blob_file_number);
+    if (it == blob_files.end()) {
       auto& blobs_in_file = elem.second;
       for (const auto& blob : blobs_in_file) {
         const KeyContext& key_context = blob.second;
@@ -1880,25 +1889,11 @@ void Version::MultiGetBlob(
       }
       continue;
     }
-    CacheHandleGuard<BlobFileReader> blob_file_reader;
-    assert(blob_file_cache_);
-    status = blob_file_cache_->GetBlobFileReader(blob_file_number,
-                                                 &blob_file_reader);
-    assert(!status.ok() || blob_file_reader.GetValue());
 
-    auto& blobs_in_file = elem.second;
-    if (!status.ok()) {
-      for (const auto& blob : blobs_in_file) {
-        const KeyContext& key_context = blob.second;
-        *(key_context.s) = status;
-      }
-      continue;
-    }
+    assert(it->second);
+    const uint64_t file_size = it->second->GetBlobFileSize();
 
-    assert(blob_file_reader.GetValue());
-    const uint64_t file_size = blob_file_reader.GetValue()->GetFileSize();
-    const CompressionType compression =
-        blob_file_reader.GetValue()->GetCompressionType();
+    auto& blobs_in_file = elem.second;
 
     // sort blobs_in_file by file offset.
     std::sort(
@@ -1909,11 +1904,7 @@ void Version::MultiGetBlob(
         });
 
     autovector<std::reference_wrapper<const KeyContext>> blob_read_key_contexts;
-    autovector<std::reference_wrapper<const Slice>> user_keys;
-    autovector<uint64_t> offsets;
-    autovector<uint64_t> value_sizes;
-    autovector<Status*> statuses;
-    autovector<PinnableSlice*> values;
+    autovector<BlobSource::ReadRequest> blob_source_reqs;
     for (const auto& blob : blobs_in_file) {
       const auto& blob_index = blob.first;
       const KeyContext& key_context = blob.second;
@@ -1929,33 +1920,38 @@ void Version::MultiGetBlob(
         *(key_context.s) = Status::Corruption("Invalid blob offset");
         continue;
       }
-      if (blob_index.compression() != compression) {
-        *(key_context.s) =
-            Status::Corruption("Compression type mismatch when reading a blob");
-        continue;
-      }
       blob_read_key_contexts.emplace_back(std::cref(key_context));
-      user_keys.emplace_back(std::cref(key_context.ukey_with_ts));
-      offsets.push_back(blob_index.offset());
-      value_sizes.push_back(blob_index.size());
-      statuses.push_back(key_context.s);
-      values.push_back(key_context.value);
-    }
-    blob_file_reader.GetValue()->MultiGetBlob(read_options, user_keys, offsets,
-                                              value_sizes, statuses, values,
-                                              /*bytes_read=*/nullptr);
-    size_t num = blob_read_key_contexts.size();
-    assert(num == user_keys.size());
-    assert(num == offsets.size());
-    assert(num == value_sizes.size());
-    assert(num == statuses.size());
-    assert(num == values.size());
-    for (size_t i = 0; i < num; ++i) {
-      if (statuses[i]->ok()) {
-        range.AddValueSize(blob_read_key_contexts[i].get().value->size());
+
+      BlobSource::ReadRequest req;
+      req.user_key = &key_context.ukey_with_ts;
+      req.offset = offset;
+      req.value_size = value_size;
+      req.compression = blob_index.compression();
+      req.value = key_context.value;
+      req.status = key_context.s;
+      blob_source_reqs.push_back(req);
+    }
+
+    if (blob_source_reqs.empty()) {
+      continue;
+    }
+
+    assert(blob_source_);
+    blob_source_->MultiGetBlobFromOneFile(read_options, blob_file_number,
+                                          file_size, blob_source_reqs,
+                                          /*bytes_read=*/nullptr);
+
+    for (const auto& key_context_ref : blob_read_key_contexts) {
+      const KeyContext& key_context = key_context_ref.get();
+      if (key_context.s->ok()) {
+        range.AddValueSize(key_context.value->size());
         if (range.GetValueSize() > read_options.value_size_soft_limit) {
-          *(blob_read_key_contexts[i].get().s) = Status::Aborted();
+          *(key_context.s) = Status::Aborted();
         }
+      } else if (key_context.s->IsIncomplete()) {
+        // The blob is not in the blob cache and no I/O is allowed
+        assert(key_context.get_context);
+        key_context.get_context->MarkKeyMayExist();
       }
     }
   }
@@ -2188,148 +2184,225 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
   // blob_file => [[blob_idx, it], ...]
   std::unordered_map<uint64_t, BlobReadRequests> blob_rqs;
 
+  struct FileLookup {
+    FileLookup(FdWithKeyRange* _file, const MultiGetRange& _file_range,
+               unsigned int _level, bool _is_last_in_level)
+        : file(_file),
+          file_range(_file_range),
+          level(_level),
+          is_last_in_level(_is_last_in_level) {}
+
+    FdWithKeyRange* file;
+    MultiGetRange file_range;
+    unsigned int level;
+    bool is_last_in_level;
+    // Time spent in TableCache::StartMultiGet(), if the lookup was started
+    // ahead of time
+    uint64_t start_nanos = 0;
+    TableCache::PendingMultiGet pending;
+  };
+  // With ReadOptions::async_io, the lookups in all the files of a level
+  // (other than L0, whose files overlap) are started before the first of them
+  // is finished, so that their data block reads overlap.
+  std::deque<FileLookup> lookups;
+  bool lookup_failed = false;
   while (f != nullptr) {
-    MultiGetRange file_range = fp.CurrentFileRange();
-    bool timer_enabled =
-        GetPerfLevel() >= PerfLevel::kEnableTimeExceptForMutex &&
-        get_perf_context()->per_level_perf_context_enabled;
-    StopWatchNano timer(clock_, timer_enabled /* auto_start */);
-    s = table_cache_->MultiGet(
-        read_options, *internal_comparator(), *f->file_metadata, &file_range,
-        mutable_cf_options_.prefix_extractor.get(),
-        cfd_->internal_stats()->GetFileReadHist(fp.GetHitFileLevel()),
-        IsFilterSkipped(static_cast<int>(fp.GetHitFileLevel()),
-                        fp.IsHitFileLastInLevel()),
-        fp.GetHitFileLevel());
-    // TODO: examine the behavior for corrupted key
-    if (timer_enabled) {
-      PERF_COUNTER_BY_LEVEL_ADD(get_from_table_nanos, timer.ElapsedNanos(),
-                                fp.GetHitFileLevel());
-    }
-    if (!s.ok()) {
-      // TODO: Set status for individual keys appropriately
-      for (auto iter = file_range.begin(); iter != file_range.end(); ++iter) {
-        *iter->s = s;
-        file_range.MarkKeyDone(iter);
+    const bool async_lookups = read_options.async_io &&
+                               read_options.read_tier != kBlockCacheTier &&
+                               fp.GetHitFileLevel() > 0;
+    lookups.emplace_back(f, fp.CurrentFileRange(), fp.GetHitFileLevel(),
+                         fp.IsHitFileLastInLevel());
+    if (async_lookups) {
+      for (FdWithKeyRange* next = fp.GetNextFileInLevel(); next != nullptr;
+           next = fp.GetNextFileInLevel()) {
+        lookups.emplace_back(next, fp.CurrentFileRange(), fp.GetHitFileLevel(),
+                             fp.IsHitFileLastInLevel());
       }
-      return;
-    }
-    uint64_t batch_size = 0;
-    for (auto iter = file_range.begin(); s.ok() && iter != file_range.end();
-         ++iter) {
-      GetContext& get_context = *iter->get_context;
-      Status* status = iter->s;
-      // The Status in the KeyContext takes precedence over GetContext state
-      // Status may be an error if there were any IO errors in the table
-      // reader. We never expect Status to be NotFound(), as that is
-      // determined by get_context
-      assert(!status->IsNotFound());
-      if (!status->ok()) {
-        file_range.MarkKeyDone(iter);
-        continue;
+      const bool timer_enabled =
+          GetPerfLevel() >= PerfLevel::kEnableTimeExceptForMutex &&
+          get_perf_context()->per_level_perf_context_enabled;
+      for (auto& lookup : lookups) {
+        StopWatchNano timer(clock_, timer_enabled /* auto_start */);
+        table_cache_->StartMultiGet(
+            read_options, *internal_comparator(),
+            *lookup.file->file_metadata, &lookup.file_range,
+            mutable_cf_options_.prefix_extractor.get(),
+            cfd_->internal_stats()->GetFileReadHist(lookup.level),
+            IsFilterSkipped(static_cast<int>(lookup.level),
+                            lookup.is_last_in_level),
+            lookup.level, &lookup.pending);
+        lookup.start_nanos = timer.ElapsedNanos();
       }
-
-      if (get_context.sample()) {
-        sample_file_read_inc(f->file_metadata);
-      }
-      batch_size++;
-      num_index_read += get_context.get_context_stats_.num_index_read;
-      num_filter_read += get_context.get_context_stats_.num_filter_read;
-      num_data_read += get_context.get_context_stats_.num_data_read;
-      num_sst_read += get_context.get_context_stats_.num_sst_read;
-
-      // report the counters before returning
-      if (get_context.State() != GetContext::kNotFound &&
-          get_context.State() != GetContext::kMerge &&
-          db_statistics_ != nullptr) {
-        get_context.ReportCounters();
+      size_t num_lookups = lookups.size();
+      TEST_SYNC_POINT_CALLBACK("Version::MultiGet:AsyncLookups", &num_lookups);
+    }
+
+    for (; !lookups.empty(); lookups.pop_front()) {
+      FileLookup& lookup = lookups.front();
+      f = lookup.file;
+      MultiGetRange& file_range = lookup.file_range;
+      bool timer_enabled =
+          GetPerfLevel() >= PerfLevel::kEnableTimeExceptForMutex &&
+          get_perf_context()->per_level_perf_context_enabled;
+      StopWatchNano timer(clock_, timer_enabled /* auto_start */);
+      if (async_lookups) {
+        s = table_cache_->FinishMultiGet(&lookup.pending);
       } else {
-        if (iter->max_covering_tombstone_seq > 0) {
-          // The remaining files we look at will only contain covered keys, so
-          // we stop here for this key
-          file_picker_range.SkipKey(iter);
+        s = table_cache_->MultiGet(
+            read_options, *internal_comparator(), *f->file_metadata,
+            &file_range, mutable_cf_options_.prefix_extractor.get(),
+            cfd_->internal_stats()->GetFileReadHist(lookup.level),
+            IsFilterSkipped(static_cast<int>(lookup.level),
+                            lookup.is_last_in_level),
+            lookup.level);
+      }
+      // TODO: examine the behavior for corrupted key
+      if (timer_enabled) {
+        PERF_COUNTER_BY_LEVEL_ADD(get_from_table_nanos,
+                                  lookup.start_nanos + timer.ElapsedNanos(),
+                                  lookup.level);
+      }
+      if (!s.ok()) {
+        // TODO: Set status for individual keys appropriately
+        for (auto iter = file_range.begin(); iter != file_range.end(); ++iter) {
+          *iter->s = s;
+          file_range.MarkKeyDone(iter);
         }
+        lookups.pop_front();
+        lookup_failed = true;
+        break;
       }
-      switch (get_context.State()) {
-        case GetContext::kNotFound:
-          // Keep searching in other files
-          break;
-        case GetContext::kMerge:
-          // TODO: update per-level perfcontext user_key_return_count for kMerge
-          break;
-        case GetContext::kFound:
-          if (fp.GetHitFileLevel() == 0) {
-            RecordTick(db_statistics_, GET_HIT_L0);
-          } else if (fp.GetHitFileLevel() == 1) {
-            RecordTick(db_statistics_, GET_HIT_L1);
-          } else if (fp.GetHitFileLevel() >= 2) {
-            RecordTick(db_statistics_, GET_HIT_L2_AND_UP);
-          }
-
-          PERF_COUNTER_BY_LEVEL_ADD(user_key_return_count, 1,
-                                    fp.GetHitFileLevel());
-
+      uint64_t batch_size = 0;
+      for (auto iter = file_range.begin(); s.ok() && iter != file_range.end();
+           ++iter) {
+        GetContext& get_context = *iter->get_context;
+        Status* status = iter->s;
+        // The Status in the KeyContext takes precedence over GetContext state
+        // Status may be an error if there were any IO errors in the table
+        // reader. We never expect Status to be NotFound(), as that is
+        // determined by get_context
+        assert(!status->IsNotFound());
+        if (!status->ok()) {
           file_range.MarkKeyDone(iter);
+          continue;
+        }
 
-          if (iter->is_blob_index) {
-            if (iter->value) {
-              const Slice& blob_index_slice = *(iter->value);
-              BlobIndex blob_index;
-              Status tmp_s = blob_index.DecodeFrom(blob_index_slice);
-              if (tmp_s.ok()) {
-                const uint64_t blob_file_num = blob_index.file_number();
-                blob_rqs[blob_file_num].emplace_back(
-                    std::make_pair(blob_index, std::cref(*iter)));
-              } else {
-                *(iter->s) = tmp_s;
-              }
+        if (get_context.sample()) {
+          sample_file_read_inc(lookup.file->file_metadata);
+        }
+        batch_size++;
+        num_index_read += get_context.get_context_stats_.num_index_read;
+        num_filter_read += get_context.get_context_stats_.num_filter_read;
+        num_data_read += get_context.get_context_stats_.num_data_read;
+        num_sst_read += get_context.get_context_stats_.num_sst_read;
+
+        // report the counters before returning
+        if (get_context.State() != GetContext::kNotFound &&
+            get_context.State() != GetContext::kMerge &&
+            db_statistics_ != nullptr) {
+          get_context.ReportCounters();
+        } else {
+          if (iter->max_covering_tombstone_seq > 0) {
+            // The remaining files we look at will only contain covered keys, so
+            // we stop here for this key
+            file_picker_range.SkipKey(iter);
+          }
+        }
+        switch (get_context.State()) {
+          case GetContext::kNotFound:
+            // Keep searching in other files
+            break;
+          case GetContext::kMerge:
+            // TODO: update per-level perfcontext user_key_return_count for
+            // kMerge
+            break;
+          case GetContext::kFound:
+            if (lookup.level == 0) {
+              RecordTick(db_statistics_, GET_HIT_L0);
+            } else if (lookup.level == 1) {
+              RecordTick(db_statistics_, GET_HIT_L1);
+            } else if (lookup.level >= 2) {
+              RecordTick(db_statistics_, GET_HIT_L2_AND_UP);
             }
-          } else {
-            file_range.AddValueSize(iter->value->size());
-            if (file_range.GetValueSize() >
-                read_options.value_size_soft_limit) {
-              s = Status::Aborted();
-              break;
+
+            PERF_COUNTER_BY_LEVEL_ADD(user_key_return_count, 1,
+                                      lookup.level);
+
+            file_range.MarkKeyDone(iter);
+
+            if (iter->is_blob_index) {
+              if (iter->value) {
+                const Slice& blob_index_slice = *(iter->value);
+                BlobIndex blob_index;
+                Status tmp_s = blob_index.DecodeFrom(blob_index_slice);
+                if (tmp_s.ok()) {
+                  const uint64_t blob_file_num = blob_index.file_number();
+                  blob_rqs[blob_file_num].emplace_back(
+                      std::make_pair(blob_index, std::cref(*iter)));
+                } else {
+                  *(iter->s) = tmp_s;
+                }
+              }
+            } else {
+              file_range.AddValueSize(iter->value->size());
+              if (file_range.GetValueSize() >
+                  read_options.value_size_soft_limit) {
+                s = Status::Aborted();
+                break;
+              }
             }
-          }
-          continue;
-        case GetContext::kDeleted:
-          // Use empty error message for speed
-          *status = Status::NotFound();
-          file_range.MarkKeyDone(iter);
-          continue;
-        case GetContext::kCorrupt:
-          *status =
-              Status::Corruption("corrupted key for ", iter->lkey->user_key());
-          file_range.MarkKeyDone(iter);
-          continue;
-        case GetContext::kUnexpectedBlobIndex:
-          ROCKS_LOG_ERROR(info_log_, "Encounter unexpected blob index.");
-          *status = Status::NotSupported(
-              "Encounter unexpected blob index. Please open DB with "
-              "ROCKSDB_NAMESPACE::blob_db::BlobDB instead.");
-          file_range.MarkKeyDone(iter);
-          continue;
+            continue;
+          case GetContext::kDeleted:
+            // Use empty error message for speed
+            *status = Status::NotFound();
+            file_range.MarkKeyDone(iter);
+            continue;
+          case GetContext::kCorrupt:
+            *status = Status::Corruption("corrupted key for ",
+                                         iter->lkey->user_key());
+            file_range.MarkKeyDone(iter);
+            continue;
+          case GetContext::kUnexpectedBlobIndex:
+            ROCKS_LOG_ERROR(info_log_, "Encounter unexpected blob index.");
+            *status = Status::NotSupported(
+                "Encounter unexpected blob index. Please open DB with "
+                "ROCKSDB_NAMESPACE::blob_db::BlobDB instead.");
+            file_range.MarkKeyDone(iter);
+            continue;
+        }
       }
-    }
 
-    // Report MultiGet stats per level.
-    if (fp.IsHitFileLastInLevel()) {
-      // Dump the stats if this is the last file of this level and reset for
-      // next level.
-      RecordInHistogram(db_statistics_,
-                        NUM_INDEX_AND_FILTER_BLOCKS_READ_PER_LEVEL,
-                        num_index_read + num_filter_read);
-      RecordInHistogram(db_statistics_, NUM_DATA_BLOCKS_READ_PER_LEVEL,
-                        num_data_read);
-      RecordInHistogram(db_statistics_, NUM_SST_READ_PER_LEVEL, num_sst_read);
-      num_filter_read = 0;
-      num_index_read = 0;
-      num_data_read = 0;
-      num_sst_read = 0;
-    }
+      // Report MultiGet stats per level.
+      if (lookup.is_last_in_level) {
+        // Dump the stats if this is the last file of this level and reset for
+        // next level.
+        RecordInHistogram(db_statistics_,
+                          NUM_INDEX_AND_FILTER_BLOCKS_READ_PER_LEVEL,
+                          num_index_read + num_filter_read);
+        RecordInHistogram(db_statistics_, NUM_DATA_BLOCKS_READ_PER_LEVEL,
+                          num_data_read);
+        RecordInHistogram(db_statistics_, NUM_SST_READ_PER_LEVEL, num_sst_read);
+        num_filter_read = 0;
+        num_index_read = 0;
+        num_data_read = 0;
+        num_sst_read = 0;
+      }
 
-    RecordInHistogram(db_statistics_, SST_BATCH_SIZE, batch_size);
+      RecordInHistogram(db_statistics_, SST_BATCH_SIZE, batch_size);
+      if (!s.ok() || file_picker_range.empty()) {
+        lookups.pop_front();
+        break;
+      }
+    }
+    // Lookups started ahead of an error or of the batch completing still
+    // have to release their resources
+    for (auto& lookup : lookups) {
+      table_cache_->FinishMultiGet(&lookup.pending).PermitUncheckedError();
+    }
+    lookups.clear();
+    if (lookup_failed) {
+      return;
+    }
     if (!s.ok() || file_picker_range.empty()) {
       break;
     }
@@ -4363,7 +4436,7 @@ Status VersionSet::ProcessManifestWrites(
                builder_guards.size() == versions.size());
         ColumnFamilyData* cfd = versions[i]->cfd_;
         s = builder_guards[i]->version_builder()->LoadTableHandlers(
-            cfd->internal_stats(), 1 /* max_threads */,
+            cfd->internal_stats(), 1 /* max_threads */, 1 /* batch_size */,
             true /* prefetch_index_and_filter_in_cache */,
             false /* is_initial_load */,
             mutable_cf_options_ptrs[i]->prefix_extractor.get(),
@@ -271,7 +271,9 @@ class PosixFileSystem : public FileSystem {
           options
 #if defined(ROCKSDB_IOURING_PRESENT)
           ,
-          !IsIOUringEnabled() ? nullptr : thread_local_io_urings_.get()
+          !IsIOUringEnabled() ? nullptr : thread_local_io_urings_.get(),
+          !IsIOUringEnabled() ? nullptr
+                              : thread_local_async_read_io_urings_.get()
 #endif
               ));
     }
@@ -996,6 +998,39 @@ class PosixFileSystem : public FileSystem {
     return Status::OK();
   }
 #endif
+#if defined(ROCKSDB_IOURING_PRESENT)
+  IOStatus Poll(std::vector<void*>& io_handles,
+                size_t /*min_completions*/) override {
+    // Simply wait for all of the reads; they were submitted from this thread,
+    // so their completions are in this thread's ring.
+    for (void* io_handle : io_handles) {
+      Posix_IOHandle* posix_handle = static_cast<Posix_IOHandle*>(io_handle);
+      while (!posix_handle->is_finished) {
+        struct io_uring_cqe* cqe = nullptr;
+        int ret = io_uring_wait_cqe(posix_handle->iu, &cqe);
+        if (ret) {
+          return IOStatus::IOError("io_uring_wait_cqe() returns " +
+                                   ToString(ret));
+        }
+        // The completion may belong to another read submitted from this
+        // thread; finish whichever one it is.
+        Posix_IOHandle* finished =
+            static_cast<Posix_IOHandle*>(io_uring_cqe_get_data(cqe));
+        int res = cqe->res;
+        io_uring_cqe_seen(posix_handle->iu, cqe);
+        FinishPosixAsyncRead(finished, res);
+      }
+    }
+    return IOStatus::OK();
+  }
+
+  IOStatus AbortIO(std::vector<void*>& io_handles) override {
+    // Reads from local files complete quickly, so waiting for them is
+    // simpler than cancelling them.
+    return Poll(io_handles, io_handles.size());
+  }
+#endif  // defined(ROCKSDB_IOURING_PRESENT)
+
  private:
   bool checkedDiskForMmap_;
   bool forceMmapOff_;  // do we override Env options?
@@ -1044,6 +1079,8 @@ class PosixFileSystem : public FileSystem {
 #if defined(ROCKSDB_IOURING_PRESENT)
   // io_uring instance
   std::unique_ptr<ThreadLocalPtr> thread_local_io_urings_;
+  // io_uring instance for asynchronous reads
+  std::unique_ptr<ThreadLocalPtr> thread_local_async_read_io_urings_;
 #endif
 
   size_t page_size_;
@@ -1105,6 +1142,8 @@ PosixFileSystem::PosixFileSystem()
   struct io_uring* new_io_uring = CreateIOUring();
   if (new_io_uring != nullptr) {
     thread_local_io_urings_.reset(new ThreadLocalPtr(DeleteIOUring));
+    thread_local_async_read_io_urings_.reset(
+        new ThreadLocalPtr(DeleteIOUring));
     delete new_io_uring;
   }
 #endif
@@ -545,7 +545,8 @@ PosixRandomAccessFile::PosixRandomAccessFile(
     const EnvOptions& options
 #if defined(ROCKSDB_IOURING_PRESENT)
     ,
-    ThreadLocalPtr* thread_local_io_urings
+    ThreadLocalPtr* thread_local_io_urings,
+    ThreadLocalPtr* thread_local_async_read_io_urings
 #endif
     )
     : filename_(fname),
@@ -554,7 +555,8 @@ PosixRandomAccessFile::PosixRandomAccessFile(
       logical_sector_size_(logical_block_size)
 #if defined(ROCKSDB_IOURING_PRESENT)
       ,
-      thread_local_io_urings_(thread_local_io_urings)
+      thread_local_io_urings_(thread_local_io_urings),
+      thread_local_async_read_io_urings_(thread_local_async_read_io_urings)
 #endif
 {
   assert(!options.use_direct_reads || !options.use_mmap_reads);
@@ -796,6 +798,114 @@ IOStatus PosixRandomAccessFile::MultiRead(FSReadRequest* reqs,
 #endif
 }
 
+#if defined(ROCKSDB_IOURING_PRESENT)
+IOStatus PosixRandomAccessFile::ReadAsync(
+    FSReadRequest& req, const IOOptions& opts,
+    std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+    void** io_handle, IOHandleDeleter* del_fn, IODebugContext* dbg) {
+  if (use_direct_io()) {
+    assert(IsSectorAligned(req.offset, GetRequiredBufferAlignment()));
+    assert(IsSectorAligned(req.len, GetRequiredBufferAlignment()));
+    assert(IsSectorAligned(req.scratch, GetRequiredBufferAlignment()));
+  }
+
+  struct io_uring* iu = nullptr;
+  if (thread_local_async_read_io_urings_) {
+    iu = static_cast<struct io_uring*>(
+        thread_local_async_read_io_urings_->Get());
+    if (iu == nullptr) {
+      iu = CreateIOUring();
+      if (iu != nullptr) {
+        thread_local_async_read_io_urings_->Reset(iu);
+      }
+    }
+  }
+
+  // Init failed, platform doesn't support io_uring. Fall back to a
+  // synchronous read.
+  if (iu == nullptr) {
+    return FSRandomAccessFile::ReadAsync(req, opts, cb, cb_arg, io_handle,
+                                         del_fn, dbg);
+  }
+
+  struct io_uring_sqe* sqe = io_uring_get_sqe(iu);
+  if (sqe == nullptr) {
+    // The submission queue is full.
+    return FSRandomAccessFile::ReadAsync(req, opts, cb, cb_arg, io_handle,
+                                         del_fn, dbg);
+  }
+
+  Posix_IOHandle* posix_handle = new Posix_IOHandle();
+  posix_handle->iov.iov_base = req.scratch;
+  posix_handle->iov.iov_len = req.len;
+  posix_handle->iu = iu;
+  posix_handle->cb = cb;
+  posix_handle->cb_arg = cb_arg;
+  posix_handle->offset = req.offset;
+  posix_handle->len = req.len;
+  posix_handle->scratch = req.scratch;
+  posix_handle->fd = fd_;
+  posix_handle->filename = &filename_;
+  posix_handle->use_direct_io = use_direct_io();
+  posix_handle->alignment = GetRequiredBufferAlignment();
+
+  io_uring_prep_readv(sqe, fd_, &posix_handle->iov, 1, req.offset);
+  io_uring_sqe_set_data(sqe, posix_handle);
+
+  ssize_t ret = io_uring_submit(iu);
+  TEST_SYNC_POINT_CALLBACK("PosixRandomAccessFile::ReadAsync:io_uring_submit",
+                           &ret);
+  if (ret < 0) {
+    delete posix_handle;
+    return IOError("io_uring_submit() returns " + ToString(ret), filename_,
+                   static_cast<int>(-ret));
+  }
+  *io_handle = posix_handle;
+  *del_fn = DeletePosixIOHandle;
+  return IOStatus::OK();
+}
+
+void FinishPosixAsyncRead(Posix_IOHandle* posix_handle, int res) {
+  assert(!posix_handle->is_finished);
+  FSReadRequest req;
+  req.offset = posix_handle->offset;
+  req.len = posix_handle->len;
+  req.scratch = posix_handle->scratch;
+  if (res < 0) {
+    req.result = Slice(req.scratch, 0);
+    req.status = IOError("Req failed", *posix_handle->filename, -res);
+  } else {
+    size_t finished_len = static_cast<size_t>(res);
+    // A short read means EOF or a partial result; see the comment in
+    // PosixRandomAccessFile::MultiRead(). Read the rest synchronously.
+    bool eof = posix_handle->use_direct_io &&
+               !IsSectorAligned(finished_len, posix_handle->alignment);
+    while (!eof && finished_len < req.len) {
+      ssize_t r = pread(posix_handle->fd, req.scratch + finished_len,
+                        req.len - finished_len,
+                        static_cast<off_t>(req.offset + finished_len));
+      if (r < 0 && errno == EINTR) {
+        continue;
+      }
+      if (r < 0) {
+        req.status = IOError("While pread offset " +
+                                 ToString(req.offset + finished_len) +
+                                 " len " + ToString(req.len - finished_len),
+                             *posix_handle->filename, errno);
+        break;
+      }
+      finished_len += static_cast<size_t>(r);
+      eof = r == 0 || (posix_handle->use_direct_io &&
+                       !IsSectorAligned(static_cast<size_t>(r),
+                                        posix_handle->alignment));
+    }
+    req.result = Slice(req.scratch, req.status.ok() ? finished_len : 0);
+  }
+  posix_handle->is_finished = true;
+  posix_handle->cb(req, posix_handle->cb_arg);
+}
+#endif  // defined(ROCKSDB_IOURING_PRESENT)
+
 IOStatus PosixRandomAccessFile::Prefetch(uint64_t offset, size_t n,
                                          const IOOptions& /*opts*/,
                                          IODebugContext* /*dbg*/) {
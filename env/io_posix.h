@@ -167,6 +167,31 @@ inline struct io_uring* CreateIOUring() {
   }
   return new_io_uring;
 }
+
+// State of a read submitted by PosixRandomAccessFile::ReadAsync(), kept until
+// its completion is reaped by PosixFileSystem::Poll() or AbortIO().
+struct Posix_IOHandle {
+  struct iovec iov;
+  struct io_uring* iu;
+  std::function<void(const FSReadRequest&, void*)> cb;
+  void* cb_arg;
+  uint64_t offset;
+  size_t len;
+  char* scratch;
+  int fd;
+  const std::string* filename;
+  bool use_direct_io;
+  size_t alignment;
+  bool is_finished = false;
+};
+
+inline void DeletePosixIOHandle(void* p) {
+  delete static_cast<Posix_IOHandle*>(p);
+}
+
+// Completes the read of posix_handle, whose io_uring completion returned res,
+// and invokes its callback. Short reads are completed synchronously.
+void FinishPosixAsyncRead(Posix_IOHandle* posix_handle, int res);
 #endif  // defined(ROCKSDB_IOURING_PRESENT)
 
 class PosixRandomAccessFile : public FSRandomAccessFile {
@@ -177,6 +202,9 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
   size_t logical_sector_size_;
 #if defined(ROCKSDB_IOURING_PRESENT)
   ThreadLocalPtr* thread_local_io_urings_;
+  // Kept apart from thread_local_io_urings_ so that MultiRead() never reaps
+  // the completions of asynchronous reads.
+  ThreadLocalPtr* thread_local_async_read_io_urings_;
 #endif
 
  public:
@@ -185,7 +213,8 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
                         const EnvOptions& options
 #if defined(ROCKSDB_IOURING_PRESENT)
                         ,
-                        ThreadLocalPtr* thread_local_io_urings
+                        ThreadLocalPtr* thread_local_io_urings,
+                        ThreadLocalPtr* thread_local_async_read_io_urings
 #endif
   );
   virtual ~PosixRandomAccessFile();
@@ -201,6 +230,13 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
   virtual IOStatus Prefetch(uint64_t offset, size_t n, const IOOptions& opts,
                             IODebugContext* dbg) override;
 
+#if defined(ROCKSDB_IOURING_PRESENT)
+  virtual IOStatus ReadAsync(
+      FSReadRequest& req, const IOOptions& opts,
+      std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+      void** io_handle, IOHandleDeleter* del_fn, IODebugContext* dbg) override;
+#endif
+
 #if defined(OS_LINUX) || defined(OS_MACOSX) || defined(OS_AIX)
   virtual size_t GetUniqueId(char* id, size_t max_size) const override;
 #endif
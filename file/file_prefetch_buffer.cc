@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <mutex>
+#include <vector>
 
 #include "file/random_access_file_reader.h"
 #include "monitoring/histogram.h"
@@ -29,6 +30,10 @@ Status FilePrefetchBuffer::Prefetch(const IOOptions& opts,
     return Status::OK();
   }
   TEST_SYNC_POINT("FilePrefetchBuffer::Prefetch:Start");
+  if (bufs_[curr_].async_read_in_progress_) {
+    // Submitted by SubmitPrefetch()
+    WaitForAsyncRead(curr_);
+  }
   size_t alignment = reader->file()->GetRequiredBufferAlignment();
   size_t offset_ = static_cast<size_t>(offset);
   uint64_t rounddown_offset = Rounddown(offset_, alignment);
@@ -37,19 +42,20 @@ Status FilePrefetchBuffer::Prefetch(const IOOptions& opts,
   assert(roundup_len >= alignment);
   assert(roundup_len % alignment == 0);
 
-  // Check if requested bytes are in the existing buffer_.
+  // Check if requested bytes are in the existing buffer.
   // If all bytes exist -- return.
   // If only a few bytes exist -- reuse them & read only what is really needed.
   //     This is typically the case of incremental reading of data.
   // If no bytes exist in buffer -- full pread.
 
   Status s;
+  BufferInfo& buf = bufs_[curr_];
   uint64_t chunk_offset_in_buffer = 0;
   uint64_t chunk_len = 0;
   bool copy_data_to_new_buffer = false;
-  if (buffer_.CurrentSize() > 0 && offset >= buffer_offset_ &&
-      offset <= buffer_offset_ + buffer_.CurrentSize()) {
-    if (offset + n <= buffer_offset_ + buffer_.CurrentSize()) {
+  if (buf.buffer_.CurrentSize() > 0 && offset >= buf.offset_ &&
+      offset <= buf.offset_ + buf.buffer_.CurrentSize()) {
+    if (offset + n <= buf.offset_ + buf.buffer_.CurrentSize()) {
       // All requested bytes are already in the buffer. So no need to Read
       // again.
       return s;
@@ -58,12 +64,12 @@ Status FilePrefetchBuffer::Prefetch(const IOOptions& opts,
       // bytes to the beginning, and memcpy them back into the new buffer if a
       // new buffer is created.
       chunk_offset_in_buffer =
-          Rounddown(static_cast<size_t>(offset - buffer_offset_), alignment);
-      chunk_len = buffer_.CurrentSize() - chunk_offset_in_buffer;
+          Rounddown(static_cast<size_t>(offset - buf.offset_), alignment);
+      chunk_len = buf.buffer_.CurrentSize() - chunk_offset_in_buffer;
       assert(chunk_offset_in_buffer % alignment == 0);
       assert(chunk_len % alignment == 0);
       assert(chunk_offset_in_buffer + chunk_len <=
-             buffer_offset_ + buffer_.CurrentSize());
+             buf.offset_ + buf.buffer_.CurrentSize());
       if (chunk_len > 0) {
         copy_data_to_new_buffer = true;
       } else {
@@ -75,22 +81,24 @@ Status FilePrefetchBuffer::Prefetch(const IOOptions& opts,
 
   // Create a new buffer only if current capacity is not sufficient, and memcopy
   // bytes from old buffer if needed (i.e., if chunk_len is greater than 0).
-  if (buffer_.Capacity() < roundup_len) {
-    buffer_.Alignment(alignment);
-    buffer_.AllocateNewBuffer(static_cast<size_t>(roundup_len),
-                              copy_data_to_new_buffer, chunk_offset_in_buffer,
-                              static_cast<size_t>(chunk_len));
+  if (buf.buffer_.Capacity() < roundup_len) {
+    buf.buffer_.Alignment(alignment);
+    buf.buffer_.AllocateNewBuffer(static_cast<size_t>(roundup_len),
+                                  copy_data_to_new_buffer,
+                                  chunk_offset_in_buffer,
+                                  static_cast<size_t>(chunk_len));
   } else if (chunk_len > 0) {
     // New buffer not needed. But memmove bytes from tail to the beginning since
     // chunk_len is greater than 0.
-    buffer_.RefitTail(static_cast<size_t>(chunk_offset_in_buffer),
-                      static_cast<size_t>(chunk_len));
+    buf.buffer_.RefitTail(static_cast<size_t>(chunk_offset_in_buffer),
+                          static_cast<size_t>(chunk_len));
   }
 
   Slice result;
   size_t read_len = static_cast<size_t>(roundup_len - chunk_len);
   s = reader->Read(opts, rounddown_offset + chunk_len, read_len, &result,
-                   buffer_.BufferStart() + chunk_len, nullptr, for_compaction);
+                   buf.buffer_.BufferStart() + chunk_len, nullptr,
+                   for_compaction);
   if (!s.ok()) {
     return s;
   }
@@ -102,11 +110,25 @@ Status FilePrefetchBuffer::Prefetch(const IOOptions& opts,
     IGNORE_STATUS_IF_ERROR(Status::IOError());
   }
 #endif
-  buffer_offset_ = rounddown_offset;
-  buffer_.Size(static_cast<size_t>(chunk_len) + result.size());
+  buf.offset_ = rounddown_offset;
+  buf.buffer_.Size(static_cast<size_t>(chunk_len) + result.size());
   return s;
 }
 
+void FilePrefetchBuffer::SubmitPrefetch(const IOOptions& opts,
+                                        RandomAccessFileReader* reader,
+                                        uint64_t offset, size_t n) {
+  assert(fs_ != nullptr);
+  assert(!async_io_);
+  if (!enable_ || reader == nullptr || n == 0) {
+    return;
+  }
+  if (bufs_[curr_].async_read_in_progress_) {
+    WaitForAsyncRead(curr_);
+  }
+  ReadAsync(opts, reader, curr_, offset, n, false /* for_compaction */);
+}
+
 bool FilePrefetchBuffer::TryReadFromCache(const IOOptions& opts,
                                           RandomAccessFileReader* reader,
                                           uint64_t offset, size_t n,
@@ -115,7 +137,15 @@ bool FilePrefetchBuffer::TryReadFromCache(const IOOptions& opts,
   if (track_min_offset_ && offset < min_offset_read_) {
     min_offset_read_ = static_cast<size_t>(offset);
   }
-  if (!enable_ || offset < buffer_offset_) {
+  if (async_io_) {
+    return TryReadFromCacheAsync(opts, reader, offset, n, result, status,
+                                 for_compaction);
+  }
+  if (bufs_[curr_].async_read_in_progress_) {
+    // Submitted by SubmitPrefetch()
+    WaitForAsyncRead(curr_);
+  }
+  if (!enable_ || offset < bufs_[curr_].offset_) {
     return false;
   }
 
@@ -125,7 +155,7 @@ bool FilePrefetchBuffer::TryReadFromCache(const IOOptions& opts,
   //    If readahead is not enabled: return false.
   TEST_SYNC_POINT_CALLBACK("FilePrefetchBuffer::TryReadFromCache",
                            &readahead_size_);
-  if (offset + n > buffer_offset_ + buffer_.CurrentSize()) {
+  if (offset + n > bufs_[curr_].End()) {
     if (readahead_size_ > 0) {
       assert(reader != nullptr);
       assert(max_readahead_size_ >= readahead_size_);
@@ -169,8 +199,294 @@ bool FilePrefetchBuffer::TryReadFromCache(const IOOptions& opts,
     }
   }
   UpdateReadPattern(offset, n);
-  uint64_t offset_in_buffer = offset - buffer_offset_;
-  *result = Slice(buffer_.BufferStart() + offset_in_buffer, n);
+  uint64_t offset_in_buffer = offset - bufs_[curr_].offset_;
+  *result = Slice(bufs_[curr_].buffer_.BufferStart() + offset_in_buffer, n);
   return true;
 }
+
+bool FilePrefetchBuffer::TryReadFromCacheAsync(const IOOptions& opts,
+                                               RandomAccessFileReader* reader,
+                                               uint64_t offset, size_t n,
+                                               Slice* result, Status* status,
+                                               bool for_compaction) {
+  // Data is only ever read ahead, so bytes before the current buffer are in
+  // neither buffer.
+  if (!enable_ || offset < bufs_[curr_].offset_) {
+    return false;
+  }
+
+  TEST_SYNC_POINT_CALLBACK("FilePrefetchBuffer::TryReadFromCache",
+                           &readahead_size_);
+  if (offset + n > bufs_[curr_].End()) {
+    if (readahead_size_ == 0) {
+      return false;
+    }
+    assert(reader != nullptr);
+    assert(max_readahead_size_ >= readahead_size_);
+    if (implicit_auto_readahead_) {
+      // Prefetch only if this read is sequential otherwise reset
+      // readahead_size_ to initial value.
+      if (!IsBlockSequential(offset)) {
+        UpdateReadPattern(offset, n);
+        ResetValues();
+        return false;
+      }
+      num_file_reads_++;
+      if (num_file_reads_ <= kMinNumFileReadsToStartAutoReadahead) {
+        UpdateReadPattern(offset, n);
+        return false;
+      }
+    }
+    Status s = PrefetchAsync(opts, reader, offset, n, for_compaction);
+    if (!s.ok()) {
+      if (status) {
+        *status = s;
+      }
+#ifndef NDEBUG
+      IGNORE_STATUS_IF_ERROR(s);
+#endif
+      return false;
+    }
+    readahead_size_ = std::min(max_readahead_size_, readahead_size_ * 2);
+    if (offset + n > bufs_[curr_].End()) {
+      // Hit the end of the file.
+      return false;
+    }
+  }
+  UpdateReadPattern(offset, n);
+  uint64_t offset_in_buffer = offset - bufs_[curr_].offset_;
+  *result = Slice(bufs_[curr_].buffer_.BufferStart() + offset_in_buffer, n);
+  return true;
+}
+
+Status FilePrefetchBuffer::PrefetchAsync(const IOOptions& opts,
+                                         RandomAccessFileReader* reader,
+                                         uint64_t offset, size_t n,
+                                         bool for_compaction) {
+  uint32_t second = curr_ ^ 1;
+  WaitForAsyncRead(second);
+  if (!bufs_[second].async_read_status_.ok()) {
+    // Drop the failed readahead. The bytes are read synchronously below, which
+    // reports the error if it persists.
+    bufs_[second].async_read_status_ = IOStatus::OK();
+    bufs_[second].buffer_.Clear();
+  }
+
+  // Switch to the other buffer if it holds the start of the request.
+  if (offset >= bufs_[curr_].End() && offset >= bufs_[second].offset_ &&
+      offset < bufs_[second].End()) {
+    bufs_[curr_].buffer_.Clear();
+    curr_ = second;
+    second = curr_ ^ 1;
+  }
+
+  BufferInfo& curr = bufs_[curr_];
+  BufferInfo& next = bufs_[second];
+  if (offset + n > curr.End()) {
+    if (offset >= curr.offset_ && offset < curr.End() &&
+        next.buffer_.CurrentSize() > 0 && next.offset_ == curr.End()) {
+      // The request spans both buffers. Combine the tail of the current
+      // buffer with the other buffer instead of reading those bytes again.
+      size_t alignment = reader->file()->GetRequiredBufferAlignment();
+      size_t chunk_offset =
+          Rounddown(static_cast<size_t>(offset - curr.offset_), alignment);
+      size_t chunk_len = curr.buffer_.CurrentSize() - chunk_offset;
+      AlignedBuffer combined;
+      combined.Alignment(alignment);
+      combined.AllocateNewBuffer(chunk_len + next.buffer_.CurrentSize());
+      combined.Append(curr.buffer_.BufferStart() + chunk_offset, chunk_len);
+      combined.Append(next.buffer_.BufferStart(), next.buffer_.CurrentSize());
+      curr.buffer_ = std::move(combined);
+      curr.offset_ += chunk_offset;
+      next.buffer_.Clear();
+    }
+    if (offset + n > curr.End()) {
+      Status s = Prefetch(opts, reader, offset, n, for_compaction);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+  }
+
+  // Read the next readahead window into the other buffer, unless it already
+  // holds it or the current buffer ends at the end of the file.
+  if (next.buffer_.CurrentSize() > 0 && next.offset_ != curr.End()) {
+    next.buffer_.Clear();
+  }
+  if (next.buffer_.CurrentSize() == 0 && offset + n <= curr.End()) {
+    ReadAsync(opts, reader, second, curr.End(), readahead_size_,
+              for_compaction);
+  }
+  return Status::OK();
+}
+
+void FilePrefetchBuffer::ReadAsync(const IOOptions& opts,
+                                   RandomAccessFileReader* reader,
+                                   uint32_t index, uint64_t offset, size_t n,
+                                   bool for_compaction) {
+  BufferInfo& buf = bufs_[index];
+  assert(!buf.async_read_in_progress_);
+  size_t alignment = reader->file()->GetRequiredBufferAlignment();
+  uint64_t rounddown_offset = Rounddown(static_cast<size_t>(offset), alignment);
+  uint64_t roundup_len =
+      Roundup(static_cast<size_t>(offset + n), alignment) - rounddown_offset;
+  if (buf.buffer_.Capacity() < roundup_len) {
+    buf.buffer_.Alignment(alignment);
+    buf.buffer_.AllocateNewBuffer(static_cast<size_t>(roundup_len));
+  }
+  buf.buffer_.Size(0);
+  buf.offset_ = rounddown_offset;
+
+  // Split the read into up to async_io_depth_ aligned requests. The callbacks
+  // refer to the requests, so async_requests_ must not be resized until they
+  // have all completed.
+  size_t request_len = Roundup(
+      (static_cast<size_t>(roundup_len) + async_io_depth_ - 1) /
+          async_io_depth_,
+      alignment);
+  size_t num_requests =
+      (static_cast<size_t>(roundup_len) + request_len - 1) / request_len;
+  buf.async_requests_.clear();
+  buf.async_requests_.resize(num_requests);
+  buf.num_pending_requests_ = num_requests;
+  buf.async_read_in_progress_ = true;
+  buf.async_read_status_ = IOStatus::OK();
+  TEST_SYNC_POINT("FilePrefetchBuffer::ReadAsync:Start");
+  for (size_t i = 0; i < num_requests; ++i) {
+    AsyncRequest& async_req = buf.async_requests_[i];
+    async_req.buf = &buf;
+    async_req.offset_in_buffer = i * request_len;
+    async_req.len = std::min(
+        request_len, static_cast<size_t>(roundup_len) - i * request_len);
+    async_req.in_progress = true;
+
+    FSReadRequest req;
+    req.offset = rounddown_offset + async_req.offset_in_buffer;
+    req.len = async_req.len;
+    req.scratch = buf.buffer_.BufferStart() + async_req.offset_in_buffer;
+    TEST_SYNC_POINT_CALLBACK("FilePrefetchBuffer::ReadAsync:Request", &req);
+    IOStatus s = reader->ReadAsync(
+        req, opts,
+        [this](const FSReadRequest& read_req, void* cb_arg) {
+          AsyncReadCallback(read_req, cb_arg);
+        },
+        &async_req, &async_req.io_handle, &async_req.del_fn, for_compaction);
+    if (!s.ok()) {
+      // The readahead is best-effort; the data will be read synchronously
+      // when needed. The requests submitted so far still complete.
+      async_req.in_progress = false;
+      if (buf.async_read_status_.ok()) {
+        buf.async_read_status_ = s;
+      }
+      buf.num_pending_requests_ -= num_requests - i;
+      if (buf.num_pending_requests_ == 0) {
+        FinishAsyncRead(&buf);
+      }
+      break;
+    }
+  }
+}
+
+void FilePrefetchBuffer::AsyncReadCallback(const FSReadRequest& req,
+                                           void* cb_arg) {
+  AsyncRequest* async_req = static_cast<AsyncRequest*>(cb_arg);
+  BufferInfo* buf = async_req->buf;
+  assert(async_req->in_progress);
+  assert(buf->num_pending_requests_ > 0);
+  if (req.status.ok()) {
+    assert(req.result.size() <= async_req->len);
+    char* dest = buf->buffer_.BufferStart() + async_req->offset_in_buffer;
+    if (req.result.data() != dest) {
+      // The file system may return data from its own buffer (e.g. mmap).
+      memcpy(dest, req.result.data(), req.result.size());
+    }
+    async_req->result_len = req.result.size();
+  } else if (buf->async_read_status_.ok()) {
+    buf->async_read_status_ = req.status;
+  }
+  async_req->in_progress = false;
+  if (--buf->num_pending_requests_ == 0) {
+    FinishAsyncRead(buf);
+  }
+}
+
+void FilePrefetchBuffer::FinishAsyncRead(BufferInfo* buf) {
+  size_t size = 0;
+  if (buf->async_read_status_.ok()) {
+    // A short read means the end of the file; the data ends there.
+    for (const AsyncRequest& async_req : buf->async_requests_) {
+      size += async_req.result_len;
+      if (async_req.result_len < async_req.len) {
+        break;
+      }
+    }
+  }
+  buf->buffer_.Size(size);
+  buf->async_read_in_progress_ = false;
+}
+
+void FilePrefetchBuffer::WaitForAsyncRead(uint32_t index) {
+  BufferInfo& buf = bufs_[index];
+  if (buf.async_read_in_progress_) {
+    std::vector<void*> handles;
+    for (const AsyncRequest& async_req : buf.async_requests_) {
+      if (async_req.in_progress && async_req.io_handle != nullptr) {
+        handles.push_back(async_req.io_handle);
+      }
+    }
+    if (!handles.empty()) {
+      IOStatus s = fs_->Poll(handles, handles.size());
+      if (!s.ok()) {
+        buf.async_read_status_ = s;
+      }
+    }
+  }
+  if (buf.async_read_in_progress_) {
+    // Polling failed; make sure the read won't touch the buffer anymore.
+    AbortAsyncRead(index);
+    return;
+  }
+  ReleaseIOHandles(index);
+}
+
+void FilePrefetchBuffer::AbortAsyncRead(uint32_t index) {
+  BufferInfo& buf = bufs_[index];
+  if (buf.async_read_in_progress_) {
+    std::vector<void*> handles;
+    for (const AsyncRequest& async_req : buf.async_requests_) {
+      if (async_req.in_progress && async_req.io_handle != nullptr) {
+        handles.push_back(async_req.io_handle);
+      }
+    }
+    if (!handles.empty()) {
+      IOStatus s = fs_->AbortIO(handles);
+      s.PermitUncheckedError();
+    }
+  }
+  ReleaseIOHandles(index);
+  if (buf.async_read_in_progress_) {
+    buf.async_read_in_progress_ = false;
+    buf.num_pending_requests_ = 0;
+    buf.buffer_.Clear();
+    if (buf.async_read_status_.ok()) {
+      buf.async_read_status_ = IOStatus::IOError("Readahead aborted");
+    }
+  }
+}
+
+void FilePrefetchBuffer::ReleaseIOHandles(uint32_t index) {
+  for (AsyncRequest& async_req : bufs_[index].async_requests_) {
+    if (async_req.io_handle != nullptr && async_req.del_fn != nullptr) {
+      async_req.del_fn(async_req.io_handle);
+    }
+    async_req.io_handle = nullptr;
+    async_req.del_fn = nullptr;
+  }
+}
+
+FilePrefetchBuffer::~FilePrefetchBuffer() {
+  for (uint32_t i = 0; i < 2; ++i) {
+    AbortAsyncRead(i);
+  }
+}
 }  // namespace ROCKSDB_NAMESPACE
@@ -12,10 +12,12 @@
 #include <atomic>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "file/readahead_file_info.h"
 #include "port/port.h"
 #include "rocksdb/env.h"
+#include "rocksdb/file_system.h"
 #include "rocksdb/options.h"
 #include "util/aligned_buffer.h"
 
@@ -48,6 +50,12 @@ class FilePrefetchBuffer {
   //   it. Used for adaptable readahead of the file footer/metadata.
   // implicit_auto_readahead : Readahead is enabled implicitly by rocksdb after
   //   doing sequential scans for two times.
+  // async_io : Readahead is double-buffered: the next readahead window is
+  //   read asynchronously into the second buffer while the first one is
+  //   being consumed. Requires fs, which is used to wait for the asynchronous
+  //   reads.
+  // async_io_depth : With async_io, the number of requests that each
+  //   asynchronous readahead is split into. They are in flight together.
   //
   // Automatic readhead is enabled for a file if readahead_size
   // and max_readahead_size are passed in.
@@ -55,8 +63,10 @@ class FilePrefetchBuffer {
   // `Prefetch` to load data into the buffer.
   FilePrefetchBuffer(size_t readahead_size = 0, size_t max_readahead_size = 0,
                      bool enable = true, bool track_min_offset = false,
-                     bool implicit_auto_readahead = false)
-      : buffer_offset_(0),
+                     bool implicit_auto_readahead = false,
+                     bool async_io = false, FileSystem* fs = nullptr,
+                     int async_io_depth = 1)
+      : curr_(0),
         readahead_size_(readahead_size),
         max_readahead_size_(max_readahead_size),
         min_offset_read_(port::kMaxSizet),
@@ -65,7 +75,12 @@ class FilePrefetchBuffer {
         implicit_auto_readahead_(implicit_auto_readahead),
         prev_offset_(0),
         prev_len_(0),
-        num_file_reads_(kMinNumFileReadsToStartAutoReadahead + 1) {}
+        num_file_reads_(kMinNumFileReadsToStartAutoReadahead + 1),
+        async_io_(async_io && fs != nullptr),
+        fs_(fs),
+        async_io_depth_(static_cast<size_t>(std::max(async_io_depth, 1))) {}
+
+  ~FilePrefetchBuffer();
 
   // Load data into the buffer from a file.
   // reader : the file reader.
@@ -75,6 +90,14 @@ class FilePrefetchBuffer {
   Status Prefetch(const IOOptions& opts, RandomAccessFileReader* reader,
                   uint64_t offset, size_t n, bool for_compaction = false);
 
+  // Like Prefetch(), but submits an asynchronous read and returns at once, so
+  // that reads of many files can be in flight together. Prefetch() and
+  // TryReadFromCache() wait for the read. If it fails, the data is not in the
+  // buffer, and is read from the file when needed. Requires fs, and not
+  // async_io.
+  void SubmitPrefetch(const IOOptions& opts, RandomAccessFileReader* reader,
+                      uint64_t offset, size_t n);
+
   // Tries returning the data for a file read from this buffer if that data is
   // in the buffer.
   // It handles tracking the minimum read offset if track_min_offset = true.
@@ -92,6 +115,11 @@ class FilePrefetchBuffer {
                         uint64_t offset, size_t n, Slice* result, Status* s,
                         bool for_compaction = false);
 
+  // Returns true if an asynchronous readahead is in flight. For tests.
+  bool TEST_AsyncReadInProgress() const {
+    return bufs_[curr_ ^ 1].async_read_in_progress_;
+  }
+
   // The minimum `offset` ever passed to TryReadFromCache(). This will nly be
   // tracked if track_min_offset = true.
   size_t min_offset_read() const { return min_offset_read_; }
@@ -136,7 +164,7 @@ class FilePrefetchBuffer {
     //   - num_file_reads_ + 1 (including this read) >
     //   kMinNumFileReadsToStartAutoReadahead
     if (implicit_auto_readahead_ && readahead_size_ > 0) {
-      if ((offset + size > buffer_offset_ + buffer_.CurrentSize()) &&
+      if ((offset + size > bufs_[curr_].End()) &&
           IsBlockSequential(offset) &&
           (num_file_reads_ + 1 > kMinNumFileReadsToStartAutoReadahead)) {
         size_t initial_auto_readahead_size = kInitAutoReadaheadSize;
@@ -148,8 +176,78 @@ class FilePrefetchBuffer {
   }
 
  private:
-  AlignedBuffer buffer_;
-  uint64_t buffer_offset_;
+  struct BufferInfo;
+
+  // One of the requests that an asynchronous read into a buffer is split
+  // into.
+  struct AsyncRequest {
+    BufferInfo* buf = nullptr;
+    // The part of buf->buffer_ read by this request
+    size_t offset_in_buffer = 0;
+    size_t len = 0;
+    // Number of bytes read, once the request has completed
+    size_t result_len = 0;
+    bool in_progress = false;
+    void* io_handle = nullptr;
+    IOHandleDeleter del_fn = nullptr;
+  };
+
+  // One of the two buffers; only bufs_[curr_] is used unless async_io_.
+  struct BufferInfo {
+    AlignedBuffer buffer_;
+    // File offset of the first byte in buffer_
+    uint64_t offset_ = 0;
+    // An asynchronous read into buffer_ is in flight. buffer_ must not be
+    // touched until it has completed.
+    bool async_read_in_progress_ = false;
+    // Status of the last asynchronous read into buffer_
+    IOStatus async_read_status_;
+    // The requests of the last asynchronous read into buffer_, and the number
+    // of them that have not completed yet
+    std::vector<AsyncRequest> async_requests_;
+    size_t num_pending_requests_ = 0;
+
+    uint64_t End() const { return offset_ + buffer_.CurrentSize(); }
+  };
+
+  // Double-buffered variant of TryReadFromCache() used with async_io_.
+  bool TryReadFromCacheAsync(const IOOptions& opts,
+                             RandomAccessFileReader* reader, uint64_t offset,
+                             size_t n, Slice* result, Status* status,
+                             bool for_compaction);
+
+  // Loads [offset, offset + n) into bufs_[curr_], reusing the bytes already
+  // in either buffer, then submits an asynchronous read of the next
+  // readahead_size_ bytes into the other buffer.
+  Status PrefetchAsync(const IOOptions& opts, RandomAccessFileReader* reader,
+                       uint64_t offset, size_t n, bool for_compaction);
+
+  // Submits an asynchronous read of n bytes at offset into bufs_[index], as
+  // up to async_io_depth_ requests.
+  void ReadAsync(const IOOptions& opts, RandomAccessFileReader* reader,
+                 uint32_t index, uint64_t offset, size_t n,
+                 bool for_compaction);
+
+  // Waits for the asynchronous read into bufs_[index], if any, to complete.
+  void WaitForAsyncRead(uint32_t index);
+
+  // Called when a request of an asynchronous read completes.
+  void AsyncReadCallback(const FSReadRequest& req, void* cb_arg);
+
+  // Called once all the requests of the asynchronous read into buf have
+  // completed.
+  void FinishAsyncRead(BufferInfo* buf);
+
+  // Cancels (or waits for) the asynchronous read into bufs_[index], if any.
+  void AbortAsyncRead(uint32_t index);
+
+  // Releases the IO handles of the requests of the last asynchronous read
+  // into bufs_[index].
+  void ReleaseIOHandles(uint32_t index);
+
+  BufferInfo bufs_[2];
+  // Index of the buffer that reads are served from
+  uint32_t curr_;
   size_t readahead_size_;
   // FilePrefetchBuffer object won't be created from Iterator flow if
   // max_readahead_size_ = 0.
@@ -169,5 +267,10 @@ class FilePrefetchBuffer {
   uint64_t prev_offset_;
   size_t prev_len_;
   int64_t num_file_reads_;
+
+  // Double-buffer readahead with asynchronous reads
+  bool async_io_;
+  FileSystem* fs_;
+  size_t async_io_depth_;
 };
 }  // namespace ROCKSDB_NAMESPACE
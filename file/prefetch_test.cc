@@ -4,6 +4,7 @@
 //  (found in the LICENSE.Apache file in the root directory).
 
 #include "db/db_test_util.h"
+#include "table/block_based/readahead_history.h"
 #include "test_util/sync_point.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -876,6 +877,100 @@ TEST_P(PrefetchTest2, NonSequentialReads) {
   }
   Close();
 }
+
+TEST_P(PrefetchTest2, LearnAutoReadahead) {
+  const int kNumKeys = 1000;
+  // Set options
+  std::shared_ptr<MockFS> fs =
+      std::make_shared<MockFS>(env_->GetFileSystem(), false);
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+
+  Options options = CurrentOptions();
+  options.write_buffer_size = 1024;
+  options.create_if_missing = true;
+  options.compression = kNoCompression;
+  options.env = env.get();
+  if (GetParam()) {
+    options.use_direct_reads = true;
+    options.use_direct_io_for_flush_and_compaction = true;
+  }
+  BlockBasedTableOptions table_options;
+  table_options.no_block_cache = true;
+  table_options.cache_index_and_filter_blocks = false;
+  table_options.learn_auto_readahead = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  Status s = TryReopen(options);
+  if (GetParam() && (s.IsNotSupported() || s.IsInvalidArgument())) {
+    // If direct IO is not supported, skip the test
+    return;
+  } else {
+    ASSERT_OK(s);
+  }
+
+  WriteBatch batch;
+  Random rnd(309);
+  for (int j = 0; j < 5; j++) {
+    for (int i = j * kNumKeys; i < (j + 1) * kNumKeys; i++) {
+      ASSERT_OK(batch.Put(BuildKey(i), rnd.RandomString(1000)));
+    }
+    ASSERT_OK(db_->Write(WriteOptions(), &batch));
+    ASSERT_OK(Flush());
+  }
+  MoveFilesToLevel(2);
+
+  int buff_prefetch_count = 0;
+  size_t learned_readahead_size = 0;
+  SyncPoint::GetInstance()->SetCallBack("FilePrefetchBuffer::Prefetch:Start",
+                                        [&](void*) { buff_prefetch_count++; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockPrefetcher::StartRun", [&](void* arg) {
+        learned_readahead_size = *reinterpret_cast<size_t*>(arg);
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Short scans at the start of the first file make it look randomly read.
+  for (uint32_t i = 0; i < ReadaheadHistory::kNumShortRunsForRandom; i++) {
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ReadOptions()));
+    iter->Seek(BuildKey(0));
+    ASSERT_TRUE(iter->Valid());
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(learned_readahead_size, 0);
+  }
+  ASSERT_EQ(buff_prefetch_count, 0);
+
+  {
+    // A longer scan there doesn't start readahead after a few blocks, as it
+    // would by default, but still does once it keeps going.
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ReadOptions()));
+    iter->Seek(BuildKey(0));
+    for (int i = 0; i < 20 && iter->Valid(); i++) {
+      iter->Next();
+    }
+    ASSERT_EQ(buff_prefetch_count, 0);
+    while (iter->Valid()) {
+      iter->Next();
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_GT(buff_prefetch_count, 0);
+  }
+
+  {
+    // A new scan starts reading ahead at once, with the readahead size that
+    // the previous scan reached.
+    buff_prefetch_count = 0;
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ReadOptions()));
+    iter->SeekToFirst();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_GT(learned_readahead_size, 8 * 1024);
+    ASSERT_EQ(buff_prefetch_count, 1);
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+}
 #endif  //! ROCKSDB_LITE
 
 TEST_P(PrefetchTest2, DecreaseReadAheadIfInCache) {
@@ -995,6 +1090,228 @@ TEST_P(PrefetchTest2, DecreaseReadAheadIfInCache) {
   Close();
 }
 
+#ifndef ROCKSDB_LITE
+TEST_P(PrefetchTest2, ReadAsyncWithDoubleBuffering) {
+  const int kNumKeys = 1000;
+  // Set options
+  std::shared_ptr<MockFS> fs =
+      std::make_shared<MockFS>(env_->GetFileSystem(), false);
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+
+  Options options = CurrentOptions();
+  options.write_buffer_size = 1024;
+  options.create_if_missing = true;
+  options.compression = kNoCompression;
+  options.env = env.get();
+  if (GetParam()) {
+    options.use_direct_reads = true;
+    options.use_direct_io_for_flush_and_compaction = true;
+  }
+  BlockBasedTableOptions table_options;
+  table_options.no_block_cache = true;
+  table_options.cache_index_and_filter_blocks = false;
+  table_options.metadata_block_size = 1024;
+  table_options.index_type =
+      BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  Status s = TryReopen(options);
+  if (GetParam() && (s.IsNotSupported() || s.IsInvalidArgument())) {
+    // If direct IO is not supported, skip the test
+    return;
+  } else {
+    ASSERT_OK(s);
+  }
+
+  WriteBatch batch;
+  Random rnd(309);
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < kNumKeys; i++) {
+    expected[BuildKey(i)] = rnd.RandomString(1000);
+    ASSERT_OK(batch.Put(BuildKey(i), expected[BuildKey(i)]));
+  }
+  ASSERT_OK(db_->Write(WriteOptions(), &batch));
+
+  std::string start_key = BuildKey(0);
+  std::string end_key = BuildKey(kNumKeys - 1);
+  Slice least(start_key.data(), start_key.size());
+  Slice greatest(end_key.data(), end_key.size());
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), &least, &greatest));
+
+  int read_async_count = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "FilePrefetchBuffer::ReadAsync:Start",
+      [&](void*) { read_async_count++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  ReadOptions ro;
+  ro.async_io = true;
+  {
+    // Full scan: the readahead window is read asynchronously into the second
+    // buffer while the first one is consumed.
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ro));
+    auto expected_it = expected.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_TRUE(expected_it != expected.end());
+      ASSERT_EQ(iter->key(), expected_it->first);
+      ASSERT_EQ(iter->value(), expected_it->second);
+      ++expected_it;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(expected_it == expected.end());
+    ASSERT_GT(read_async_count, 0);
+  }
+  {
+    // Reseeks, both within and out of the prefetched range.
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ro));
+    for (int key : {0, 1, 2, 3, 500, 501, 502, 10, 11, 12, 13, 990}) {
+      iter->Seek(BuildKey(key));
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(iter->key(), BuildKey(key));
+      ASSERT_EQ(iter->value(), expected[BuildKey(key)]);
+    }
+    ASSERT_OK(iter->status());
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+}
+
+TEST_P(PrefetchTest2, CompactionReadAsync) {
+  const int kNumKeys = 1000;
+  const size_t kReadaheadSize = 64 * 1024;
+  const int kAsyncIODepth = 4;
+  Options options = CurrentOptions();
+  options.write_buffer_size = 1024 * 1024;
+  options.create_if_missing = true;
+  options.compression = kNoCompression;
+  options.disable_auto_compactions = true;
+  options.compaction_readahead_size = kReadaheadSize;
+  options.compaction_async_io_depth = kAsyncIODepth;
+  if (GetParam()) {
+    options.use_direct_reads = true;
+    options.use_direct_io_for_flush_and_compaction = true;
+  }
+  BlockBasedTableOptions table_options;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  Status s = TryReopen(options);
+  if (GetParam() && (s.IsNotSupported() || s.IsInvalidArgument())) {
+    // If direct IO is not supported, skip the test
+    return;
+  } else {
+    ASSERT_OK(s);
+  }
+
+  // Two overlapping files
+  Random rnd(309);
+  std::map<std::string, std::string> expected;
+  for (int file = 0; file < 2; ++file) {
+    for (int i = file; i < kNumKeys; i += 1 + file) {
+      expected[BuildKey(i)] = rnd.RandomString(1000);
+      ASSERT_OK(Put(BuildKey(i), expected[BuildKey(i)]));
+    }
+    ASSERT_OK(Flush());
+  }
+
+  int read_async_count = 0;
+  int request_count = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "FilePrefetchBuffer::ReadAsync:Start",
+      [&](void*) { read_async_count++; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "FilePrefetchBuffer::ReadAsync:Request", [&](void* arg) {
+        request_count++;
+        FSReadRequest* req = static_cast<FSReadRequest*>(arg);
+        // Each readahead window is split into kAsyncIODepth requests, after
+        // extending it to the alignment of the file (up to a page).
+        ASSERT_LE(req->len, kReadaheadSize / kAsyncIODepth + 4096);
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel());
+  ASSERT_GT(read_async_count, 0);
+  ASSERT_GT(request_count, read_async_count);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ReadOptions()));
+  auto expected_it = expected.begin();
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_TRUE(expected_it != expected.end());
+    ASSERT_EQ(iter->key(), expected_it->first);
+    ASSERT_EQ(iter->value(), expected_it->second);
+    ++expected_it;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_TRUE(expected_it == expected.end());
+  iter.reset();
+  Close();
+}
+
+TEST_P(PrefetchTest2, BatchedTableFileOpening) {
+  const int kNumFiles = 10;
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.disable_auto_compactions = true;
+  options.max_open_files = -1;
+  if (GetParam()) {
+    options.use_direct_reads = true;
+    options.use_direct_io_for_flush_and_compaction = true;
+  }
+  Status s = TryReopen(options);
+  if (GetParam() && (s.IsNotSupported() || s.IsInvalidArgument())) {
+    // If direct IO is not supported, skip the test
+    return;
+  } else {
+    ASSERT_OK(s);
+  }
+  for (int file = 0; file < kNumFiles; ++file) {
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_OK(Put(BuildKey(i), "value" + std::to_string(file)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(ToString(kNumFiles), FilesPerLevel());
+
+  std::atomic<int> prefetched_files{0};
+  std::atomic<int> read_async_count{0};
+  std::atomic<int> buff_prefetch_count{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "TableCache::PrefetchTableFile", [&](void*) { prefetched_files++; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "FilePrefetchBuffer::ReadAsync:Start",
+      [&](void*) { read_async_count++; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "FilePrefetchBuffer::Prefetch:Start",
+      [&](void*) { buff_prefetch_count++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  options.max_file_opening_threads = 2;
+  options.file_opening_batch_size = 4;
+  Reopen(options);
+
+  // All files were opened in batches, with their tails read asynchronously
+  // and not again when opening the table readers
+  ASSERT_EQ(prefetched_files, kNumFiles);
+  ASSERT_EQ(read_async_count, kNumFiles);
+  ASSERT_EQ(buff_prefetch_count, 0);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ("value" + std::to_string(kNumFiles - 1), Get(BuildKey(i)));
+  }
+  Close();
+}
+#endif  // !ROCKSDB_LITE
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
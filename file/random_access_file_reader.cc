@@ -463,6 +463,89 @@ IOStatus RandomAccessFileReader::MultiRead(const IOOptions& opts,
   return io_s;
 }
 
+namespace {
+// State of an asynchronous read submitted through
+// RandomAccessFileReader::ReadAsync(), kept until it completes.
+struct ReadAsyncInfo {
+  std::function<void(const FSReadRequest&, void*)> cb;
+  void* cb_arg;
+  uint64_t start_time;
+#ifndef ROCKSDB_LITE
+  FileOperationInfo::StartTimePoint fs_start_ts;
+#endif
+};
+}  // namespace
+
+IOStatus RandomAccessFileReader::ReadAsync(
+    FSReadRequest& req, const IOOptions& opts,
+    std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+    void** io_handle, IOHandleDeleter* del_fn, bool for_compaction) {
+  if (use_direct_io()) {
+    const size_t alignment = file_->GetRequiredBufferAlignment();
+    assert(req.offset % alignment == 0);
+    assert(req.len % alignment == 0);
+    assert(reinterpret_cast<uintptr_t>(req.scratch) % alignment == 0);
+    (void)alignment;
+  }
+
+  if (for_compaction && rate_limiter_ != nullptr) {
+    // The request is submitted as a whole, so wait for all of its tokens.
+    size_t charged = 0;
+    while (charged < req.len) {
+      charged += rate_limiter_->RequestToken(
+          req.len - charged, 0 /* alignment */, Env::IOPriority::IO_LOW,
+          stats_, RateLimiter::OpType::kRead);
+    }
+  }
+
+  ReadAsyncInfo* info = new ReadAsyncInfo;
+  info->cb = std::move(cb);
+  info->cb_arg = cb_arg;
+  info->start_time = clock_ ? clock_->NowMicros() : 0;
+#ifndef ROCKSDB_LITE
+  if (ShouldNotifyListeners()) {
+    info->fs_start_ts = FileOperationInfo::StartNow();
+  }
+#endif
+
+  auto read_async_callback = [this](const FSReadRequest& read_req,
+                                    void* arg) {
+    std::unique_ptr<ReadAsyncInfo> read_async_info(
+        static_cast<ReadAsyncInfo*>(arg));
+#ifndef ROCKSDB_LITE
+    if (ShouldNotifyListeners()) {
+      auto finish_ts = FileOperationInfo::FinishNow();
+      NotifyOnFileReadFinish(read_req.offset, read_req.result.size(),
+                             read_async_info->fs_start_ts, finish_ts,
+                             read_req.status);
+      if (!read_req.status.ok()) {
+        NotifyOnIOError(read_req.status, FileOperationType::kRead,
+                        file_name(), read_req.result.size(), read_req.offset);
+      }
+    }
+#endif
+    const size_t bytes_read = read_req.result.size();
+    IOSTATS_ADD(bytes_read, bytes_read);
+    IOStatsAddBytesByTemperature(file_temperature_, bytes_read);
+    IOStatsAddCountByTemperature(file_temperature_, 1);
+    StatisticAddBytesByTemperature(stats_, file_temperature_, bytes_read);
+    StatisticAddCountByTemperature(stats_, file_temperature_, 1);
+    if (stats_ != nullptr && file_read_hist_ != nullptr && clock_ != nullptr) {
+      file_read_hist_->Add(clock_->NowMicros() -
+                           read_async_info->start_time);
+    }
+    read_async_info->cb(read_req, read_async_info->cb_arg);
+  };
+
+  IOStatus s = file_->ReadAsync(req, opts, read_async_callback, info,
+                                io_handle, del_fn, nullptr /* dbg */);
+  if (!s.ok()) {
+    // The callback won't be called
+    delete info;
+  }
+  return s;
+}
+
 IOStatus RandomAccessFileReader::PrepareIOOptions(const ReadOptions& ro,
                                                   IOOptions& opts) {
   if (clock_ != nullptr) {
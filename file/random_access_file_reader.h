@@ -151,6 +151,17 @@ class RandomAccessFileReader {
   IOStatus MultiRead(const IOOptions& opts, FSReadRequest* reqs,
                      size_t num_reqs, AlignedBuf* aligned_buf) const;
 
+  // Submits an asynchronous read of req (see FSRandomAccessFile::ReadAsync)
+  // and updates the IO stats once it completes, before calling cb.
+  // In direct IO mode, req.offset, req.len and req.scratch must be aligned to
+  // GetRequiredBufferAlignment().
+  // Reads for compaction are charged to the rate limiter before they are
+  // submitted.
+  IOStatus ReadAsync(FSReadRequest& req, const IOOptions& opts,
+                     std::function<void(const FSReadRequest&, void*)> cb,
+                     void* cb_arg, void** io_handle, IOHandleDeleter* del_fn,
+                     bool for_compaction = false);
+
   IOStatus Prefetch(uint64_t offset, size_t n) const {
     return file_->Prefetch(offset, n, IOOptions(), nullptr);
   }
@@ -16,6 +16,8 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class Cache;
+class KeyHotnessTracker;
 class Slice;
 class SliceTransform;
 class TablePropertiesCollectorFactory;
@@ -907,6 +909,58 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through the SetOptions() API
   uint64_t blob_compaction_readahead_size = 0;
 
+  // If non-NULL, use the specified cache for blobs. The cache holds the
+  // uncompressed blob values, keyed by blob file and offset, so that repeated
+  // reads of hot blobs by Get, MultiGet and iterators avoid the file read and
+  // the decompression. The cache can be shared with the block cache or with
+  // the blob caches of other column families.
+  //
+  // Blobs are inserted only if ReadOptions::fill_cache is set. Reads with
+  // ReadOptions::read_tier == kBlockCacheTier are served from this cache.
+  //
+  // Default: nullptr (disabled)
+  //
+  // Not dynamically changeable through the SetOptions() API
+  std::shared_ptr<Cache> blob_cache = nullptr;
+
+  // EXPERIMENTAL
+  // If set together with cold_key_temperature, the table readers of this
+  // column family feed the keys they read to the tracker, and compactions
+  // below L0 cut their output files where the keys turn from hot to cold or
+  // back, per the tracker. The files of cold keys are created with
+  // cold_key_temperature, while those of hot keys keep the temperature of the
+  // output level. See NewKeyHotnessTracker().
+  //
+  // Default: nullptr (disabled)
+  //
+  // Not dynamically changeable through the SetOptions() API
+  std::shared_ptr<KeyHotnessTracker> key_hotness_tracker = nullptr;
+
+  // EXPERIMENTAL
+  // Temperature passed to the FileSystem for the compaction output files that
+  // only hold cold keys, per key_hotness_tracker. kUnknown disables the
+  // separation of hot and cold keys.
+  //
+  // Default: kUnknown
+  Temperature cold_key_temperature = Temperature::kUnknown;
+
+  // EXPERIMENTAL
+  // If true, compactions pass the data blocks of an input file that no other
+  // input file overlaps, i.e. that fall in the gaps between the key ranges of
+  // the other input files, through to their output files, copying them as
+  // stored instead of decoding, merging and recompressing their keys. Only the
+  // blocks whose keys compaction would write out unchanged are copied, i.e.
+  // single versions of keys written by Put, and only into block-based tables of
+  // the same format_version and compression type, without compression
+  // dictionaries. Compactions with compaction filters, blob files, range
+  // deletions, SST partitioners, user-defined timestamps, cold_key_temperature
+  // or pipelined_compaction rewrite all their keys.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool compaction_block_passthrough = false;
+
   // Create ColumnFamilyOptions with default values for all fields
   AdvancedColumnFamilyOptions();
   // Create ColumnFamilyOptions from Options
@@ -27,6 +27,7 @@
 #include <memory>
 #include <string>
 
+#include "rocksdb/compression_type.h"
 #include "rocksdb/memory_allocator.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/statistics.h"
@@ -127,6 +128,121 @@ extern std::shared_ptr<Cache> NewLRUCache(
 
 extern std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts);
 
+struct CompressedSecondaryCacheOptions : LRUCacheOptions {
+  // The compression method (if any) that is used to compress data before it
+  // is stored in the secondary cache. If the configured method is not
+  // supported by this build, or does not shrink a given value, the value is
+  // stored uncompressed.
+  CompressionType compression_type = CompressionType::kLZ4Compression;
+
+  // compress_format_version can have two values:
+  // compress_format_version == 1 -- decompressed size is not included in the
+  // block header.
+  // compress_format_version == 2 -- decompressed size is included in the block
+  // header in varint32 format.
+  uint32_t compress_format_version = 2;
+
+  CompressedSecondaryCacheOptions() {}
+  CompressedSecondaryCacheOptions(
+      size_t _capacity, int _num_shard_bits, bool _strict_capacity_limit,
+      double _high_pri_pool_ratio,
+      std::shared_ptr<MemoryAllocator> _memory_allocator = nullptr,
+      bool _use_adaptive_mutex = kDefaultToAdaptiveMutex,
+      CacheMetadataChargePolicy _metadata_charge_policy =
+          kDefaultCacheMetadataChargePolicy,
+      CompressionType _compression_type = CompressionType::kLZ4Compression,
+      uint32_t _compress_format_version = 2)
+      : LRUCacheOptions(_capacity, _num_shard_bits, _strict_capacity_limit,
+                        _high_pri_pool_ratio, std::move(_memory_allocator),
+                        _use_adaptive_mutex, _metadata_charge_policy),
+        compression_type(_compression_type),
+        compress_format_version(_compress_format_version) {}
+};
+
+// EXPERIMENTAL
+// Create a new SecondaryCache that keeps the data evicted from the primary
+// (block) cache compressed in memory, so that more hot data fits into the
+// same amount of DRAM. Lookups with wait == false return a handle right
+// away and defer decompression until the handle is waited on.
+extern std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    size_t capacity, int num_shard_bits = -1,
+    bool strict_capacity_limit = false, double high_pri_pool_ratio = 0.5,
+    std::shared_ptr<MemoryAllocator> memory_allocator = nullptr,
+    bool use_adaptive_mutex = kDefaultToAdaptiveMutex,
+    CacheMetadataChargePolicy metadata_charge_policy =
+        kDefaultCacheMetadataChargePolicy,
+    CompressionType compression_type = CompressionType::kLZ4Compression,
+    uint32_t compress_format_version = 2);
+
+extern std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts);
+
+struct HyperClockCacheOptions {
+  // Capacity of the cache.
+  size_t capacity = 0;
+
+  // Estimated average charge of an entry, including its value. The cache
+  // uses a fixed-size hash table per shard, sized as
+  // capacity / estimated_entry_charge (plus some headroom), so this should
+  // be set close to the actual average, e.g. the block size for a block
+  // cache. Underestimating wastes memory on unused table slots, while
+  // overestimating limits the number of entries, in which case entries are
+  // evicted before the cache reaches its capacity. Must be > 0.
+  size_t estimated_entry_charge = 0;
+
+  // Cache is sharded into 2^num_shard_bits shards, by hash of key.
+  // Refer to NewHyperClockCache for further information.
+  int num_shard_bits = -1;
+
+  // If strict_capacity_limit is set, insert to the cache will fail when
+  // cache is full.
+  bool strict_capacity_limit = false;
+
+  // If non-nullptr will use this allocator instead of system allocator when
+  // allocating memory for cache blocks. Call this method before you start
+  // using the cache!
+  std::shared_ptr<MemoryAllocator> memory_allocator;
+
+  CacheMetadataChargePolicy metadata_charge_policy =
+      kDefaultCacheMetadataChargePolicy;
+
+  HyperClockCacheOptions() {}
+  HyperClockCacheOptions(
+      size_t _capacity, size_t _estimated_entry_charge,
+      int _num_shard_bits = -1, bool _strict_capacity_limit = false,
+      std::shared_ptr<MemoryAllocator> _memory_allocator = nullptr,
+      CacheMetadataChargePolicy _metadata_charge_policy =
+          kDefaultCacheMetadataChargePolicy)
+      : capacity(_capacity),
+        estimated_entry_charge(_estimated_entry_charge),
+        num_shard_bits(_num_shard_bits),
+        strict_capacity_limit(_strict_capacity_limit),
+        memory_allocator(std::move(_memory_allocator)),
+        metadata_charge_policy(_metadata_charge_policy) {}
+};
+
+// Create a new cache with a fixed size capacity, based on a lock-free
+// variant of the CLOCK algorithm. Lookups and releases only use atomic
+// operations on the entry, so unlike LRUCache, hot entries do not contend on
+// a shard mutex, and throughput keeps scaling with many concurrent readers.
+// The cache is sharded like LRUCache (num_shard_bits < 0 picks a default
+// based on capacity), but since each shard is already concurrent, fewer
+// shards are needed for good performance.
+//
+// Not supported: secondary cache and high priority pool ratio (high
+// priority entries are merely kept somewhat longer than low priority ones).
+//
+// Returns nullptr if num_shard_bits >= 20 or estimated_entry_charge == 0.
+extern std::shared_ptr<Cache> NewHyperClockCache(
+    size_t capacity, size_t estimated_entry_charge, int num_shard_bits = -1,
+    bool strict_capacity_limit = false,
+    CacheMetadataChargePolicy metadata_charge_policy =
+        kDefaultCacheMetadataChargePolicy,
+    std::shared_ptr<MemoryAllocator> memory_allocator = nullptr);
+
+extern std::shared_ptr<Cache> NewHyperClockCache(
+    const HyperClockCacheOptions& cache_opts);
+
 // Similar to NewLRUCache, but create a cache based on CLOCK algorithm with
 // better concurrent performance in some cases. See util/clock_cache.cc for
 // more detail.
@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -432,6 +433,29 @@ class DB {
   // Note: consider setting options.sync = true.
   virtual Status Write(const WriteOptions& options, WriteBatch* updates) = 0;
 
+  // EXPERIMENTAL
+  // Like Write(), but may return before the updates are applied. `callback`
+  // is called exactly once with the result of the write, once it is durable
+  // according to options.sync. It may be called on another thread, or before
+  // WriteAsync() returns. `updates` must not be modified or destroyed until
+  // then. Returns non-OK, without calling `callback`, only if the arguments
+  // are invalid.
+  //
+  // Writes only complete asynchronously with DBOptions::enable_staged_writes,
+  // where the writes staged by many WriteAsync() calls are committed together
+  // and share one WAL write and sync. Otherwise, or if the write cannot be
+  // staged (see enable_staged_writes), the write is done and `callback` is
+  // called before WriteAsync() returns. Callbacks run on the thread that
+  // commits the staged writes, so they should be quick.
+  virtual Status WriteAsync(const WriteOptions& options, WriteBatch* updates,
+                            const std::function<void(const Status&)>& callback) {
+    if (!callback) {
+      return Status::InvalidArgument("WriteAsync() needs a callback");
+    }
+    callback(Write(options, updates));
+    return Status::OK();
+  }
+
   // If the database contains an entry for "key" store the
   // corresponding value in *value and return OK.
   //
@@ -488,6 +512,55 @@ class DB {
     return Get(options, DefaultColumnFamily(), key, value, timestamp);
   }
 
+  // EXPERIMENTAL
+  // Like Get(), but returns the value as a reference-counted handle, which
+  // can be shared with and released by other threads. While a copy of the
+  // handle is alive, (*value)->data() stays valid, so it can be passed to
+  // zero-copy I/O such as writev(). If the value is in an uncompressed block
+  // in the block cache, it is not copied: the block stays pinned in the block
+  // cache until the last copy of the handle is destroyed. Values that are not
+  // in the block cache (e.g. in a memtable) are copied into the handle.
+  //
+  // The handles must be destroyed before the DB is closed. *value is reset
+  // unless the status is OK.
+  virtual Status GetPinned(const ReadOptions& options,
+                           ColumnFamilyHandle* column_family, const Slice& key,
+                           std::shared_ptr<const PinnableSlice>* value) {
+    assert(value != nullptr);
+    std::shared_ptr<PinnableSlice> pinnable_val =
+        std::make_shared<PinnableSlice>();
+    Status s = Get(options, column_family, key, pinnable_val.get());
+    if (s.ok()) {
+      *value = std::move(pinnable_val);
+    } else {
+      value->reset();
+    }
+    return s;
+  }
+
+  // EXPERIMENTAL
+  // Like MultiGet(), but returns the values as handles, like GetPinned().
+  // Each handle pins its own value, independently of the others.
+  virtual void MultiGetPinned(const ReadOptions& options,
+                              ColumnFamilyHandle* column_family,
+                              const size_t num_keys, const Slice* keys,
+                              std::shared_ptr<const PinnableSlice>* values,
+                              Status* statuses,
+                              const bool sorted_input = false) {
+    std::vector<PinnableSlice> pinnable_vals(num_keys);
+    MultiGet(options, column_family, num_keys, keys, pinnable_vals.data(),
+             statuses, sorted_input);
+    for (size_t i = 0; i < num_keys; ++i) {
+      if (statuses[i].ok()) {
+        // Moves the pins of the value
+        values[i] =
+            std::make_shared<PinnableSlice>(std::move(pinnable_vals[i]));
+      } else {
+        values[i].reset();
+      }
+    }
+  }
+
   // Returns all the merge operands corresponding to the key. If the
   // number of merge operands in DB is greater than
   // merge_operands_options.expected_max_number_of_operands
@@ -53,6 +53,10 @@ struct ConfigOptions;
 using AccessPattern = RandomAccessFile::AccessPattern;
 using FileAttributes = Env::FileAttributes;
 
+// A function pointer type for freeing an IO handle returned by
+// FSRandomAccessFile::ReadAsync().
+using IOHandleDeleter = std::function<void(void*)>;
+
 // Priority of an IO request. This is a hint and does not guarantee any
 // particular QoS.
 // IO_LOW - Typically background reads/writes such as compaction/flush
@@ -640,6 +644,29 @@ class FileSystem : public Customizable {
                                const IOOptions& options, bool* is_dir,
                                IODebugContext* /*dgb*/) = 0;
 
+  // EXPERIMENTAL
+  // Waits for the completion of the asynchronous reads (see
+  // FSRandomAccessFile::ReadAsync()) identified by io_handles, until at least
+  // min_completions of them have completed. The callbacks of the completed
+  // reads are invoked from this function.
+  //
+  // It must be called from the thread that submitted the reads. The default
+  // implementation does nothing, which is correct for file systems whose
+  // ReadAsync() completes the read before returning.
+  virtual IOStatus Poll(std::vector<void*>& /*io_handles*/,
+                        size_t /*min_completions*/) {
+    return IOStatus::OK();
+  }
+
+  // EXPERIMENTAL
+  // Makes sure the asynchronous reads identified by io_handles are no longer
+  // in flight, cancelling them if possible. The callbacks of these reads are
+  // invoked (with a non-OK status if cancelled) before this returns, after
+  // which their buffers may be freed.
+  virtual IOStatus AbortIO(std::vector<void*>& /*io_handles*/) {
+    return IOStatus::OK();
+  }
+
   // If you're adding methods here, remember to add them to EnvWrapper too.
 
  private:
@@ -779,6 +806,30 @@ class FSRandomAccessFile {
     return IOStatus::OK();
   }
 
+  // EXPERIMENTAL
+  // Submits the read described by req (offset, len and scratch) without
+  // waiting for it to complete. When the read completes, cb is called with
+  // req (with result and status filled in) and cb_arg; req.scratch must stay
+  // valid until then. Completion is driven by FileSystem::Poll(), which
+  // must be called with the handle returned in *io_handle (if not nullptr)
+  // from the same thread. *del_fn, if set, is used to free the handle after
+  // the read has completed or was aborted.
+  //
+  // The return status only reflects the submission; the status of the read
+  // itself is passed to cb.
+  //
+  // The default implementation reads synchronously and calls cb before
+  // returning, leaving *io_handle untouched.
+  virtual IOStatus ReadAsync(
+      FSReadRequest& req, const IOOptions& opts,
+      std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+      void** /*io_handle*/, IOHandleDeleter* /*del_fn*/, IODebugContext* dbg) {
+    req.status =
+        Read(req.offset, req.len, opts, &(req.result), req.scratch, dbg);
+    cb(req, cb_arg);
+    return IOStatus::OK();
+  }
+
   // Tries to get an unique ID for this file that will be the same each time
   // the file is opened (and will stay the same while the file is open).
   // Furthermore, it tries to make this ID at most "max_size" bytes. If such an
@@ -1387,6 +1438,15 @@ class FileSystemWrapper : public FileSystem {
     return target_->IsDirectory(path, options, is_dir, dbg);
   }
 
+  IOStatus Poll(std::vector<void*>& io_handles,
+                size_t min_completions) override {
+    return target_->Poll(io_handles, min_completions);
+  }
+
+  IOStatus AbortIO(std::vector<void*>& io_handles) override {
+    return target_->AbortIO(io_handles);
+  }
+
   const Customizable* Inner() const override { return target_.get(); }
   Status PrepareOptions(const ConfigOptions& options) override;
 #ifndef ROCKSDB_LITE
@@ -1455,6 +1515,12 @@ class FSRandomAccessFileWrapper : public FSRandomAccessFile {
                      const IOOptions& options, IODebugContext* dbg) override {
     return target_->MultiRead(reqs, num_reqs, options, dbg);
   }
+  IOStatus ReadAsync(FSReadRequest& req, const IOOptions& opts,
+                     std::function<void(const FSReadRequest&, void*)> cb,
+                     void* cb_arg, void** io_handle, IOHandleDeleter* del_fn,
+                     IODebugContext* dbg) override {
+    return target_->ReadAsync(req, opts, cb, cb_arg, io_handle, del_fn, dbg);
+  }
   IOStatus Prefetch(uint64_t offset, size_t n, const IOOptions& options,
                     IODebugContext* dbg) override {
     return target_->Prefetch(offset, n, options, dbg);
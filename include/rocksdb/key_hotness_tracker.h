@@ -0,0 +1,70 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class Slice;
+class SystemClock;
+
+// EXPERIMENTAL
+// Tracks which user keys are read, so that compactions can write the keys
+// that are hot and those that are cold to separate output files, with
+// different temperatures. See AdvancedColumnFamilyOptions::
+// key_hotness_tracker.
+//
+// The table readers of a column family with a tracker feed it with the keys
+// of the data blocks they read for point lookups and iterators: the key found
+// by each Get() that reads a data block, and the first key that an iterator
+// lands on in each data block it reads. Applications can also feed it from
+// their own access statistics.
+//
+// Implementations must be thread-safe. RecordRead() is called on the read
+// path, so it should not block or allocate.
+class KeyHotnessTracker {
+ public:
+  virtual ~KeyHotnessTracker() {}
+
+  virtual const char* Name() const = 0;
+
+  // Records a read of `user_key`.
+  virtual void RecordRead(const Slice& user_key) = 0;
+
+  // Returns whether `user_key` is hot. Called by compactions for each key they
+  // output, in key order, so it should be cheap.
+  virtual bool IsHot(const Slice& user_key) = 0;
+};
+
+struct KeyHotnessTrackerOptions {
+  // Keys are tracked by range: keys that share their first
+  // range_prefix_length bytes are in the same range, which is hot if any of
+  // them was read recently. Output files are cut where hot ranges start and
+  // end, so ranges should not be too small.
+  size_t range_prefix_length = 8;
+
+  // A range is hot if one of its keys was read within the last hot_seconds.
+  uint64_t hot_seconds = 3600;
+
+  // Number of ranges the tracker has room for. Read times are kept in a
+  // fixed-size sketch (8 bytes per range), where ranges may share slots:
+  // beyond about this many recently read ranges, some cold ranges look hot.
+  size_t max_tracked_ranges = 1 << 18;
+
+  // Clock used for the read times. nullptr means SystemClock::Default().
+  std::shared_ptr<SystemClock> clock;
+};
+
+// Returns a tracker of the ranges of keys read within the last hot_seconds.
+extern std::shared_ptr<KeyHotnessTracker> NewKeyHotnessTracker(
+    const KeyHotnessTrackerOptions& options = KeyHotnessTrackerOptions());
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -78,4 +78,41 @@ extern Status NewJemallocNodumpAllocator(
     JemallocAllocatorOptions& options,
     std::shared_ptr<MemoryAllocator>* memory_allocator);
 
+struct HugePageSlabAllocatorOptions {
+  static const char* kName() { return "HugePageSlabAllocatorOptions"; }
+  // Size of the slabs that allocations are carved from. Has to be a multiple
+  // of the huge page size (2MB).
+  size_t slab_size = 2 << 20;
+
+  // If true, slabs are mapped from the huge pages reserved through
+  // /proc/sys/vm/nr_hugepages (MAP_HUGETLB) as long as there are enough of
+  // them. Otherwise, or once they run out, slabs are mapped from regular pages
+  // and the kernel is asked to back them with transparent huge pages
+  // (MADV_HUGEPAGE).
+  bool use_hugetlb = true;
+
+  // If true, the slabs of the arena of each core are bound to the NUMA node of
+  // that core, so that a cache entry lives on the node of the thread that
+  // allocated it. Requires building with NUMA.
+  bool numa_aware = false;
+};
+
+// EXPERIMENTAL
+// Generate memory allocator which carves allocations out of slabs of huge
+// pages, to reduce the TLB misses of accessing block cache entries.
+//
+// Implementation details:
+// Every core has its own arena, with a free list per size class (16 bytes
+// apart up to 128 bytes, then four per power of two), and the slab that it
+// currently carves new blocks from. An allocation is served by the arena of
+// the core that the thread runs on, and a deallocation returns the block to
+// the free list of the arena it came from. Freed blocks are kept for
+// allocations of the same size class, and slabs are only returned to the
+// system when the allocator is destroyed, so the allocator suits long-lived
+// users of bounded capacity like the block cache. Allocations larger than
+// 1/8 of a slab get their own mapping.
+extern Status NewHugePageSlabAllocator(
+    const HugePageSlabAllocatorOptions& options,
+    std::shared_ptr<MemoryAllocator>* memory_allocator);
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -564,6 +564,18 @@ struct DBOptions {
   // Default: 16
   int max_file_opening_threads = 16;
 
+  // Number of table files that each of the max_file_opening_threads threads
+  // opens together, e.g. on DB::Open() with max_open_files = -1. The files of
+  // a batch are opened first, and the tails that their table readers read on
+  // open (footer, metaindex, properties, index and filter blocks) are read
+  // with asynchronous reads (FSRandomAccessFile::ReadAsync()) that are in
+  // flight together. With a file system that implements ReadAsync() and
+  // storage with high latency, this makes opening many files much faster, at
+  // the cost of a tail buffer per file in flight. Only applies to
+  // block-based tables.
+  // Default: 1 (no batching)
+  int file_opening_batch_size = 1;
+
   // Once write-ahead logs exceed this size, we will start forcing the flush of
   // column families whose memtables are backed by the oldest live WAL file
   // (i.e. the ones that are causing all the space amplification). If set to 0
@@ -927,6 +939,32 @@ struct DBOptions {
   // Dynamically changeable through SetDBOptions() API.
   size_t compaction_readahead_size = 0;
 
+  // EXPERIMENTAL
+  // If greater than 0 and compaction_readahead_size is set, compaction input
+  // files of the block-based table format are read ahead asynchronously
+  // (FSRandomAccessFile::ReadAsync(), implemented with io_uring by the posix
+  // file system). While a compaction consumes one compaction_readahead_size
+  // window of a file, the next window is read as this many requests, which
+  // are in flight together. 0 means readahead is synchronous.
+  //
+  // Default: 0
+  int compaction_async_io_depth = 0;
+
+  // EXPERIMENTAL
+  // If true, each compaction runs as a pipeline of threads connected by
+  // bounded queues, instead of a single thread: a thread reads, decompresses
+  // and merges the input files, the compaction thread runs the compaction
+  // filter, merge operator, etc. and builds the output blocks, and the table
+  // builder compresses and writes them with threads of its own (as with
+  // CompressionOptions::parallel_threads of at least 2, which this implies
+  // for compaction outputs). A compaction is then limited by its slowest
+  // stage rather than by the sum of them, at the cost of more threads and of
+  // copying the input keys and values. Compactions with range deletions in
+  // their input files do not use a pipeline for reading their input.
+  //
+  // Default: false
+  bool pipelined_compaction = false;
+
   // This is a maximum buffer size that is used by WinMmapReadableFile in
   // unbuffered disk I/O mode. We need to maintain an aligned buffer for
   // reads. We allow the buffer to grow until the specified value and then
@@ -1084,9 +1122,31 @@ struct DBOptions {
   // Default: false
   bool unordered_write = false;
 
+  // EXPERIMENTAL
+  // If true, DB::Write() (and Put(), Delete(), etc.) does not queue writers
+  // up in the write thread. Instead, a writer stages its write batch on a
+  // queue of the core it runs on with a single compare-and-swap, and a
+  // dedicated committer thread commits all the batches staged since its
+  // previous commit as one batch, i.e. with one WAL record and one memtable
+  // insert, and then marks their writers done. This saves most of the
+  // per-writer handoff of the write thread when many threads issue small
+  // writes.
+  //
+  // The writes committed together succeed or fail together, and their
+  // statistics and perf context are accounted to the committer thread.
+  // Writes with disableWAL, ignore_missing_column_families, no_slowdown,
+  // low_pri, memtable_insert_hint_per_batch or a timestamp, writes of
+  // transactions, and all writes with two_write_queues go through the write
+  // thread as before.
+  //
+  // Default: false
+  bool enable_staged_writes = false;
+
   // If true, allow multi-writers to update mem tables in parallel.
   // Only some memtable_factory-s support concurrent writes; currently it
-  // is implemented only for SkipListFactory.  Concurrent memtable writes
+  // is implemented for SkipListFactory and for the factories returned by
+  // NewHashSkipListRepFactory() and NewHashLinkListRepFactory(), but not for
+  // VectorRepFactory.  Concurrent memtable writes
   // are not compatible with inplace_update_support or filter_deletes.
   // It is strongly recommended to set enable_write_thread_adaptive_yield
   // if you are going to use this feature.
@@ -1150,6 +1210,27 @@ struct DBOptions {
   // Default: kPointInTimeRecovery
   WALRecoveryMode wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
 
+  // Number of threads used to insert the records of the WALs into the
+  // memtables while replaying the WALs in DB::Open(). With more than one
+  // thread, the thread opening the DB reads and checks the WALs while the
+  // other threads insert the write batches concurrently. Since every entry
+  // keeps its own sequence number, the result is the same as with serial
+  // replay.
+  //
+  // Parallel replay is only used if the memtables of all column families
+  // support concurrent inserts (MemTableRepFactory::
+  // IsInsertConcurrentlySupported()), neither inplace_update_support nor
+  // max_successive_merges is used, and allow_2pc is false and the DB is not
+  // opened as a WritePrepared or WriteUnprepared TransactionDB. Otherwise,
+  // the WALs are replayed serially.
+  //
+  // Unlike serial replay, a write batch that is read correctly but cannot be
+  // applied to the memtables fails DB::Open() in kPointInTimeRecovery mode,
+  // as later write batches may have been applied already.
+  //
+  // Default: 1 (serial replay)
+  int wal_recovery_threads = 1;
+
   // if set to false then recovery will fail when a prepared
   // transaction is encountered in the WAL
   bool allow_2pc = false;
@@ -1608,6 +1689,35 @@ struct ReadOptions {
   // Default: false
   bool adaptive_readahead;
 
+  // EXPERIMENTAL
+  // If true, iterators issue the next readahead window asynchronously (see
+  // FSRandomAccessFile::ReadAsync()) while the data of the current window is
+  // being consumed, instead of reading it synchronously when the scan reaches
+  // it. It applies to both explicit (readahead_size) and automatic
+  // readahead of block-based tables, but not to compaction reads.
+  //
+  // The benefit depends on the FileSystem: the default ReadAsync()
+  // implementation is synchronous, while PosixFileSystem uses io_uring when
+  // RocksDB is built with it.
+  //
+  // Default: false
+  bool async_io;
+
+  // EXPERIMENTAL
+  // If set, iterators return only the given columns of each value, as split
+  // by BlockBasedTableOptions::value_column_splitter, concatenated in the
+  // given order. Columns that a value does not have are skipped. In data
+  // blocks that store value columns, the other columns are not read at all.
+  // Merge operands are merged before the projection, and blob indexes (with
+  // allow_unprepared_value) are returned whole. Requires the table factory
+  // to be block-based, with a value_column_splitter. Ignored by Get() and
+  // MultiGet().
+  //
+  // The vector must outlive the iterators created with these options.
+  //
+  // Default: nullptr
+  const std::vector<uint32_t>* value_columns;
+
   ReadOptions();
   ReadOptions(bool cksum, bool cache);
 };
@@ -1917,6 +2027,7 @@ struct CompactionServiceOptionsOverride {
   const CompactionFilter* compaction_filter = nullptr;
   std::shared_ptr<CompactionFilterFactory> compaction_filter_factory = nullptr;
   std::shared_ptr<const SliceTransform> prefix_extractor = nullptr;
+  // nullptr means the table factory configured in the DB options.
   std::shared_ptr<TableFactory> table_factory;
   std::shared_ptr<SstPartitionerFactory> sst_partitioner_factory = nullptr;
 
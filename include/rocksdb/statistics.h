@@ -430,6 +430,20 @@ enum Tickers : uint32_t {
   LOOKASIDE_CACHE_MISS,
   LOOKASIDE_CACHE_EVICTION,
 
+  // Blob cache (ColumnFamilyOptions::blob_cache) statistics
+  // # of times the blob cache missed
+  BLOB_DB_CACHE_MISS,
+  // # of times the blob cache hit
+  BLOB_DB_CACHE_HIT,
+  // # of blobs added to the blob cache
+  BLOB_DB_CACHE_ADD,
+  // # of failures when adding blobs to the blob cache
+  BLOB_DB_CACHE_ADD_FAILURES,
+  // # of bytes read from the blob cache
+  BLOB_DB_CACHE_BYTES_READ,
+  // # of bytes written into the blob cache
+  BLOB_DB_CACHE_BYTES_WRITE,
+
   TICKER_ENUM_MAX
 };
 
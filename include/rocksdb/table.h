@@ -21,6 +21,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "rocksdb/customizable.h"
 #include "rocksdb/env.h"
@@ -104,6 +105,23 @@ struct MetadataCacheOptions {
   PinningTier unpartitioned_pinning = PinningTier::kFallback;
 };
 
+// EXPERIMENTAL
+// Splits values that are records of a fixed schema into their fields, or
+// columns, for BlockBasedTableOptions::value_column_splitter.
+class ValueColumnSplitter {
+ public:
+  virtual ~ValueColumnSplitter() {}
+
+  // The name of the splitter, for logging.
+  virtual const char* Name() const = 0;
+
+  // Splits `value` into its columns, which it appends to *columns. The columns
+  // must be consecutive slices of `value` that cover it, i.e. `value` is the
+  // concatenation of its columns. Returns a non-OK status if `value` is not a
+  // record of the schema, in which case it is stored whole.
+  virtual Status Split(const Slice& value, std::vector<Slice>* columns) const = 0;
+};
+
 // For advanced user only
 struct BlockBasedTableOptions {
   static const char* kName() { return "BlockTableOptions"; };
@@ -211,6 +229,18 @@ struct BlockBasedTableOptions {
     // Makes the index significantly bigger (2x or more), especially when keys
     // are long.
     kBinarySearchWithFirstKey = 0x03,
+
+    // EXPERIMENTAL
+    // Like kBinarySearch, but a piecewise-linear model of the keys of the
+    // index block, stored in a meta block, predicts the position of the seek
+    // key among the restart points of the index block, so that the binary
+    // search only covers a few of them. Works best with keys whose bytes
+    // after their common prefix are roughly uniformly distributed, and with
+    // large index blocks (e.g. large files and index_block_restart_interval
+    // = 1). The model is only built for the bytewise comparator; with other
+    // comparators, this is the same as kBinarySearch. Files written with this
+    // index type cannot be read by older versions of RocksDB.
+    kInterpolationSearch = 0x04,
   };
 
   IndexType index_type = kBinarySearch;
@@ -227,6 +257,21 @@ struct BlockBasedTableOptions {
   // kDataBlockBinaryAndHash.
   double data_block_hash_table_util_ratio = 0.75;
 
+  // EXPERIMENTAL
+  // If set, data blocks store the (plain) values that the splitter can split
+  // column by column, in a PAX layout: the entries of a block point to rows,
+  // and column i of all the rows is stored contiguously. Iterators that only
+  // read some columns of the values (see ReadOptions::value_columns) then
+  // only touch and copy these columns, instead of the whole values. Reading
+  // whole values assembles them from their columns.
+  //
+  // Requires format_version >= 6. Reading the files does not require the
+  // splitter, but projecting the values of other sources (e.g. memtables or
+  // files written without it) does.
+  //
+  // Default: nullptr (values are stored whole)
+  std::shared_ptr<const ValueColumnSplitter> value_column_splitter = nullptr;
+
   // This option is now deprecated. No matter what value it is set to,
   // it will behave as if hash_index_allow_collision=true.
   bool hash_index_allow_collision = true;
@@ -418,6 +463,10 @@ struct BlockBasedTableOptions {
   // 5 -- Can be read by RocksDB's versions since 6.6.0. Full and partitioned
   // filters use a generally faster and more accurate Bloom filter
   // implementation, with a different schema.
+  // 6 -- Cannot be read by older versions of RocksDB. With the bytewise
+  // comparator and no user-defined timestamps, data blocks store an 8-byte
+  // prefix of each restart key, which speeds up seeks within data blocks at
+  // the cost of 8 bytes per restart point.
   uint32_t format_version = 5;
 
   // Store index blocks on disk in compressed format. Changing this option to
@@ -490,6 +539,24 @@ struct BlockBasedTableOptions {
   // Default: 256 KB (256 * 1024).
   size_t max_auto_readahead_size = 256 * 1024;
 
+  // If enabled, the table reader of each table file keeps track of how its
+  // iterators read it when doing auto-readahead, per region of the file. A new
+  // iterator whose scan starts in a region that was read sequentially starts
+  // auto-readahead right away, with the readahead size that earlier scans
+  // reached there, instead of ramping up from 8KB. In a region where scans
+  // mostly stop before auto-readahead starts, it starts later. Has no effect
+  // if max_auto_readahead_size is 0 or if the user provides readahead_size.
+  //
+  // This parameter can be changed dynamically by
+  // DB::SetOptions({{"block_based_table_factory",
+  //                  "{learn_auto_readahead=true;}"}}));
+  //
+  // Changing the value dynamically will only affect files opened after the
+  // change.
+  //
+  // Default: false
+  bool learn_auto_readahead = false;
+
   // If enabled, prepopulate warm/hot blocks (data, uncompressed dict, index and
   // filter blocks) which are already in memory into block cache at the time of
   // flush. On a flush, the block that is in memory (in memtables) get flushed
@@ -0,0 +1,81 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+#ifndef ROCKSDB_LITE
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "rocksdb/db.h"
+#include "rocksdb/options.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// EXPERIMENTAL
+// Lets a single thread, e.g. the event loop of a server, have many lookups in
+// flight without a thread per lookup. Lookups are submitted with a callback,
+// which is called with the result:
+//
+// - A lookup that needs no I/O (because its key is found in the memtables,
+//   ruled out by filters, or found in blocks that are in the block cache)
+//   completes at once: its callback is called before Get() returns.
+// - Otherwise, the lookup is suspended until the next Poll(), which resumes
+//   the suspended lookups together with batched MultiGet()s with
+//   ReadOptions::async_io. The blocks that they need from a file are then
+//   read with one MultiRead() (through io_uring with the posix file system),
+//   and the reads in the files of a level overlap.
+//
+// Each Get() or MultiGet() reads as of one point in time. Unless
+// ReadOptions::snapshot is set, the lookups that are suspended read as of an
+// implicit snapshot taken when they were submitted, so they do not see
+// writes made before Poll() resumes them.
+//
+// An AsyncReader is not thread-safe. Callbacks are called on the thread that
+// calls Get(), MultiGet() or Poll(), and may submit more lookups, which are
+// resumed by a later Poll().
+class AsyncReader {
+ public:
+  // Called with the result of a lookup. `value` is only valid during the
+  // call, but may be moved from.
+  using GetCallback =
+      std::function<void(const Status& status, PinnableSlice* value)>;
+  // Called with the results of a MultiGet(), in the order of the keys
+  using MultiGetCallback = std::function<void(std::vector<Status>* statuses,
+                                              std::vector<PinnableSlice>* values)>;
+
+  // Suspended lookups complete with Status::Aborted()
+  virtual ~AsyncReader() {}
+
+  // Looks up `key` (which is copied if the lookup is suspended) like
+  // DB::Get(), and calls `callback` with the result.
+  virtual void Get(ColumnFamilyHandle* column_family, const Slice& key,
+                   GetCallback callback) = 0;
+
+  // Looks up `keys` and calls `callback` once all of them are resolved
+  virtual void MultiGet(ColumnFamilyHandle* column_family,
+                        const std::vector<Slice>& keys,
+                        MultiGetCallback callback) = 0;
+
+  // Resumes the lookups that are suspended when it is called, and returns
+  // once they have completed. Returns the number of lookups that completed.
+  virtual size_t Poll() = 0;
+
+  // Number of suspended lookups, which the next Poll() resumes
+  virtual size_t NumSuspended() const = 0;
+};
+
+// Creates an AsyncReader of `db`, which must outlive it. The lookups use
+// `read_options`, whose read_tier must be kReadAllTier. Poll() resumes up to
+// `max_batch_size` lookups with each MultiGet().
+extern Status NewAsyncReader(DB* db, const ReadOptions& read_options,
+                             size_t max_batch_size,
+                             std::unique_ptr<AsyncReader>* reader);
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // !ROCKSDB_LITE
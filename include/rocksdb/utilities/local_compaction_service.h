@@ -0,0 +1,89 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// A CompactionService that runs the compactions of a DB in separate worker
+// processes on the same host, so that their CPU and memory use can be
+// isolated from the process serving the DB, e.g. with cgroups.
+
+#pragma once
+#ifndef ROCKSDB_LITE
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/options.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct LocalCompactionServiceOptions {
+  // Command line starting a worker process, e.g. {"/path/to/compaction_worker"}
+  // or, to run the workers in a cgroup,
+  // {"cgexec", "-g", "cpu:compaction", "/path/to/compaction_worker"}. The
+  // first element is looked up in PATH. The worker must call
+  // RunCompactionWorker() with the arguments that the service appends.
+  // Required.
+  std::vector<std::string> worker_command;
+
+  // Directory shared with the workers, where each job gets a directory for its
+  // input, result and output files. The output files are renamed into the DB
+  // directory, so it must be on the same file system. Empty means the DB
+  // directory.
+  std::string work_dir;
+
+  // Maximum number of worker processes running at the same time. The other
+  // jobs wait for one of them to finish, in the order they were started.
+  int max_workers = 4;
+
+  // Number of times a job is run before giving up on the workers, if they
+  // fail, crash or time out. The compaction then runs in the DB process.
+  int max_attempts = 2;
+
+  // A worker still running after job_timeout_seconds is killed, which counts
+  // as a failed attempt. 0 means no timeout.
+  uint64_t job_timeout_seconds = 0;
+
+  // Env used to manage the job directories and to time the workers, which use
+  // the env of the options given to RunCompactionWorker(). nullptr means
+  // Env::Default().
+  Env* env = nullptr;
+};
+
+class LocalCompactionService : public CompactionService {
+ public:
+  static const char* kClassName() { return "LocalCompactionService"; }
+  const char* Name() const override { return kClassName(); }
+
+  // Kills the running workers and fails their jobs, as well as the jobs
+  // started but still waiting for a worker. The compactions fail with
+  // Status::Incomplete(). Jobs started afterwards run as usual. For use
+  // before closing the DB.
+  virtual void CancelAllJobs() = 0;
+
+  // Number of jobs completed by a worker, and number of jobs that ran in the
+  // DB process because all their attempts failed.
+  virtual uint64_t GetNumRemoteJobs() const = 0;
+  virtual uint64_t GetNumLocalFallbacks() const = 0;
+};
+
+// Returns a LocalCompactionService, which is not supported on Windows.
+extern std::shared_ptr<LocalCompactionService> NewLocalCompactionService(
+    const LocalCompactionServiceOptions& options);
+
+// Main function of a worker process started by a LocalCompactionService,
+// which runs one compaction job. Returns the exit code of the process.
+//
+// As the pointer options of the DB are not passed to the workers, a worker
+// uses those of `override_options`: a worker program must set the comparator,
+// merge operator, compaction filter, etc. that the DB uses. The table factory
+// defaults to the one configured in the DB options if not set.
+extern int RunCompactionWorker(
+    int argc, char** argv,
+    const CompactionServiceOptionsOverride& override_options =
+        CompactionServiceOptionsOverride());
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // !ROCKSDB_LITE
@@ -1173,7 +1173,8 @@ public interface DBOptionsInterface<T extends DBOptionsInterface<T>> {
   /**
    * If true, allow multi-writers to update mem tables in parallel.
    * Only some memtable factorys support concurrent writes; currently it
-   * is implemented only for SkipListFactory.  Concurrent memtable writes
+   * is implemented for SkipListMemTableConfig, HashSkipListMemTableConfig and
+   * HashLinkedListMemTableConfig.  Concurrent memtable writes
    * are not compatible with inplace_update_support or filter_deletes.
    * It is strongly recommended to set
    * {@link #setEnableWriteThreadAdaptiveYield(boolean)} if you are going to use
@@ -1190,7 +1191,8 @@ public interface DBOptionsInterface<T extends DBOptionsInterface<T>> {
   /**
    * If true, allow multi-writers to update mem tables in parallel.
    * Only some memtable factorys support concurrent writes; currently it
-   * is implemented only for SkipListFactory.  Concurrent memtable writes
+   * is implemented for SkipListMemTableConfig, HashSkipListMemTableConfig and
+   * HashLinkedListMemTableConfig.  Concurrent memtable writes
    * are not compatible with inplace_update_support or filter_deletes.
    * It is strongly recommended to set
    * {@link #setEnableWriteThreadAdaptiveYield(boolean)} if you are going to use
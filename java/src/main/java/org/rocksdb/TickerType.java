@@ -800,6 +800,36 @@ public enum TickerType {
     LOOKASIDE_CACHE_MISS((byte) -0x2b),
     LOOKASIDE_CACHE_EVICTION((byte) -0x2c),
 
+    /**
+     * # of times the blob cache missed.
+     */
+    BLOB_DB_CACHE_MISS((byte) -0x2d),
+
+    /**
+     * # of times the blob cache hit.
+     */
+    BLOB_DB_CACHE_HIT((byte) -0x2e),
+
+    /**
+     * # of blobs added to the blob cache.
+     */
+    BLOB_DB_CACHE_ADD((byte) -0x2f),
+
+    /**
+     * # of failures when adding blobs to the blob cache.
+     */
+    BLOB_DB_CACHE_ADD_FAILURES((byte) -0x30),
+
+    /**
+     * # of bytes read from the blob cache.
+     */
+    BLOB_DB_CACHE_BYTES_READ((byte) -0x31),
+
+    /**
+     * # of bytes written into the blob cache.
+     */
+    BLOB_DB_CACHE_BYTES_WRITE((byte) -0x32),
+
     TICKER_ENUM_MAX((byte) 0x5F);
 
     private final byte value;
@@ -0,0 +1,293 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "memory/hugepage_slab_allocator.h"
+
+#ifdef ROCKSDB_HUGEPAGE_SLAB_ALLOCATOR
+#include <sys/mman.h>
+#endif  // ROCKSDB_HUGEPAGE_SLAB_ALLOCATOR
+#ifdef NUMA
+#include <numa.h>
+#endif  // NUMA
+
+#include <algorithm>
+#include <new>
+
+#include "rocksdb/utilities/options_type.h"
+#include "util/math.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Size of the huge pages that slabs are mapped from
+constexpr size_t kHugePageSize = size_t{2} << 20;
+}  // namespace
+
+static std::unordered_map<std::string, OptionTypeInfo>
+    hugepage_slab_type_info = {
+#ifndef ROCKSDB_LITE
+        {"slab_size",
+         {offsetof(struct HugePageSlabAllocatorOptions, slab_size),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"use_hugetlb",
+         {offsetof(struct HugePageSlabAllocatorOptions, use_hugetlb),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"numa_aware",
+         {offsetof(struct HugePageSlabAllocatorOptions, numa_aware),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+#endif  // ROCKSDB_LITE
+};
+
+HugePageSlabAllocator::HugePageSlabAllocator(
+    const HugePageSlabAllocatorOptions& options)
+    : options_(options), prepared_(false) {
+  RegisterOptions(&options_, &hugepage_slab_type_info);
+}
+
+bool HugePageSlabAllocator::IsSupported(std::string* why) {
+#ifdef ROCKSDB_HUGEPAGE_SLAB_ALLOCATOR
+  (void)why;
+  return true;
+#else
+  *why = "HugePageSlabAllocator requires mmap()";
+  return false;
+#endif  // ROCKSDB_HUGEPAGE_SLAB_ALLOCATOR
+}
+
+Status HugePageSlabAllocator::PrepareOptions(
+    const ConfigOptions& config_options) {
+  std::string message;
+  if (!IsSupported(&message)) {
+    return Status::NotSupported(message);
+  } else if (!IsMutable()) {
+    // Already prepared
+    return Status::OK();
+  } else if (options_.slab_size == 0 ||
+             options_.slab_size % kHugePageSize != 0) {
+    return Status::InvalidArgument(
+        "slab_size must be a multiple of the huge page size (2MB).");
+  }
+#ifndef NUMA
+  if (options_.numa_aware) {
+    return Status::NotSupported("numa_aware requires building with NUMA");
+  }
+#else
+  if (options_.numa_aware && numa_available() < 0) {
+    return Status::NotSupported("NUMA is not available on this system");
+  }
+#endif  // NUMA
+  Status s = MemoryAllocator::PrepareOptions(config_options);
+#ifdef ROCKSDB_HUGEPAGE_SLAB_ALLOCATOR
+  if (s.ok()) {
+    Initialize();
+  }
+#endif  // ROCKSDB_HUGEPAGE_SLAB_ALLOCATOR
+  if (s.ok()) {
+    prepared_ = true;
+  }
+  return s;
+}
+
+#ifdef ROCKSDB_HUGEPAGE_SLAB_ALLOCATOR
+HugePageSlabAllocator::~HugePageSlabAllocator() {
+  for (size_t i = 0; i < arenas_.Size(); ++i) {
+    for (char* slab : arenas_.AccessAtCore(i)->slabs) {
+      int ret __attribute__((__unused__)) = munmap(slab, options_.slab_size);
+      assert(ret == 0);
+    }
+  }
+}
+
+void HugePageSlabAllocator::Initialize() {
+  // Classes are 16 bytes apart up to 128 bytes, and then four per power of
+  // two (as in jemalloc), so that at most 20% of a block is wasted. The
+  // largest class is 1/8 of a slab, to bound what is left unused at the end
+  // of a slab.
+  const size_t max_class_size = options_.slab_size / 8;
+  class_sizes_.clear();
+  for (size_t size = 2 * sizeof(BlockHeader); size <= max_class_size;) {
+    class_sizes_.push_back(size);
+    size_t step = size < 128 ? 16 : (size_t{1} << (FloorLog2(size) - 2));
+    size += step;
+  }
+  assert(class_sizes_.back() == max_class_size);
+
+  for (size_t i = 0; i < arenas_.Size(); ++i) {
+    Arena* arena = arenas_.AccessAtCore(i);
+    arena->free_lists.assign(class_sizes_.size(), nullptr);
+#ifdef NUMA
+    if (options_.numa_aware && static_cast<int>(i) < numa_num_configured_cpus()) {
+      arena->numa_node = numa_node_of_cpu(static_cast<int>(i));
+    }
+#endif  // NUMA
+  }
+}
+
+uint32_t HugePageSlabAllocator::SizeClassOf(size_t size) const {
+  auto it = std::lower_bound(class_sizes_.begin(), class_sizes_.end(), size);
+  assert(it != class_sizes_.end());
+  return static_cast<uint32_t>(it - class_sizes_.begin());
+}
+
+char* HugePageSlabAllocator::Map(size_t size, int numa_node, bool* hugetlb) {
+  void* addr = MAP_FAILED;
+  *hugetlb = false;
+#ifdef MAP_HUGETLB
+  if (options_.use_hugetlb && size % kHugePageSize == 0) {
+    // Fails if there are not enough reserved huge pages left
+    addr = mmap(nullptr, size, (PROT_READ | PROT_WRITE),
+                (MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB), -1, 0);
+    *hugetlb = addr != MAP_FAILED;
+  }
+#endif  // MAP_HUGETLB
+  if (addr == MAP_FAILED) {
+    addr = mmap(nullptr, size, (PROT_READ | PROT_WRITE),
+                (MAP_PRIVATE | MAP_ANONYMOUS), -1, 0);
+    if (addr == MAP_FAILED) {
+      return nullptr;
+    }
+#ifdef MADV_HUGEPAGE
+    // Only a hint: transparent huge pages may be disabled
+    madvise(addr, size, MADV_HUGEPAGE);
+#endif  // MADV_HUGEPAGE
+  }
+#ifdef NUMA
+  if (numa_node >= 0) {
+    // Before the pages are touched, so that they are allocated on the node
+    numa_tonode_memory(addr, size, numa_node);
+  }
+#else
+  (void)numa_node;
+#endif  // NUMA
+  return static_cast<char*>(addr);
+}
+
+void* HugePageSlabAllocator::Allocate(size_t size) {
+  assert(prepared_);
+  auto arena_and_idx = arenas_.AccessElementAndIndex();
+  Arena* arena = arena_and_idx.first;
+  uint32_t arena_idx = static_cast<uint32_t>(arena_and_idx.second);
+  size_t block_size = size + sizeof(BlockHeader);
+
+  if (block_size > class_sizes_.back()) {
+    // Large blocks get their own mapping, of whole huge pages if it is at
+    // least one huge page
+    size_t unit = block_size >= kHugePageSize ? kHugePageSize : port::kPageSize;
+    size_t mapped_size = (block_size + unit - 1) / unit * unit;
+    bool hugetlb = false;
+    char* block = Map(mapped_size, arena->numa_node, &hugetlb);
+    if (block == nullptr) {
+      throw std::bad_alloc();
+    }
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(block);
+    header->size_class = kLargeSizeClass;
+    header->arena = arena_idx;
+    header->mapped_size = mapped_size;
+    return block + sizeof(BlockHeader);
+  }
+
+  uint32_t size_class = SizeClassOf(block_size);
+  block_size = class_sizes_[size_class];
+  MutexLock l(&arena->mutex);
+  char* block = arena->free_lists[size_class];
+  if (block != nullptr) {
+    // The header of a free block is still set
+    arena->free_lists[size_class] =
+        *reinterpret_cast<char**>(block + sizeof(BlockHeader));
+    return block + sizeof(BlockHeader);
+  }
+
+  if (arena->slab_remaining < block_size) {
+    // Put the rest of the slab on the free lists of the classes that it
+    // fits, and start a new slab
+    while (arena->slab_remaining >= class_sizes_[0]) {
+      uint32_t rest_class = SizeClassOf(arena->slab_remaining);
+      if (class_sizes_[rest_class] > arena->slab_remaining) {
+        --rest_class;
+      }
+      char* rest = arena->slab_ptr;
+      BlockHeader* header = reinterpret_cast<BlockHeader*>(rest);
+      header->size_class = rest_class;
+      header->arena = arena_idx;
+      header->mapped_size = 0;
+      *reinterpret_cast<char**>(rest + sizeof(BlockHeader)) =
+          arena->free_lists[rest_class];
+      arena->free_lists[rest_class] = rest;
+      arena->slab_ptr += class_sizes_[rest_class];
+      arena->slab_remaining -= class_sizes_[rest_class];
+    }
+    arena->slabs.reserve(arena->slabs.size() + 1);
+    bool hugetlb = false;
+    char* slab = Map(options_.slab_size, arena->numa_node, &hugetlb);
+    if (slab == nullptr) {
+      throw std::bad_alloc();
+    }
+    (hugetlb ? num_hugetlb_slabs_ : num_regular_slabs_)
+        .fetch_add(1, std::memory_order_relaxed);
+    arena->slabs.push_back(slab);
+    arena->slab_ptr = slab;
+    arena->slab_remaining = options_.slab_size;
+  }
+
+  block = arena->slab_ptr;
+  arena->slab_ptr += block_size;
+  arena->slab_remaining -= block_size;
+  BlockHeader* header = reinterpret_cast<BlockHeader*>(block);
+  header->size_class = size_class;
+  header->arena = arena_idx;
+  header->mapped_size = 0;
+  return block + sizeof(BlockHeader);
+}
+
+void HugePageSlabAllocator::Deallocate(void* p) {
+  if (p == nullptr) {
+    return;
+  }
+  char* block = static_cast<char*>(p) - sizeof(BlockHeader);
+  const BlockHeader* header = reinterpret_cast<const BlockHeader*>(block);
+  if (header->size_class == kLargeSizeClass) {
+    int ret __attribute__((__unused__)) =
+        munmap(block, static_cast<size_t>(header->mapped_size));
+    assert(ret == 0);
+    return;
+  }
+  // Back to the arena that it was carved from, which may be another core's
+  Arena* arena = arenas_.AccessAtCore(header->arena);
+  MutexLock l(&arena->mutex);
+  *reinterpret_cast<char**>(p) = arena->free_lists[header->size_class];
+  arena->free_lists[header->size_class] = block;
+}
+
+size_t HugePageSlabAllocator::UsableSize(void* p,
+                                         size_t /*allocation_size*/) const {
+  const BlockHeader* header = reinterpret_cast<const BlockHeader*>(
+      static_cast<char*>(p) - sizeof(BlockHeader));
+  if (header->size_class == kLargeSizeClass) {
+    return static_cast<size_t>(header->mapped_size) - sizeof(BlockHeader);
+  }
+  return class_sizes_[header->size_class] - sizeof(BlockHeader);
+}
+#endif  // ROCKSDB_HUGEPAGE_SLAB_ALLOCATOR
+
+Status NewHugePageSlabAllocator(
+    const HugePageSlabAllocatorOptions& options,
+    std::shared_ptr<MemoryAllocator>* memory_allocator) {
+  if (memory_allocator == nullptr) {
+    return Status::InvalidArgument("memory_allocator must be non-null.");
+  }
+  std::unique_ptr<MemoryAllocator> allocator(
+      new HugePageSlabAllocator(options));
+  Status s = allocator->PrepareOptions(ConfigOptions());
+  if (s.ok()) {
+    memory_allocator->reset(allocator.release());
+  }
+  return s;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
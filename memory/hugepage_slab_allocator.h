@@ -0,0 +1,117 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/memory_allocator.h"
+#include "util/core_local.h"
+#include "utilities/memory_allocators.h"
+
+#ifndef OS_WIN
+#define ROCKSDB_HUGEPAGE_SLAB_ALLOCATOR
+#endif  // OS_WIN
+
+namespace ROCKSDB_NAMESPACE {
+
+// A MemoryAllocator that carves allocations out of large slabs of huge pages
+// (see NewHugePageSlabAllocator()).
+//
+// Each core has its own arena, with a free list per size class and the slab
+// that it currently carves new blocks from. Every block starts with a small
+// header naming its size class and arena, so that a block freed by another
+// core goes back to the arena it came from. Freed blocks are reused by
+// allocations of the same size class; slabs are only unmapped when the
+// allocator is destroyed. Allocations larger than a size class get their own
+// mapping, which Deallocate() unmaps.
+class HugePageSlabAllocator : public BaseMemoryAllocator {
+ public:
+  explicit HugePageSlabAllocator(const HugePageSlabAllocatorOptions& options);
+#ifdef ROCKSDB_HUGEPAGE_SLAB_ALLOCATOR
+  ~HugePageSlabAllocator() override;
+#endif  // ROCKSDB_HUGEPAGE_SLAB_ALLOCATOR
+
+  static const char* kClassName() { return "HugePageSlabAllocator"; }
+  const char* Name() const override { return kClassName(); }
+  static bool IsSupported() {
+    std::string unused;
+    return IsSupported(&unused);
+  }
+  static bool IsSupported(std::string* why);
+  bool IsMutable() const { return !prepared_; }
+
+  Status PrepareOptions(const ConfigOptions& config_options) override;
+
+#ifdef ROCKSDB_HUGEPAGE_SLAB_ALLOCATOR
+  void* Allocate(size_t size) override;
+  void Deallocate(void* p) override;
+  size_t UsableSize(void* p, size_t allocation_size) const override;
+
+  // Number of slabs mapped from reserved huge pages (MAP_HUGETLB), and from
+  // regular pages (with transparent huge pages requested), so far.
+  uint64_t GetNumHugeTlbSlabs() const {
+    return num_hugetlb_slabs_.load(std::memory_order_relaxed);
+  }
+  uint64_t GetNumRegularSlabs() const {
+    return num_regular_slabs_.load(std::memory_order_relaxed);
+  }
+
+  // NUMA node that the slabs of the arena of core `core_idx` are bound to, or
+  // -1 if they are not bound.
+  int GetArenaNumaNode(size_t core_idx) const {
+    return arenas_.AccessAtCore(core_idx)->numa_node;
+  }
+
+ private:
+  // Sets up the size classes and arenas for options_
+  void Initialize();
+
+  // Header of every block. The returned pointer follows it.
+  struct BlockHeader {
+    // Index in class_sizes_, or kLargeSizeClass
+    uint32_t size_class;
+    // Index of the arena in arenas_
+    uint32_t arena;
+    // Length of the mapping of a large block
+    uint64_t mapped_size;
+  };
+  static constexpr uint32_t kLargeSizeClass = 0xFFFFFFFF;
+
+  struct Arena {
+    port::Mutex mutex;
+    // Head of the free list of each size class. The first bytes of a free
+    // block (after its header) point to the next one.
+    std::vector<char*> free_lists;
+    // Rest of the current slab
+    char* slab_ptr = nullptr;
+    size_t slab_remaining = 0;
+    // Slabs to unmap on destruction
+    std::vector<char*> slabs;
+    int numa_node = -1;
+  };
+
+  // Maps `size` bytes (a multiple of the page size), from reserved huge pages
+  // if possible (setting *hugetlb), bound to `numa_node` if it is not -1.
+  // Returns nullptr if out of memory.
+  char* Map(size_t size, int numa_node, bool* hugetlb);
+
+  // Index of the smallest size class that holds `size` bytes
+  uint32_t SizeClassOf(size_t size) const;
+
+  // Size of each class, including the block header
+  std::vector<size_t> class_sizes_;
+  CoreLocalArray<Arena> arenas_;
+  std::atomic<uint64_t> num_hugetlb_slabs_{0};
+  std::atomic<uint64_t> num_regular_slabs_{0};
+#endif  // ROCKSDB_HUGEPAGE_SLAB_ALLOCATOR
+  HugePageSlabAllocatorOptions options_;
+  bool prepared_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -5,7 +5,9 @@
 //  (found in the LICENSE.Apache file in the root directory).
 
 #include <cstdio>
+#include <thread>
 
+#include "memory/hugepage_slab_allocator.h"
 #include "memory/jemalloc_nodump_allocator.h"
 #include "memory/memkind_kmem_allocator.h"
 #include "rocksdb/cache.h"
@@ -211,9 +213,136 @@ TEST_F(CreateMemoryAllocatorTest, NewJemallocNodumpAllocator) {
   ASSERT_EQ(opts->limit_tcache_size, jopts.limit_tcache_size);
 }
 
+TEST_F(CreateMemoryAllocatorTest, HugePageSlabOptionsTest) {
+  std::shared_ptr<MemoryAllocator> allocator;
+  std::string id = std::string("id=") + HugePageSlabAllocator::kClassName();
+  Status s = MemoryAllocator::CreateFromString(config_options_, id, &allocator);
+  if (!HugePageSlabAllocator::IsSupported()) {
+    ASSERT_TRUE(s.IsNotSupported());
+    ROCKSDB_GTEST_SKIP("HugePageSlabAllocator not supported");
+    return;
+  }
+  ASSERT_OK(s);
+  ASSERT_NE(allocator, nullptr);
+  HugePageSlabAllocatorOptions hopts;
+  auto opts = allocator->GetOptions<HugePageSlabAllocatorOptions>();
+  ASSERT_NE(opts, nullptr);
+  ASSERT_EQ(opts->slab_size, hopts.slab_size);
+  ASSERT_EQ(opts->use_hugetlb, hopts.use_hugetlb);
+  ASSERT_EQ(opts->numa_aware, hopts.numa_aware);
+
+  // Slabs are whole huge pages
+  ASSERT_NOK(MemoryAllocator::CreateFromString(
+      config_options_, id + "; slab_size=1048576", &allocator));
+  ASSERT_OK(MemoryAllocator::CreateFromString(
+      config_options_, id + "; slab_size=4194304; use_hugetlb=false",
+      &allocator));
+  opts = allocator->GetOptions<HugePageSlabAllocatorOptions>();
+  ASSERT_NE(opts, nullptr);
+  ASSERT_EQ(opts->slab_size, 4U << 20);
+  ASSERT_EQ(opts->use_hugetlb, false);
+#ifndef NUMA
+  ASSERT_TRUE(MemoryAllocator::CreateFromString(
+                  config_options_, id + "; numa_aware=true", &allocator)
+                  .IsNotSupported());
+#endif  // NUMA
+}
+
+#ifdef ROCKSDB_HUGEPAGE_SLAB_ALLOCATOR
+TEST_F(CreateMemoryAllocatorTest, HugePageSlabAllocate) {
+  HugePageSlabAllocatorOptions hopts;
+  std::shared_ptr<MemoryAllocator> allocator;
+  ASSERT_NOK(NewHugePageSlabAllocator(hopts, nullptr));
+  ASSERT_OK(NewHugePageSlabAllocator(hopts, &allocator));
+  auto* slab_allocator = allocator->CheckedCast<HugePageSlabAllocator>();
+  ASSERT_NE(slab_allocator, nullptr);
+
+  // Blocks of many sizes, including large ones, and all of them usable
+  std::vector<std::pair<char*, size_t>> blocks;
+  for (size_t size = 1; size <= (size_t{3} << 20); size = size * 3 / 2 + 1) {
+    char* p = static_cast<char*>(allocator->Allocate(size));
+    ASSERT_NE(p, nullptr);
+    size_t usable_size = allocator->UsableSize(p, size);
+    ASSERT_GE(usable_size, size);
+    // At most 25% more than requested, past the smallest size classes
+    if (size >= 128 && size < hopts.slab_size / 8) {
+      ASSERT_LE(usable_size, size + size / 4 + 16);
+    }
+    memset(p, static_cast<int>(blocks.size()), usable_size);
+    blocks.emplace_back(p, usable_size);
+  }
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    for (size_t j = 0; j < blocks[i].second; j += 61) {
+      ASSERT_EQ(blocks[i].first[j], static_cast<char>(i));
+    }
+  }
+  ASSERT_GE(slab_allocator->GetNumHugeTlbSlabs() +
+                slab_allocator->GetNumRegularSlabs(),
+            1U);
+
+  // Freed blocks are reused for the same size
+  uint64_t num_slabs = slab_allocator->GetNumHugeTlbSlabs() +
+                       slab_allocator->GetNumRegularSlabs();
+  for (auto& block : blocks) {
+    allocator->Deallocate(block.first);
+  }
+  for (int i = 0; i < 1000; ++i) {
+    void* p = allocator->Allocate(4096);
+    allocator->Deallocate(p);
+  }
+  ASSERT_LE(slab_allocator->GetNumHugeTlbSlabs() +
+                slab_allocator->GetNumRegularSlabs(),
+            num_slabs + 1);
+}
+
+TEST_F(CreateMemoryAllocatorTest, HugePageSlabCrossThreadDeallocate) {
+  HugePageSlabAllocatorOptions hopts;
+  std::shared_ptr<MemoryAllocator> allocator;
+  ASSERT_OK(NewHugePageSlabAllocator(hopts, &allocator));
+
+  // Blocks allocated by some threads and freed by others
+  const int kNumThreads = 8;
+  const int kNumBlocks = 2000;
+  std::vector<std::vector<void*>> blocks(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumBlocks; ++i) {
+        size_t size = 100 + (t * kNumBlocks + i) % 8000;
+        char* p = static_cast<char*>(allocator->Allocate(size));
+        memset(p, t, size);
+        blocks[t].push_back(p);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (void* p : blocks[(t + 1) % kNumThreads]) {
+        ASSERT_EQ(*static_cast<char*>(p), (t + 1) % kNumThreads);
+        allocator->Deallocate(p);
+      }
+      for (int i = 0; i < kNumBlocks; ++i) {
+        allocator->Deallocate(allocator->Allocate(100 + i % 8000));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+#endif  // ROCKSDB_HUGEPAGE_SLAB_ALLOCATOR
+
 INSTANTIATE_TEST_CASE_P(DefaultMemoryAllocator, MemoryAllocatorTest,
                         ::testing::Values(std::make_tuple(
                             DefaultMemoryAllocator::kClassName(), true)));
+INSTANTIATE_TEST_CASE_P(
+    HugePageSlabAllocator, MemoryAllocatorTest,
+    ::testing::Values(std::make_tuple(HugePageSlabAllocator::kClassName(),
+                                      HugePageSlabAllocator::IsSupported())));
 #ifdef MEMKIND
 INSTANTIATE_TEST_CASE_P(
     MemkindkMemAllocator, MemoryAllocatorTest,
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <thread>
 
 #include "db/memtable.h"
 #include "memory/arena.h"
@@ -31,9 +32,14 @@ using Pointer = std::atomic<void*>;
 struct BucketHeader {
   Pointer next;
   std::atomic<uint32_t> num_entries;
+  // Number of entries that have been, or are being, added to the bucket.
+  // Concurrent inserts claim their slot here before linking the entry and
+  // increment num_entries once it is linked. Equal to num_entries whenever
+  // no insert is in flight.
+  std::atomic<uint32_t> num_reserved;
 
   explicit BucketHeader(void* n, uint32_t count)
-      : next(n), num_entries(count) {}
+      : next(n), num_entries(count), num_reserved(count) {}
 
   bool IsSkipListBucket() {
     return next.load(std::memory_order_relaxed) == this;
@@ -48,6 +54,8 @@ struct BucketHeader {
     // Only one thread can do write at one time. No need to do atomic
     // incremental. Update it with relaxed load and store.
     num_entries.store(GetNumEntries() + 1, std::memory_order_relaxed);
+    num_reserved.store(num_reserved.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
   }
 };
 
@@ -83,6 +91,10 @@ struct Node {
 
   void NoBarrier_SetNext(Node* x) { next_.store(x, std::memory_order_relaxed); }
 
+  bool CASNext(Node* expected, Node* x) {
+    return next_.compare_exchange_strong(expected, x);
+  }
+
   // Needed for placement new below which is fine
   Node() {}
 
@@ -156,6 +168,15 @@ struct Node {
 //     to itself, so no matter a reader sees any stale or newer value, it will
 //     be able to correctly distinguish case 3 and 4.
 //
+// InsertConcurrently() follows the same transitions, using compare-and-swap
+// to publish the bucket pointer in case 1->2 and 2->3 and to link nodes into
+// the linked list of case 3. For case 3->4, every insert first reserves a
+// slot in the header (BucketHeader::num_reserved). The insert that reserves
+// slot threshold_use_skiplist_ waits until all inserts with smaller slots
+// have linked their nodes, builds the skip list and publishes the new
+// header; inserts with larger slots wait for the new header to be published
+// and then insert into the skip list.
+//
 // The reason that we use case 2 is we want to make the format to be efficient
 // when the utilization of buckets is relatively low. If we use case 3 for
 // single entry bucket, we will need to waste 12 bytes for every entry,
@@ -173,6 +194,8 @@ class HashLinkListRep : public MemTableRep {
 
   void Insert(KeyHandle handle) override;
 
+  void InsertConcurrently(KeyHandle handle) override;
+
   bool Contains(const char* key) const override;
 
   size_t ApproximateMemoryUsage() override;
@@ -259,6 +282,14 @@ class HashLinkListRep : public MemTableRep {
   Node* FindGreaterOrEqualInBucket(Node* head, const Slice& key) const;
   Node* FindLessOrEqualInBucket(Node* head, const Slice& key) const;
 
+  // Links x into the sorted linked list of a case 3 bucket, racing with
+  // other concurrent inserts into the same list.
+  void LinkListInsertConcurrently(BucketHeader* header, Node* x,
+                                  const Slice& internal_key);
+
+  void LogBucketEntries(const Slice& transformed, uint32_t num_entries,
+                        const Node* x) const;
+
   class FullListIterator : public MemTableRep::Iterator {
    public:
     explicit FullListIterator(MemtableSkipList* list, Allocator* allocator)
@@ -615,15 +646,7 @@ void HashLinkListRep::Insert(KeyHandle handle) {
     }
   }
 
-  if (bucket_entries_logging_threshold_ > 0 &&
-      header->GetNumEntries() ==
-          static_cast<uint32_t>(bucket_entries_logging_threshold_)) {
-    Info(logger_, "HashLinkedList bucket %" ROCKSDB_PRIszt
-                  " has more than %d "
-                  "entries. Key to insert: %s",
-         GetHash(transformed), header->GetNumEntries(),
-         GetLengthPrefixedSlice(x->key).ToString(true).c_str());
-  }
+  LogBucketEntries(transformed, header->GetNumEntries(), x);
 
   if (header->GetNumEntries() == threshold_use_skiplist_) {
     // Case 3. number of entries reaches the threshold so need to convert to
@@ -691,6 +714,143 @@ void HashLinkListRep::Insert(KeyHandle handle) {
   }
 }
 
+void HashLinkListRep::InsertConcurrently(KeyHandle handle) {
+  Node* x = static_cast<Node*>(handle);
+  Slice internal_key = GetLengthPrefixedSlice(x->key);
+  auto transformed = GetPrefix(internal_key);
+  auto& bucket = buckets_[GetHash(transformed)];
+
+  while (true) {
+    void* first_next_pointer_raw = bucket.load(std::memory_order_acquire);
+    Pointer* first_next_pointer = static_cast<Pointer*>(first_next_pointer_raw);
+
+    if (first_next_pointer == nullptr) {
+      // Case 1. empty bucket
+      x->NoBarrier_SetNext(nullptr);
+      if (bucket.compare_exchange_strong(first_next_pointer_raw, x,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+        return;
+      }
+      continue;
+    }
+
+    if (first_next_pointer->load(std::memory_order_acquire) == nullptr) {
+      // Case 2. only one entry in the bucket
+      // Convert it to a Counting bucket and retry. The single node is never
+      // modified while it is the bucket itself, so losing the race to
+      // another converting insert only wastes the header allocated here.
+      Node* first = reinterpret_cast<Node*>(first_next_pointer);
+      auto* mem = allocator_->AllocateAligned(sizeof(BucketHeader));
+      BucketHeader* new_header = new (mem) BucketHeader(first, 1);
+      bucket.compare_exchange_strong(first_next_pointer_raw, new_header,
+                                     std::memory_order_release,
+                                     std::memory_order_relaxed);
+      continue;
+    }
+
+    BucketHeader* header = reinterpret_cast<BucketHeader*>(first_next_pointer);
+    if (header->IsSkipListBucket()) {
+      // Case 4. Bucket is already a skip list
+      auto* skip_list_bucket_header =
+          reinterpret_cast<SkipListBucketHeader*>(header);
+      skip_list_bucket_header->Counting_header.num_entries.fetch_add(
+          1, std::memory_order_relaxed);
+      skip_list_bucket_header->skip_list.InsertConcurrently(x->key);
+      return;
+    }
+
+    uint32_t slot =
+        header->num_reserved.fetch_add(1, std::memory_order_relaxed);
+    if (slot > threshold_use_skiplist_) {
+      // Another insert is converting the bucket to a skip list. Wait for the
+      // new header to be published, then retry against it.
+      while (bucket.load(std::memory_order_acquire) == header) {
+        std::this_thread::yield();
+      }
+      continue;
+    }
+
+    LogBucketEntries(transformed, slot, x);
+
+    if (slot == threshold_use_skiplist_) {
+      // Case 3. number of entries reaches the threshold so need to convert to
+      // skip list. Wait for the inserts holding the smaller slots to finish
+      // linking their nodes; no node is added to the linked list afterwards.
+      while (header->num_entries.load(std::memory_order_acquire) !=
+             threshold_use_skiplist_) {
+        std::this_thread::yield();
+      }
+      LinkListIterator bucket_iter(
+          this, reinterpret_cast<Node*>(
+                    header->next.load(std::memory_order_acquire)));
+      auto mem = allocator_->AllocateAligned(sizeof(SkipListBucketHeader));
+      SkipListBucketHeader* new_skip_list_header =
+          new (mem) SkipListBucketHeader(compare_, allocator_,
+                                         threshold_use_skiplist_ + 1);
+      auto& skip_list = new_skip_list_header->skip_list;
+
+      // The new skip list is not visible to anyone else yet
+      for (bucket_iter.SeekToHead(); bucket_iter.Valid(); bucket_iter.Next()) {
+        skip_list.Insert(bucket_iter.key());
+      }
+      skip_list.Insert(x->key);
+      bucket.store(new_skip_list_header, std::memory_order_release);
+      return;
+    }
+
+    // Case 5. insert to the sorted linked list without changing the header
+    LinkListInsertConcurrently(header, x, internal_key);
+    header->num_entries.fetch_add(1, std::memory_order_release);
+    return;
+  }
+}
+
+void HashLinkListRep::LinkListInsertConcurrently(BucketHeader* header, Node* x,
+                                                 const Slice& internal_key) {
+  Node* prev = nullptr;
+  Node* cur =
+      reinterpret_cast<Node*>(header->next.load(std::memory_order_acquire));
+  while (true) {
+    while (KeyIsAfterNode(internal_key, cur)) {
+      prev = cur;
+      cur = cur->Next();
+    }
+
+    // Our data structure does not allow duplicate insertion
+    assert(cur == nullptr || !Equal(x->key, cur->key));
+
+    x->NoBarrier_SetNext(cur);
+    if (prev != nullptr) {
+      if (prev->CASNext(cur, x)) {
+        return;
+      }
+      // Another insert linked a node after prev, which still precedes x
+      cur = prev->Next();
+    } else {
+      void* expected = cur;
+      if (header->next.compare_exchange_strong(expected, x)) {
+        return;
+      }
+      cur = static_cast<Node*>(expected);
+    }
+  }
+}
+
+void HashLinkListRep::LogBucketEntries(const Slice& transformed,
+                                       uint32_t num_entries,
+                                       const Node* x) const {
+  if (bucket_entries_logging_threshold_ > 0 &&
+      num_entries ==
+          static_cast<uint32_t>(bucket_entries_logging_threshold_)) {
+    Info(logger_, "HashLinkedList bucket %" ROCKSDB_PRIszt
+                  " has more than %d "
+                  "entries. Key to insert: %s",
+         GetHash(transformed), num_entries,
+         GetLengthPrefixedSlice(x->key).ToString(true).c_str());
+  }
+}
+
 bool HashLinkListRep::Contains(const char* key) const {
   Slice internal_key = GetLengthPrefixedSlice(key);
 
@@ -878,6 +1038,8 @@ class HashLinkListRepFactory : public MemTableRepFactory {
   virtual const char* Name() const override { return kClassName(); }
   virtual const char* NickName() const override { return kNickName(); }
 
+  bool IsInsertConcurrentlySupported() const override { return true; }
+
  private:
   HashLinkListRepOptions options_;
 };
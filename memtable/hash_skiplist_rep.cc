@@ -29,6 +29,8 @@ class HashSkipListRep : public MemTableRep {
 
   void Insert(KeyHandle handle) override;
 
+  void InsertConcurrently(KeyHandle handle) override;
+
   bool Contains(const char* key) const override;
 
   size_t ApproximateMemoryUsage() override;
@@ -74,7 +76,7 @@ class HashSkipListRep : public MemTableRep {
     return GetBucket(GetHash(slice));
   }
   // Get a bucket from buckets_. If the bucket hasn't been initialized yet,
-  // initialize it before returning.
+  // initialize it before returning. Safe to call from concurrent inserts.
   Bucket* GetInitializedBucket(const Slice& transformed);
 
   class Iterator : public MemTableRep::Iterator {
@@ -257,9 +259,16 @@ HashSkipListRep::Bucket* HashSkipListRep::GetInitializedBucket(
   auto bucket = GetBucket(hash);
   if (bucket == nullptr) {
     auto addr = allocator_->AllocateAligned(sizeof(Bucket));
-    bucket = new (addr) Bucket(compare_, allocator_, skiplist_height_,
-                               skiplist_branching_factor_);
-    buckets_[hash].store(bucket, std::memory_order_release);
+    auto new_bucket = new (addr) Bucket(compare_, allocator_, skiplist_height_,
+                                        skiplist_branching_factor_);
+    // If a concurrent insert has installed a bucket in the meantime, use
+    // that one. The memory of new_bucket is wasted until the allocator is
+    // freed, which is acceptable as it can only happen once per bucket.
+    if (buckets_[hash].compare_exchange_strong(bucket, new_bucket,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+      bucket = new_bucket;
+    }
   }
   return bucket;
 }
@@ -272,6 +281,13 @@ void HashSkipListRep::Insert(KeyHandle handle) {
   bucket->Insert(key);
 }
 
+void HashSkipListRep::InsertConcurrently(KeyHandle handle) {
+  auto* key = static_cast<char*>(handle);
+  auto transformed = transform_->Transform(UserKey(key));
+  auto bucket = GetInitializedBucket(transformed);
+  bucket->InsertConcurrently(key);
+}
+
 bool HashSkipListRep::Contains(const char* key) const {
   auto transformed = transform_->Transform(UserKey(key));
   auto bucket = GetBucket(transformed);
@@ -370,6 +386,8 @@ class HashSkipListRepFactory : public MemTableRepFactory {
   virtual const char* Name() const override { return kClassName(); }
   virtual const char* NickName() const override { return kNickName(); }
 
+  bool IsInsertConcurrentlySupported() const override { return true; }
+
  private:
   HashSkipListRepOptions options_;
 };
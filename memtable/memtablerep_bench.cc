@@ -25,6 +25,7 @@ int main() {
 #include "db/dbformat.h"
 #include "db/memtable.h"
 #include "memory/arena.h"
+#include "memory/concurrent_arena.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/comparator.h"
@@ -47,6 +48,9 @@ DEFINE_string(benchmarks, "fillrandom",
               "Comma-separated list of benchmarks to run. Options:\n"
               "\tfillrandom             -- write N random values\n"
               "\tfillseq                -- write N values in sequential order\n"
+              "\tfillrandomconcurrent   -- N threads write random values "
+              "in parallel\n"
+              "\t                          using InsertConcurrently()\n"
               "\treadrandom             -- read N values in random order\n"
               "\treadseq                -- scan the DB\n"
               "\treadwrite              -- 1 thread writes while N - 1 threads "
@@ -99,7 +103,8 @@ DEFINE_int64(write_buffer_size, 256,
 DEFINE_int32(
     num_threads, 1,
     "Number of concurrent threads to run. If the benchmark includes writes,\n"
-    "then at most one thread will be a writer");
+    "then at most one thread will be a writer, except for\n"
+    "fillrandomconcurrent, where all threads are writers");
 
 DEFINE_int32(num_operations, 1000000,
              "Number of operations to do for write and random read benchmarks");
@@ -234,7 +239,9 @@ class FillBenchmarkThread : public BenchmarkThread {
       : BenchmarkThread(table, key_gen, bytes_written, bytes_read, sequence,
                         num_ops, read_hits) {}
 
-  void FillOne() {
+  void FillOne() { FillOne(key_gen_->Next(), false /* concurrently */); }
+
+  void FillOne(uint64_t key, bool concurrently) {
     char* buf = nullptr;
     auto internal_key_size = 16;
     auto encoded_len =
@@ -242,7 +249,6 @@ class FillBenchmarkThread : public BenchmarkThread {
     KeyHandle handle = table_->Allocate(encoded_len, &buf);
     assert(buf != nullptr);
     char* p = EncodeVarint32(buf, internal_key_size);
-    auto key = key_gen_->Next();
     EncodeFixed64(p, key);
     p += 8;
     EncodeFixed64(p, ++(*sequence_));
@@ -251,7 +257,11 @@ class FillBenchmarkThread : public BenchmarkThread {
     memcpy(p, bytes.data(), FLAGS_item_size);
     p += FLAGS_item_size;
     assert(p == buf + encoded_len);
-    table_->Insert(handle);
+    if (concurrently) {
+      table_->InsertConcurrently(handle);
+    } else {
+      table_->Insert(handle);
+    }
     *bytes_written_ += encoded_len;
   }
 
@@ -286,6 +296,30 @@ class ConcurrentFillBenchmarkThread : public FillBenchmarkThread {
   std::atomic_int* threads_done_;
 };
 
+// One of several writer threads inserting into the same table. Every thread
+// writes its own keys (key_gen_ values scaled by the number of threads plus
+// the thread index), and counts its own bytes and sequence numbers.
+class MultiWriterFillBenchmarkThread : public FillBenchmarkThread {
+ public:
+  MultiWriterFillBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
+                                 uint64_t* bytes_written, uint64_t* bytes_read,
+                                 uint64_t* sequence, uint64_t num_ops,
+                                 uint64_t* read_hits, uint32_t thread_index)
+      : FillBenchmarkThread(table, key_gen, bytes_written, bytes_read, sequence,
+                            num_ops, read_hits),
+        thread_index_(thread_index) {}
+
+  void operator()() override {
+    for (unsigned int i = 0; i < num_ops_; ++i) {
+      FillOne(key_gen_->Next() * FLAGS_num_threads + thread_index_,
+              true /* concurrently */);
+    }
+  }
+
+ private:
+  const uint32_t thread_index_;
+};
+
 class ReadBenchmarkThread : public BenchmarkThread {
  public:
   ReadBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
@@ -475,6 +509,38 @@ class FillBenchmark : public Benchmark {
   }
 };
 
+class MultiWriterFillBenchmark : public Benchmark {
+ public:
+  explicit MultiWriterFillBenchmark(MemTableRep* table, uint64_t* sequence)
+      : Benchmark(table, nullptr, sequence, FLAGS_num_threads) {
+    num_write_ops_per_thread_ = FLAGS_num_operations / FLAGS_num_threads;
+  }
+
+  void RunThreads(std::vector<port::Thread>* threads, uint64_t* bytes_written,
+                  uint64_t* bytes_read, bool /*write*/,
+                  uint64_t* read_hits) override {
+    std::vector<std::unique_ptr<KeyGenerator>> key_gens;
+    std::vector<uint64_t> thread_bytes_written(num_threads_, 0);
+    std::vector<uint64_t> thread_sequences(num_threads_, *sequence_);
+    for (uint32_t i = 0; i < num_threads_; ++i) {
+      key_gens.emplace_back(new KeyGenerator(nullptr, UNIQUE_RANDOM,
+                                             num_write_ops_per_thread_));
+    }
+    for (uint32_t i = 0; i < num_threads_; ++i) {
+      threads->emplace_back(MultiWriterFillBenchmarkThread(
+          table_, key_gens[i].get(), &thread_bytes_written[i], bytes_read,
+          &thread_sequences[i], num_write_ops_per_thread_, read_hits, i));
+    }
+    for (auto& thread : *threads) {
+      thread.join();
+    }
+    for (uint32_t i = 0; i < num_threads_; ++i) {
+      *bytes_written += thread_bytes_written[i];
+      *sequence_ = std::max(*sequence_, thread_sequences[i]);
+    }
+  }
+};
+
 class ReadBenchmark : public Benchmark {
  public:
   explicit ReadBenchmark(MemTableRep* table, KeyGenerator* key_gen,
@@ -615,6 +681,8 @@ int main(int argc, char** argv) {
       ROCKSDB_NAMESPACE::BytewiseComparator());
   ROCKSDB_NAMESPACE::MemTable::KeyComparator key_comp(internal_key_comp);
   ROCKSDB_NAMESPACE::Arena arena;
+  // Concurrent inserts need a thread-safe allocator, as in MemTable
+  ROCKSDB_NAMESPACE::ConcurrentArena concurrent_arena;
   ROCKSDB_NAMESPACE::WriteBufferManager wb(FLAGS_write_buffer_size);
   uint64_t sequence;
   auto createMemtableRep = [&] {
@@ -623,6 +691,12 @@ int main(int argc, char** argv) {
                                       options.prefix_extractor.get(),
                                       options.info_log.get());
   };
+  auto createConcurrentMemtableRep = [&] {
+    sequence = 0;
+    return factory->CreateMemTableRep(key_comp, &concurrent_arena,
+                                      options.prefix_extractor.get(),
+                                      options.info_log.get());
+  };
   std::unique_ptr<ROCKSDB_NAMESPACE::MemTableRep> memtablerep;
   ROCKSDB_NAMESPACE::Random64 rng(FLAGS_seed);
   const char* benchmarks = FLAGS_benchmarks.c_str();
@@ -650,6 +724,16 @@ int main(int argc, char** argv) {
           &rng, ROCKSDB_NAMESPACE::UNIQUE_RANDOM, FLAGS_num_operations));
       benchmark.reset(new ROCKSDB_NAMESPACE::FillBenchmark(
           memtablerep.get(), key_gen.get(), &sequence));
+    } else if (name == ROCKSDB_NAMESPACE::Slice("fillrandomconcurrent")) {
+      if (!factory->IsInsertConcurrentlySupported()) {
+        std::cout << "WARNING: skipping benchmark '" << name.ToString()
+                  << "', memtablerep " << FLAGS_memtablerep
+                  << " does not support concurrent inserts" << std::endl;
+        continue;
+      }
+      memtablerep.reset(createConcurrentMemtableRep());
+      benchmark.reset(new ROCKSDB_NAMESPACE::MultiWriterFillBenchmark(
+          memtablerep.get(), &sequence));
     } else if (name == ROCKSDB_NAMESPACE::Slice("readrandom")) {
       key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
           &rng, ROCKSDB_NAMESPACE::RANDOM, FLAGS_num_operations));
@@ -10,7 +10,9 @@
 // Thread safety
 // -------------
 //
-// Writes require external synchronization, most likely a mutex.
+// Writes via Insert require external synchronization, most likely a mutex.
+// InsertConcurrently can be safely called concurrently with reads and
+// with other concurrent inserts, but not concurrently with Insert.
 // Reads require a guarantee that the SkipList will not be destroyed
 // while the read is in progress.  Apart from that, reads progress
 // without any internal locking or synchronization.
@@ -35,6 +37,7 @@
 #include <stdlib.h>
 #include <atomic>
 #include "memory/allocator.h"
+#include "port/likely.h"
 #include "port/port.h"
 #include "util/random.h"
 
@@ -55,10 +58,19 @@ class SkipList {
   SkipList(const SkipList&) = delete;
   void operator=(const SkipList&) = delete;
 
+  static const uint16_t kMaxPossibleHeight = 32;
+
   // Insert key into the list.
   // REQUIRES: nothing that compares equal to key is currently in the list.
+  // REQUIRES: no concurrent calls to any of inserts.
   void Insert(const Key& key);
 
+  // Like Insert, but external synchronization is not required between
+  // concurrent calls of InsertConcurrently.
+  // REQUIRES: nothing that compares equal to key is currently in the list.
+  // REQUIRES: no concurrent calls to Insert.
+  void InsertConcurrently(const Key& key);
+
   // Returns true iff an entry that compares equal to key is in the list.
   bool Contains(const Key& key) const;
 
@@ -134,6 +146,10 @@ class SkipList {
   Node** prev_;
   int32_t prev_height_;
 
+  // Set by InsertConcurrently(), which does not maintain prev_. The next
+  // Insert() recomputes prev_ with a full search and clears it.
+  std::atomic<bool> prev_stale_;
+
   inline int GetMaxHeight() const {
     return max_height_.load(std::memory_order_relaxed);
   }
@@ -158,6 +174,13 @@ class SkipList {
   // level in [0..max_height_-1], if prev is non-null.
   Node* FindLessThan(const Key& key, Node** prev = nullptr) const;
 
+  // Traverses a single level of the list, starting at before, and sets
+  // *out_prev and *out_next to the nodes the key belongs between at that
+  // level.
+  // REQUIRES: before is head_ or a node with a key less than key.
+  void FindSpliceForLevel(const Key& key, Node* before, int level,
+                          Node** out_prev, Node** out_next) const;
+
   // Return the last node in the list.
   // Return head_ if list is empty.
   Node* FindLast() const;
@@ -195,6 +218,11 @@ struct SkipList<Key, Comparator>::Node {
     next_[n].store(x, std::memory_order_relaxed);
   }
 
+  bool CASNext(int n, Node* expected, Node* x) {
+    assert(n >= 0);
+    return next_[n].compare_exchange_strong(expected, x);
+  }
+
  private:
   // Array of length equal to the node height.  next_[0] is lowest level link.
   std::atomic<Node*> next_[1];
@@ -360,6 +388,25 @@ SkipList<Key, Comparator>::FindLessThan(const Key& key, Node** prev) const {
   }
 }
 
+template <typename Key, class Comparator>
+void SkipList<Key, Comparator>::FindSpliceForLevel(const Key& key,
+                                                   Node* before, int level,
+                                                   Node** out_prev,
+                                                   Node** out_next) const {
+  while (true) {
+    Node* next = before->Next(level);
+    assert(before == head_ || next == nullptr ||
+           KeyIsAfterNode(next->key, before));
+    assert(before == head_ || KeyIsAfterNode(key, before));
+    if (!KeyIsAfterNode(key, next)) {
+      *out_prev = before;
+      *out_next = next;
+      return;
+    }
+    before = next;
+  }
+}
+
 template<typename Key, class Comparator>
 typename SkipList<Key, Comparator>::Node* SkipList<Key, Comparator>::FindLast()
     const {
@@ -415,7 +462,8 @@ SkipList<Key, Comparator>::SkipList(const Comparator cmp, Allocator* allocator,
       allocator_(allocator),
       head_(NewNode(0 /* any key will do */, max_height)),
       max_height_(1),
-      prev_height_(1) {
+      prev_height_(1),
+      prev_stale_(false) {
   assert(max_height > 0 && kMaxHeight_ == static_cast<uint32_t>(max_height));
   assert(branching_factor > 0 &&
          kBranching_ == static_cast<uint32_t>(branching_factor));
@@ -434,8 +482,13 @@ SkipList<Key, Comparator>::SkipList(const Comparator cmp, Allocator* allocator,
 template<typename Key, class Comparator>
 void SkipList<Key, Comparator>::Insert(const Key& key) {
   // fast path for sequential insertion
-  if (!KeyIsAfterNode(key, prev_[0]->NoBarrier_Next(0)) &&
-      (prev_[0] == head_ || KeyIsAfterNode(key, prev_[0]))) {
+  if (UNLIKELY(prev_stale_.load(std::memory_order_relaxed))) {
+    // Nodes linked by InsertConcurrently() may sit between prev_[i] and
+    // prev_[0] on any level, so the cached predecessors cannot be trusted.
+    FindLessThan(key, prev_);
+    prev_stale_.store(false, std::memory_order_relaxed);
+  } else if (!KeyIsAfterNode(key, prev_[0]->NoBarrier_Next(0)) &&
+             (prev_[0] == head_ || KeyIsAfterNode(key, prev_[0]))) {
     assert(prev_[0] != head_ || (prev_height_ == 1 && GetMaxHeight() == 1));
 
     // Outside of this method prev_[1..max_height_] is the predecessor
@@ -483,6 +536,52 @@ void SkipList<Key, Comparator>::Insert(const Key& key) {
   prev_height_ = height;
 }
 
+template <typename Key, class Comparator>
+void SkipList<Key, Comparator>::InsertConcurrently(const Key& key) {
+  assert(kMaxHeight_ <= kMaxPossibleHeight);
+  Node* prev[kMaxPossibleHeight];
+  Node* next[kMaxPossibleHeight];
+
+  int height = RandomHeight();
+  int max_height = GetMaxHeight();
+  while (height > max_height) {
+    if (max_height_.compare_exchange_weak(max_height, height)) {
+      // Readers that observe the new height before the new levels of head_
+      // are linked see nullptr there and drop to the next level.
+      max_height = height;
+      break;
+    }
+    // compare_exchange_weak has reloaded max_height
+  }
+
+  // Find the splice on every level, top-down, as FindLessThan() does
+  Node* before = head_;
+  for (int level = max_height - 1; level >= 0; --level) {
+    FindSpliceForLevel(key, before, level, &prev[level], &next[level]);
+    before = prev[level];
+  }
+
+  if (!prev_stale_.load(std::memory_order_relaxed)) {
+    prev_stale_.store(true, std::memory_order_relaxed);
+  }
+
+  Node* x = NewNode(key, height);
+  for (int i = 0; i < height; i++) {
+    while (true) {
+      // Our data structure does not allow duplicate insertion
+      assert(next[i] == nullptr || !Equal(key, next[i]->key));
+      x->NoBarrier_SetNext(i, next[i]);
+      if (prev[i]->CASNext(i, next[i], x)) {
+        // success
+        break;
+      }
+      // CAS failed, another concurrent insert linked a node after prev[i].
+      // prev[i] still precedes key, so the search can resume from there.
+      FindSpliceForLevel(key, prev[i], i, &prev[i], &next[i]);
+    }
+  }
+}
+
 template<typename Key, class Comparator>
 bool SkipList<Key, Comparator>::Contains(const Key& key) const {
   Node* x = FindGreaterOrEqual(key);
@@ -9,7 +9,9 @@
 
 #include "memtable/skiplist.h"
 #include <set>
+#include <vector>
 #include "memory/arena.h"
+#include "memory/concurrent_arena.h"
 #include "rocksdb/env.h"
 #include "test_util/testharness.h"
 #include "util/hash.h"
@@ -136,6 +138,55 @@ TEST_F(SkipTest, InsertAndLookup) {
   }
 }
 
+TEST_F(SkipTest, InsertConcurrently) {
+  const int kNumThreads = 4;
+  const int kKeysPerThread = 2000;
+  ConcurrentArena arena;
+  TestComparator cmp;
+  SkipList<Key, TestComparator> list(cmp, &arena);
+
+  // Seed the list with a few serial inserts, so that the concurrent inserts
+  // start from stale sequential insertion hints.
+  for (Key k = 0; k < 100; k += 2) {
+    list.Insert(k * kNumThreads * kKeysPerThread);
+  }
+
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&list, t]() {
+      Random rnd(301 + t);
+      for (int i = 0; i < kKeysPerThread; ++i) {
+        // Odd keys, interleaved across threads
+        Key k = (static_cast<Key>(rnd.Uniform(1000)) * kKeysPerThread + i) *
+                    kNumThreads * 2 +
+                t * 2 + 1;
+        list.InsertConcurrently(k);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Serial inserts after concurrent ones must still keep the list sorted
+  for (Key k = 1; k < 100; k += 2) {
+    list.Insert(k * kNumThreads * kKeysPerThread);
+  }
+
+  size_t count = 0;
+  SkipList<Key, TestComparator>::Iterator iter(&list);
+  Key prev_key = 0;
+  for (iter.SeekToFirst(); iter.Valid(); iter.Next()) {
+    if (count > 0) {
+      ASSERT_LT(prev_key, iter.key());
+    }
+    ASSERT_TRUE(list.Contains(iter.key()));
+    prev_key = iter.key();
+    ++count;
+  }
+  ASSERT_EQ(static_cast<size_t>(100 + kNumThreads * kKeysPerThread), count);
+}
+
 // We want to make sure that with a single writer and multiple
 // concurrent readers (with no synchronization other than when a
 // reader's iterator is created), the reader always observes all the
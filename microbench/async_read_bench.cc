@@ -0,0 +1,128 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+// Compares point lookups from a single thread with DB::Get() against lookups
+// kept in flight with an AsyncReader, on a DB that does not fit in the block
+// cache.
+#include <benchmark/benchmark.h>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/db.h"
+#include "rocksdb/options.h"
+#include "rocksdb/table.h"
+#include "rocksdb/utilities/async_reader.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+static const int kNumKeys = 100000;
+
+static std::string BenchKey(int i) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "key%08d", i);
+  return buf;
+}
+
+// Opens a DB of kNumKeys keys in table files, with a small block cache
+static Status OpenBenchDB(DB** db, std::string* db_name) {
+  std::string db_path;
+  Status s = Env::Default()->GetTestDirectory(&db_path);
+  if (!s.ok()) {
+    return s;
+  }
+  *db_name = db_path + "/bench_async_read";
+  Options options;
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(1 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyDB(*db_name, options);
+  options.create_if_missing = true;
+  s = DB::Open(options, *db_name, db);
+  if (!s.ok()) {
+    return s;
+  }
+  auto rnd = Random(12345);
+  for (int i = 0; i < kNumKeys && s.ok(); i++) {
+    s = (*db)->Put(WriteOptions(), BenchKey(i), rnd.RandomString(100));
+  }
+  if (s.ok()) {
+    s = (*db)->Flush(FlushOptions());
+  }
+  return s;
+}
+
+static void SyncGet(benchmark::State& state) {
+  DB* db;
+  std::string db_name;
+  Status s = OpenBenchDB(&db, &db_name);
+  if (!s.ok()) {
+    state.SkipWithError(s.ToString().c_str());
+    return;
+  }
+  auto rnd = Random(301);
+  PinnableSlice value;
+  for (auto _ : state) {
+    value.Reset();
+    s = db->Get(ReadOptions(), db->DefaultColumnFamily(),
+                BenchKey(static_cast<int>(rnd.Uniform(kNumKeys))), &value);
+    if (!s.ok()) {
+      state.SkipWithError(s.ToString().c_str());
+      break;
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+  delete db;
+  DestroyDB(db_name, Options());
+}
+
+BENCHMARK(SyncGet);
+
+static void AsyncReaderGet(benchmark::State& state) {
+  DB* db;
+  std::string db_name;
+  Status s = OpenBenchDB(&db, &db_name);
+  if (!s.ok()) {
+    state.SkipWithError(s.ToString().c_str());
+    return;
+  }
+  const size_t num_in_flight = static_cast<size_t>(state.range(0));
+  std::unique_ptr<AsyncReader> reader;
+  s = NewAsyncReader(db, ReadOptions(), num_in_flight, &reader);
+  if (!s.ok()) {
+    state.SkipWithError(s.ToString().c_str());
+    return;
+  }
+  auto rnd = Random(301);
+  int64_t num_completed = 0;
+  Status lookup_status;
+  for (auto _ : state) {
+    // Submit num_in_flight lookups, and resume those that need I/O together
+    for (size_t i = 0; i < num_in_flight; i++) {
+      reader->Get(db->DefaultColumnFamily(),
+                  BenchKey(static_cast<int>(rnd.Uniform(kNumKeys))),
+                  [&](const Status& status, PinnableSlice* /*value*/) {
+                    ++num_completed;
+                    if (!status.ok()) {
+                      lookup_status = status;
+                    }
+                  });
+    }
+    reader->Poll();
+    if (!lookup_status.ok()) {
+      state.SkipWithError(lookup_status.ToString().c_str());
+      break;
+    }
+  }
+  state.SetItemsProcessed(num_completed);
+  reader.reset();
+  delete db;
+  DestroyDB(db_name, Options());
+}
+
+BENCHMARK(AsyncReaderGet)->Arg(1)->Arg(8)->Arg(32)->Arg(128);
+
+}  // namespace ROCKSDB_NAMESPACE
+
+BENCHMARK_MAIN();
@@ -225,6 +225,12 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {LOOKASIDE_CACHE_HIT, "rocksdb.lookaside.cache.hit"},
     {LOOKASIDE_CACHE_MISS, "rocksdb.lookaside.cache.miss"},
     {LOOKASIDE_CACHE_EVICTION, "rocksdb.lookaside.cache.eviction"},
+    {BLOB_DB_CACHE_MISS, "rocksdb.blobdb.cache.miss"},
+    {BLOB_DB_CACHE_HIT, "rocksdb.blobdb.cache.hit"},
+    {BLOB_DB_CACHE_ADD, "rocksdb.blobdb.cache.add"},
+    {BLOB_DB_CACHE_ADD_FAILURES, "rocksdb.blobdb.cache.add.failures"},
+    {BLOB_DB_CACHE_BYTES_READ, "rocksdb.blobdb.cache.bytes.read"},
+    {BLOB_DB_CACHE_BYTES_WRITE, "rocksdb.blobdb.cache.bytes.write"},
 };
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
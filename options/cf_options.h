@@ -82,6 +82,10 @@ struct ImmutableCFOptions {
   std::shared_ptr<ConcurrentTaskLimiter> compaction_thread_limiter;
 
   std::shared_ptr<SstPartitionerFactory> sst_partitioner_factory;
+
+  std::shared_ptr<Cache> blob_cache;
+
+  std::shared_ptr<KeyHotnessTracker> key_hotness_tracker;
 };
 
 struct ImmutableOptions : public ImmutableDBOptions, public ImmutableCFOptions {
@@ -155,6 +159,8 @@ struct MutableCFOptions {
         compression_opts(options.compression_opts),
         bottommost_compression_opts(options.bottommost_compression_opts),
         bottommost_temperature(options.bottommost_temperature),
+        cold_key_temperature(options.cold_key_temperature),
+        compaction_block_passthrough(options.compaction_block_passthrough),
         sample_for_compression(
             options.sample_for_compression) {  // TODO: is 0 fine here?
     RefreshDerivedOptions(options.num_levels, options.compaction_style);
@@ -199,6 +205,8 @@ struct MutableCFOptions {
         compression(Snappy_Supported() ? kSnappyCompression : kNoCompression),
         bottommost_compression(kDisableCompressionOption),
         bottommost_temperature(Temperature::kUnknown),
+        cold_key_temperature(Temperature::kUnknown),
+        compaction_block_passthrough(false),
         sample_for_compression(0) {}
 
   explicit MutableCFOptions(const Options& options);
@@ -271,6 +279,8 @@ struct MutableCFOptions {
   // TODO this experimental option isn't made configurable
   // through strings yet.
   Temperature bottommost_temperature;
+  Temperature cold_key_temperature;
+  bool compaction_block_passthrough;
 
   uint64_t sample_for_compression;
 
@@ -20,6 +20,7 @@
 #include "rocksdb/compaction_filter.h"
 #include "rocksdb/comparator.h"
 #include "rocksdb/env.h"
+#include "rocksdb/key_hotness_tracker.h"
 #include "rocksdb/filter_policy.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/merge_operator.h"
@@ -100,7 +101,11 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
           options.blob_garbage_collection_age_cutoff),
       blob_garbage_collection_force_threshold(
           options.blob_garbage_collection_force_threshold),
-      blob_compaction_readahead_size(options.blob_compaction_readahead_size) {
+      blob_compaction_readahead_size(options.blob_compaction_readahead_size),
+      blob_cache(options.blob_cache),
+      key_hotness_tracker(options.key_hotness_tracker),
+      cold_key_temperature(options.cold_key_temperature),
+      compaction_block_passthrough(options.compaction_block_passthrough) {
   assert(memtable_factory.get() != nullptr);
   if (max_bytes_for_level_multiplier_additional.size() <
       static_cast<unsigned int>(num_levels)) {
@@ -409,6 +414,22 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(
         log, "         Options.blob_compaction_readahead_size: %" PRIu64,
         blob_compaction_readahead_size);
+    if (blob_cache) {
+      ROCKS_LOG_HEADER(log, "                     Options.blob_cache: %s",
+                       blob_cache->Name());
+      ROCKS_LOG_HEADER(log,
+                       "            Options.blob_cache capacity: %" ROCKSDB_PRIszt,
+                       blob_cache->GetCapacity());
+    } else {
+      ROCKS_LOG_HEADER(log, "                     Options.blob_cache: None");
+    }
+    ROCKS_LOG_HEADER(log, "            Options.key_hotness_tracker: %s",
+                     key_hotness_tracker ? key_hotness_tracker->Name()
+                                         : "None");
+    ROCKS_LOG_HEADER(log, "           Options.cold_key_temperature: %d",
+                     static_cast<int>(cold_key_temperature));
+    ROCKS_LOG_HEADER(log, "   Options.compaction_block_passthrough: %d",
+                     compaction_block_passthrough);
 }  // ColumnFamilyOptions::Dump
 
 void Options::Dump(Logger* log) const {
@@ -655,7 +676,9 @@ ReadOptions::ReadOptions()
       deadline(std::chrono::microseconds::zero()),
       io_timeout(std::chrono::microseconds::zero()),
       value_size_soft_limit(std::numeric_limits<uint64_t>::max()),
-      adaptive_readahead(false) {}
+      adaptive_readahead(false),
+      async_io(false),
+      value_columns(nullptr) {}
 
 ReadOptions::ReadOptions(bool cksum, bool cache)
     : snapshot(nullptr),
@@ -680,7 +703,9 @@ ReadOptions::ReadOptions(bool cksum, bool cache)
       deadline(std::chrono::microseconds::zero()),
       io_timeout(std::chrono::microseconds::zero()),
       value_size_soft_limit(std::numeric_limits<uint64_t>::max()),
-      adaptive_readahead(false) {}
+      adaptive_readahead(false),
+      async_io(false),
+      value_columns(nullptr) {}
 
 void cache_options::UpdateFromEnv() {
   // a true hack, not to be imitated
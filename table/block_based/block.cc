@@ -21,6 +21,7 @@
 #include "rocksdb/comparator.h"
 #include "table/block_based/block_prefix_index.h"
 #include "table/block_based/data_block_footer.h"
+#include "table/block_based/interpolation_index.h"
 #include "table/format.h"
 #include "util/coding.h"
 
@@ -220,20 +221,51 @@ void DataBlockIter::PrevImpl() {
     if (raw_key_.IsKeyPinned()) {
       // The key is not delta encoded
       prev_entries_.emplace_back(current_, current_key.data(), 0,
-                                 current_key.size(), value());
+                                 current_key.size(), value_);
     } else {
       // The key is delta encoded, cache decoded key in buffer
       size_t new_key_offset = prev_entries_keys_buff_.size();
       prev_entries_keys_buff_.append(current_key.data(), current_key.size());
 
       prev_entries_.emplace_back(current_, nullptr, new_key_offset,
-                                 current_key.size(), value());
+                                 current_key.size(), value_);
     }
     // Loop until end of current entry hits the start of original entry
   } while (NextEntryOffset() < original);
   prev_entries_idx_ = static_cast<int32_t>(prev_entries_.size()) - 1;
 }
 
+Slice DataBlockIter::AssembleValue() const {
+  uint32_t row = 0;
+  Slice value;
+  if (!value_columns_->DecodeEntryValue(value_, &row, &value)) {
+    return value;
+  }
+  assembled_value_.clear();
+  value_columns_->AppendRow(row, &assembled_value_);
+  return assembled_value_;
+}
+
+bool DataBlockIter::IsValueAssembled() const {
+  uint32_t row = 0;
+  Slice value;
+  return value_columns_ != nullptr &&
+         value_columns_->DecodeEntryValue(value_, &row, &value);
+}
+
+bool DataBlockIter::ProjectValue(const std::vector<uint32_t>& columns,
+                                 std::string* projected) const {
+  assert(Valid());
+  uint32_t row = 0;
+  Slice value;
+  if (value_columns_ == nullptr ||
+      !value_columns_->DecodeEntryValue(value_, &row, &value)) {
+    return false;
+  }
+  value_columns_->AppendColumns(row, columns, projected);
+  return true;
+}
+
 void DataBlockIter::SeekImpl(const Slice& target) {
   Slice seek_key = target;
   PERF_TIMER_GUARD(block_seek_nanos);
@@ -242,7 +274,13 @@ void DataBlockIter::SeekImpl(const Slice& target) {
   }
   uint32_t index = 0;
   bool skip_linear_scan = false;
-  bool ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan);
+  int64_t left = -1;
+  int64_t right = static_cast<int64_t>(num_restarts_) - 1;
+  if (restart_key_prefixes_ != nullptr) {
+    RestartKeyPrefixBounds(seek_key, &left, &right);
+  }
+  bool ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan, left,
+                                  right);
 
   if (!ok) {
     return;
@@ -250,6 +288,63 @@ void DataBlockIter::SeekImpl(const Slice& target) {
   FindKeyAfterBinarySeek(seek_key, index, skip_linear_scan);
 }
 
+namespace {
+// Restart key prefixes are searched by bisection down to a window of this many
+// prefixes, which are then compared all at once.
+const uint32_t kRestartKeyPrefixScanWindow = 16;
+
+// Returns the number of restart key prefixes less than `target_prefix` (or,
+// if kOrEqual, less than or equal to it).
+template <bool kOrEqual>
+uint32_t CountRestartKeyPrefixesBelow(const char* restart_key_prefixes,
+                                      uint32_t num_restarts,
+                                      uint64_t target_prefix) {
+  uint32_t lo = 0;
+  uint32_t hi = num_restarts;
+  while (hi - lo > kRestartKeyPrefixScanWindow) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    uint64_t prefix =
+        DecodeFixed64(restart_key_prefixes + mid * sizeof(uint64_t));
+    if (kOrEqual ? prefix <= target_prefix : prefix < target_prefix) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  // Branch-free, so that the compiler can vectorize it
+  uint32_t count = lo;
+  for (uint32_t i = lo; i < hi; ++i) {
+    uint64_t prefix = DecodeFixed64(restart_key_prefixes + i * sizeof(uint64_t));
+    count += static_cast<uint32_t>(kOrEqual ? prefix <= target_prefix
+                                            : prefix < target_prefix);
+  }
+  return count;
+}
+}  // namespace
+
+void DataBlockIter::RestartKeyPrefixBounds(const Slice& target, int64_t* left,
+                                           int64_t* right) {
+  assert(restart_key_prefixes_ != nullptr);
+  uint64_t target_prefix = RestartKeyPrefix(ExtractUserKey(target));
+  // Restart keys with a smaller prefix are smaller than target, and those with
+  // a larger prefix are larger
+  int64_t new_left = static_cast<int64_t>(CountRestartKeyPrefixesBelow<false>(
+                         restart_key_prefixes_, num_restarts_, target_prefix)) -
+                     1;
+  int64_t new_right = static_cast<int64_t>(CountRestartKeyPrefixesBelow<true>(
+                          restart_key_prefixes_, num_restarts_, target_prefix)) -
+                      1;
+  // The prefixes of a corrupted block may be out of order
+  if (new_left <= new_right) {
+    *left = new_left;
+    *right = new_right;
+  }
+#ifndef NDEBUG
+  int64_t bounds[2] = {*left, *right};
+  TEST_SYNC_POINT_CALLBACK("DataBlockIter::RestartKeyPrefixBounds", bounds);
+#endif  // NDEBUG
+}
+
 // Optimized Seek for point lookup for an internal key `target`
 // target = "seek_user_key @ type | seqno".
 //
@@ -275,7 +370,10 @@ void DataBlockIter::SeekImpl(const Slice& target) {
 //    but larger type).
 bool DataBlockIter::SeekForGetImpl(const Slice& target) {
   Slice target_user_key = ExtractUserKey(target);
-  uint32_t map_offset = restarts_ + num_restarts_ * sizeof(uint32_t);
+  uint32_t map_offset =
+      restarts_ +
+      num_restarts_ * (sizeof(uint32_t) +
+                       (restart_key_prefixes_ ? sizeof(uint64_t) : 0));
   uint8_t entry =
       data_block_hash_index_->Lookup(data_, map_offset, target_user_key);
 
@@ -396,10 +494,20 @@ void IndexBlockIter::SeekImpl(const Slice& target) {
     // restart interval must be one when hash search is enabled so the binary
     // search simply lands at the right place.
     skip_linear_scan = true;
-  } else if (value_delta_encoded_) {
-    ok = BinarySeek<DecodeKeyV4>(seek_key, &index, &skip_linear_scan);
   } else {
-    ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan);
+    int64_t left = -1;
+    int64_t right = static_cast<int64_t>(num_restarts_) - 1;
+    if (interpolation_index_ != nullptr &&
+        !InterpolationSeekBounds(target, seek_key, &left, &right)) {
+      return;
+    }
+    if (value_delta_encoded_) {
+      ok = BinarySeek<DecodeKeyV4>(seek_key, &index, &skip_linear_scan, left,
+                                   right);
+    } else {
+      ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan, left,
+                                 right);
+    }
   }
 
   if (!ok) {
@@ -416,7 +524,13 @@ void DataBlockIter::SeekForPrevImpl(const Slice& target) {
   }
   uint32_t index = 0;
   bool skip_linear_scan = false;
-  bool ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan);
+  int64_t left = -1;
+  int64_t right = static_cast<int64_t>(num_restarts_) - 1;
+  if (restart_key_prefixes_ != nullptr) {
+    RestartKeyPrefixBounds(seek_key, &left, &right);
+  }
+  bool ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan, left,
+                                  right);
 
   if (!ok) {
     return;
@@ -538,6 +652,10 @@ bool DataBlockIter::ParseNextDataKey(const char* limit) {
 #endif  // NDEBUG
 
     value_ = Slice(p + non_shared, value_length);
+    if (value_columns_ != nullptr && !value_columns_->CheckEntryValue(value_)) {
+      CorruptionError();
+      return false;
+    }
     if (shared == 0) {
       while (restart_index_ + 1 < num_restarts_ &&
              GetRestartPoint(restart_index_ + 1) < current_) {
@@ -686,7 +804,8 @@ void BlockIter<TValue>::FindKeyAfterBinarySeek(const Slice& target,
 template <class TValue>
 template <typename DecodeKeyFunc>
 bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
-                                   bool* skip_linear_scan) {
+                                   bool* skip_linear_scan, int64_t left,
+                                   int64_t right) {
   if (restarts_ == 0) {
     // SST files dedicated to range tombstones are written with index blocks
     // that have no keys while also having `num_restarts_ == 1`. This would
@@ -704,7 +823,7 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
   //   keys.
   // - Any restart keys after index `right` are strictly greater than the target
   //   key.
-  int64_t left = -1, right = num_restarts_ - 1;
+  assert(left >= -1 && left <= right && right < num_restarts_);
   while (left != right) {
     // The `mid` is computed by rounding up so it lands in (`left`, `right`].
     int64_t mid = left + (right - left + 1) / 2;
@@ -764,6 +883,40 @@ int IndexBlockIter::CompareBlockKey(uint32_t block_index, const Slice& target) {
   return CompareCurrentKey(target);
 }
 
+bool IndexBlockIter::InterpolationSeekBounds(const Slice& target,
+                                             const Slice& seek_key,
+                                             int64_t* left, int64_t* right) {
+  uint32_t predicted_left = 0;
+  uint32_t predicted_right = 0;
+  // See BinarySeek() about blocks with restarts_ == 0
+  if (restarts_ == 0 ||
+      interpolation_index_->num_restarts() != num_restarts_ ||
+      !interpolation_index_->Predict(ExtractUserKey(target), &predicted_left,
+                                     &predicted_right)) {
+    return true;
+  }
+  // The prediction is only a hint, so check that the restart keys around the
+  // predicted range enclose the target, and search all of the restart points
+  // on the side(s) where they do not.
+  if (predicted_left > 0 &&
+      CompareBlockKey(predicted_left, seek_key) <= 0) {
+    *left = predicted_left;
+  }
+  if (predicted_right + 1 < num_restarts_ &&
+      CompareBlockKey(predicted_right + 1, seek_key) > 0) {
+    *right = predicted_right;
+  }
+  if (*left > *right) {
+    // Only possible with out-of-order restart keys
+    CorruptionError();
+  }
+#ifndef NDEBUG
+  int64_t bounds[2] = {*left, *right};
+  TEST_SYNC_POINT_CALLBACK("IndexBlockIter::InterpolationSeekBounds", bounds);
+#endif  // NDEBUG
+  return status_.ok();
+}
+
 // Binary search in block_ids to find the first block
 // with a key >= target
 bool IndexBlockIter::BinaryBlockIndexSeek(const Slice& target,
@@ -887,7 +1040,18 @@ uint32_t Block::NumRestarts() const {
     // Such check is for backward compatibility. We can ensure legacy block
     // with a vary large num_restarts i.e. >= 0x80000000 can be interpreted
     // correctly as no HashIndex even if the MSB of num_restarts is set.
-    return num_restarts;
+    //
+    // Blocks with restart key prefixes or value columns are much smaller than
+    // 2GiB, so when either flag is set, num_restarts is still in the lower
+    // bits.
+    bool has_restart_key_prefixes = false;
+    bool has_value_columns = false;
+    uint32_t packed_num_restarts = 0;
+    UnPackIndexTypeAndNumRestarts(
+        block_footer, nullptr /* index_type */, &packed_num_restarts,
+        &has_restart_key_prefixes, &has_value_columns);
+    return has_restart_key_prefixes || has_value_columns ? packed_num_restarts
+                                                         : num_restarts;
   }
   BlockBasedTableOptions::DataBlockIndexType index_type;
   UnPackIndexTypeAndNumRestarts(block_footer, &index_type, &num_restarts);
@@ -919,50 +1083,66 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
       data_(contents_.data.data()),
       size_(contents_.data.size()),
       restart_offset_(0),
-      num_restarts_(0) {
+      num_restarts_(0),
+      restart_key_prefixes_(nullptr) {
   TEST_SYNC_POINT("Block::Block:0");
   if (size_ < sizeof(uint32_t)) {
     size_ = 0;  // Error marker
   } else {
     // Should only decode restart points for uncompressed blocks
     num_restarts_ = NumRestarts();
-    switch (IndexType()) {
+    bool has_restart_key_prefixes = false;
+    bool has_value_columns = false;
+    UnPackIndexTypeAndNumRestarts(
+        DecodeFixed32(data_ + size_ - sizeof(uint32_t)),
+        nullptr /* index_type */, nullptr /* num_restarts */,
+        &has_restart_key_prefixes, &has_value_columns);
+    // Size of the restart array, and of the restart key prefixes if any
+    const uint64_t restarts_size =
+        uint64_t{num_restarts_} *
+        (sizeof(uint32_t) + (has_restart_key_prefixes ? sizeof(uint64_t) : 0));
+    // End of the restart array, or of the hash index if any (chop off
+    // NUM_RESTARTS, and the value columns if any)
+    size_t restarts_end = size_ - sizeof(uint32_t);
+    if (has_value_columns &&
+        !value_columns_.Initialize(data_, restarts_end, &restarts_end)) {
+      restarts_end = 0;
+      size_ = 0;  // Error marker
+    }
+    switch (size_ == 0 ? BlockBasedTableOptions::kDataBlockBinarySearch
+                       : IndexType()) {
       case BlockBasedTableOptions::kDataBlockBinarySearch:
-        restart_offset_ = static_cast<uint32_t>(size_) -
-                          (1 + num_restarts_) * sizeof(uint32_t);
-        if (restart_offset_ > size_ - sizeof(uint32_t)) {
-          // The size is too small for NumRestarts() and therefore
-          // restart_offset_ wrapped around.
+        if (restarts_size > restarts_end) {
+          // The size is too small for NumRestarts()
           size_ = 0;
+          break;
         }
+        restart_offset_ = static_cast<uint32_t>(restarts_end - restarts_size);
         break;
       case BlockBasedTableOptions::kDataBlockBinaryAndHash:
-        if (size_ < sizeof(uint32_t) /* block footer */ +
-                        sizeof(uint16_t) /* NUM_BUCK */) {
+        if (restarts_end < sizeof(uint16_t) /* NUM_BUCK */) {
           size_ = 0;
           break;
         }
 
         uint16_t map_offset;
         data_block_hash_index_.Initialize(
-            contents.data.data(),
-            static_cast<uint16_t>(contents.data.size() -
-                                  sizeof(uint32_t)), /*chop off
-                                                 NUM_RESTARTS*/
-            &map_offset);
+            data_, static_cast<uint16_t>(restarts_end), &map_offset);
 
-        restart_offset_ = map_offset - num_restarts_ * sizeof(uint32_t);
-
-        if (restart_offset_ > map_offset) {
-          // map_offset is too small for NumRestarts() and
-          // therefore restart_offset_ wrapped around.
+        if (restarts_size > map_offset) {
+          // map_offset is too small for NumRestarts()
           size_ = 0;
           break;
         }
+        restart_offset_ = static_cast<uint32_t>(map_offset - restarts_size);
         break;
       default:
         size_ = 0;  // Error marker
     }
+    if (size_ != 0 && has_restart_key_prefixes) {
+      restart_key_prefixes_ =
+          data_ + restart_offset_ + num_restarts_ * sizeof(uint32_t);
+    }
   }
   if (read_amp_bytes_per_bit != 0 && statistics && size_ != 0) {
     read_amp_bitmap_.reset(new BlockReadAmpBitmap(
@@ -992,7 +1172,9 @@ DataBlockIter* Block::NewDataIterator(const Comparator* raw_ucmp,
     ret_iter->Initialize(
         raw_ucmp, data_, restart_offset_, num_restarts_, global_seqno,
         read_amp_bitmap_.get(), block_contents_pinned,
-        data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr);
+        data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr,
+        restart_key_prefixes_,
+        value_columns_.Valid() ? &value_columns_ : nullptr);
     if (read_amp_bitmap_) {
       if (read_amp_bitmap_->GetStatistics() != stats) {
         // DB changed the Statistics pointer, we need to notify read_amp_bitmap_
@@ -1008,7 +1190,8 @@ IndexBlockIter* Block::NewIndexIterator(
     const Comparator* raw_ucmp, SequenceNumber global_seqno,
     IndexBlockIter* iter, Statistics* /*stats*/, bool total_order_seek,
     bool have_first_key, bool key_includes_seq, bool value_is_full,
-    bool block_contents_pinned, BlockPrefixIndex* prefix_index) {
+    bool block_contents_pinned, BlockPrefixIndex* prefix_index,
+    const InterpolationIndex* interpolation_index) {
   IndexBlockIter* ret_iter;
   if (iter != nullptr) {
     ret_iter = iter;
@@ -1029,7 +1212,7 @@ IndexBlockIter* Block::NewIndexIterator(
     ret_iter->Initialize(raw_ucmp, data_, restart_offset_, num_restarts_,
                          global_seqno, prefix_index_ptr, have_first_key,
                          key_includes_seq, value_is_full,
-                         block_contents_pinned);
+                         block_contents_pinned, interpolation_index);
   }
 
   return ret_iter;
@@ -21,6 +21,7 @@
 #include "rocksdb/table.h"
 #include "table/block_based/block_prefix_index.h"
 #include "table/block_based/data_block_hash_index.h"
+#include "table/block_based/value_columns.h"
 #include "table/format.h"
 #include "table/internal_iterator.h"
 #include "test_util/sync_point.h"
@@ -35,6 +36,7 @@ class BlockIter;
 class DataBlockIter;
 class IndexBlockIter;
 class BlockPrefixIndex;
+class InterpolationIndex;
 
 // BlockReadAmpBitmap is a bitmap that map the ROCKSDB_NAMESPACE::Block data
 // bytes to a bitmap with ratio bytes_per_bit. Whenever we access a range of
@@ -203,6 +205,9 @@ class Block {
   // If `prefix_index` is not nullptr this block will do hash lookup for the key
   // prefix. If total_order_seek is true, prefix_index_ is ignored.
   //
+  // If `interpolation_index` is not nullptr, it narrows down the binary search
+  // over the restart points of the block. It must model this block.
+  //
   // `have_first_key` controls whether IndexValue will contain
   // first_internal_key. It affects data serialization format, so the same value
   // have_first_key must be used when writing and reading index.
@@ -213,7 +218,9 @@ class Block {
                                    bool total_order_seek, bool have_first_key,
                                    bool key_includes_seq, bool value_is_full,
                                    bool block_contents_pinned = false,
-                                   BlockPrefixIndex* prefix_index = nullptr);
+                                   BlockPrefixIndex* prefix_index = nullptr,
+                                   const InterpolationIndex*
+                                       interpolation_index = nullptr);
 
   // Report an approximation of how much memory has been used.
   size_t ApproximateMemoryUsage() const;
@@ -224,8 +231,11 @@ class Block {
   size_t size_;              // contents_.data.size()
   uint32_t restart_offset_;  // Offset in data_ of restart array
   uint32_t num_restarts_;
+  // Restart key prefixes in data_ (see data_block_footer.h), or nullptr
+  const char* restart_key_prefixes_;
   std::unique_ptr<BlockReadAmpBitmap> read_amp_bitmap_;
   DataBlockHashIndex data_block_hash_index_;
+  ValueColumns value_columns_;
 };
 
 // A `BlockIter` iterates over the entries in a `Block`'s data buffer. The
@@ -465,7 +475,20 @@ class BlockIter : public InternalIteratorBase<TValue> {
  protected:
   template <typename DecodeKeyFunc>
   inline bool BinarySeek(const Slice& target, uint32_t* index,
-                         bool* is_index_key_result);
+                         bool* is_index_key_result) {
+    return BinarySeek<DecodeKeyFunc>(target, index, is_index_key_result,
+                                     -1 /* left */,
+                                     static_cast<int64_t>(num_restarts_) - 1);
+  }
+
+  // Like the above, but only searches the restart points in [left, right].
+  // The restart key at `left` must be less than or equal to `target` (-1
+  // meaning less than all keys), and the one after `right` must be greater
+  // than `target`.
+  template <typename DecodeKeyFunc>
+  inline bool BinarySeek(const Slice& target, uint32_t* index,
+                         bool* is_index_key_result, int64_t left,
+                         int64_t right);
 
   void FindKeyAfterBinarySeek(const Slice& target, uint32_t index,
                               bool is_index_key_result);
@@ -478,23 +501,30 @@ class DataBlockIter final : public BlockIter<Slice> {
   DataBlockIter(const Comparator* raw_ucmp, const char* data, uint32_t restarts,
                 uint32_t num_restarts, SequenceNumber global_seqno,
                 BlockReadAmpBitmap* read_amp_bitmap, bool block_contents_pinned,
-                DataBlockHashIndex* data_block_hash_index)
+                DataBlockHashIndex* data_block_hash_index,
+                const char* restart_key_prefixes = nullptr,
+                const ValueColumns* value_columns = nullptr)
       : DataBlockIter() {
     Initialize(raw_ucmp, data, restarts, num_restarts, global_seqno,
-               read_amp_bitmap, block_contents_pinned, data_block_hash_index);
+               read_amp_bitmap, block_contents_pinned, data_block_hash_index,
+               restart_key_prefixes, value_columns);
   }
   void Initialize(const Comparator* raw_ucmp, const char* data,
                   uint32_t restarts, uint32_t num_restarts,
                   SequenceNumber global_seqno,
                   BlockReadAmpBitmap* read_amp_bitmap,
                   bool block_contents_pinned,
-                  DataBlockHashIndex* data_block_hash_index) {
+                  DataBlockHashIndex* data_block_hash_index,
+                  const char* restart_key_prefixes = nullptr,
+                  const ValueColumns* value_columns = nullptr) {
     InitializeBase(raw_ucmp, data, restarts, num_restarts, global_seqno,
                    block_contents_pinned);
     raw_key_.SetIsUserKey(false);
     read_amp_bitmap_ = read_amp_bitmap;
     last_bitmap_offset_ = current_ + 1;
     data_block_hash_index_ = data_block_hash_index;
+    restart_key_prefixes_ = restart_key_prefixes;
+    value_columns_ = value_columns;
   }
 
   Slice value() const override {
@@ -505,9 +535,24 @@ class DataBlockIter final : public BlockIter<Slice> {
                              NextEntryOffset() - 1);
       last_bitmap_offset_ = current_;
     }
+    if (value_columns_ != nullptr) {
+      return AssembleValue();
+    }
     return value_;
   }
 
+  // Values assembled from value columns are in a buffer of the iterator.
+  bool IsValuePinned() const override {
+    return BlockIter::IsValuePinned() && !IsValueAssembled();
+  }
+
+  // Whether the current value is a row of value columns, which value()
+  // assembles (see value_columns.h).
+  bool IsValueAssembled() const;
+
+  bool ProjectValue(const std::vector<uint32_t>& columns,
+                    std::string* projected) const override;
+
   inline bool SeekForGet(const Slice& target) {
     if (!data_block_hash_index_) {
       SeekImpl(target);
@@ -556,6 +601,12 @@ class DataBlockIter final : public BlockIter<Slice> {
   BlockReadAmpBitmap* read_amp_bitmap_;
   // last `current_` value we report to read-amp bitmp
   mutable uint32_t last_bitmap_offset_;
+  // Restart key prefixes of the block (see data_block_footer.h), or nullptr
+  const char* restart_key_prefixes_ = nullptr;
+  // Value columns of the block, or nullptr
+  const ValueColumns* value_columns_ = nullptr;
+  // Buffer for the value assembled by value()
+  mutable std::string assembled_value_;
   struct CachedPrevEntry {
     explicit CachedPrevEntry(uint32_t _offset, const char* _key_ptr,
                              size_t _key_offset, size_t _key_size, Slice _value)
@@ -586,13 +637,22 @@ class DataBlockIter final : public BlockIter<Slice> {
   inline bool ParseNextDataKey(const char* limit = nullptr);
 
   bool SeekForGetImpl(const Slice& target);
+
+  Slice AssembleValue() const;
+
+  // Narrows down [*left, *right], the range of restart points that
+  // BinarySeek() searches for `target`, with the restart key prefixes.
+  void RestartKeyPrefixBounds(const Slice& target, int64_t* left,
+                              int64_t* right);
+
   void NextOrReportImpl();
   void SeekToFirstOrReportImpl();
 };
 
 class IndexBlockIter final : public BlockIter<IndexValue> {
  public:
-  IndexBlockIter() : BlockIter(), prefix_index_(nullptr) {}
+  IndexBlockIter()
+      : BlockIter(), prefix_index_(nullptr), interpolation_index_(nullptr) {}
 
   // key_includes_seq, default true, means that the keys are in internal key
   // format.
@@ -602,11 +662,13 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
                   uint32_t restarts, uint32_t num_restarts,
                   SequenceNumber global_seqno, BlockPrefixIndex* prefix_index,
                   bool have_first_key, bool key_includes_seq,
-                  bool value_is_full, bool block_contents_pinned) {
+                  bool value_is_full, bool block_contents_pinned,
+                  const InterpolationIndex* interpolation_index = nullptr) {
     InitializeBase(raw_ucmp, data, restarts, num_restarts,
                    kDisableGlobalSequenceNumber, block_contents_pinned);
     raw_key_.SetIsUserKey(!key_includes_seq);
     prefix_index_ = prefix_index;
+    interpolation_index_ = interpolation_index;
     value_delta_encoded_ = !value_is_full;
     have_first_key_ = have_first_key;
     if (have_first_key_ && global_seqno != kDisableGlobalSequenceNumber) {
@@ -674,6 +736,7 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
   bool value_delta_encoded_;
   bool have_first_key_;  // value includes first_internal_key
   BlockPrefixIndex* prefix_index_;
+  const InterpolationIndex* interpolation_index_;
   // Whether the value is delta encoded. In that case the value is assumed to be
   // BlockHandle. The first value in each restart interval is the full encoded
   // BlockHandle; the restart of encoded size part of the BlockHandle. The
@@ -707,6 +770,11 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
   bool BinaryBlockIndexSeek(const Slice& target, uint32_t* block_ids,
                             uint32_t left, uint32_t right, uint32_t* index,
                             bool* prefix_may_exist);
+  // Sets [*left, *right] to the range of restart points that BinarySeek()
+  // needs to search for `seek_key`, as predicted by interpolation_index_ and
+  // checked against the restart keys. Returns false on corruption.
+  bool InterpolationSeekBounds(const Slice& target, const Slice& seek_key,
+                               int64_t* left, int64_t* right);
   inline int CompareBlockKey(uint32_t block_index, const Slice& target);
 
   inline bool ParseNextIndexKey();
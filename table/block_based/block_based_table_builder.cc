@@ -11,6 +11,7 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <atomic>
 #include <list>
@@ -111,6 +112,16 @@ bool GoodCompressionRatio(size_t compressed_size, size_t raw_size) {
   return compressed_size < raw_size - (raw_size / 8u);
 }
 
+// Whether data blocks store the restart key prefixes (see
+// data_block_footer.h), which are only ordered like the keys with the
+// bytewise comparator.
+bool UseRestartKeyPrefixes(const BlockBasedTableOptions& table_opt,
+                           const TableBuilderOptions& tbo) {
+  const Comparator* ucmp = tbo.internal_comparator.user_comparator();
+  return table_opt.format_version >= 6 && ucmp->timestamp_size() == 0 &&
+         strcmp(ucmp->Name(), BytewiseComparator()->Name()) == 0;
+}
+
 }  // namespace
 
 // format_version is the block format as defined in include/rocksdb/table.h
@@ -326,6 +337,9 @@ struct BlockBasedTableBuilder::Rep {
   const TableFileCreationReason reason;
 
   BlockHandle pending_handle;  // Handle to add to index block
+  // Whether the index entry of the last data block, added by
+  // AddRawDataBlock(), is still to be added to the index block
+  bool pending_raw_block_index_entry = false;
 
   std::string compressed_output;
   std::unique_ptr<FlushBlockPolicy> flush_block_policy;
@@ -415,7 +429,11 @@ struct BlockBasedTableBuilder::Rep {
                            ->CanKeysWithDifferentByteContentsBeEqual()
                        ? BlockBasedTableOptions::kDataBlockBinarySearch
                        : table_options.data_block_index_type,
-                   table_options.data_block_hash_table_util_ratio),
+                   table_options.data_block_hash_table_util_ratio,
+                   UseRestartKeyPrefixes(table_opt, tbo),
+                   table_opt.format_version >= 6
+                       ? table_opt.value_column_splitter.get()
+                       : nullptr),
         range_del_block(1 /* block_restart_interval */),
         internal_prefix_transform(tbo.moptions.prefix_extractor.get()),
         compression_type(tbo.compression_type),
@@ -962,6 +980,15 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
       }
     }
 
+    if (r->pending_raw_block_index_entry) {
+      // The data block is empty after a raw data block
+      assert(!should_flush);
+      if (ok()) {
+        r->index_builder->AddIndexEntry(&r->last_key, &key, r->pending_handle);
+      }
+      r->pending_raw_block_index_entry = false;
+    }
+
     // Note: PartitionedFilterBlockBuilder requires key being added to filter
     // builder after being added to index builder.
     if (r->state == Rep::State::kUnbuffered) {
@@ -1014,6 +1041,94 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
   }
 }
 
+bool BlockBasedTableBuilder::AddRawDataBlock(const RawDataBlock& block) {
+  Rep* r = rep_;
+  assert(rep_->state != Rep::State::kClosed);
+  assert(block.entries != nullptr);
+  if (r->state != Rep::State::kUnbuffered ||
+      r->IsParallelCompressionEnabled() ||
+      block.format_version != r->table_options.format_version ||
+      // Blocks that could not be compressed enough are stored uncompressed in
+      // compressed tables, but an uncompressed table may have blocks that
+      // would compress well, so only blocks of the output compression type
+      // are copied.
+      block.compression_type != r->compression_type ||
+      (r->compression_dict != nullptr &&
+       !r->compression_dict->GetRawDict().empty())) {
+    return false;
+  }
+  if (!ok()) return true;
+  InternalIterator* entries = block.entries;
+  entries->SeekToFirst();
+  if (!entries->Valid()) {
+    r->SetStatus(entries->status().ok()
+                     ? Status::Corruption("Empty raw data block")
+                     : entries->status());
+    return true;
+  }
+
+  // The keys added so far end the current data block, or the previous raw
+  // data block is still to be indexed.
+  bool add_index_entry = r->pending_raw_block_index_entry;
+  if (!r->data_block.empty()) {
+    Flush();
+    add_index_entry = true;
+  }
+  if (ok() && add_index_entry) {
+    Slice first_key = entries->key();
+    r->index_builder->AddIndexEntry(&r->last_key, &first_key,
+                                    r->pending_handle);
+  }
+  r->pending_raw_block_index_entry = false;
+  if (!ok()) return true;
+
+  size_t ts_sz = r->internal_comparator.user_comparator()->timestamp_size();
+  for (; entries->Valid(); entries->Next()) {
+    const Slice key = entries->key();
+    const Slice value = entries->value();
+    ValueType value_type = ExtractValueType(key);
+    assert(IsValueType(value_type));
+#ifndef NDEBUG
+    if (r->props.num_entries > r->props.num_range_deletions) {
+      assert(r->internal_comparator.Compare(key, Slice(r->last_key)) > 0);
+    }
+#endif  // !NDEBUG
+    if (r->filter_builder != nullptr) {
+      r->filter_builder->Add(ExtractUserKeyAndStripTimestamp(key, ts_sz));
+    }
+    r->index_builder->OnKeyAdded(key);
+    NotifyCollectTableCollectorsOnAdd(key, value, r->get_offset(),
+                                      r->table_properties_collectors,
+                                      r->ioptions.logger);
+    r->last_key.assign(key.data(), key.size());
+
+    r->props.num_entries++;
+    r->props.raw_key_size += key.size();
+    r->props.raw_value_size += value.size();
+    if (value_type == kTypeDeletion || value_type == kTypeSingleDeletion) {
+      r->props.num_deletions++;
+    } else if (value_type == kTypeMerge) {
+      r->props.num_merge_operands++;
+    }
+  }
+  if (!entries->status().ok()) {
+    r->SetStatus(entries->status());
+    return true;
+  }
+
+  WriteRawBlock(block.contents, block.compression_type, &r->pending_handle,
+                BlockType::kData);
+  if (ok()) {
+    if (r->filter_builder != nullptr) {
+      r->filter_builder->StartBlock(r->get_offset());
+    }
+    r->props.data_size = r->get_offset();
+    ++r->props.num_data_blocks;
+    r->pending_raw_block_index_entry = true;
+  }
+  return true;
+}
+
 void BlockBasedTableBuilder::Flush() {
   Rep* r = rep_;
   assert(rep_->state != Rep::State::kClosed);
@@ -1961,7 +2076,7 @@ Status BlockBasedTableBuilder::Finish() {
   } else {
     // To make sure properties block is able to keep the accurate size of index
     // block, we will finish writing all index entries first.
-    if (ok() && !empty_data_block) {
+    if (ok() && (!empty_data_block || r->pending_raw_block_index_entry)) {
       r->index_builder->AddIndexEntry(
           &r->last_key, nullptr /* no next data block */, r->pending_handle);
     }
@@ -57,6 +57,12 @@ class BlockBasedTableBuilder : public TableBuilder {
   // REQUIRES: Finish(), Abandon() have not been called
   void Add(const Slice& key, const Slice& value) override;
 
+  // Copies the block as stored if it was read from a table of the same
+  // format_version, is uncompressed or compressed like the blocks of this
+  // table, and neither table uses a compression dictionary. Not supported
+  // with parallel compression.
+  bool AddRawDataBlock(const RawDataBlock& block) override;
+
   // Return non-ok iff some error has been detected.
   Status status() const override;
 
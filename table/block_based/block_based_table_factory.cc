@@ -182,7 +182,9 @@ static std::unordered_map<std::string, BlockBasedTableOptions::IndexType>
         {"kTwoLevelIndexSearch",
          BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch},
         {"kBinarySearchWithFirstKey",
-         BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey}};
+         BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey},
+        {"kInterpolationSearch",
+         BlockBasedTableOptions::IndexType::kInterpolationSearch}};
 
 static std::unordered_map<std::string,
                           BlockBasedTableOptions::DataBlockIndexType>
@@ -433,6 +435,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct BlockBasedTableOptions, max_auto_readahead_size),
           OptionType::kSizeT, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"learn_auto_readahead",
+         {offsetof(struct BlockBasedTableOptions, learn_auto_readahead),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"prepopulate_block_cache",
          OptionTypeInfo::Enum<BlockBasedTableOptions::PrepopulateBlockCache>(
              offsetof(struct BlockBasedTableOptions, prepopulate_block_cache),
@@ -620,7 +626,17 @@ Status BlockBasedTableFactory::NewTableReader(
       table_reader_options.block_cache_tracer,
       table_reader_options.max_file_size_for_l0_meta_pin,
       table_reader_options.cur_db_session_id,
-      table_reader_options.cur_file_num);
+      table_reader_options.cur_file_num,
+      table_reader_options.tail_prefetch_buffer);
+}
+
+void BlockBasedTableFactory::SubmitTailPrefetch(
+    const ReadOptions& ro, RandomAccessFileReader* file, uint64_t file_size,
+    bool prefetch_index_and_filter_in_cache, int level, FileSystem* fs,
+    std::unique_ptr<FilePrefetchBuffer>* tail_prefetch_buffer) const {
+  BlockBasedTable::SubmitTailPrefetch(
+      ro, file, file_size, &tail_prefetch_stats_, table_options_,
+      prefetch_index_and_filter_in_cache, level, fs, tail_prefetch_buffer);
 }
 
 TableBuilder* BlockBasedTableFactory::NewTableBuilder(
@@ -655,6 +671,11 @@ Status BlockBasedTableFactory::ValidateOptions(
         "Unsupported BlockBasedTable format_version. Please check "
         "include/rocksdb/table.h for more info");
   }
+  if (table_options_.value_column_splitter != nullptr &&
+      table_options_.format_version < 6) {
+    return Status::InvalidArgument(
+        "value_column_splitter requires format_version >= 6");
+  }
   if (table_options_.block_align && (cf_opts.compression != kNoCompression)) {
     return Status::InvalidArgument(
         "Enable block_align, but compression "
@@ -735,6 +756,11 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  data_block_hash_table_util_ratio: %lf\n",
            table_options_.data_block_hash_table_util_ratio);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  value_column_splitter: %s\n",
+           table_options_.value_column_splitter == nullptr
+               ? "nullptr"
+               : table_options_.value_column_splitter->Name());
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  hash_index_allow_collision: %d\n",
            table_options_.hash_index_allow_collision);
   ret.append(buffer);
@@ -826,6 +852,9 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
            "  max_auto_readahead_size: %" ROCKSDB_PRIszt "\n",
            table_options_.max_auto_readahead_size);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  learn_auto_readahead: %d\n",
+           table_options_.learn_auto_readahead);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  prepopulate_block_cache: %d\n",
            static_cast<int>(table_options_.prepopulate_block_cache));
   ret.append(buffer);
@@ -975,6 +1004,7 @@ const std::string BlockBasedTablePropertyNames::kPrefixFiltering =
 const std::string kHashIndexPrefixesBlock = "rocksdb.hashindex.prefixes";
 const std::string kHashIndexPrefixesMetadataBlock =
     "rocksdb.hashindex.metadata";
+const std::string kInterpolationIndexBlock = "rocksdb.interpolation.index";
 const std::string kPropTrue = "1";
 const std::string kPropFalse = "0";
 
@@ -24,6 +24,8 @@ struct DBOptions;
 struct EnvOptions;
 
 class BlockBasedTableBuilder;
+class FilePrefetchBuffer;
+class FileSystem;
 class RandomAccessFileReader;
 class WritableFileWriter;
 
@@ -77,6 +79,13 @@ class BlockBasedTableFactory : public TableFactory {
 
   TailPrefetchStats* tail_prefetch_stats() { return &tail_prefetch_stats_; }
 
+  // Submits an asynchronous read of the tail of `file` that NewTableReader()
+  // reads first. Pass the buffer as TableReaderOptions::tail_prefetch_buffer.
+  void SubmitTailPrefetch(
+      const ReadOptions& ro, RandomAccessFileReader* file, uint64_t file_size,
+      bool prefetch_index_and_filter_in_cache, int level, FileSystem* fs,
+      std::unique_ptr<FilePrefetchBuffer>* tail_prefetch_buffer) const;
+
  protected:
   const void* GetOptionsPtr(const std::string& name) const override;
 #ifndef ROCKSDB_LITE
@@ -94,6 +103,7 @@ class BlockBasedTableFactory : public TableFactory {
 
 extern const std::string kHashIndexPrefixesBlock;
 extern const std::string kHashIndexPrefixesMetadataBlock;
+extern const std::string kInterpolationIndexBlock;
 extern const std::string kPropTrue;
 extern const std::string kPropFalse;
 }  // namespace ROCKSDB_NAMESPACE
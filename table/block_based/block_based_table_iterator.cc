@@ -8,12 +8,16 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include "table/block_based/block_based_table_iterator.h"
 
+#include "rocksdb/key_hotness_tracker.h"
+#include "test_util/sync_point.h"
+
 namespace ROCKSDB_NAMESPACE {
 void BlockBasedTableIterator::Seek(const Slice& target) { SeekImpl(&target); }
 
 void BlockBasedTableIterator::SeekToFirst() { SeekImpl(nullptr); }
 
 void BlockBasedTableIterator::SeekImpl(const Slice* target) {
+  pinned_assembled_value_ = nullptr;
   is_out_of_bound_ = false;
   is_at_first_key_from_index_ = false;
   if (target && !CheckPrefixMayMatch(*target, IterDirection::kForward)) {
@@ -89,6 +93,7 @@ void BlockBasedTableIterator::SeekImpl(const Slice* target) {
     } else {
       block_iter_.SeekToFirst();
     }
+    RecordKeyHotness();
     FindKeyForward();
   }
 
@@ -100,6 +105,7 @@ void BlockBasedTableIterator::SeekImpl(const Slice* target) {
 }
 
 void BlockBasedTableIterator::SeekForPrev(const Slice& target) {
+  pinned_assembled_value_ = nullptr;
   is_out_of_bound_ = false;
   is_at_first_key_from_index_ = false;
   // For now totally disable prefix seek in auto prefix mode because we don't
@@ -152,6 +158,7 @@ void BlockBasedTableIterator::SeekForPrev(const Slice& target) {
   InitDataBlock();
 
   block_iter_.SeekForPrev(target);
+  RecordKeyHotness();
 
   FindKeyBackward();
   CheckDataBlockWithinUpperBound();
@@ -160,6 +167,7 @@ void BlockBasedTableIterator::SeekForPrev(const Slice& target) {
 }
 
 void BlockBasedTableIterator::SeekToLast() {
+  pinned_assembled_value_ = nullptr;
   is_out_of_bound_ = false;
   is_at_first_key_from_index_ = false;
   SavePrevIndexValue();
@@ -170,11 +178,13 @@ void BlockBasedTableIterator::SeekToLast() {
   }
   InitDataBlock();
   block_iter_.SeekToLast();
+  RecordKeyHotness();
   FindKeyBackward();
   CheckDataBlockWithinUpperBound();
 }
 
 void BlockBasedTableIterator::Next() {
+  pinned_assembled_value_ = nullptr;
   if (is_at_first_key_from_index_ && !MaterializeCurrentBlock()) {
     return;
   }
@@ -196,6 +206,7 @@ bool BlockBasedTableIterator::NextAndGetResult(IterateResult* result) {
 }
 
 void BlockBasedTableIterator::Prev() {
+  pinned_assembled_value_ = nullptr;
   if (is_at_first_key_from_index_) {
     is_at_first_key_from_index_ = false;
 
@@ -206,6 +217,7 @@ void BlockBasedTableIterator::Prev() {
 
     InitDataBlock();
     block_iter_.SeekToLast();
+    RecordKeyHotness();
   } else {
     assert(block_iter_points_to_real_block_);
     block_iter_.Prev();
@@ -234,7 +246,8 @@ void BlockBasedTableIterator::InitDataBlock() {
     //   Enabled from the very first IO when ReadOptions.readahead_size is set.
     block_prefetcher_.PrefetchIfNeeded(rep, data_block_handle,
                                        read_options_.readahead_size,
-                                       is_for_compaction);
+                                       is_for_compaction,
+                                       read_options_.async_io);
     Status s;
     table_->NewDataBlockIterator<DataBlockIter>(
         read_options_, data_block_handle, &block_iter_, BlockType::kData,
@@ -242,10 +255,41 @@ void BlockBasedTableIterator::InitDataBlock() {
         block_prefetcher_.prefetch_buffer(),
         /*for_compaction=*/is_for_compaction);
     block_iter_points_to_real_block_ = true;
+    // Only the reads of user iterators make keys hot, not those checking
+    // the output of flushes and compactions. The key is recorded once the
+    // callers have positioned the block iterator.
+    record_key_hotness_ =
+        lookup_context_.caller == TableReaderCaller::kUserIterator &&
+        rep->ioptions.key_hotness_tracker != nullptr;
     CheckDataBlockWithinUpperBound();
   }
 }
 
+void BlockBasedTableIterator::RecordKeyHotness() {
+  if (!record_key_hotness_) {
+    return;
+  }
+  record_key_hotness_ = false;
+  if (block_iter_.Valid()) {
+    auto* rep = table_->get_rep();
+    const size_t ts_sz =
+        rep->internal_comparator.user_comparator()->timestamp_size();
+    rep->ioptions.key_hotness_tracker->RecordRead(
+        ExtractUserKeyAndStripTimestamp(block_iter_.key(), ts_sz));
+  }
+}
+
+const std::string* BlockBasedTableIterator::PinAssembledValue() const {
+  assert(pinned_iters_mgr_ != nullptr && pinned_iters_mgr_->PinningEnabled());
+  TEST_SYNC_POINT("BlockBasedTableIterator::PinAssembledValue");
+  Slice value = block_iter_.value();
+  std::string* buf = new std::string(value.data(), value.size());
+  pinned_iters_mgr_->PinPtr(buf, [](void* ptr) {
+    delete static_cast<std::string*>(ptr);
+  });
+  return buf;
+}
+
 bool BlockBasedTableIterator::MaterializeCurrentBlock() {
   assert(is_at_first_key_from_index_);
   assert(!block_iter_points_to_real_block_);
@@ -260,6 +304,7 @@ bool BlockBasedTableIterator::MaterializeCurrentBlock() {
   }
 
   block_iter_.SeekToFirst();
+  RecordKeyHotness();
 
   if (!block_iter_.Valid() ||
       icomp_.Compare(block_iter_.key(),
@@ -333,6 +378,7 @@ void BlockBasedTableIterator::FindBlockForward() {
 
     InitDataBlock();
     block_iter_.SeekToFirst();
+    RecordKeyHotness();
   } while (!block_iter_.Valid());
 }
 
@@ -348,6 +394,7 @@ void BlockBasedTableIterator::FindKeyBackward() {
     if (index_iter_->Valid()) {
       InitDataBlock();
       block_iter_.SeekToLast();
+      RecordKeyHotness();
     } else {
       return;
     }
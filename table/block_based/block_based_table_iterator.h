@@ -86,6 +86,15 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
     assert(!is_at_first_key_from_index_);
     assert(Valid());
 
+    if (pinned_iters_mgr_ != nullptr && pinned_iters_mgr_->PinningEnabled() &&
+        block_iter_.IsValueAssembled()) {
+      // The value is assembled from value columns into a buffer of
+      // block_iter_, which the next value would overwrite
+      if (pinned_assembled_value_ == nullptr) {
+        pinned_assembled_value_ = PinAssembledValue();
+      }
+      return *pinned_assembled_value_;
+    }
     return block_iter_.value();
   }
   Status status() const override {
@@ -113,6 +122,7 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
 
   void SetPinnedItersMgr(PinnedIteratorsManager* pinned_iters_mgr) override {
     pinned_iters_mgr_ = pinned_iters_mgr;
+    pinned_assembled_value_ = nullptr;
   }
   bool IsKeyPinned() const override {
     // Our key comes either from block_iter_'s current key
@@ -129,6 +139,12 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
     return pinned_iters_mgr_ && pinned_iters_mgr_->PinningEnabled() &&
            block_iter_points_to_real_block_;
   }
+  bool ProjectValue(const std::vector<uint32_t>& columns,
+                    std::string* projected) const override {
+    assert(!is_at_first_key_from_index_);
+    assert(Valid());
+    return block_iter_.ProjectValue(columns, projected);
+  }
 
   void ResetDataIter() {
     if (block_iter_points_to_real_block_) {
@@ -230,6 +246,13 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
   // True if we're standing at the first key of a block, and we haven't loaded
   // that block yet. A call to PrepareValue() will trigger loading the block.
   bool is_at_first_key_from_index_ = false;
+  // True if a data block was loaded for a user iterator with a key hotness
+  // tracker, and the key the iterator lands on in it is still to be recorded
+  bool record_key_hotness_ = false;
+  // Copy of the current entry's assembled value pinned by pinned_iters_mgr_,
+  // or null if value() has not pinned one yet. Reset whenever the iterator
+  // moves.
+  mutable const std::string* pinned_assembled_value_ = nullptr;
   bool check_filter_;
   // TODO(Zhongyi): pick a better name
   bool need_upper_bound_check_;
@@ -243,6 +266,7 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
   void FindBlockForward();
   void FindKeyBackward();
   void CheckOutOfBound();
+  void RecordKeyHotness();
 
   // Check if data block is fully within iterate_upper_bound.
   //
@@ -250,6 +274,10 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
   // we need to check and update data_block_within_upper_bound_ accordingly.
   void CheckDataBlockWithinUpperBound();
 
+  // Copies the value assembled by block_iter_ into a buffer pinned by
+  // pinned_iters_mgr_, and returns it.
+  const std::string* PinAssembledValue() const;
+
   bool CheckPrefixMayMatch(const Slice& ikey, IterDirection direction) {
     if (need_upper_bound_check_ && direction == IterDirection::kBackward) {
       // Upper bound check isn't sufficient for backward direction to
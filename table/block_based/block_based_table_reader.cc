@@ -34,6 +34,7 @@
 #include "rocksdb/file_system.h"
 #include "rocksdb/filter_policy.h"
 #include "rocksdb/iterator.h"
+#include "rocksdb/key_hotness_tracker.h"
 #include "rocksdb/options.h"
 #include "rocksdb/snapshot.h"
 #include "rocksdb/statistics.h"
@@ -52,6 +53,7 @@
 #include "table/block_based/filter_block.h"
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/hash_index_reader.h"
+#include "table/block_based/interpolation_index_reader.h"
 #include "table/block_based/partitioned_filter_block.h"
 #include "table/block_based/partitioned_index_reader.h"
 #include "table/block_fetcher.h"
@@ -75,6 +77,7 @@ namespace ROCKSDB_NAMESPACE {
 extern const uint64_t kBlockBasedTableMagicNumber;
 extern const std::string kHashIndexPrefixesBlock;
 extern const std::string kHashIndexPrefixesMetadataBlock;
+extern const std::string kInterpolationIndexBlock;
 
 BlockBasedTable::~BlockBasedTable() {
   delete rep_;
@@ -557,12 +560,14 @@ Status BlockBasedTable::Open(
     TailPrefetchStats* tail_prefetch_stats,
     BlockCacheTracer* const block_cache_tracer,
     size_t max_file_size_for_l0_meta_pin, const std::string& cur_db_session_id,
-    uint64_t cur_file_num) {
+    uint64_t cur_file_num, FilePrefetchBuffer* tail_prefetch_buffer) {
   table_reader->reset();
 
   Status s;
   Footer footer;
-  std::unique_ptr<FilePrefetchBuffer> prefetch_buffer;
+  // Owned unless the caller prefetched the tail
+  std::unique_ptr<FilePrefetchBuffer> owned_prefetch_buffer;
+  FilePrefetchBuffer* prefetch_buffer = tail_prefetch_buffer;
 
   // Only retain read_options.deadline and read_options.io_timeout.
   // In future, we may retain more
@@ -577,19 +582,21 @@ Status BlockBasedTable::Open(
   const bool prefetch_all = prefetch_index_and_filter_in_cache || level == 0;
   const bool preload_all = !table_options.cache_index_and_filter_blocks;
 
-  if (!ioptions.allow_mmap_reads) {
+  if (ioptions.allow_mmap_reads) {
+    // Should not prefetch for mmap mode.
+    owned_prefetch_buffer.reset(new FilePrefetchBuffer(
+        0 /* readahead_size */, 0 /* max_readahead_size */, false /* enable */,
+        true /* track_min_offset */));
+    prefetch_buffer = owned_prefetch_buffer.get();
+  } else if (prefetch_buffer == nullptr) {
     s = PrefetchTail(ro, file.get(), file_size, force_direct_prefetch,
                      tail_prefetch_stats, prefetch_all, preload_all,
-                     &prefetch_buffer);
+                     &owned_prefetch_buffer);
     // Return error in prefetch path to users.
     if (!s.ok()) {
       return s;
     }
-  } else {
-    // Should not prefetch for mmap mode.
-    prefetch_buffer.reset(new FilePrefetchBuffer(
-        0 /* readahead_size */, 0 /* max_readahead_size */, false /* enable */,
-        true /* track_min_offset */));
+    prefetch_buffer = owned_prefetch_buffer.get();
   }
 
   // Read in the following order:
@@ -603,7 +610,7 @@ Status BlockBasedTable::Open(
   IOOptions opts;
   s = file->PrepareIOOptions(ro, opts);
   if (s.ok()) {
-    s = ReadFooterFromFile(opts, file.get(), prefetch_buffer.get(), file_size,
+    s = ReadFooterFromFile(opts, file.get(), prefetch_buffer, file_size,
                            &footer, kBlockBasedTableMagicNumber);
   }
   if (!s.ok()) {
@@ -632,6 +639,9 @@ Status BlockBasedTable::Open(
     rep->internal_prefix_transform.reset(
         new InternalKeySliceTransform(prefix_extractor));
   }
+  if (table_options.learn_auto_readahead) {
+    rep->readahead_history.reset(new ReadaheadHistory(file_size));
+  }
 
   // For fully portable/stable cache keys, we need to read the properties
   // block before setting up cache keys. TODO: consider setting up a bootstrap
@@ -648,7 +658,7 @@ Status BlockBasedTable::Open(
       new BlockBasedTable(rep, block_cache_tracer));
   std::unique_ptr<Block> metaindex;
   std::unique_ptr<InternalIterator> metaindex_iter;
-  s = new_table->ReadMetaIndexBlock(ro, prefetch_buffer.get(), &metaindex,
+  s = new_table->ReadMetaIndexBlock(ro, prefetch_buffer, &metaindex,
                                     &metaindex_iter);
   if (!s.ok()) {
     return s;
@@ -656,8 +666,8 @@ Status BlockBasedTable::Open(
 
   // Populates table_properties and some fields that depend on it,
   // such as index_type.
-  s = new_table->ReadPropertiesBlock(ro, prefetch_buffer.get(),
-                                     metaindex_iter.get(), largest_seqno);
+  s = new_table->ReadPropertiesBlock(ro, prefetch_buffer, metaindex_iter.get(),
+                                     largest_seqno);
   if (!s.ok()) {
     return s;
   }
@@ -670,20 +680,19 @@ Status BlockBasedTable::Open(
       PersistentCacheOptions(rep->table_options.persistent_cache,
                              rep->base_cache_key, rep->ioptions.stats);
 
-  s = new_table->ReadRangeDelBlock(ro, prefetch_buffer.get(),
-                                   metaindex_iter.get(), internal_comparator,
-                                   &lookup_context);
+  s = new_table->ReadRangeDelBlock(ro, prefetch_buffer, metaindex_iter.get(),
+                                   internal_comparator, &lookup_context);
   if (!s.ok()) {
     return s;
   }
   s = new_table->PrefetchIndexAndFilterBlocks(
-      ro, prefetch_buffer.get(), metaindex_iter.get(), new_table.get(),
+      ro, prefetch_buffer, metaindex_iter.get(), new_table.get(),
       prefetch_all, table_options, level, file_size,
       max_file_size_for_l0_meta_pin, &lookup_context);
 
   if (s.ok()) {
     // Update tail prefetch stats
-    assert(prefetch_buffer.get() != nullptr);
+    assert(prefetch_buffer != nullptr);
     if (tail_prefetch_stats != nullptr) {
       assert(prefetch_buffer->min_offset_read() < file_size);
       tail_prefetch_stats->RecordEffectiveSize(
@@ -696,11 +705,38 @@ Status BlockBasedTable::Open(
   return s;
 }
 
-Status BlockBasedTable::PrefetchTail(
+void BlockBasedTable::SubmitTailPrefetch(
     const ReadOptions& ro, RandomAccessFileReader* file, uint64_t file_size,
-    bool force_direct_prefetch, TailPrefetchStats* tail_prefetch_stats,
-    const bool prefetch_all, const bool preload_all,
-    std::unique_ptr<FilePrefetchBuffer>* prefetch_buffer) {
+    TailPrefetchStats* tail_prefetch_stats,
+    const BlockBasedTableOptions& table_options,
+    bool prefetch_index_and_filter_in_cache, int level, FileSystem* fs,
+    std::unique_ptr<FilePrefetchBuffer>* tail_prefetch_buffer) {
+  // As in Open()
+  ReadOptions open_ro;
+  open_ro.deadline = ro.deadline;
+  open_ro.io_timeout = ro.io_timeout;
+  const bool prefetch_all = prefetch_index_and_filter_in_cache || level == 0;
+  const bool preload_all = !table_options.cache_index_and_filter_blocks;
+
+  size_t prefetch_off;
+  size_t prefetch_len;
+  GetTailPrefetchRange(file_size, tail_prefetch_stats, prefetch_all,
+                       preload_all, &prefetch_off, &prefetch_len);
+  tail_prefetch_buffer->reset(new FilePrefetchBuffer(
+      0 /* readahead_size */, 0 /* max_readahead_size */, true /* enable */,
+      true /* track_min_offset */, false /* implicit_auto_readahead */,
+      false /* async_io */, fs));
+  IOOptions opts;
+  if (file->PrepareIOOptions(open_ro, opts).ok()) {
+    (*tail_prefetch_buffer)->SubmitPrefetch(opts, file, prefetch_off,
+                                            prefetch_len);
+  }
+}
+
+void BlockBasedTable::GetTailPrefetchRange(
+    uint64_t file_size, TailPrefetchStats* tail_prefetch_stats,
+    const bool prefetch_all, const bool preload_all, size_t* offset,
+    size_t* len) {
   size_t tail_prefetch_size = 0;
   if (tail_prefetch_stats != nullptr) {
     // Multiple threads may get a 0 (no history) when running in parallel,
@@ -716,17 +752,26 @@ Status BlockBasedTable::PrefetchTail(
     // at which point we don't yet know the index type.
     tail_prefetch_size = prefetch_all || preload_all ? 512 * 1024 : 4 * 1024;
   }
-  size_t prefetch_off;
-  size_t prefetch_len;
   if (file_size < tail_prefetch_size) {
-    prefetch_off = 0;
-    prefetch_len = static_cast<size_t>(file_size);
+    *offset = 0;
+    *len = static_cast<size_t>(file_size);
   } else {
-    prefetch_off = static_cast<size_t>(file_size - tail_prefetch_size);
-    prefetch_len = tail_prefetch_size;
+    *offset = static_cast<size_t>(file_size - tail_prefetch_size);
+    *len = tail_prefetch_size;
   }
   TEST_SYNC_POINT_CALLBACK("BlockBasedTable::Open::TailPrefetchLen",
                            &tail_prefetch_size);
+}
+
+Status BlockBasedTable::PrefetchTail(
+    const ReadOptions& ro, RandomAccessFileReader* file, uint64_t file_size,
+    bool force_direct_prefetch, TailPrefetchStats* tail_prefetch_stats,
+    const bool prefetch_all, const bool preload_all,
+    std::unique_ptr<FilePrefetchBuffer>* prefetch_buffer) {
+  size_t prefetch_off;
+  size_t prefetch_len;
+  GetTailPrefetchRange(file_size, tail_prefetch_stats, prefetch_all,
+                       preload_all, &prefetch_off, &prefetch_len);
 
   // Try file system prefetch
   if (!file->use_direct_io() && !force_direct_prefetch) {
@@ -1616,13 +1661,7 @@ void BlockBasedTable::RetrieveMultipleBlocks(
     autovector<Status, MultiGetContext::MAX_BATCH_SIZE>* statuses,
     autovector<CachableEntry<Block>, MultiGetContext::MAX_BATCH_SIZE>* results,
     char* scratch, const UncompressionDict& uncompression_dict) const {
-  RandomAccessFileReader* file = rep_->file.get();
-  const Footer& footer = rep_->footer;
-  const ImmutableOptions& ioptions = rep_->ioptions;
-  size_t read_amp_bytes_per_bit = rep_->table_options.read_amp_bytes_per_bit;
-  MemoryAllocator* memory_allocator = GetMemoryAllocator(rep_->table_options);
-
-  if (ioptions.allow_mmap_reads) {
+  if (rep_->ioptions.allow_mmap_reads) {
     size_t idx_in_batch = 0;
     for (auto mget_iter = batch->begin(); mget_iter != batch->end();
          ++mget_iter, ++idx_in_batch) {
@@ -1643,18 +1682,31 @@ void BlockBasedTable::RetrieveMultipleBlocks(
     return;
   }
 
+  MultiBlockReads reads(rep_->ioptions.fs.get());
+  PrepareMultipleBlockReads(batch, handles, scratch, &reads);
+  ReadMultipleBlocks(options, &reads);
+  ProcessMultipleBlockReads(options, batch, handles, statuses, results,
+                            uncompression_dict, &reads);
+}
+
+void BlockBasedTable::PrepareMultipleBlockReads(
+    const MultiGetRange* batch,
+    const autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE>* handles,
+    char* scratch, MultiBlockReads* reads) const {
+  RandomAccessFileReader* file = rep_->file.get();
+
   // In direct IO mode, blocks share the direct io buffer.
   // Otherwise, blocks share the scratch buffer.
-  const bool use_shared_buffer = file->use_direct_io() || scratch != nullptr;
-
-  autovector<FSReadRequest, MultiGetContext::MAX_BATCH_SIZE> read_reqs;
+  reads->use_shared_buffer = file->use_direct_io() || scratch != nullptr;
+  const bool use_shared_buffer = reads->use_shared_buffer;
+  auto& read_reqs = reads->read_reqs;
+  auto& req_idx_for_block = reads->req_idx_for_block;
+  auto& req_offset_for_block = reads->req_offset_for_block;
   size_t buf_offset = 0;
   size_t idx_in_batch = 0;
 
   uint64_t prev_offset = 0;
   size_t prev_len = 0;
-  autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> req_idx_for_block;
-  autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> req_offset_for_block;
   for (auto mget_iter = batch->begin(); mget_iter != batch->end();
        ++mget_iter, ++idx_in_batch) {
     const BlockHandle& handle = (*handles)[idx_in_batch];
@@ -1716,25 +1768,111 @@ void BlockBasedTable::RetrieveMultipleBlocks(
     }
     read_reqs.emplace_back(req);
   }
+}
 
-  AlignedBuf direct_io_buf;
-  {
-    IOOptions opts;
-    IOStatus s = file->PrepareIOOptions(options, opts);
+void BlockBasedTable::ReadMultipleBlocks(const ReadOptions& options,
+                                         MultiBlockReads* reads) const {
+  RandomAccessFileReader* file = rep_->file.get();
+  auto& read_reqs = reads->read_reqs;
+  IOOptions opts;
+  IOStatus s = file->PrepareIOOptions(options, opts);
+  if (s.ok()) {
+    s = file->MultiRead(opts, &read_reqs[0], read_reqs.size(),
+                        &reads->direct_io_buf);
+  }
+  if (!s.ok()) {
+    // Discard all the results in this batch if there is any time out
+    // or overall MultiRead error
+    for (FSReadRequest& req : read_reqs) {
+      req.status = s;
+    }
+  }
+}
+
+void BlockBasedTable::SubmitMultipleBlockReads(const ReadOptions& options,
+                                               MultiBlockReads* reads) const {
+  RandomAccessFileReader* file = rep_->file.get();
+  assert(!file->use_direct_io());
+  IOOptions opts;
+  IOStatus s = file->PrepareIOOptions(options, opts);
+  for (FSReadRequest& req : reads->read_reqs) {
     if (s.ok()) {
-      s = file->MultiRead(opts, &read_reqs[0], read_reqs.size(),
-                          &direct_io_buf);
+      void* io_handle = nullptr;
+      IOHandleDeleter del_fn = nullptr;
+      s = file->ReadAsync(
+          req, opts,
+          [](const FSReadRequest& read_req, void* cb_arg) {
+            // The file system may report the result in its own copy of the
+            // request.
+            FSReadRequest* dest = static_cast<FSReadRequest*>(cb_arg);
+            if (dest != &read_req) {
+              dest->result = read_req.result;
+              dest->status = read_req.status;
+            }
+          },
+          &req, &io_handle, &del_fn);
+      if (io_handle != nullptr) {
+        reads->io_handles.push_back(io_handle);
+        reads->del_fns.push_back(del_fn);
+      }
     }
     if (!s.ok()) {
-      // Discard all the results in this batch if there is any time out
-      // or overall MultiRead error
-      for (FSReadRequest& req : read_reqs) {
-        req.status = s;
+      // Discard the results of the reads that were not submitted
+      req.status = s;
+    }
+  }
+}
+
+void BlockBasedTable::WaitForMultipleBlockReads(MultiBlockReads* reads) const {
+  if (reads->io_handles.empty()) {
+    return;
+  }
+  IOStatus s = reads->fs->Poll(reads->io_handles, reads->io_handles.size());
+  if (!s.ok()) {
+    // Make sure none of the reads is still in flight, and fail all of them
+    // as it is not known which ones completed.
+    reads->fs->AbortIO(reads->io_handles).PermitUncheckedError();
+    for (FSReadRequest& req : reads->read_reqs) {
+      req.status = s;
+    }
+  }
+  for (size_t i = 0; i < reads->io_handles.size(); ++i) {
+    if (reads->del_fns[i]) {
+      reads->del_fns[i](reads->io_handles[i]);
+    }
+  }
+  reads->io_handles.clear();
+  reads->del_fns.clear();
+}
+
+BlockBasedTable::MultiBlockReads::~MultiBlockReads() {
+  if (!io_handles.empty()) {
+    fs->AbortIO(io_handles).PermitUncheckedError();
+    for (size_t i = 0; i < io_handles.size(); ++i) {
+      if (del_fns[i]) {
+        del_fns[i](io_handles[i]);
       }
     }
   }
+}
 
-  idx_in_batch = 0;
+void BlockBasedTable::ProcessMultipleBlockReads(
+    const ReadOptions& options, const MultiGetRange* batch,
+    const autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE>* handles,
+    autovector<Status, MultiGetContext::MAX_BATCH_SIZE>* statuses,
+    autovector<CachableEntry<Block>, MultiGetContext::MAX_BATCH_SIZE>* results,
+    const UncompressionDict& uncompression_dict,
+    MultiBlockReads* reads) const {
+  const Footer& footer = rep_->footer;
+  const ImmutableOptions& ioptions = rep_->ioptions;
+  size_t read_amp_bytes_per_bit = rep_->table_options.read_amp_bytes_per_bit;
+  MemoryAllocator* memory_allocator = GetMemoryAllocator(rep_->table_options);
+  const bool use_shared_buffer = reads->use_shared_buffer;
+  auto& read_reqs = reads->read_reqs;
+  auto& req_idx_for_block = reads->req_idx_for_block;
+  auto& req_offset_for_block = reads->req_offset_for_block;
+
+  size_t idx_in_batch = 0;
   size_t valid_batch_idx = 0;
   for (auto mget_iter = batch->begin(); mget_iter != batch->end();
        ++mget_iter, ++idx_in_batch) {
@@ -2407,6 +2545,10 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
         }
         s = biter.status();
       }
+      if (does_referenced_key_exist && rep_->ioptions.key_hotness_tracker) {
+        rep_->ioptions.key_hotness_tracker->RecordRead(
+            ExtractUserKeyAndStripTimestamp(key, ts_sz));
+      }
       // Write the block cache access record.
       if (block_cache_tracer_ && block_cache_tracer_->is_tracing_enabled()) {
         // Avoid making copy of block_key, cf_name, and referenced_key when
@@ -2467,386 +2609,448 @@ void BlockBasedTable::MultiGet(const ReadOptions& read_options,
     return;  // Nothing to do
   }
 
-  FilterBlockReader* const filter =
-      !skip_filters ? rep_->filter.get() : nullptr;
-  MultiGetRange sst_file_range(*mget_range, mget_range->begin(),
-                               mget_range->end());
+  MultiGetState state(read_options, *mget_range, rep_->ioptions.fs.get());
+  StartMultiGetImpl(read_options, prefix_extractor, skip_filters,
+                    false /* async_read */, &state);
+  FinishMultiGetImpl(&state);
+}
+
+std::unique_ptr<TableReader::MultiGetState> BlockBasedTable::StartMultiGet(
+    const ReadOptions& read_options, const MultiGetRange* mget_range,
+    const SliceTransform* prefix_extractor, bool skip_filters) {
+  std::unique_ptr<MultiGetState> state(
+      new MultiGetState(read_options, *mget_range, rep_->ioptions.fs.get()));
+  if (!mget_range->empty()) {
+    StartMultiGetImpl(read_options, prefix_extractor, skip_filters,
+                      true /* async_read */, state.get());
+  }
+  return std::unique_ptr<TableReader::MultiGetState>(state.release());
+}
+
+void BlockBasedTable::FinishMultiGet(TableReader::MultiGetState* state) {
+  FinishMultiGetImpl(static_cast<MultiGetState*>(state));
+}
+
+void BlockBasedTable::StartMultiGetImpl(const ReadOptions& read_options,
+                                        const SliceTransform* prefix_extractor,
+                                        bool skip_filters, bool async_read,
+                                        MultiGetState* state) {
+  state->skip_filters = skip_filters;
+  state->filter = !skip_filters ? rep_->filter.get() : nullptr;
+  MultiGetRange& sst_file_range = state->sst_file_range;
 
   // First check the full filter
   // If full filter not useful, Then go into each block
   const bool no_io = read_options.read_tier == kBlockCacheTier;
-  uint64_t tracing_mget_id = BlockCacheTraceHelper::kReservedGetId;
   if (sst_file_range.begin()->get_context) {
-    tracing_mget_id = sst_file_range.begin()->get_context->get_tracing_get_id();
+    state->tracing_mget_id =
+        sst_file_range.begin()->get_context->get_tracing_get_id();
   }
   BlockCacheLookupContext lookup_context{
-      TableReaderCaller::kUserMultiGet, tracing_mget_id,
+      TableReaderCaller::kUserMultiGet, state->tracing_mget_id,
       /*get_from_user_specified_snapshot=*/read_options.snapshot != nullptr};
-  FullFilterKeysMayMatch(read_options, filter, &sst_file_range, no_io,
+  FullFilterKeysMayMatch(read_options, state->filter, &sst_file_range, no_io,
                          prefix_extractor, &lookup_context);
 
-  if (!sst_file_range.empty()) {
-    IndexBlockIter iiter_on_stack;
-    // if prefix_extractor found in block differs from options, disable
-    // BlockPrefixIndex. Only do this check when index_type is kHashSearch.
-    bool need_upper_bound_check = false;
-    if (rep_->index_type == BlockBasedTableOptions::kHashSearch) {
-      need_upper_bound_check = PrefixExtractorChanged(
-          rep_->table_properties.get(), prefix_extractor);
-    }
-    auto iiter =
-        NewIndexIterator(read_options, need_upper_bound_check, &iiter_on_stack,
-                         sst_file_range.begin()->get_context, &lookup_context);
-    std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
-    if (iiter != &iiter_on_stack) {
-      iiter_unique_ptr.reset(iiter);
-    }
+  if (sst_file_range.empty()) {
+    return;
+  }
 
-    uint64_t offset = std::numeric_limits<uint64_t>::max();
-    autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE> block_handles;
-    autovector<CachableEntry<Block>, MultiGetContext::MAX_BATCH_SIZE> results;
-    autovector<Status, MultiGetContext::MAX_BATCH_SIZE> statuses;
-    char stack_buf[kMultiGetReadStackBufSize];
-    std::unique_ptr<char[]> block_buf;
-    {
-      MultiGetRange data_block_range(sst_file_range, sst_file_range.begin(),
-                                     sst_file_range.end());
-      std::vector<Cache::Handle*> cache_handles;
-      bool wait_for_cache_results = false;
-
-      CachableEntry<UncompressionDict> uncompression_dict;
-      Status uncompression_dict_status;
-      uncompression_dict_status.PermitUncheckedError();
-      bool uncompression_dict_inited = false;
-      size_t total_len = 0;
-      ReadOptions ro = read_options;
-      ro.read_tier = kBlockCacheTier;
-
-      for (auto miter = data_block_range.begin();
-           miter != data_block_range.end(); ++miter) {
-        const Slice& key = miter->ikey;
-        iiter->Seek(miter->ikey);
-
-        IndexValue v;
-        if (iiter->Valid()) {
-          v = iiter->value();
-        }
-        if (!iiter->Valid() ||
-            (!v.first_internal_key.empty() && !skip_filters &&
-             UserComparatorWrapper(rep_->internal_comparator.user_comparator())
-                     .CompareWithoutTimestamp(
-                         ExtractUserKey(key),
-                         ExtractUserKey(v.first_internal_key)) < 0)) {
-          // The requested key falls between highest key in previous block and
-          // lowest key in current block.
-          if (!iiter->status().IsNotFound()) {
-            *(miter->s) = iiter->status();
-          }
-          data_block_range.SkipKey(miter);
-          sst_file_range.SkipKey(miter);
-          continue;
-        }
+  // if prefix_extractor found in block differs from options, disable
+  // BlockPrefixIndex. Only do this check when index_type is kHashSearch.
+  bool need_upper_bound_check = false;
+  if (rep_->index_type == BlockBasedTableOptions::kHashSearch) {
+    need_upper_bound_check = PrefixExtractorChanged(
+        rep_->table_properties.get(), prefix_extractor);
+  }
+  state->iiter = NewIndexIterator(
+      read_options, need_upper_bound_check, &state->iiter_on_stack,
+      sst_file_range.begin()->get_context, &lookup_context);
+  if (state->iiter != &state->iiter_on_stack) {
+    state->iiter_unique_ptr.reset(state->iiter);
+  }
+  InternalIteratorBase<IndexValue>* iiter = state->iiter;
+
+  uint64_t offset = std::numeric_limits<uint64_t>::max();
+  auto& block_handles = state->block_handles;
+  auto& results = state->results;
+  auto& statuses = state->statuses;
+  state->data_block_range = MultiGetRange(
+      sst_file_range, sst_file_range.begin(), sst_file_range.end());
+  MultiGetRange& data_block_range = state->data_block_range;
+  std::vector<Cache::Handle*> cache_handles;
+  bool wait_for_cache_results = false;
+
+  CachableEntry<UncompressionDict>& uncompression_dict =
+      state->uncompression_dict;
+  Status uncompression_dict_status;
+  uncompression_dict_status.PermitUncheckedError();
+  bool uncompression_dict_inited = false;
+  size_t total_len = 0;
+  ReadOptions ro = read_options;
+  ro.read_tier = kBlockCacheTier;
+
+  for (auto miter = data_block_range.begin();
+       miter != data_block_range.end(); ++miter) {
+    const Slice& key = miter->ikey;
+    iiter->Seek(miter->ikey);
+
+    IndexValue v;
+    if (iiter->Valid()) {
+      v = iiter->value();
+    }
+    if (!iiter->Valid() ||
+        (!v.first_internal_key.empty() && !skip_filters &&
+         UserComparatorWrapper(rep_->internal_comparator.user_comparator())
+                 .CompareWithoutTimestamp(
+                     ExtractUserKey(key),
+                     ExtractUserKey(v.first_internal_key)) < 0)) {
+      // The requested key falls between highest key in previous block and
+      // lowest key in current block.
+      if (!iiter->status().IsNotFound()) {
+        *(miter->s) = iiter->status();
+      }
+      data_block_range.SkipKey(miter);
+      sst_file_range.SkipKey(miter);
+      continue;
+    }
 
-        if (!uncompression_dict_inited && rep_->uncompression_dict_reader) {
-          uncompression_dict_status =
-              rep_->uncompression_dict_reader->GetOrReadUncompressionDictionary(
-                  nullptr /* prefetch_buffer */, no_io,
-                  sst_file_range.begin()->get_context, &lookup_context,
-                  &uncompression_dict);
-          uncompression_dict_inited = true;
-        }
+    if (!uncompression_dict_inited && rep_->uncompression_dict_reader) {
+      uncompression_dict_status =
+          rep_->uncompression_dict_reader->GetOrReadUncompressionDictionary(
+              nullptr /* prefetch_buffer */, no_io,
+              sst_file_range.begin()->get_context, &lookup_context,
+              &uncompression_dict);
+      uncompression_dict_inited = true;
+    }
 
-        if (!uncompression_dict_status.ok()) {
-          assert(!uncompression_dict_status.IsNotFound());
-          *(miter->s) = uncompression_dict_status;
-          data_block_range.SkipKey(miter);
-          sst_file_range.SkipKey(miter);
-          continue;
-        }
+    if (!uncompression_dict_status.ok()) {
+      assert(!uncompression_dict_status.IsNotFound());
+      *(miter->s) = uncompression_dict_status;
+      data_block_range.SkipKey(miter);
+      sst_file_range.SkipKey(miter);
+      continue;
+    }
 
-        statuses.emplace_back();
-        results.emplace_back();
-        if (v.handle.offset() == offset) {
-          // We're going to reuse the block for this key later on. No need to
-          // look it up now. Place a null handle
-          block_handles.emplace_back(BlockHandle::NullBlockHandle());
-          continue;
-        }
-        // Lookup the cache for the given data block referenced by an index
-        // iterator value (i.e BlockHandle). If it exists in the cache,
-        // initialize block to the contents of the data block.
-        offset = v.handle.offset();
-        BlockHandle handle = v.handle;
-        BlockCacheLookupContext lookup_data_block_context(
-            TableReaderCaller::kUserMultiGet);
-        const UncompressionDict& dict = uncompression_dict.GetValue()
-                                            ? *uncompression_dict.GetValue()
-                                            : UncompressionDict::GetEmptyDict();
-        Status s = RetrieveBlock(
-            nullptr, ro, handle, dict, &(results.back()), BlockType::kData,
-            miter->get_context, &lookup_data_block_context,
-            /* for_compaction */ false, /* use_cache */ true,
-            /* wait_for_cache */ false);
-        if (s.IsIncomplete()) {
-          s = Status::OK();
-        }
-        if (s.ok() && !results.back().IsEmpty()) {
-          // Since we have a valid handle, check the value. If its nullptr,
-          // it means the cache is waiting for the final result and we're
-          // supposed to call WaitAll() to wait for the result.
-          if (results.back().GetValue() != nullptr) {
-            // Found it in the cache. Add NULL handle to indicate there is
-            // nothing to read from disk.
-            if (results.back().GetCacheHandle()) {
-              results.back().UpdateCachedValue();
-            }
-            block_handles.emplace_back(BlockHandle::NullBlockHandle());
-          } else {
-            // We have to wait for the cache lookup to finish in the
-            // background, and then we may have to read the block from disk
-            // anyway
-            assert(results.back().GetCacheHandle());
-            wait_for_cache_results = true;
-            block_handles.emplace_back(handle);
-            cache_handles.emplace_back(results.back().GetCacheHandle());
-          }
-        } else {
-          block_handles.emplace_back(handle);
-          total_len += BlockSizeWithTrailer(handle);
+    statuses.emplace_back();
+    results.emplace_back();
+    if (v.handle.offset() == offset) {
+      // We're going to reuse the block for this key later on. No need to
+      // look it up now. Place a null handle
+      block_handles.emplace_back(BlockHandle::NullBlockHandle());
+      continue;
+    }
+    // Lookup the cache for the given data block referenced by an index
+    // iterator value (i.e BlockHandle). If it exists in the cache,
+    // initialize block to the contents of the data block.
+    offset = v.handle.offset();
+    BlockHandle handle = v.handle;
+    BlockCacheLookupContext lookup_data_block_context(
+        TableReaderCaller::kUserMultiGet);
+    const UncompressionDict& dict = uncompression_dict.GetValue()
+                                        ? *uncompression_dict.GetValue()
+                                        : UncompressionDict::GetEmptyDict();
+    Status s = RetrieveBlock(
+        nullptr, ro, handle, dict, &(results.back()), BlockType::kData,
+        miter->get_context, &lookup_data_block_context,
+        /* for_compaction */ false, /* use_cache */ true,
+        /* wait_for_cache */ false);
+    if (s.IsIncomplete()) {
+      s = Status::OK();
+    }
+    if (s.ok() && !results.back().IsEmpty()) {
+      // Since we have a valid handle, check the value. If its nullptr,
+      // it means the cache is waiting for the final result and we're
+      // supposed to call WaitAll() to wait for the result.
+      if (results.back().GetValue() != nullptr) {
+        // Found it in the cache. Add NULL handle to indicate there is
+        // nothing to read from disk.
+        if (results.back().GetCacheHandle()) {
+          results.back().UpdateCachedValue();
         }
+        block_handles.emplace_back(BlockHandle::NullBlockHandle());
+      } else {
+        // We have to wait for the cache lookup to finish in the
+        // background, and then we may have to read the block from disk
+        // anyway
+        assert(results.back().GetCacheHandle());
+        wait_for_cache_results = true;
+        block_handles.emplace_back(handle);
+        cache_handles.emplace_back(results.back().GetCacheHandle());
       }
+    } else {
+      block_handles.emplace_back(handle);
+      total_len += BlockSizeWithTrailer(handle);
+    }
+  }
 
-      if (wait_for_cache_results) {
-        Cache* block_cache = rep_->table_options.block_cache.get();
-        block_cache->WaitAll(cache_handles);
-        for (size_t i = 0; i < block_handles.size(); ++i) {
-          // If this block was a success or failure or not needed because
-          // the corresponding key is in the same block as a prior key, skip
-          if (block_handles[i] == BlockHandle::NullBlockHandle() ||
-              results[i].IsEmpty()) {
-            continue;
-          }
-          results[i].UpdateCachedValue();
-          void* val = results[i].GetValue();
-          if (!val) {
-            // The async cache lookup failed - could be due to an error
-            // or a false positive. We need to read the data block from
-            // the SST file
-            results[i].Reset();
-            total_len += BlockSizeWithTrailer(block_handles[i]);
-          } else {
-            block_handles[i] = BlockHandle::NullBlockHandle();
-          }
-        }
+  if (wait_for_cache_results) {
+    Cache* block_cache = rep_->table_options.block_cache.get();
+    block_cache->WaitAll(cache_handles);
+    for (size_t i = 0; i < block_handles.size(); ++i) {
+      // If this block was a success or failure or not needed because
+      // the corresponding key is in the same block as a prior key, skip
+      if (block_handles[i] == BlockHandle::NullBlockHandle() ||
+          results[i].IsEmpty()) {
+        continue;
       }
+      results[i].UpdateCachedValue();
+      void* val = results[i].GetValue();
+      if (!val) {
+        // The async cache lookup failed - could be due to an error
+        // or a false positive. We need to read the data block from
+        // the SST file
+        results[i].Reset();
+        total_len += BlockSizeWithTrailer(block_handles[i]);
+      } else {
+        block_handles[i] = BlockHandle::NullBlockHandle();
+      }
+    }
+  }
 
-      if (total_len) {
-        char* scratch = nullptr;
-        const UncompressionDict& dict = uncompression_dict.GetValue()
-                                            ? *uncompression_dict.GetValue()
-                                            : UncompressionDict::GetEmptyDict();
-        assert(uncompression_dict_inited || !rep_->uncompression_dict_reader);
-        assert(uncompression_dict_status.ok());
-        // If using direct IO, then scratch is not used, so keep it nullptr.
-        // If the blocks need to be uncompressed and we don't need the
-        // compressed blocks, then we can use a contiguous block of
-        // memory to read in all the blocks as it will be temporary
-        // storage
-        // 1. If blocks are compressed and compressed block cache is there,
-        //    alloc heap bufs
-        // 2. If blocks are uncompressed, alloc heap bufs
-        // 3. If blocks are compressed and no compressed block cache, use
-        //    stack buf
-        if (!rep_->file->use_direct_io() &&
-            rep_->table_options.block_cache_compressed == nullptr &&
-            rep_->blocks_maybe_compressed) {
-          if (total_len <= kMultiGetReadStackBufSize) {
-            scratch = stack_buf;
-          } else {
-            scratch = new char[total_len];
-            block_buf.reset(scratch);
-          }
-        }
-        RetrieveMultipleBlocks(read_options, &data_block_range, &block_handles,
-                               &statuses, &results, scratch, dict);
-        if (sst_file_range.begin()->get_context) {
-          ++(sst_file_range.begin()
-                 ->get_context->get_context_stats_.num_sst_read);
-        }
+  if (total_len) {
+    char* scratch = nullptr;
+    const UncompressionDict& dict = uncompression_dict.GetValue()
+                                        ? *uncompression_dict.GetValue()
+                                        : UncompressionDict::GetEmptyDict();
+    assert(uncompression_dict_inited || !rep_->uncompression_dict_reader);
+    assert(uncompression_dict_status.ok());
+    // If using direct IO, then scratch is not used, so keep it nullptr.
+    // If the blocks need to be uncompressed and we don't need the
+    // compressed blocks, then we can use a contiguous block of
+    // memory to read in all the blocks as it will be temporary
+    // storage
+    // 1. If blocks are compressed and compressed block cache is there,
+    //    alloc heap bufs
+    // 2. If blocks are uncompressed, alloc heap bufs
+    // 3. If blocks are compressed and no compressed block cache, use
+    //    stack buf
+    if (!rep_->file->use_direct_io() &&
+        rep_->table_options.block_cache_compressed == nullptr &&
+        rep_->blocks_maybe_compressed) {
+      if (total_len <= kMultiGetReadStackBufSize) {
+        scratch = state->stack_buf;
+      } else {
+        scratch = new char[total_len];
+        state->block_buf.reset(scratch);
       }
     }
+    if (async_read && !rep_->ioptions.allow_mmap_reads &&
+        !rep_->file->use_direct_io()) {
+      // The blocks are processed by FinishMultiGetImpl() once read.
+      PrepareMultipleBlockReads(&data_block_range, &block_handles, scratch,
+                                &state->reads);
+      SubmitMultipleBlockReads(read_options, &state->reads);
+      state->reads_pending = true;
+    } else {
+      RetrieveMultipleBlocks(read_options, &data_block_range, &block_handles,
+                             &statuses, &results, scratch, dict);
+    }
+    if (sst_file_range.begin()->get_context) {
+      ++(sst_file_range.begin()->get_context->get_context_stats_.num_sst_read);
+    }
+  }
+}
 
-    DataBlockIter first_biter;
-    DataBlockIter next_biter;
-    size_t idx_in_batch = 0;
-    for (auto miter = sst_file_range.begin(); miter != sst_file_range.end();
-         ++miter) {
-      Status s;
-      GetContext* get_context = miter->get_context;
-      const Slice& key = miter->ikey;
-      bool matched = false;  // if such user key matched a key in SST
-      bool done = false;
-      bool first_block = true;
-      do {
-        DataBlockIter* biter = nullptr;
-        bool reusing_block = true;
-        uint64_t referenced_data_size = 0;
-        bool does_referenced_key_exist = false;
-        BlockCacheLookupContext lookup_data_block_context(
-            TableReaderCaller::kUserMultiGet, tracing_mget_id,
-            /*get_from_user_specified_snapshot=*/read_options.snapshot !=
-                nullptr);
-        if (first_block) {
-          if (!block_handles[idx_in_batch].IsNull() ||
-              !results[idx_in_batch].IsEmpty()) {
-            first_biter.Invalidate(Status::OK());
-            NewDataBlockIterator<DataBlockIter>(
-                read_options, results[idx_in_batch], &first_biter,
-                statuses[idx_in_batch]);
-            reusing_block = false;
-          } else {
-            // If handler is null and result is empty, then the status is never
-            // set, which should be the initial value: ok().
-            assert(statuses[idx_in_batch].ok());
-          }
-          biter = &first_biter;
-          idx_in_batch++;
-        } else {
-          IndexValue v = iiter->value();
-          if (!v.first_internal_key.empty() && !skip_filters &&
-              UserComparatorWrapper(rep_->internal_comparator.user_comparator())
-                      .CompareWithoutTimestamp(
-                          ExtractUserKey(key),
-                          ExtractUserKey(v.first_internal_key)) < 0) {
-            // The requested key falls between highest key in previous block and
-            // lowest key in current block.
-            break;
-          }
+void BlockBasedTable::FinishMultiGetImpl(MultiGetState* state) {
+  MultiGetRange& sst_file_range = state->sst_file_range;
+  if (sst_file_range.empty()) {
+    return;
+  }
 
-          next_biter.Invalidate(Status::OK());
+  const ReadOptions& read_options = state->read_options;
+  auto& block_handles = state->block_handles;
+  auto& results = state->results;
+  auto& statuses = state->statuses;
+  if (state->reads_pending) {
+    WaitForMultipleBlockReads(&state->reads);
+    const UncompressionDict& dict =
+        state->uncompression_dict.GetValue()
+            ? *state->uncompression_dict.GetValue()
+            : UncompressionDict::GetEmptyDict();
+    ProcessMultipleBlockReads(read_options, &state->data_block_range,
+                              &block_handles, &statuses, &results, dict,
+                              &state->reads);
+    state->reads_pending = false;
+  }
+
+  FilterBlockReader* const filter = state->filter;
+  const bool skip_filters = state->skip_filters;
+  const uint64_t tracing_mget_id = state->tracing_mget_id;
+  InternalIteratorBase<IndexValue>* iiter = state->iiter;
+  DataBlockIter first_biter;
+  DataBlockIter next_biter;
+  size_t idx_in_batch = 0;
+  for (auto miter = sst_file_range.begin(); miter != sst_file_range.end();
+       ++miter) {
+    Status s;
+    GetContext* get_context = miter->get_context;
+    const Slice& key = miter->ikey;
+    bool matched = false;  // if such user key matched a key in SST
+    bool done = false;
+    bool first_block = true;
+    do {
+      DataBlockIter* biter = nullptr;
+      bool reusing_block = true;
+      uint64_t referenced_data_size = 0;
+      bool does_referenced_key_exist = false;
+      BlockCacheLookupContext lookup_data_block_context(
+          TableReaderCaller::kUserMultiGet, tracing_mget_id,
+          /*get_from_user_specified_snapshot=*/read_options.snapshot !=
+              nullptr);
+      if (first_block) {
+        if (!block_handles[idx_in_batch].IsNull() ||
+            !results[idx_in_batch].IsEmpty()) {
+          first_biter.Invalidate(Status::OK());
           NewDataBlockIterator<DataBlockIter>(
-              read_options, iiter->value().handle, &next_biter,
-              BlockType::kData, get_context, &lookup_data_block_context,
-              Status(), nullptr);
-          biter = &next_biter;
+              read_options, results[idx_in_batch], &first_biter,
+              statuses[idx_in_batch]);
           reusing_block = false;
+        } else {
+          // If handler is null and result is empty, then the status is never
+          // set, which should be the initial value: ok().
+          assert(statuses[idx_in_batch].ok());
         }
-
-        if (read_options.read_tier == kBlockCacheTier &&
-            biter->status().IsIncomplete()) {
-          // couldn't get block from block_cache
-          // Update Saver.state to Found because we are only looking for
-          // whether we can guarantee the key is not there when "no_io" is set
-          get_context->MarkKeyMayExist();
-          break;
-        }
-        if (!biter->status().ok()) {
-          s = biter->status();
+        biter = &first_biter;
+        idx_in_batch++;
+      } else {
+        IndexValue v = iiter->value();
+        if (!v.first_internal_key.empty() && !skip_filters &&
+            UserComparatorWrapper(rep_->internal_comparator.user_comparator())
+                    .CompareWithoutTimestamp(
+                        ExtractUserKey(key),
+                        ExtractUserKey(v.first_internal_key)) < 0) {
+          // The requested key falls between highest key in previous block and
+          // lowest key in current block.
           break;
         }
 
-        bool may_exist = biter->SeekForGet(key);
-        if (!may_exist) {
-          // HashSeek cannot find the key this block and the the iter is not
-          // the end of the block, i.e. cannot be in the following blocks
-          // either. In this case, the seek_key cannot be found, so we break
-          // from the top level for-loop.
-          break;
-        }
+        next_biter.Invalidate(Status::OK());
+        NewDataBlockIterator<DataBlockIter>(
+            read_options, iiter->value().handle, &next_biter,
+            BlockType::kData, get_context, &lookup_data_block_context,
+            Status(), nullptr);
+        biter = &next_biter;
+        reusing_block = false;
+      }
 
-        // Call the *saver function on each entry/block until it returns false
-        for (; biter->Valid(); biter->Next()) {
-          ParsedInternalKey parsed_key;
-          Cleanable dummy;
-          Cleanable* value_pinner = nullptr;
-          Status pik_status = ParseInternalKey(
-              biter->key(), &parsed_key, false /* log_err_key */);  // TODO
-          if (!pik_status.ok()) {
-            s = pik_status;
-          }
-          if (biter->IsValuePinned()) {
-            if (reusing_block) {
-              Cache* block_cache = rep_->table_options.block_cache.get();
-              assert(biter->cache_handle() != nullptr);
-              block_cache->Ref(biter->cache_handle());
-              dummy.RegisterCleanup(&ReleaseCachedEntry, block_cache,
-                                    biter->cache_handle());
-              value_pinner = &dummy;
-            } else {
-              value_pinner = biter;
-            }
-          }
-          if (!get_context->SaveValue(parsed_key, biter->value(), &matched,
-                                      value_pinner)) {
-            if (get_context->State() == GetContext::GetState::kFound) {
-              does_referenced_key_exist = true;
-              referenced_data_size =
-                  biter->key().size() + biter->value().size();
-            }
-            done = true;
-            break;
-          }
-          s = biter->status();
+      if (read_options.read_tier == kBlockCacheTier &&
+          biter->status().IsIncomplete()) {
+        // couldn't get block from block_cache
+        // Update Saver.state to Found because we are only looking for
+        // whether we can guarantee the key is not there when "no_io" is set
+        get_context->MarkKeyMayExist();
+        break;
+      }
+      if (!biter->status().ok()) {
+        s = biter->status();
+        break;
+      }
+
+      bool may_exist = biter->SeekForGet(key);
+      if (!may_exist) {
+        // HashSeek cannot find the key this block and the the iter is not
+        // the end of the block, i.e. cannot be in the following blocks
+        // either. In this case, the seek_key cannot be found, so we break
+        // from the top level for-loop.
+        break;
+      }
+
+      // Call the *saver function on each entry/block until it returns false
+      for (; biter->Valid(); biter->Next()) {
+        ParsedInternalKey parsed_key;
+        Cleanable dummy;
+        Cleanable* value_pinner = nullptr;
+        Status pik_status = ParseInternalKey(
+            biter->key(), &parsed_key, false /* log_err_key */);  // TODO
+        if (!pik_status.ok()) {
+          s = pik_status;
         }
-        // Write the block cache access.
-        if (block_cache_tracer_ && block_cache_tracer_->is_tracing_enabled()) {
-          // Avoid making copy of block_key, cf_name, and referenced_key when
-          // constructing the access record.
-          Slice referenced_key;
-          if (does_referenced_key_exist) {
-            referenced_key = biter->key();
+        if (biter->IsValuePinned()) {
+          if (reusing_block) {
+            Cache* block_cache = rep_->table_options.block_cache.get();
+            assert(biter->cache_handle() != nullptr);
+            block_cache->Ref(biter->cache_handle());
+            dummy.RegisterCleanup(&ReleaseCachedEntry, block_cache,
+                                  biter->cache_handle());
+            value_pinner = &dummy;
           } else {
-            referenced_key = key;
+            value_pinner = biter;
           }
-          BlockCacheTraceRecord access_record(
-              rep_->ioptions.clock->NowMicros(),
-              /*block_key=*/"", lookup_data_block_context.block_type,
-              lookup_data_block_context.block_size, rep_->cf_id_for_tracing(),
-              /*cf_name=*/"", rep_->level_for_tracing(),
-              rep_->sst_number_for_tracing(), lookup_data_block_context.caller,
-              lookup_data_block_context.is_cache_hit,
-              lookup_data_block_context.no_insert,
-              lookup_data_block_context.get_id,
-              lookup_data_block_context.get_from_user_specified_snapshot,
-              /*referenced_key=*/"", referenced_data_size,
-              lookup_data_block_context.num_keys_in_block,
-              does_referenced_key_exist);
-          // TODO: Should handle status here?
-          block_cache_tracer_
-              ->WriteBlockAccess(access_record,
-                                 lookup_data_block_context.block_key,
-                                 rep_->cf_name_for_tracing(), referenced_key)
-              .PermitUncheckedError();
         }
-        s = biter->status();
-        if (done) {
-          // Avoid the extra Next which is expensive in two-level indexes
+        if (!get_context->SaveValue(parsed_key, biter->value(), &matched,
+                                    value_pinner)) {
+          if (get_context->State() == GetContext::GetState::kFound) {
+            does_referenced_key_exist = true;
+            referenced_data_size =
+                biter->key().size() + biter->value().size();
+          }
+          done = true;
           break;
         }
-        if (first_block) {
-          iiter->Seek(key);
+        s = biter->status();
+      }
+      if (does_referenced_key_exist && rep_->ioptions.key_hotness_tracker) {
+        rep_->ioptions.key_hotness_tracker->RecordRead(miter->ukey_without_ts);
+      }
+      // Write the block cache access.
+      if (block_cache_tracer_ && block_cache_tracer_->is_tracing_enabled()) {
+        // Avoid making copy of block_key, cf_name, and referenced_key when
+        // constructing the access record.
+        Slice referenced_key;
+        if (does_referenced_key_exist) {
+          referenced_key = biter->key();
+        } else {
+          referenced_key = key;
         }
-        first_block = false;
-        iiter->Next();
-      } while (iiter->Valid());
-
-      if (matched && filter != nullptr && !filter->IsBlockBased()) {
-        RecordTick(rep_->ioptions.stats, BLOOM_FILTER_FULL_TRUE_POSITIVE);
-        PERF_COUNTER_BY_LEVEL_ADD(bloom_filter_full_true_positive, 1,
-                                  rep_->level);
+        BlockCacheTraceRecord access_record(
+            rep_->ioptions.clock->NowMicros(),
+            /*block_key=*/"", lookup_data_block_context.block_type,
+            lookup_data_block_context.block_size, rep_->cf_id_for_tracing(),
+            /*cf_name=*/"", rep_->level_for_tracing(),
+            rep_->sst_number_for_tracing(), lookup_data_block_context.caller,
+            lookup_data_block_context.is_cache_hit,
+            lookup_data_block_context.no_insert,
+            lookup_data_block_context.get_id,
+            lookup_data_block_context.get_from_user_specified_snapshot,
+            /*referenced_key=*/"", referenced_data_size,
+            lookup_data_block_context.num_keys_in_block,
+            does_referenced_key_exist);
+        // TODO: Should handle status here?
+        block_cache_tracer_
+            ->WriteBlockAccess(access_record,
+                               lookup_data_block_context.block_key,
+                               rep_->cf_name_for_tracing(), referenced_key)
+            .PermitUncheckedError();
+      }
+      s = biter->status();
+      if (done) {
+        // Avoid the extra Next which is expensive in two-level indexes
+        break;
       }
-      if (s.ok() && !iiter->status().IsNotFound()) {
-        s = iiter->status();
+      if (first_block) {
+        iiter->Seek(key);
       }
-      *(miter->s) = s;
+      first_block = false;
+      iiter->Next();
+    } while (iiter->Valid());
+
+    if (matched && filter != nullptr && !filter->IsBlockBased()) {
+      RecordTick(rep_->ioptions.stats, BLOOM_FILTER_FULL_TRUE_POSITIVE);
+      PERF_COUNTER_BY_LEVEL_ADD(bloom_filter_full_true_positive, 1,
+                                rep_->level);
     }
-#ifdef ROCKSDB_ASSERT_STATUS_CHECKED
-    // Not sure why we need to do it. Should investigate more.
-    for (auto& st : statuses) {
-      st.PermitUncheckedError();
+    if (s.ok() && !iiter->status().IsNotFound()) {
+      s = iiter->status();
     }
-#endif  // ROCKSDB_ASSERT_STATUS_CHECKED
+    *(miter->s) = s;
+  }
+#ifdef ROCKSDB_ASSERT_STATUS_CHECKED
+  // Not sure why we need to do it. Should investigate more.
+  for (auto& st : statuses) {
+    st.PermitUncheckedError();
   }
+#endif  // ROCKSDB_ASSERT_STATUS_CHECKED
 }
 
 Status BlockBasedTable::Prefetch(const Slice* const begin,
@@ -3014,6 +3218,10 @@ BlockType BlockBasedTable::GetBlockTypeForMetaBlockByName(
     return BlockType::kHashIndexMetadata;
   }
 
+  if (meta_block_name == kInterpolationIndexBlock) {
+    return BlockType::kInterpolationIndex;
+  }
+
   assert(false);
   return BlockType::kInvalid;
 }
@@ -3116,6 +3324,11 @@ Status BlockBasedTable::CreateIndexReader(
                                              use_cache, prefetch, pin,
                                              lookup_context, index_reader);
     }
+    case BlockBasedTableOptions::kInterpolationSearch: {
+      return InterpolationIndexReader::Create(
+          this, ro, prefetch_buffer, meta_iter, use_cache, prefetch, pin,
+          lookup_context, index_reader);
+    }
     case BlockBasedTableOptions::kHashSearch: {
       std::unique_ptr<Block> metaindex_guard;
       std::unique_ptr<InternalIterator> metaindex_iter_guard;
@@ -3238,6 +3451,218 @@ uint64_t BlockBasedTable::ApproximateSize(const Slice& start, const Slice& end,
                                static_cast<double>(rep_->file_size));
 }
 
+Status BlockBasedTable::ApproximateKeyAnchors(const ReadOptions& read_options,
+                                              std::vector<Anchor>& anchors) {
+  // Reads the whole index. The anchors are used to split compactions, which
+  // read all the data blocks of the table anyway.
+  const uint64_t kMaxNumAnchors = 128;
+  BlockCacheLookupContext context(TableReaderCaller::kCompaction);
+  IndexBlockIter iiter_on_stack;
+  auto iiter =
+      NewIndexIterator(read_options, /*disable_prefix_seek=*/true,
+                       /*input_iter=*/&iiter_on_stack, /*get_context=*/nullptr,
+                       /*lookup_context=*/&context);
+  std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr.reset(iiter);
+  }
+
+  uint64_t num_blocks = rep_->table_properties
+                            ? rep_->table_properties->num_data_blocks
+                            : 0;
+  uint64_t num_blocks_per_anchor =
+      std::max((num_blocks + kMaxNumAnchors - 1) / kMaxNumAnchors, uint64_t{1});
+  uint64_t count = 0;
+  uint64_t range_size = 0;
+  uint64_t prev_end_offset = 0;
+  std::string last_key;
+  for (iiter->SeekToFirst(); iiter->Valid(); iiter->Next()) {
+    const BlockHandle& handle = iiter->value().handle;
+    uint64_t end_offset = handle.offset() + BlockSizeWithTrailer(handle);
+    range_size += end_offset - prev_end_offset;
+    prev_end_offset = end_offset;
+    if (++count == num_blocks_per_anchor) {
+      // The index key of a data block is at or after all its keys
+      anchors.emplace_back(iiter->user_key(), range_size);
+      count = 0;
+      range_size = 0;
+    } else {
+      last_key = iiter->user_key().ToString();
+    }
+  }
+  if (count > 0) {
+    anchors.emplace_back(last_key, range_size);
+  }
+  return iiter->status();
+}
+
+// Reads the data blocks in order through a prefetch buffer, bypassing the
+// block cache. Each block is decompressed once, to iterate over its entries.
+class BlockBasedTable::RawDataBlockIteratorImpl : public RawDataBlockIterator {
+ public:
+  RawDataBlockIteratorImpl(const BlockBasedTable* table,
+                           const ReadOptions& read_options)
+      : table_(table),
+        read_options_(read_options),
+        lookup_context_(TableReaderCaller::kCompaction),
+        prefetch_buffer_(
+            read_options.readahead_size != 0
+                ? read_options.readahead_size
+                : table->rep_->table_options.max_auto_readahead_size,
+            read_options.readahead_size != 0
+                ? read_options.readahead_size
+                : table->rep_->table_options.max_auto_readahead_size,
+            !table->rep_->ioptions.allow_mmap_reads /* enable */) {
+    index_iter_.reset(table_->NewIndexIterator(
+        read_options_, /*disable_prefix_seek=*/true, /*input_iter=*/nullptr,
+        /*get_context=*/nullptr, &lookup_context_));
+    block_.format_version = table_->rep_->footer.format_version();
+  }
+
+  bool Valid() const override { return valid_; }
+
+  void SeekToFirst() override {
+    index_iter_->SeekToFirst();
+    ReadBlock();
+  }
+
+  void Seek(const Slice& target) override {
+    index_iter_->Seek(target);
+    ReadBlock();
+  }
+
+  void Next() override {
+    assert(Valid());
+    index_iter_->Next();
+    ReadBlock();
+  }
+
+  const RawDataBlock& block() const override {
+    assert(Valid());
+    return block_;
+  }
+
+  std::unique_ptr<RawDataBlock> ReleaseBlock() override {
+    assert(Valid());
+    assert(block_.entries != nullptr);
+    ReleasedBlock* released = new ReleasedBlock;
+    if (raw_contents_.own_bytes()) {
+      released->raw_contents = std::move(raw_contents_);
+    } else {
+      // E.g. with mmap reads, the contents were not copied out of the file,
+      // which may be closed before the block is freed.
+      const Slice data = raw_contents_.data;
+      std::unique_ptr<char[]> buf(new char[data.size()]);
+      memcpy(buf.get(), data.data(), data.size());
+      released->raw_contents = BlockContents(std::move(buf), data.size());
+      if (block_.compression_type == kNoCompression) {
+        data_block_.reset(new Block(BlockContents(released->raw_contents.data)));
+        entries_.reset(data_block_->NewDataIterator(
+            table_->rep_->internal_comparator.user_comparator(),
+            kDisableGlobalSequenceNumber));
+      }
+    }
+    released->data_block = std::move(data_block_);
+    released->entries = std::move(entries_);
+
+    std::unique_ptr<RawDataBlock> block(new RawDataBlock);
+    block->contents = released->raw_contents.data;
+    block->compression_type = block_.compression_type;
+    block->format_version = block_.format_version;
+    block->entries = released->entries.get();
+    block->RegisterCleanup(&DeleteReleasedBlock, released, nullptr);
+    block_.contents = Slice();
+    block_.entries = nullptr;
+    return block;
+  }
+
+  Status status() const override { return status_; }
+
+ private:
+  // What a block released by ReleaseBlock() owns
+  struct ReleasedBlock {
+    BlockContents raw_contents;
+    std::unique_ptr<Block> data_block;
+    std::unique_ptr<DataBlockIter> entries;
+  };
+
+  static void DeleteReleasedBlock(void* arg1, void* /* arg2 */) {
+    delete static_cast<ReleasedBlock*>(arg1);
+  }
+
+  void ReadBlock() {
+    valid_ = false;
+    entries_.reset();
+    data_block_.reset();
+    raw_contents_ = BlockContents();
+    status_ = index_iter_->status();
+    if (!status_.ok() || !index_iter_->Valid()) {
+      return;
+    }
+
+    const Rep* rep = table_->rep_;
+    BlockFetcher block_fetcher(
+        rep->file.get(), &prefetch_buffer_, rep->footer, read_options_,
+        index_iter_->value().handle, &raw_contents_, rep->ioptions,
+        false /* do_uncompress */, true /* maybe_compressed */,
+        BlockType::kData, UncompressionDict::GetEmptyDict(),
+        rep->persistent_cache_options, /*memory_allocator=*/nullptr,
+        /*memory_allocator_compressed=*/nullptr, /*for_compaction=*/true);
+    status_ = block_fetcher.ReadBlockContents();
+    if (!status_.ok()) {
+      return;
+    }
+    block_.compression_type = block_fetcher.get_compression_type();
+    block_.contents = raw_contents_.data;
+
+    BlockContents contents;
+    if (block_.compression_type == kNoCompression) {
+      contents = BlockContents(raw_contents_.data);
+    } else {
+      UncompressionContext context(block_.compression_type);
+      UncompressionInfo info(context, UncompressionDict::GetEmptyDict(),
+                             block_.compression_type);
+      status_ = UncompressBlockContents(
+          info, raw_contents_.data.data(), raw_contents_.data.size(),
+          &contents, rep->footer.format_version(), rep->ioptions);
+      if (!status_.ok()) {
+        return;
+      }
+    }
+    data_block_.reset(new Block(std::move(contents)));
+    entries_.reset(data_block_->NewDataIterator(
+        rep->internal_comparator.user_comparator(),
+        kDisableGlobalSequenceNumber));
+    status_ = entries_->status();
+    if (!status_.ok()) {
+      return;
+    }
+    block_.entries = entries_.get();
+    valid_ = true;
+  }
+
+  const BlockBasedTable* const table_;
+  const ReadOptions read_options_;
+  BlockCacheLookupContext lookup_context_;
+  FilePrefetchBuffer prefetch_buffer_;
+  std::unique_ptr<InternalIteratorBase<IndexValue>> index_iter_;
+  BlockContents raw_contents_;
+  std::unique_ptr<Block> data_block_;
+  std::unique_ptr<DataBlockIter> entries_;
+  RawDataBlock block_;
+  bool valid_ = false;
+  Status status_;
+};
+
+RawDataBlockIterator* BlockBasedTable::NewRawDataBlockIterator(
+    const ReadOptions& read_options) {
+  if (rep_->uncompression_dict_reader != nullptr ||
+      rep_->global_seqno != kDisableGlobalSequenceNumber) {
+    return nullptr;
+  }
+  return new RawDataBlockIteratorImpl(this, read_options);
+}
+
 bool BlockBasedTable::TEST_FilterBlockInCache() const {
   assert(rep_ != nullptr);
   return rep_->filter_type != Rep::FilterType::kNoFilter &&
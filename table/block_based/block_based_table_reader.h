@@ -14,12 +14,14 @@
 #include "cache/cache_key.h"
 #include "db/range_tombstone_fragmenter.h"
 #include "file/filename.h"
+#include "file/random_access_file_reader.h"
 #include "rocksdb/table_properties.h"
 #include "table/block_based/block.h"
 #include "table/block_based/block_based_table_factory.h"
 #include "table/block_based/block_type.h"
 #include "table/block_based/cachable_entry.h"
 #include "table/block_based/filter_block.h"
+#include "table/block_based/readahead_history.h"
 #include "table/block_based/uncompression_dict_reader.h"
 #include "table/format.h"
 #include "table/persistent_cache_options.h"
@@ -90,6 +92,8 @@ class BlockBasedTable : public TableReader {
   //    are set.
   // @param force_direct_prefetch if true, always prefetching to RocksDB
   //    buffer, rather than calling RandomAccessFile::Prefetch().
+  // @param tail_prefetch_buffer if not null, the tail of the file prefetched
+  //    by SubmitTailPrefetch(), which is used instead of prefetching it.
   static Status Open(const ReadOptions& ro, const ImmutableOptions& ioptions,
                      const EnvOptions& env_options,
                      const BlockBasedTableOptions& table_options,
@@ -107,7 +111,19 @@ class BlockBasedTable : public TableReader {
                      BlockCacheTracer* const block_cache_tracer = nullptr,
                      size_t max_file_size_for_l0_meta_pin = 0,
                      const std::string& cur_db_session_id = "",
-                     uint64_t cur_file_num = 0);
+                     uint64_t cur_file_num = 0,
+                     FilePrefetchBuffer* tail_prefetch_buffer = nullptr);
+
+  // Submits an asynchronous read of the tail of `file` that Open() reads
+  // first, into a new *tail_prefetch_buffer, so that the tails of many files
+  // can be read together. The parameters are those of the Open() that the
+  // buffer is passed to. `fs` is used to wait for the read.
+  static void SubmitTailPrefetch(
+      const ReadOptions& ro, RandomAccessFileReader* file, uint64_t file_size,
+      TailPrefetchStats* tail_prefetch_stats,
+      const BlockBasedTableOptions& table_options,
+      bool prefetch_index_and_filter_in_cache, int level, FileSystem* fs,
+      std::unique_ptr<FilePrefetchBuffer>* tail_prefetch_buffer);
 
   bool PrefixMayMatch(const Slice& internal_key,
                       const ReadOptions& read_options,
@@ -142,6 +158,16 @@ class BlockBasedTable : public TableReader {
                 const SliceTransform* prefix_extractor,
                 bool skip_filters = false) override;
 
+  // Filter, index and block cache lookups are done by StartMultiGet(), which
+  // submits the data block reads asynchronously unless the file uses mmap or
+  // direct IO reads.
+  std::unique_ptr<TableReader::MultiGetState> StartMultiGet(
+      const ReadOptions& readOptions, const MultiGetContext::Range* mget_range,
+      const SliceTransform* prefix_extractor,
+      bool skip_filters = false) override;
+
+  void FinishMultiGet(TableReader::MultiGetState* state) override;
+
   // Pre-fetch the disk blocks that correspond to the key range specified by
   // (kbegin, kend). The call will return error status in the event of
   // IO or iteration error.
@@ -163,6 +189,16 @@ class BlockBasedTable : public TableReader {
   uint64_t ApproximateSize(const Slice& start, const Slice& end,
                            TableReaderCaller caller) override;
 
+  // Samples up to 128 keys from the index, one every num_data_blocks / 128
+  // data blocks (rounded up).
+  Status ApproximateKeyAnchors(const ReadOptions& read_options,
+                               std::vector<Anchor>& anchors) override;
+
+  // Returns nullptr for tables with a compression dictionary or a global
+  // sequence number, whose data blocks cannot be read by another table.
+  RawDataBlockIterator* NewRawDataBlockIterator(
+      const ReadOptions& read_options) override;
+
   bool TEST_BlockInCache(const BlockHandle& handle) const;
 
   // Returns true if the block for the specified key is in cache.
@@ -303,6 +339,10 @@ class BlockBasedTable : public TableReader {
   friend class BlockBasedTableReaderTestVerifyChecksum_ChecksumMismatch_Test;
   BlockCacheTracer* const block_cache_tracer_;
 
+  struct MultiBlockReads;
+  struct MultiGetState;
+  class RawDataBlockIteratorImpl;
+
   void UpdateCacheHitMetrics(BlockType block_type, GetContext* get_context,
                              size_t usage) const;
   void UpdateCacheMissMetrics(BlockType block_type,
@@ -369,6 +409,38 @@ class BlockBasedTable : public TableReader {
           results,
       char* scratch, const UncompressionDict& uncompression_dict) const;
 
+  // The steps of RetrieveMultipleBlocks() (other than with mmap reads), so
+  // that the reads can be waited for separately:
+  // PrepareMultipleBlockReads() coalesces the reads of the non-null handles
+  // into reads->read_reqs, ReadMultipleBlocks() or
+  // SubmitMultipleBlockReads() + WaitForMultipleBlockReads() does the reads,
+  // and ProcessMultipleBlockReads() turns them into blocks.
+  void PrepareMultipleBlockReads(
+      const MultiGetRange* batch,
+      const autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE>* handles,
+      char* scratch, MultiBlockReads* reads) const;
+  void ReadMultipleBlocks(const ReadOptions& options,
+                          MultiBlockReads* reads) const;
+  void SubmitMultipleBlockReads(const ReadOptions& options,
+                                MultiBlockReads* reads) const;
+  void WaitForMultipleBlockReads(MultiBlockReads* reads) const;
+  void ProcessMultipleBlockReads(
+      const ReadOptions& options, const MultiGetRange* batch,
+      const autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE>* handles,
+      autovector<Status, MultiGetContext::MAX_BATCH_SIZE>* statuses,
+      autovector<CachableEntry<Block>, MultiGetContext::MAX_BATCH_SIZE>*
+          results,
+      const UncompressionDict& uncompression_dict,
+      MultiBlockReads* reads) const;
+
+  // The two halves of MultiGet(). With async_read, the data block reads are
+  // submitted by StartMultiGetImpl() and waited for by FinishMultiGetImpl().
+  void StartMultiGetImpl(const ReadOptions& read_options,
+                         const SliceTransform* prefix_extractor,
+                         bool skip_filters, bool async_read,
+                         MultiGetState* state);
+  void FinishMultiGetImpl(MultiGetState* state);
+
   // Get the iterator from the index reader.
   //
   // If input_iter is not set, return a new Iterator.
@@ -453,6 +525,13 @@ class BlockBasedTable : public TableReader {
                               const SliceTransform* prefix_extractor,
                               BlockCacheLookupContext* lookup_context) const;
 
+  // Returns the range at the end of a file of `file_size` bytes to prefetch
+  // before reading the footer
+  static void GetTailPrefetchRange(uint64_t file_size,
+                                   TailPrefetchStats* tail_prefetch_stats,
+                                   const bool prefetch_all,
+                                   const bool preload_all, size_t* offset,
+                                   size_t* len);
   // If force_direct_prefetch is true, always prefetching to RocksDB
   //    buffer, rather than calling RandomAccessFile::Prefetch().
   static Status PrefetchTail(
@@ -531,6 +610,60 @@ class BlockBasedTable::PartitionedIndexIteratorState
   std::unordered_map<uint64_t, CachableEntry<Block>>* block_map_;
 };
 
+// The coalesced data block reads of a MultiGet()
+struct BlockBasedTable::MultiBlockReads {
+  explicit MultiBlockReads(FileSystem* _fs) : fs(_fs) {}
+  // Makes sure no read is still in flight.
+  ~MultiBlockReads();
+
+  FileSystem* fs;
+  autovector<FSReadRequest, MultiGetContext::MAX_BATCH_SIZE> read_reqs;
+  // For each block to read, the index of its request in read_reqs and its
+  // offset in that request
+  autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> req_idx_for_block;
+  autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> req_offset_for_block;
+  // In direct IO mode, blocks share the direct io buffer. Otherwise, blocks
+  // share the scratch buffer if there is one.
+  bool use_shared_buffer = false;
+  AlignedBuf direct_io_buf;
+  // Handles of the asynchronous reads in flight
+  std::vector<void*> io_handles;
+  std::vector<IOHandleDeleter> del_fns;
+};
+
+// State of a MultiGet() in a BlockBasedTable
+struct BlockBasedTable::MultiGetState : public TableReader::MultiGetState {
+  MultiGetState(const ReadOptions& _read_options, const MultiGetRange& range,
+                FileSystem* fs)
+      : read_options(_read_options),
+        sst_file_range(range, range.begin(), range.end()),
+        data_block_range(range, range.begin(), range.end()),
+        reads(fs) {}
+
+  const ReadOptions& read_options;
+  bool skip_filters = false;
+  FilterBlockReader* filter = nullptr;
+  uint64_t tracing_mget_id = BlockCacheTraceHelper::kReservedGetId;
+  // The keys that may be in the table, and the subset of them that needs a
+  // data block lookup
+  MultiGetRange sst_file_range;
+  MultiGetRange data_block_range;
+  IndexBlockIter iiter_on_stack;
+  std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+  InternalIteratorBase<IndexValue>* iiter = nullptr;
+  // The data block of each key in data_block_range; a null handle if the
+  // block is in results already or is the same as the previous key's
+  autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE> block_handles;
+  autovector<CachableEntry<Block>, MultiGetContext::MAX_BATCH_SIZE> results;
+  autovector<Status, MultiGetContext::MAX_BATCH_SIZE> statuses;
+  CachableEntry<UncompressionDict> uncompression_dict;
+  char stack_buf[kMultiGetReadStackBufSize];
+  std::unique_ptr<char[]> block_buf;
+  // Whether reads has reads to wait for and process in FinishMultiGetImpl()
+  bool reads_pending = false;
+  MultiBlockReads reads;
+};
+
 // Stores all the properties associated with a BlockBasedTable.
 // These are immutable.
 struct BlockBasedTable::Rep {
@@ -605,6 +738,11 @@ struct BlockBasedTable::Rep {
   // Size of the table file on disk
   uint64_t file_size;
 
+  // How iterators have read this file, if
+  // BlockBasedTableOptions::learn_auto_readahead is set. Shared by all the
+  // iterators of the table.
+  std::unique_ptr<ReadaheadHistory> readahead_history;
+
   // the level when the table is opened, could potentially change when trivial
   // move is involved
   int level;
@@ -653,20 +791,23 @@ struct BlockBasedTable::Rep {
   void CreateFilePrefetchBuffer(size_t readahead_size,
                                 size_t max_readahead_size,
                                 std::unique_ptr<FilePrefetchBuffer>* fpb,
-                                bool implicit_auto_readahead) const {
-    fpb->reset(new FilePrefetchBuffer(readahead_size, max_readahead_size,
-                                      !ioptions.allow_mmap_reads /* enable */,
-                                      false /* track_min_offset */,
-                                      implicit_auto_readahead));
+                                bool implicit_auto_readahead,
+                                bool async_io = false,
+                                int async_io_depth = 1) const {
+    fpb->reset(new FilePrefetchBuffer(
+        readahead_size, max_readahead_size,
+        !ioptions.allow_mmap_reads /* enable */, false /* track_min_offset */,
+        implicit_auto_readahead, async_io, ioptions.fs.get(), async_io_depth));
   }
 
   void CreateFilePrefetchBufferIfNotExists(
       size_t readahead_size, size_t max_readahead_size,
-      std::unique_ptr<FilePrefetchBuffer>* fpb,
-      bool implicit_auto_readahead) const {
+      std::unique_ptr<FilePrefetchBuffer>* fpb, bool implicit_auto_readahead,
+      bool async_io = false, int async_io_depth = 1) const {
     if (!(*fpb)) {
       CreateFilePrefetchBuffer(readahead_size, max_readahead_size, fpb,
-                               implicit_auto_readahead);
+                               implicit_auto_readahead, async_io,
+                               async_io_depth);
     }
   }
 };
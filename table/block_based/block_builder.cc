@@ -28,8 +28,14 @@
 //
 // The trailer of the block has the form:
 //     restarts: uint32[num_restarts]
+//     restart_key_prefixes: uint64[num_restarts] (optional)
+//     hash index (optional)
 //     num_restarts: uint32
 // restarts[i] contains the offset within the block of the ith restart point.
+// restart_key_prefixes[i] contains the RestartKeyPrefix() of the user key of
+// the ith restart point. The top bits of the num_restarts field tell whether
+// the block has a hash index, the restart key prefixes and value columns (see
+// data_block_footer.h and value_columns.h).
 
 #include "table/block_based/block_builder.h"
 
@@ -46,10 +52,12 @@ BlockBuilder::BlockBuilder(
     int block_restart_interval, bool use_delta_encoding,
     bool use_value_delta_encoding,
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    double data_block_hash_table_util_ratio)
+    double data_block_hash_table_util_ratio, bool use_restart_key_prefixes,
+    const ValueColumnSplitter* value_column_splitter)
     : block_restart_interval_(block_restart_interval),
       use_delta_encoding_(use_delta_encoding),
       use_value_delta_encoding_(use_value_delta_encoding),
+      use_restart_key_prefixes_(use_restart_key_prefixes),
       restarts_(1, 0),  // First restart point is at offset 0
       counter_(0),
       finished_(false) {
@@ -63,6 +71,9 @@ BlockBuilder::BlockBuilder(
     default:
       assert(0);
   }
+  if (value_column_splitter != nullptr) {
+    value_columns_builder_.Initialize(value_column_splitter);
+  }
   assert(block_restart_interval_ >= 1);
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
 }
@@ -71,6 +82,7 @@ void BlockBuilder::Reset() {
   buffer_.clear();
   restarts_.resize(1);  // First restart point is at offset 0
   assert(restarts_[0] == 0);
+  restart_key_prefixes_.clear();
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
   counter_ = 0;
   finished_ = false;
@@ -78,6 +90,9 @@ void BlockBuilder::Reset() {
   if (data_block_hash_index_builder_.Valid()) {
     data_block_hash_index_builder_.Reset();
   }
+  if (value_columns_builder_.Valid()) {
+    value_columns_builder_.Reset();
+  }
 #ifndef NDEBUG
   add_with_last_key_called_ = false;
 #endif
@@ -104,6 +119,10 @@ size_t BlockBuilder::EstimateSizeAfterKV(const Slice& key,
   if (counter_ >= block_restart_interval_) {
     estimate += sizeof(uint32_t);  // a new restart entry.
   }
+  if (use_restart_key_prefixes_ &&
+      (counter_ == 0 || counter_ >= block_restart_interval_)) {
+    estimate += sizeof(uint64_t);  // a new restart key prefix.
+  }
 
   estimate += sizeof(int32_t);  // varint for shared prefix length.
   // Note: this is an imprecise estimate as we will have to encoded size, one
@@ -122,6 +141,16 @@ Slice BlockBuilder::Finish() {
     PutFixed32(&buffer_, restarts_[i]);
   }
 
+  // An empty block has a restart point, but no restart key
+  bool has_restart_key_prefixes =
+      use_restart_key_prefixes_ &&
+      restart_key_prefixes_.size() == restarts_.size();
+  if (has_restart_key_prefixes) {
+    for (uint64_t prefix : restart_key_prefixes_) {
+      PutFixed64(&buffer_, prefix);
+    }
+  }
+
   uint32_t num_restarts = static_cast<uint32_t>(restarts_.size());
   BlockBasedTableOptions::DataBlockIndexType index_type =
       BlockBasedTableOptions::kDataBlockBinarySearch;
@@ -131,8 +160,16 @@ Slice BlockBuilder::Finish() {
     index_type = BlockBasedTableOptions::kDataBlockBinaryAndHash;
   }
 
-  // footer is a packed format of data_block_index_type and num_restarts
-  uint32_t block_footer = PackIndexTypeAndNumRestarts(index_type, num_restarts);
+  bool has_value_columns = value_columns_builder_.Valid();
+  if (has_value_columns) {
+    value_columns_builder_.Finish(buffer_);
+  }
+
+  // footer is a packed format of data_block_index_type, num_restarts and
+  // flags for the optional parts of the block
+  uint32_t block_footer =
+      PackIndexTypeAndNumRestarts(index_type, num_restarts,
+                                  has_restart_key_prefixes, has_value_columns);
 
   PutFixed32(&buffer_, block_footer);
   finished_ = true;
@@ -178,13 +215,18 @@ void BlockBuilder::AddWithLastKey(const Slice& key, const Slice& value,
 }
 
 inline void BlockBuilder::AddWithLastKeyImpl(const Slice& key,
-                                             const Slice& value,
+                                             const Slice& value_param,
                                              const Slice& last_key,
                                              const Slice* const delta_value,
                                              size_t buffer_size) {
   assert(!finished_);
   assert(counter_ <= block_restart_interval_);
   assert(!use_value_delta_encoding_ || delta_value);
+  Slice value = value_param;
+  if (value_columns_builder_.Valid()) {
+    value_columns_builder_.AddValue(key, value, &entry_value_);
+    value = entry_value_;
+  }
   size_t shared = 0;  // number of bytes shared with prev key
   if (counter_ >= block_restart_interval_) {
     // Restart compression
@@ -196,6 +238,11 @@ inline void BlockBuilder::AddWithLastKeyImpl(const Slice& key,
     shared = key.difference_offset(last_key);
   }
 
+  if (use_restart_key_prefixes_ && counter_ == 0) {
+    restart_key_prefixes_.push_back(RestartKeyPrefix(ExtractUserKey(key)));
+    estimate_ += sizeof(uint64_t);
+  }
+
   const size_t non_shared = key.size() - shared;
 
   if (use_value_delta_encoding_) {
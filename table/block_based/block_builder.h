@@ -14,6 +14,7 @@
 #include "rocksdb/slice.h"
 #include "rocksdb/table.h"
 #include "table/block_based/data_block_hash_index.h"
+#include "table/block_based/value_columns.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -27,7 +28,10 @@ class BlockBuilder {
                         bool use_value_delta_encoding = false,
                         BlockBasedTableOptions::DataBlockIndexType index_type =
                             BlockBasedTableOptions::kDataBlockBinarySearch,
-                        double data_block_hash_table_util_ratio = 0.75);
+                        double data_block_hash_table_util_ratio = 0.75,
+                        bool use_restart_key_prefixes = false,
+                        const ValueColumnSplitter* value_column_splitter =
+                            nullptr);
 
   // Reset the contents as if the BlockBuilder was just constructed.
   void Reset();
@@ -63,9 +67,12 @@ class BlockBuilder {
   // Returns an estimate of the current (uncompressed) size of the block
   // we are building.
   inline size_t CurrentSizeEstimate() const {
-    return estimate_ + (data_block_hash_index_builder_.Valid()
-                            ? data_block_hash_index_builder_.EstimateSize()
-                            : 0);
+    return estimate_ +
+           (data_block_hash_index_builder_.Valid()
+                ? data_block_hash_index_builder_.EstimateSize()
+                : 0) +
+           (value_columns_builder_.Valid() ? value_columns_builder_.EstimateSize()
+                                           : 0);
   }
 
   // Returns an estimated block size after appending key and value.
@@ -85,14 +92,21 @@ class BlockBuilder {
   const bool use_delta_encoding_;
   // Refer to BlockIter::DecodeCurrentValue for format of delta encoded values
   const bool use_value_delta_encoding_;
+  // Whether to store the prefixes of the restart keys (which must be internal
+  // keys ordered by the bytewise comparator); see RestartKeyPrefix()
+  const bool use_restart_key_prefixes_;
 
   std::string buffer_;              // Destination buffer
   std::vector<uint32_t> restarts_;  // Restart points
+  std::vector<uint64_t> restart_key_prefixes_;
   size_t estimate_;
   int counter_;    // Number of entries emitted since restart
   bool finished_;  // Has Finish() been called?
   std::string last_key_;
   DataBlockHashIndexBuilder data_block_hash_index_builder_;
+  ValueColumnsBuilder value_columns_builder_;
+  // What is stored in the entry for the value with value columns
+  std::string entry_value_;
 #ifndef NDEBUG
   bool add_with_last_key_called_ = false;
 #endif
@@ -14,18 +14,21 @@ namespace ROCKSDB_NAMESPACE {
 void BlockPrefetcher::PrefetchIfNeeded(const BlockBasedTable::Rep* rep,
                                        const BlockHandle& handle,
                                        size_t readahead_size,
-                                       bool is_for_compaction) {
+                                       bool is_for_compaction,
+                                       bool async_io) {
   if (is_for_compaction) {
-    rep->CreateFilePrefetchBufferIfNotExists(compaction_readahead_size_,
-                                             compaction_readahead_size_,
-                                             &prefetch_buffer_, false);
+    const int async_io_depth = rep->ioptions.compaction_async_io_depth;
+    rep->CreateFilePrefetchBufferIfNotExists(
+        compaction_readahead_size_, compaction_readahead_size_,
+        &prefetch_buffer_, false, async_io_depth > 0, async_io_depth);
     return;
   }
 
   // Explicit user requested readahead.
   if (readahead_size > 0) {
     rep->CreateFilePrefetchBufferIfNotExists(readahead_size, readahead_size,
-                                             &prefetch_buffer_, false);
+                                             &prefetch_buffer_, false,
+                                             async_io);
     return;
   }
 
@@ -51,27 +54,34 @@ void BlockPrefetcher::PrefetchIfNeeded(const BlockBasedTable::Rep* rep,
   if (!IsBlockSequential(offset)) {
     UpdateReadPattern(offset, len);
     ResetValues();
+    StartRun(rep, offset);
     return;
   }
+  if (prev_len_ == 0) {
+    StartRun(rep, offset);
+  }
   UpdateReadPattern(offset, len);
 
   // Implicit auto readahead, which will be enabled if the number of reads
   // reached `kMinNumFileReadsToStartAutoReadahead` (default: 2)  and scans are
   // sequential.
   num_file_reads_++;
-  if (num_file_reads_ <=
-      BlockBasedTable::kMinNumFileReadsToStartAutoReadahead) {
+  if (num_file_reads_ <= num_file_reads_to_start_readahead_) {
     return;
   }
+  run_reached_readahead_ = true;
 
   if (initial_auto_readahead_size_ > max_auto_readahead_size) {
     initial_auto_readahead_size_ = max_auto_readahead_size;
   }
 
-  if (rep->file->use_direct_io()) {
+  // With async_io, the internal prefetch buffer reads ahead asynchronously,
+  // so it is used instead of the file system's readahead.
+  if (rep->file->use_direct_io() || async_io) {
     rep->CreateFilePrefetchBufferIfNotExists(initial_auto_readahead_size_,
                                              max_auto_readahead_size,
-                                             &prefetch_buffer_, true);
+                                             &prefetch_buffer_, true,
+                                             async_io);
     return;
   }
 
@@ -97,4 +107,58 @@ void BlockPrefetcher::PrefetchIfNeeded(const BlockBasedTable::Rep* rep,
   // max_auto_readahead_size.
   readahead_size_ = std::min(max_auto_readahead_size, readahead_size_ * 2);
 }
+
+void BlockPrefetcher::StartRun(const BlockBasedTable::Rep* rep,
+                               uint64_t offset) {
+  EndRun();
+  readahead_history_ = rep->readahead_history.get();
+  if (readahead_history_ == nullptr) {
+    return;
+  }
+  run_offset_ = offset;
+  run_started_ = true;
+  run_reached_readahead_ = false;
+
+  // Regions mostly read by short scans wait for more sequential reads before
+  // reading ahead.
+  num_file_reads_to_start_readahead_ =
+      readahead_history_->IsRandom(offset)
+          ? 4 * BlockBasedTable::kMinNumFileReadsToStartAutoReadahead
+          : BlockBasedTable::kMinNumFileReadsToStartAutoReadahead;
+  if (readahead_state_set_) {
+    // The state carried over from the previous iterator takes precedence for
+    // its first run.
+    readahead_state_set_ = false;
+    return;
+  }
+  size_t learned_readahead_size =
+      readahead_history_->GetLearnedReadaheadSize(offset);
+  if (learned_readahead_size > 0) {
+    // Read ahead from this read on, with the size that earlier scans reached.
+    num_file_reads_ = BlockBasedTable::kMinNumFileReadsToStartAutoReadahead;
+    initial_auto_readahead_size_ = learned_readahead_size;
+    readahead_size_ = learned_readahead_size;
+  }
+  TEST_SYNC_POINT_CALLBACK("BlockPrefetcher::StartRun",
+                           &learned_readahead_size);
+}
+
+void BlockPrefetcher::EndRun() {
+  if (!run_started_) {
+    return;
+  }
+  run_started_ = false;
+  size_t readahead_size = 0;
+  if (run_reached_readahead_) {
+    if (prefetch_buffer_) {
+      ReadaheadFileInfo::ReadaheadInfo readahead_info;
+      prefetch_buffer_->GetReadaheadState(&readahead_info);
+      readahead_size = readahead_info.readahead_size;
+    } else {
+      readahead_size = readahead_size_;
+    }
+  }
+  readahead_history_->RecordRun(run_offset_, readahead_size,
+                                BlockBasedTable::kInitAutoReadaheadSize);
+}
 }  // namespace ROCKSDB_NAMESPACE
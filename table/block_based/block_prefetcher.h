@@ -14,9 +14,11 @@ class BlockPrefetcher {
  public:
   explicit BlockPrefetcher(size_t compaction_readahead_size)
       : compaction_readahead_size_(compaction_readahead_size) {}
+  ~BlockPrefetcher() { EndRun(); }
+
   void PrefetchIfNeeded(const BlockBasedTable::Rep* rep,
                         const BlockHandle& handle, size_t readahead_size,
-                        bool is_for_compaction);
+                        bool is_for_compaction, bool async_io = false);
   FilePrefetchBuffer* prefetch_buffer() { return prefetch_buffer_.get(); }
 
   void UpdateReadPattern(const uint64_t& offset, const size_t& len) {
@@ -42,11 +44,19 @@ class BlockPrefetcher {
   void SetReadaheadState(ReadaheadFileInfo::ReadaheadInfo* readahead_info) {
     num_file_reads_ = readahead_info->num_file_reads;
     initial_auto_readahead_size_ = readahead_info->readahead_size;
+    readahead_state_set_ = true;
     TEST_SYNC_POINT_CALLBACK("BlockPrefetcher::SetReadaheadState",
                              &initial_auto_readahead_size_);
   }
 
  private:
+  // Starts a run of sequential reads at `offset`, with the readahead learned
+  // from the earlier runs there if rep->readahead_history is set.
+  void StartRun(const BlockBasedTable::Rep* rep, uint64_t offset);
+
+  // Records the current run, if any, in the readahead history.
+  void EndRun();
+
   // Readahead size used in compaction, its value is used only if
   // lookup_context_.caller = kCompaction.
   size_t compaction_readahead_size_;
@@ -62,5 +72,18 @@ class BlockPrefetcher {
   uint64_t prev_offset_ = 0;
   size_t prev_len_ = 0;
   std::unique_ptr<FilePrefetchBuffer> prefetch_buffer_;
+
+  // Number of sequential reads after which auto readahead starts
+  int64_t num_file_reads_to_start_readahead_ =
+      BlockBasedTable::kMinNumFileReadsToStartAutoReadahead;
+  // Set if the readahead state was carried over from another iterator
+  bool readahead_state_set_ = false;
+
+  // Learned readahead of the table, and the current run of sequential reads
+  // to record in it. The table outlives its iterators.
+  ReadaheadHistory* readahead_history_ = nullptr;
+  uint64_t run_offset_ = 0;
+  bool run_started_ = false;
+  bool run_reached_readahead_ = false;
 };
 }  // namespace ROCKSDB_NAMESPACE
@@ -27,8 +27,10 @@
 #include "table/block_based/block_builder.h"
 #include "table/format.h"
 #include "test_util/testharness.h"
+#include "test_util/sync_point.h"
 #include "test_util/testutil.h"
 #include "util/random.h"
+#include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -618,6 +620,159 @@ INSTANTIATE_TEST_CASE_P(P, IndexBlockTest,
                                           std::make_tuple(true, false),
                                           std::make_tuple(true, true)));
 
+class RestartKeyPrefixesTest
+    : public testing::Test,
+      public testing::WithParamInterface<std::tuple<int, bool>> {
+ public:
+  int restartInterval() const { return std::get<0>(GetParam()); }
+  BlockBasedTableOptions::DataBlockIndexType indexType() const {
+    return std::get<1>(GetParam())
+               ? BlockBasedTableOptions::kDataBlockBinaryAndHash
+               : BlockBasedTableOptions::kDataBlockBinarySearch;
+  }
+
+  // Checks seeks to every user key in `probes`, in a block of `user_keys`
+  // (sorted and unique) built with and without restart key prefixes. There
+  // must be few enough keys for the hash index to support a restart per key.
+  void CheckSeeks(const std::vector<std::string> &user_keys,
+                  const std::vector<std::string> &probes) {
+    std::vector<std::string> keys;
+    for (const auto &user_key : user_keys) {
+      keys.emplace_back(user_key);
+      AppendInternalKeyFooter(&keys.back(), 0 /* seqno */, kTypeValue);
+    }
+
+    BlockBuilder builder(restartInterval(), true /* use_delta_encoding */,
+                         false /* use_value_delta_encoding */, indexType(),
+                         0.75 /* data_block_hash_table_util_ratio */,
+                         true /* use_restart_key_prefixes */);
+    BlockBuilder builder_without_prefixes(
+        restartInterval(), true /* use_delta_encoding */,
+        false /* use_value_delta_encoding */, indexType());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      builder.Add(keys[i], "v" + ToString(i));
+      builder_without_prefixes.Add(keys[i], "v" + ToString(i));
+    }
+    BlockContents contents;
+    contents.data = builder.Finish();
+    Block reader(std::move(contents));
+    ASSERT_EQ(reader.IndexType(), indexType());
+    ASSERT_EQ(reader.size(), builder_without_prefixes.Finish().size() +
+                                 reader.NumRestarts() * sizeof(uint64_t));
+
+    std::unique_ptr<DataBlockIter> iter(reader.NewDataIterator(
+        BytewiseComparator(), kDisableGlobalSequenceNumber));
+    for (const auto &probe : probes) {
+      auto it = std::lower_bound(user_keys.begin(), user_keys.end(), probe);
+      size_t lower = it - user_keys.begin();
+      bool found = it != user_keys.end() && *it == probe;
+
+      std::string seek_key = probe;
+      AppendInternalKeyFooter(&seek_key, kMaxSequenceNumber,
+                              kValueTypeForSeek);
+      iter->Seek(seek_key);
+      if (lower == keys.size()) {
+        ASSERT_FALSE(iter->Valid());
+      } else {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(iter->key().ToString(), keys[lower]);
+      }
+
+      std::string prev_key = probe;
+      AppendInternalKeyFooter(&prev_key, 0 /* seqno */, kTypeValue);
+      iter->SeekForPrev(prev_key);
+      size_t upper = found ? lower + 1 : lower;
+      if (upper == 0) {
+        ASSERT_FALSE(iter->Valid());
+      } else {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(iter->key().ToString(), keys[upper - 1]);
+      }
+
+      if (found) {
+        ASSERT_TRUE(iter->SeekForGet(seek_key));
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(iter->key().ToString(), keys[lower]);
+        ASSERT_EQ(iter->value().ToString(), "v" + ToString(lower));
+      }
+      ASSERT_OK(iter->status());
+    }
+  }
+};
+
+TEST_P(RestartKeyPrefixesTest, DistinctPrefixes) {
+  std::vector<std::string> user_keys;
+  std::vector<std::string> probes;
+  for (int i = 0; i < 200; ++i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%08d", i * 2);
+    user_keys.emplace_back(buf);
+    probes.emplace_back(buf);
+    snprintf(buf, sizeof(buf), "%08d", i * 2 + 1);
+    probes.emplace_back(buf);
+  }
+  probes.emplace_back("");
+  probes.emplace_back("~");
+
+  // Only the restart point of the target (if any) and its neighbor are left
+  // for the binary search
+  int64_t max_range = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DataBlockIter::RestartKeyPrefixBounds", [&](void *arg) {
+        int64_t *bounds = static_cast<int64_t *>(arg);
+        max_range = std::max(max_range, bounds[1] - bounds[0]);
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  CheckSeeks(user_keys, probes);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_LE(max_range, 1);
+}
+
+TEST_P(RestartKeyPrefixesTest, CommonPrefix) {
+  // All the restart key prefixes are equal
+  std::vector<std::string> user_keys;
+  std::vector<std::string> probes;
+  for (int i = 0; i < 200; ++i) {
+    user_keys.emplace_back("common_prefix" + ToString(1000 + i * 2));
+    probes.emplace_back(user_keys.back());
+    probes.emplace_back("common_prefix" + ToString(1000 + i * 2 + 1));
+  }
+  probes.emplace_back("common_p");
+  probes.emplace_back("common_prefiy");
+  probes.emplace_back("common_prefix");
+  CheckSeeks(user_keys, probes);
+}
+
+TEST_P(RestartKeyPrefixesTest, ShortKeys) {
+  // Keys shorter than the prefixes, and keys that only differ by trailing
+  // zero bytes, which get the same prefix
+  Random rnd(301);
+  const char kAlphabet[] = {'\0', 'a', '\xff'};
+  auto random_key = [&]() {
+    std::string key;
+    uint32_t len = rnd.Uniform(12);
+    for (uint32_t i = 0; i < len; ++i) {
+      key.push_back(kAlphabet[rnd.Uniform(3)]);
+    }
+    return key;
+  };
+  std::set<std::string> key_set;
+  for (int i = 0; i < 200; ++i) {
+    key_set.insert(random_key());
+  }
+  std::vector<std::string> user_keys(key_set.begin(), key_set.end());
+  std::vector<std::string> probes = user_keys;
+  for (int i = 0; i < 1000; ++i) {
+    probes.emplace_back(random_key());
+  }
+  CheckSeeks(user_keys, probes);
+}
+
+INSTANTIATE_TEST_CASE_P(P, RestartKeyPrefixesTest,
+                        ::testing::Combine(::testing::Values(1, 16),
+                                           ::testing::Bool()));
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char **argv) {
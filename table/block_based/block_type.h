@@ -25,6 +25,7 @@ enum class BlockType : uint8_t {
   kHashIndexMetadata,
   kMetaIndex,
   kIndex,
+  kInterpolationIndex,
   // Note: keep kInvalid the last value when adding new enum values.
   kInvalid
 };
@@ -15,15 +15,20 @@ namespace ROCKSDB_NAMESPACE {
 
 const int kDataBlockIndexTypeBitShift = 31;
 
-// 0x7FFFFFFF
-const uint32_t kMaxNumRestarts = (1u << kDataBlockIndexTypeBitShift) - 1u;
+const int kRestartKeyPrefixesBitShift = 30;
 
-// 0x7FFFFFFF
-const uint32_t kNumRestartsMask = (1u << kDataBlockIndexTypeBitShift) - 1u;
+const int kValueColumnsBitShift = 29;
+
+// 0x1FFFFFFF. A block with more restarts would be larger than 2GB.
+const uint32_t kMaxNumRestarts = (1u << kValueColumnsBitShift) - 1u;
+
+// 0x1FFFFFFF
+const uint32_t kNumRestartsMask = (1u << kValueColumnsBitShift) - 1u;
 
 uint32_t PackIndexTypeAndNumRestarts(
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    uint32_t num_restarts) {
+    uint32_t num_restarts, bool has_restart_key_prefixes,
+    bool has_value_columns) {
   if (num_restarts > kMaxNumRestarts) {
     assert(0);  // mute travis "unused" warning
   }
@@ -34,6 +39,12 @@ uint32_t PackIndexTypeAndNumRestarts(
   } else if (index_type != BlockBasedTableOptions::kDataBlockBinarySearch) {
     assert(0);
   }
+  if (has_restart_key_prefixes) {
+    block_footer |= 1u << kRestartKeyPrefixesBitShift;
+  }
+  if (has_value_columns) {
+    block_footer |= 1u << kValueColumnsBitShift;
+  }
 
   return block_footer;
 }
@@ -41,7 +52,8 @@ uint32_t PackIndexTypeAndNumRestarts(
 void UnPackIndexTypeAndNumRestarts(
     uint32_t block_footer,
     BlockBasedTableOptions::DataBlockIndexType* index_type,
-    uint32_t* num_restarts) {
+    uint32_t* num_restarts, bool* has_restart_key_prefixes,
+    bool* has_value_columns) {
   if (index_type) {
     if (block_footer & 1u << kDataBlockIndexTypeBitShift) {
       *index_type = BlockBasedTableOptions::kDataBlockBinaryAndHash;
@@ -54,6 +66,15 @@ void UnPackIndexTypeAndNumRestarts(
     *num_restarts = block_footer & kNumRestartsMask;
     assert(*num_restarts <= kMaxNumRestarts);
   }
+
+  if (has_restart_key_prefixes) {
+    *has_restart_key_prefixes =
+        (block_footer & 1u << kRestartKeyPrefixesBitShift) != 0;
+  }
+
+  if (has_value_columns) {
+    *has_value_columns = (block_footer & 1u << kValueColumnsBitShift) != 0;
+  }
 }
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -9,17 +9,39 @@
 
 #pragma once
 
+#include <stdint.h>
+
+#include "rocksdb/slice.h"
 #include "rocksdb/table.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 uint32_t PackIndexTypeAndNumRestarts(
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    uint32_t num_restarts);
+    uint32_t num_restarts, bool has_restart_key_prefixes = false,
+    bool has_value_columns = false);
 
 void UnPackIndexTypeAndNumRestarts(
     uint32_t block_footer,
     BlockBasedTableOptions::DataBlockIndexType* index_type,
-    uint32_t* num_restarts);
+    uint32_t* num_restarts, bool* has_restart_key_prefixes = nullptr,
+    bool* has_value_columns = nullptr);
+
+// Data blocks written with format_version >= 6 for the bytewise comparator
+// store, after the restart array, the restart key prefix of the user key of
+// each restart point, so that seeks can narrow down the restart points to
+// search without decoding keys. The prefix is the first 8 bytes of the user
+// key, zero-padded and read as a big-endian integer, so that a smaller
+// (resp. larger) prefix implies a smaller (resp. larger) user key.
+inline uint64_t RestartKeyPrefix(const Slice& user_key) {
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < sizeof(prefix); ++i) {
+    prefix <<= 8;
+    if (i < user_key.size()) {
+      prefix |= static_cast<unsigned char>(user_key[i]);
+    }
+  }
+  return prefix;
+}
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -441,10 +441,9 @@ class FastLocalBloomBitsReader : public FilterBitsReader {
                                       /*out*/ &byte_offsets[i]);
       hashes[i] = Upper32of64(h);
     }
-    for (int i = 0; i < num_keys; ++i) {
-      may_match[i] = FastLocalBloomImpl::HashMayMatchPrepared(
-          hashes[i], num_probes_, data_ + byte_offsets[i]);
-    }
+    FastLocalBloomImpl::BatchHashMayMatchPrepared(
+        static_cast<size_t>(num_keys), hashes.data(), byte_offsets.data(),
+        num_probes_, data_, may_match);
   }
 
  private:
@@ -10,8 +10,10 @@
 #pragma once
 
 #include <assert.h>
-#include <cinttypes>
+#include <string.h>
 
+#include <algorithm>
+#include <cinttypes>
 #include <list>
 #include <string>
 #include <unordered_map>
@@ -19,6 +21,7 @@
 #include "rocksdb/comparator.h"
 #include "table/block_based/block_based_table_factory.h"
 #include "table/block_based/block_builder.h"
+#include "table/block_based/interpolation_index.h"
 #include "table/format.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -353,6 +356,75 @@ class HashIndexBuilder : public IndexBuilder {
   uint64_t current_restart_index_ = 0;
 };
 
+// InterpolationIndexBuilder contains a binary-searchable primary index and a
+// metablock with a model of the user keys at the restart points of the
+// primary index, which the reader uses to narrow down the binary search (see
+// InterpolationIndex). The model relies on the bytewise order of keys, so it
+// is only built with the bytewise comparator.
+class InterpolationIndexBuilder : public IndexBuilder {
+ public:
+  explicit InterpolationIndexBuilder(
+      const InternalKeyComparator* comparator,
+      int index_block_restart_interval, int format_version,
+      bool use_value_delta_encoding,
+      BlockBasedTableOptions::IndexShorteningMode shortening_mode)
+      : IndexBuilder(comparator),
+        primary_index_builder_(comparator, index_block_restart_interval,
+                               format_version, use_value_delta_encoding,
+                               shortening_mode, /* include_first_key */ false),
+        index_block_restart_interval_(
+            std::max(index_block_restart_interval, 1)),
+        build_model_(comparator->user_comparator()->timestamp_size() == 0 &&
+                     strcmp(comparator->user_comparator()->Name(),
+                            BytewiseComparator()->Name()) == 0) {}
+
+  virtual void AddIndexEntry(std::string* last_key_in_current_block,
+                             const Slice* first_key_in_next_block,
+                             const BlockHandle& block_handle) override {
+    primary_index_builder_.AddIndexEntry(last_key_in_current_block,
+                                         first_key_in_next_block, block_handle);
+    // The primary index builder replaced the key with the separator, which
+    // starts a restart interval every index_block_restart_interval_ entries.
+    if (build_model_ && num_entries_ % index_block_restart_interval_ == 0) {
+      model_builder_.AddRestartKey(ExtractUserKey(*last_key_in_current_block));
+    }
+    ++num_entries_;
+  }
+
+  virtual void OnKeyAdded(const Slice& key) override {
+    primary_index_builder_.OnKeyAdded(key);
+  }
+
+  virtual Status Finish(
+      IndexBlocks* index_blocks,
+      const BlockHandle& last_partition_block_handle) override {
+    Status s = primary_index_builder_.Finish(index_blocks,
+                                             last_partition_block_handle);
+    if (s.ok() && !model_builder_.empty()) {
+      model_builder_.Finish(&model_block_);
+      index_blocks->meta_blocks.insert(
+          {kInterpolationIndexBlock.c_str(), model_block_});
+    }
+    return s;
+  }
+
+  virtual size_t IndexSize() const override {
+    return primary_index_builder_.IndexSize() + model_block_.size();
+  }
+
+  virtual bool seperator_is_key_plus_seq() override {
+    return primary_index_builder_.seperator_is_key_plus_seq();
+  }
+
+ private:
+  ShortenedIndexBuilder primary_index_builder_;
+  const uint64_t index_block_restart_interval_;
+  const bool build_model_;
+  uint64_t num_entries_ = 0;
+  InterpolationIndex::Builder model_builder_;
+  std::string model_block_;
+};
+
 /**
  * IndexBuilder for two-level indexing. Internally it creates a new index for
  * each partition and Finish then in order when Finish is called on it
@@ -0,0 +1,213 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/interpolation_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+void PutDouble(std::string* dst, double value) {
+  uint64_t bits;
+  static_assert(sizeof(bits) == sizeof(value), "double is not 64 bits");
+  memcpy(&bits, &value, sizeof(bits));
+  PutFixed64(dst, bits);
+}
+
+bool GetDouble(Slice* input, double* value) {
+  uint64_t bits;
+  if (!GetFixed64(input, &bits)) {
+    return false;
+  }
+  memcpy(value, &bits, sizeof(bits));
+  return true;
+}
+}  // namespace
+
+constexpr uint32_t InterpolationIndex::Builder::kMaxError;
+
+void InterpolationIndex::Builder::Finish(std::string* contents) {
+  InterpolationIndex model;
+  const size_t n = restart_keys_.size();
+  model.num_restarts_ = static_cast<uint32_t>(n);
+
+  if (n > 0) {
+    // The keys are sorted, so the prefix shared by the first and the last
+    // one is shared by all of them.
+    const std::string& first = restart_keys_.front();
+    const std::string& last = restart_keys_.back();
+    size_t prefix_len = 0;
+    while (prefix_len < first.size() && prefix_len < last.size() &&
+           first[prefix_len] == last[prefix_len]) {
+      ++prefix_len;
+    }
+    model.prefix_ = first.substr(0, prefix_len);
+  }
+
+  std::vector<uint64_t> xs(n);
+  for (size_t i = 0; i < n; ++i) {
+    bool ok = model.KeyToInt(restart_keys_[i], &xs[i]);
+    assert(ok);
+    (void)ok;
+  }
+
+  // Greedily extend each segment as long as some line through its first
+  // point stays within kMaxError of all of its points ("shrinking cone").
+  size_t start = 0;
+  while (start < n) {
+    double min_slope = 0.0;
+    double max_slope = std::numeric_limits<double>::infinity();
+    size_t end = start + 1;
+    for (; end < n; ++end) {
+      if (xs[end] == xs[start]) {
+        // Keys that only differ after the bytes mapped to integers
+        if (end - start > kMaxError) {
+          break;
+        }
+        continue;
+      }
+      double dx = static_cast<double>(xs[end] - xs[start]);
+      double dy = static_cast<double>(end - start);
+      double lo = std::max(min_slope, (dy - kMaxError) / dx);
+      double hi = std::min(max_slope, (dy + kMaxError) / dx);
+      if (lo > hi) {
+        break;
+      }
+      min_slope = lo;
+      max_slope = hi;
+    }
+    Segment segment;
+    segment.start_x = xs[start];
+    segment.start_y = static_cast<uint32_t>(start);
+    segment.slope = std::isinf(max_slope) ? 0.0 : (min_slope + max_slope) / 2;
+    model.segments_.push_back(segment);
+    start = end;
+  }
+
+  // The error of the model, both as used by lookups (which pick the segment
+  // by the integer, so that keys mapped to the start of a segment are
+  // predicted by that segment) and along the line of the segment of each key
+  // (which bounds the predictions for keys between restart keys).
+  double max_error = 0.0;
+  size_t segment_index = 0;
+  for (size_t i = 0; i < n; ++i) {
+    while (segment_index + 1 < model.segments_.size() &&
+           model.segments_[segment_index + 1].start_y <= i) {
+      ++segment_index;
+    }
+    const Segment& segment = model.segments_[segment_index];
+    double line = static_cast<double>(segment.start_y) +
+                  segment.slope * static_cast<double>(xs[i] - segment.start_x);
+    double y = static_cast<double>(i);
+    max_error = std::max(max_error, std::abs(line - y));
+    max_error = std::max(max_error, std::abs(model.PredictIndex(xs[i]) - y));
+  }
+  model.max_error_ = static_cast<uint32_t>(
+      std::min(std::ceil(max_error), static_cast<double>(n)));
+
+  contents->clear();
+  PutVarint32(contents, model.num_restarts_);
+  PutVarint32(contents, model.max_error_);
+  PutLengthPrefixedSlice(contents, model.prefix_);
+  PutVarint32(contents, static_cast<uint32_t>(model.segments_.size()));
+  for (const Segment& segment : model.segments_) {
+    PutFixed64(contents, segment.start_x);
+    PutVarint32(contents, segment.start_y);
+    PutDouble(contents, segment.slope);
+  }
+}
+
+Status InterpolationIndex::Create(const Slice& contents,
+                                  std::unique_ptr<InterpolationIndex>* index) {
+  std::unique_ptr<InterpolationIndex> model(new InterpolationIndex());
+  Slice input = contents;
+  Slice prefix;
+  uint32_t num_segments = 0;
+  if (!GetVarint32(&input, &model->num_restarts_) ||
+      !GetVarint32(&input, &model->max_error_) ||
+      !GetLengthPrefixedSlice(&input, &prefix) ||
+      !GetVarint32(&input, &num_segments)) {
+    return Status::Corruption("Truncated interpolation index");
+  }
+  if (num_segments > model->num_restarts_ ||
+      (num_segments == 0) != (model->num_restarts_ == 0)) {
+    return Status::Corruption("Bad number of interpolation index segments");
+  }
+  model->prefix_ = prefix.ToString();
+  model->segments_.resize(num_segments);
+  for (Segment& segment : model->segments_) {
+    if (!GetFixed64(&input, &segment.start_x) ||
+        !GetVarint32(&input, &segment.start_y) ||
+        !GetDouble(&input, &segment.slope)) {
+      return Status::Corruption("Truncated interpolation index");
+    }
+    if (segment.start_y >= model->num_restarts_ ||
+        !std::isfinite(segment.slope)) {
+      return Status::Corruption("Bad interpolation index segment");
+    }
+  }
+  *index = std::move(model);
+  return Status::OK();
+}
+
+bool InterpolationIndex::KeyToInt(const Slice& user_key, uint64_t* x) const {
+  if (!user_key.starts_with(prefix_)) {
+    return false;
+  }
+  uint64_t value = 0;
+  for (size_t i = prefix_.size(); i < prefix_.size() + sizeof(value); ++i) {
+    value <<= 8;
+    if (i < user_key.size()) {
+      value |= static_cast<unsigned char>(user_key[i]);
+    }
+  }
+  *x = value;
+  return true;
+}
+
+double InterpolationIndex::PredictIndex(uint64_t x) const {
+  assert(!segments_.empty());
+  auto it = std::upper_bound(
+      segments_.begin(), segments_.end(), x,
+      [](uint64_t value, const Segment& s) { return value < s.start_x; });
+  if (it == segments_.begin()) {
+    return static_cast<double>(segments_.front().start_y);
+  }
+  // Integers past the last restart key of the segment are not extrapolated
+  // beyond it, as the next restart key is mapped to the next segment.
+  const double limit =
+      static_cast<double>(it == segments_.end() ? num_restarts_ : it->start_y) -
+      1;
+  --it;
+  return std::min(limit, static_cast<double>(it->start_y) +
+                             it->slope *
+                                 static_cast<double>(x - it->start_x));
+}
+
+bool InterpolationIndex::Predict(const Slice& user_key, uint32_t* left,
+                                 uint32_t* right) const {
+  uint64_t x;
+  if (num_restarts_ == 0 || !KeyToInt(user_key, &x)) {
+    return false;
+  }
+  // With predictions within max_error_ of the restart keys' indexes, the
+  // restart key at or before user_key is within max_error_ + 1 below the
+  // prediction, and the one after it within max_error_ + 1 above.
+  const double prediction = PredictIndex(x);
+  const double max_index = static_cast<double>(num_restarts_ - 1);
+  double lo = std::floor(prediction) - max_error_ - 1;
+  double hi = std::ceil(prediction) + max_error_;
+  *left = static_cast<uint32_t>(std::min(std::max(lo, 0.0), max_index));
+  *right = static_cast<uint32_t>(std::min(std::max(hi, 0.0), max_index));
+  return true;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,97 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A piecewise-linear model of the positions of the restart keys of an index
+// block, used by BlockBasedTableOptions::kInterpolationSearch to narrow down
+// the binary search over the restart points of the index block.
+//
+// Keys are mapped to integers by the 8 bytes (big-endian, zero-padded) that
+// follow the prefix shared by all the restart keys of the index block. With a
+// bytewise comparator, the mapping preserves the order of keys that have the
+// prefix. Each segment of the model maps the integers from its start to the
+// start of the next segment to restart indexes along a line; every restart key
+// is predicted within max_error restarts of its actual index.
+//
+// The model only narrows down the search: the index block iterator checks the
+// restart keys at the bounds of the predicted range, and falls back to a full
+// binary search if they do not enclose the target.
+class InterpolationIndex {
+ public:
+  // Builds the model, from the user keys at the restart points of an index
+  // block, in order.
+  class Builder {
+   public:
+    // Bound of the error of the model on the restart keys, in restarts.
+    // Higher bounds need fewer segments, but leave more restarts to search.
+    static constexpr uint32_t kMaxError = 4;
+
+    void AddRestartKey(const Slice& user_key) {
+      restart_keys_.emplace_back(user_key.data(), user_key.size());
+    }
+
+    bool empty() const { return restart_keys_.empty(); }
+
+    // Serializes the model into *contents.
+    void Finish(std::string* contents);
+
+   private:
+    std::vector<std::string> restart_keys_;
+  };
+
+  // Decodes a model serialized by Builder::Finish().
+  static Status Create(const Slice& contents,
+                       std::unique_ptr<InterpolationIndex>* index);
+
+  // If the restart point that a seek to user_key lands on can be predicted,
+  // returns true and sets [*left, *right] to the predicted range of restart
+  // indexes: the last restart key less than or equal to user_key should be
+  // at an index in [*left, *right], and the restart key after *right should
+  // be greater than user_key.
+  bool Predict(const Slice& user_key, uint32_t* left, uint32_t* right) const;
+
+  uint32_t num_restarts() const { return num_restarts_; }
+
+  size_t ApproximateMemoryUsage() const {
+    return sizeof(InterpolationIndex) + prefix_.capacity() +
+           segments_.capacity() * sizeof(Segment);
+  }
+
+ private:
+  struct Segment {
+    // The first integer mapped by the segment, and its restart index
+    uint64_t start_x;
+    uint32_t start_y;
+    // Restarts per integer
+    double slope;
+  };
+
+  InterpolationIndex() = default;
+
+  // Maps user_key to an integer. Returns false if user_key does not have the
+  // prefix of the restart keys.
+  bool KeyToInt(const Slice& user_key, uint64_t* x) const;
+
+  // The predicted (fractional) restart index of x.
+  double PredictIndex(uint64_t x) const;
+
+  std::string prefix_;
+  uint32_t num_restarts_ = 0;
+  uint32_t max_error_ = 0;
+  std::vector<Segment> segments_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,174 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/interpolation_index.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "test_util/testharness.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class InterpolationIndexTest : public testing::Test {
+ protected:
+  static std::string BigEndianKey(const std::string& prefix, uint64_t value) {
+    std::string key = prefix;
+    for (int shift = 56; shift >= 0; shift -= 8) {
+      key.push_back(static_cast<char>(value >> shift));
+    }
+    return key;
+  }
+
+  static std::unique_ptr<InterpolationIndex> Build(
+      const std::vector<std::string>& keys) {
+    InterpolationIndex::Builder builder;
+    for (const std::string& key : keys) {
+      builder.AddRestartKey(key);
+    }
+    std::string contents;
+    builder.Finish(&contents);
+    std::unique_ptr<InterpolationIndex> index;
+    EXPECT_OK(InterpolationIndex::Create(contents, &index));
+    return index;
+  }
+
+  // Checks the contract of Predict() for target, which must not be less than
+  // the first key.
+  static void CheckPrediction(const InterpolationIndex& index,
+                              const std::vector<std::string>& keys,
+                              const std::string& target) {
+    ASSERT_LE(keys.front(), target);
+    uint32_t left = 0;
+    uint32_t right = 0;
+    ASSERT_TRUE(index.Predict(target, &left, &right));
+    ASSERT_LE(left, right);
+    ASSERT_LT(right, keys.size());
+    // Index of the last key less than or equal to target
+    size_t expected =
+        std::upper_bound(keys.begin(), keys.end(), target) - keys.begin() - 1;
+    ASSERT_LE(left, expected);
+    ASSERT_GE(right, expected);
+  }
+
+  static void CheckPredictions(const std::vector<std::string>& keys) {
+    std::unique_ptr<InterpolationIndex> index = Build(keys);
+    ASSERT_EQ(keys.size(), index->num_restarts());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      CheckPrediction(*index, keys, keys[i]);
+      // Between this key and the next one
+      CheckPrediction(*index, keys, keys[i] + '\0');
+      CheckPrediction(*index, keys, keys[i] + "\xff\xff");
+    }
+  }
+};
+
+TEST_F(InterpolationIndexTest, UniformKeys) {
+  std::vector<std::string> keys;
+  for (uint64_t i = 0; i < 10000; ++i) {
+    keys.push_back(BigEndianKey("prefix", i * 1000));
+  }
+  CheckPredictions(keys);
+
+  // The model is exact, so the ranges are small
+  std::unique_ptr<InterpolationIndex> index = Build(keys);
+  uint32_t left = 0;
+  uint32_t right = 0;
+  ASSERT_TRUE(index->Predict(BigEndianKey("prefix", 5000500), &left, &right));
+  ASSERT_LE(left, 5000u);
+  ASSERT_GE(right, 5000u);
+  ASSERT_LE(right - left, 2 * InterpolationIndex::Builder::kMaxError + 2);
+}
+
+TEST_F(InterpolationIndexTest, SkewedKeys) {
+  std::vector<std::string> keys;
+  for (uint64_t i = 0; i < 3000; ++i) {
+    keys.push_back(BigEndianKey("", i * i * i * i));
+  }
+  // A dense cluster
+  for (uint64_t i = 0; i < 1000; ++i) {
+    keys.push_back(BigEndianKey("", (uint64_t{1} << 40) + i));
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  CheckPredictions(keys);
+}
+
+TEST_F(InterpolationIndexTest, DecimalKeys) {
+  std::vector<std::string> keys;
+  for (int i = 0; i < 20000; i += 7) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "user%012d", i);
+    keys.push_back(buf);
+  }
+  CheckPredictions(keys);
+}
+
+TEST_F(InterpolationIndexTest, RandomKeys) {
+  Random rnd(301);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 5000; ++i) {
+    keys.push_back(rnd.RandomString(static_cast<int>(rnd.Uniform(20)) + 1));
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  CheckPredictions(keys);
+}
+
+TEST_F(InterpolationIndexTest, KeysOnlyDifferingAfterModeledBytes) {
+  // All the keys map to the same integer
+  std::vector<std::string> keys;
+  for (uint64_t i = 0; i < 100; ++i) {
+    keys.push_back(BigEndianKey("prefix" + std::string(8, 'x'), i));
+  }
+  CheckPredictions(keys);
+}
+
+TEST_F(InterpolationIndexTest, SingleKey) {
+  CheckPredictions({"key"});
+}
+
+TEST_F(InterpolationIndexTest, KeyWithoutPrefix) {
+  std::vector<std::string> keys;
+  for (uint64_t i = 0; i < 100; ++i) {
+    keys.push_back(BigEndianKey("prefix", i));
+  }
+  std::unique_ptr<InterpolationIndex> index = Build(keys);
+  uint32_t left = 0;
+  uint32_t right = 0;
+  ASSERT_FALSE(index->Predict("other", &left, &right));
+  ASSERT_FALSE(index->Predict("pre", &left, &right));
+}
+
+TEST_F(InterpolationIndexTest, Corruption) {
+  std::vector<std::string> keys;
+  for (uint64_t i = 0; i < 100; ++i) {
+    keys.push_back(BigEndianKey("prefix", i * i));
+  }
+  InterpolationIndex::Builder builder;
+  for (const std::string& key : keys) {
+    builder.AddRestartKey(key);
+  }
+  std::string contents;
+  builder.Finish(&contents);
+
+  std::unique_ptr<InterpolationIndex> index;
+  for (size_t len = 0; len < contents.size(); ++len) {
+    ASSERT_TRUE(InterpolationIndex::Create(Slice(contents.data(), len), &index)
+                    .IsCorruption());
+  }
+  ASSERT_EQ(nullptr, index);
+  ASSERT_OK(InterpolationIndex::Create(contents, &index));
+  ASSERT_NE(nullptr, index);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,98 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// How the iterators of a table file have read it, kept by the table reader
+// with BlockBasedTableOptions::learn_auto_readahead, so that a new iterator
+// starts with the readahead that earlier ones ended up with.
+//
+// The file is split into kNumRegions regions of equal size. Each run of
+// sequential block reads of an iterator is recorded in the region it started
+// in:
+// - A run that reached auto readahead moves the learned readahead size of
+//   the region halfway to the readahead size that the run reached.
+// - A short run, which ended before auto readahead started, halves the
+//   learned readahead size. After kNumShortRunsForRandom short runs in a row,
+//   the region is considered randomly accessed.
+//
+// Thread-safe. Concurrent updates may overwrite each other, which only makes
+// the history less accurate.
+class ReadaheadHistory {
+ public:
+  static constexpr size_t kNumRegions = 16;
+  static constexpr uint32_t kNumShortRunsForRandom = 4;
+
+  explicit ReadaheadHistory(uint64_t file_size) : file_size_(file_size) {}
+
+  // No copying allowed
+  ReadaheadHistory(const ReadaheadHistory&) = delete;
+  ReadaheadHistory& operator=(const ReadaheadHistory&) = delete;
+
+  // The readahead size learned for runs that start at `offset`, or 0
+  size_t GetLearnedReadaheadSize(uint64_t offset) const {
+    return regions_[RegionOf(offset)].readahead_size.load(
+        std::memory_order_relaxed);
+  }
+
+  // Whether the runs that start at `offset` are mostly short
+  bool IsRandom(uint64_t offset) const {
+    return regions_[RegionOf(offset)].num_short_runs.load(
+               std::memory_order_relaxed) >= kNumShortRunsForRandom;
+  }
+
+  // Records a run that started at `offset` and reached a readahead size of
+  // `readahead_size`, or 0 if it is short. Learned sizes below
+  // `min_readahead_size` are forgotten.
+  void RecordRun(uint64_t offset, size_t readahead_size,
+                 size_t min_readahead_size) {
+    Region& region = regions_[RegionOf(offset)];
+    size_t learned = region.readahead_size.load(std::memory_order_relaxed);
+    if (readahead_size > 0) {
+      learned = learned == 0 ? readahead_size
+                             : learned / 2 + readahead_size / 2;
+      region.num_short_runs.store(0, std::memory_order_relaxed);
+    } else {
+      learned /= 2;
+      uint32_t num_short_runs =
+          region.num_short_runs.load(std::memory_order_relaxed);
+      if (num_short_runs < kNumShortRunsForRandom) {
+        region.num_short_runs.store(num_short_runs + 1,
+                                    std::memory_order_relaxed);
+      }
+    }
+    region.readahead_size.store(learned < min_readahead_size ? 0 : learned,
+                                std::memory_order_relaxed);
+  }
+
+ private:
+  struct Region {
+    std::atomic<size_t> readahead_size{0};
+    std::atomic<uint32_t> num_short_runs{0};
+  };
+
+  size_t RegionOf(uint64_t offset) const {
+    if (file_size_ == 0) {
+      return 0;
+    }
+    return static_cast<size_t>(std::min<uint64_t>(
+        kNumRegions - 1, offset / ((file_size_ + kNumRegions - 1) /
+                                   kNumRegions)));
+  }
+
+  const uint64_t file_size_;
+  Region regions_[kNumRegions];
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,193 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/value_columns.h"
+
+#include <cassert>
+
+#include "db/dbformat.h"
+#include "port/port.h"
+#include "rocksdb/table.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+void ValueColumnsBuilder::AddValue(const Slice& key, const Slice& value,
+                                   std::string* entry_value) {
+  assert(Valid());
+  entry_value->clear();
+  split_buffer_.clear();
+  // Only plain values are split: the others (e.g. merge operands and blob
+  // indexes) are not records of the schema.
+  if (ExtractValueType(key) != kTypeValue || num_rows_ == port::kMaxUint32 ||
+      !splitter_->Split(value, &split_buffer_).ok() || !IsSplit(value)) {
+    PutVarint32(entry_value, 0);
+    entry_value->append(value.data(), value.size());
+    return;
+  }
+
+  if (split_buffer_.size() > columns_.size()) {
+    size_t old_num_columns = columns_.size();
+    columns_.resize(split_buffer_.size());
+    // The rows before this one do not have the new columns
+    column_ends_.resize(split_buffer_.size(),
+                        std::vector<uint32_t>(num_rows_, 0));
+    estimate_ += (split_buffer_.size() - old_num_columns) * num_rows_ *
+                 sizeof(uint32_t);
+  }
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    if (i < split_buffer_.size()) {
+      columns_[i].append(split_buffer_[i].data(), split_buffer_[i].size());
+      estimate_ += split_buffer_[i].size();
+    }
+    column_ends_[i].push_back(static_cast<uint32_t>(columns_[i].size()));
+  }
+  estimate_ += columns_.size() * sizeof(uint32_t);
+  ++num_rows_;
+  PutVarint32(entry_value, num_rows_);
+}
+
+bool ValueColumnsBuilder::IsSplit(const Slice& value) const {
+  // The columns must be consecutive slices of the value, so that the value is
+  // their concatenation
+  const char* next = value.data();
+  for (const Slice& column : split_buffer_) {
+    if (column.data() != next && !column.empty()) {
+      return false;
+    }
+    next += column.size();
+  }
+  return next == value.data() + value.size();
+}
+
+void ValueColumnsBuilder::Finish(std::string& buffer) {
+  assert(Valid());
+  size_t columns_offset = buffer.size();
+  for (const auto& column : columns_) {
+    buffer.append(column);
+  }
+  for (const auto& ends : column_ends_) {
+    for (uint32_t end : ends) {
+      PutFixed32(&buffer, end);
+    }
+  }
+  PutFixed32(&buffer, num_rows_);
+  PutFixed32(&buffer, static_cast<uint32_t>(columns_.size()));
+  PutFixed32(&buffer, static_cast<uint32_t>(buffer.size() - columns_offset));
+  assert(buffer.size() - columns_offset == EstimateSize());
+}
+
+void ValueColumnsBuilder::Reset() {
+  columns_.clear();
+  column_ends_.clear();
+  num_rows_ = 0;
+  // NUM_ROWS, NUM_COLUMNS and COLUMNS_SIZE
+  estimate_ = 3 * sizeof(uint32_t);
+}
+
+bool ValueColumns::Initialize(const char* data, size_t size,
+                              size_t* columns_offset) {
+  columns_ = nullptr;
+  if (size < 3 * sizeof(uint32_t)) {
+    return false;
+  }
+  uint32_t columns_size = DecodeFixed32(data + size - sizeof(uint32_t));
+  if (columns_size < 2 * sizeof(uint32_t) ||
+      columns_size > size - sizeof(uint32_t)) {
+    return false;
+  }
+  const char* end = data + size - sizeof(uint32_t);
+  const char* columns = end - columns_size;
+  uint32_t num_rows = DecodeFixed32(end - 2 * sizeof(uint32_t));
+  uint32_t num_columns = DecodeFixed32(end - sizeof(uint32_t));
+  uint64_t ends_size =
+      uint64_t{num_rows} * num_columns * sizeof(uint32_t) + 2 * sizeof(uint32_t);
+  if (ends_size > columns_size) {
+    return false;
+  }
+  const char* ends = end - ends_size;
+
+  column_offsets_.assign(1, 0);
+  for (uint32_t i = 0; i < num_columns; ++i) {
+    uint32_t column_size =
+        num_rows == 0 ? 0
+                      : DecodeFixed32(ends + (uint64_t{i} * num_rows +
+                                              num_rows - 1) *
+                                                 sizeof(uint32_t));
+    column_offsets_.push_back(column_offsets_.back() + column_size);
+    if (column_offsets_.back() < column_size) {
+      return false;  // Overflow
+    }
+  }
+  if (column_offsets_.back() + ends_size != columns_size) {
+    return false;
+  }
+
+  columns_ = columns;
+  ends_ = ends;
+  num_rows_ = num_rows;
+  num_columns_ = num_columns;
+  *columns_offset = static_cast<size_t>(columns - data);
+  return true;
+}
+
+bool ValueColumns::CheckEntryValue(const Slice& entry_value) const {
+  assert(Valid());
+  uint32_t tag = 0;
+  Slice input = entry_value;
+  return GetVarint32(&input, &tag) && (tag == 0 || input.empty()) &&
+         tag <= num_rows_;
+}
+
+bool ValueColumns::DecodeEntryValue(const Slice& entry_value, uint32_t* row,
+                                    Slice* value) const {
+  assert(CheckEntryValue(entry_value));
+  Slice input = entry_value;
+  uint32_t tag = 0;
+  GetVarint32(&input, &tag);
+  if (tag == 0) {
+    *value = input;
+    return false;
+  }
+  *row = tag - 1;
+  return true;
+}
+
+Slice ValueColumns::GetColumn(uint32_t row, uint32_t column) const {
+  assert(Valid());
+  assert(row < num_rows_);
+  if (column >= num_columns_) {
+    return Slice();
+  }
+  const char* column_ends = ends_ + uint64_t{column} * num_rows_ *
+                                        sizeof(uint32_t);
+  uint32_t start =
+      row == 0 ? 0 : DecodeFixed32(column_ends + (row - 1) * sizeof(uint32_t));
+  uint32_t end = DecodeFixed32(column_ends + row * sizeof(uint32_t));
+  uint32_t column_size = column_offsets_[column + 1] - column_offsets_[column];
+  if (start > end || end > column_size) {
+    // Corrupted
+    return Slice();
+  }
+  return Slice(columns_ + column_offsets_[column] + start, end - start);
+}
+
+void ValueColumns::AppendRow(uint32_t row, std::string* value) const {
+  for (uint32_t i = 0; i < num_columns_; ++i) {
+    Slice column = GetColumn(row, i);
+    value->append(column.data(), column.size());
+  }
+}
+
+void ValueColumns::AppendColumns(uint32_t row,
+                                 const std::vector<uint32_t>& columns,
+                                 std::string* value) const {
+  for (uint32_t column : columns) {
+    Slice data = GetColumn(row, column);
+    value->append(data.data(), data.size());
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
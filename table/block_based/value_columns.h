@@ -0,0 +1,124 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class ValueColumnSplitter;
+
+// Value columns are an experimental data block layout, used with
+// BlockBasedTableOptions::value_column_splitter, in which the values that the
+// splitter can split are stored column by column (PAX) at the end of the block,
+// so that scans that only read some of the columns (ReadOptions::value_columns)
+// do not touch the others. The block data format is as follows:
+//
+// DATA_BLOCK: [ENTRIES RESTARTS ... COLUMNS COLUMNS_SIZE FOOTER]
+//
+// ENTRIES:      The entries of the block, whose values are replaced by a
+//               varint32 tag. A tag of 0 is followed by the whole value, which
+//               the splitter could not split (or which is not a kTypeValue).
+//               A tag of i > 0 means that the value is row i-1 of COLUMNS.
+// RESTARTS ...: The restart array, and the restart key prefixes and hash
+//               index if any.
+// COLUMNS_SIZE: Size of COLUMNS, as a fixed32.
+// FOOTER:       The block footer, with the value columns flag set (see
+//               data_block_footer.h).
+//
+// The format of the columns is as follows:
+//
+// COLUMNS: [C_0 C_1 ... C_N-1 ENDS_0 ENDS_1 ... ENDS_N-1 NUM_ROWS NUM_COLUMNS]
+//
+// C_i:         The column i of the rows, concatenated.
+// ENDS_i:      For each row, the offset in C_i of the end of its column i, as
+//              fixed32s. Columns past the end of a row are empty.
+// NUM_ROWS:    Number of rows, as a fixed32.
+// NUM_COLUMNS: Number of columns, as a fixed32.
+class ValueColumnsBuilder {
+ public:
+  ValueColumnsBuilder() : splitter_(nullptr), num_rows_(0), estimate_(0) {}
+
+  void Initialize(const ValueColumnSplitter* splitter) {
+    splitter_ = splitter;
+    Reset();
+  }
+
+  inline bool Valid() const { return splitter_ != nullptr; }
+
+  // Stores the value of the entry with internal key `key`, and sets
+  // *entry_value to what is stored in the entry itself.
+  void AddValue(const Slice& key, const Slice& value, std::string* entry_value);
+
+  // Appends the columns and their size to buffer.
+  void Finish(std::string& buffer);
+
+  void Reset();
+
+  inline size_t EstimateSize() const { return estimate_; }
+
+ private:
+  // Whether split_buffer_ is a split of value
+  bool IsSplit(const Slice& value) const;
+
+  const ValueColumnSplitter* splitter_;
+  // Buffers for the columns, and for the ends of their rows
+  std::vector<std::string> columns_;
+  std::vector<std::vector<uint32_t>> column_ends_;
+  uint32_t num_rows_;
+  size_t estimate_;
+  std::vector<Slice> split_buffer_;
+};
+
+// Reads the columns of a data block with value columns.
+class ValueColumns {
+ public:
+  ValueColumns()
+      : columns_(nullptr), ends_(nullptr), num_rows_(0), num_columns_(0) {}
+
+  // Decodes the columns of a block that ends at data + size (which does not
+  // include the block footer), and sets *columns_offset to their offset.
+  // Returns false if the columns are corrupted.
+  bool Initialize(const char* data, size_t size, size_t* columns_offset);
+
+  inline bool Valid() const { return columns_ != nullptr; }
+
+  // Returns true if `entry_value`, as stored in an entry of the block, can be
+  // decoded.
+  bool CheckEntryValue(const Slice& entry_value) const;
+
+  // If `entry_value`, as stored in an entry of the block, is a row, returns
+  // true and sets *row. Otherwise sets *value to the whole value stored in
+  // the entry and returns false.
+  // REQUIRES: CheckEntryValue(entry_value)
+  bool DecodeEntryValue(const Slice& entry_value, uint32_t* row,
+                        Slice* value) const;
+
+  // Column `column` of row `row`. Empty if there is no such column.
+  Slice GetColumn(uint32_t row, uint32_t column) const;
+
+  // Appends the value of row `row` to *value.
+  void AppendRow(uint32_t row, std::string* value) const;
+
+  // Appends the given columns of row `row` to *value.
+  void AppendColumns(uint32_t row, const std::vector<uint32_t>& columns,
+                     std::string* value) const;
+
+ private:
+  const char* columns_;
+  const char* ends_;
+  uint32_t num_rows_;
+  uint32_t num_columns_;
+  // Offset of each column, and of the end of the last one
+  std::vector<uint32_t> column_offsets_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
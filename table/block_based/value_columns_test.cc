@@ -0,0 +1,266 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/value_columns.h"
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "rocksdb/table.h"
+#include "table/block_based/block.h"
+#include "table/block_based/block_builder.h"
+#include "table/format.h"
+#include "test_util/testharness.h"
+#include "util/coding.h"
+#include "util/random.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Splits values after each ','. Values that start with '!' cannot be split.
+class CommaSplitter : public ValueColumnSplitter {
+ public:
+  const char* Name() const override { return "CommaSplitter"; }
+
+  Status Split(const Slice& value,
+               std::vector<Slice>* columns) const override {
+    if (value.starts_with("!")) {
+      return Status::NotSupported();
+    }
+    size_t start = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+      if (value[i] == ',') {
+        columns->emplace_back(value.data() + start, i + 1 - start);
+        start = i + 1;
+      }
+    }
+    if (start < value.size()) {
+      columns->emplace_back(value.data() + start, value.size() - start);
+    }
+    return Status::OK();
+  }
+};
+
+std::string MakeKey(int i, ValueType type = kTypeValue) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "key%06d", i);
+  std::string key = buf;
+  AppendInternalKeyFooter(&key, 0 /* seqno */, type);
+  return key;
+}
+
+// A value with 1 to 4 columns, some of them empty
+std::string MakeValue(int i) {
+  std::string value;
+  int num_columns = 1 + i % 4;
+  for (int c = 0; c < num_columns; ++c) {
+    if ((i + c) % 5 != 0) {
+      value += "c" + ToString(c) + "_" + ToString(i);
+    }
+    if (c + 1 < num_columns) {
+      value += ",";
+    }
+  }
+  return value;
+}
+
+// Columns `columns` of `value`, as split by CommaSplitter
+std::string Project(const std::string& value,
+                    const std::vector<uint32_t>& columns) {
+  std::vector<Slice> split;
+  EXPECT_OK(CommaSplitter().Split(value, &split));
+  std::string projected;
+  for (uint32_t column : columns) {
+    if (column < split.size()) {
+      projected += split[column].ToString();
+    }
+  }
+  return projected;
+}
+}  // namespace
+
+class ValueColumnsTest : public testing::Test {};
+
+TEST_F(ValueColumnsTest, BuildAndRead) {
+  CommaSplitter splitter;
+  ValueColumnsBuilder builder;
+  builder.Initialize(&splitter);
+  ASSERT_TRUE(builder.Valid());
+
+  const int kNumValues = 100;
+  std::vector<std::string> entry_values;
+  std::vector<std::string> values;
+  for (int i = 0; i < kNumValues; ++i) {
+    values.push_back(i % 10 == 9 ? "!inline" + ToString(i) : MakeValue(i));
+    std::string entry_value;
+    builder.AddValue(MakeKey(i, i % 7 == 6 ? kTypeMerge : kTypeValue),
+                     values.back(), &entry_value);
+    entry_values.push_back(entry_value);
+  }
+  std::string buffer = "entries";
+  builder.Finish(buffer);
+
+  ValueColumns columns;
+  size_t columns_offset = 0;
+  ASSERT_TRUE(columns.Initialize(buffer.data(), buffer.size(),
+                                 &columns_offset));
+  ASSERT_TRUE(columns.Valid());
+  ASSERT_EQ(columns_offset, strlen("entries"));
+
+  for (int i = 0; i < kNumValues; ++i) {
+    ASSERT_TRUE(columns.CheckEntryValue(entry_values[i]));
+    uint32_t row = 0;
+    Slice value;
+    if (i % 10 == 9 || i % 7 == 6) {
+      // Not split: stored whole in the entry
+      ASSERT_FALSE(columns.DecodeEntryValue(entry_values[i], &row, &value));
+      ASSERT_EQ(value.ToString(), values[i]);
+      continue;
+    }
+    ASSERT_TRUE(columns.DecodeEntryValue(entry_values[i], &row, &value));
+    std::string row_value;
+    columns.AppendRow(row, &row_value);
+    ASSERT_EQ(row_value, values[i]);
+    for (uint32_t c = 0; c < 5; ++c) {
+      ASSERT_EQ(columns.GetColumn(row, c).ToString(), Project(values[i], {c}));
+    }
+    std::string projected;
+    columns.AppendColumns(row, {3, 0}, &projected);
+    ASSERT_EQ(projected, Project(values[i], {3, 0}));
+  }
+
+  // Bad tags
+  std::string bad_entry_value;
+  PutVarint32(&bad_entry_value, kNumValues + 1);
+  ASSERT_FALSE(columns.CheckEntryValue(bad_entry_value));
+  bad_entry_value.clear();
+  PutVarint32(&bad_entry_value, 1);
+  bad_entry_value += "trailing";
+  ASSERT_FALSE(columns.CheckEntryValue(bad_entry_value));
+}
+
+TEST_F(ValueColumnsTest, Corruption) {
+  CommaSplitter splitter;
+  ValueColumnsBuilder builder;
+  builder.Initialize(&splitter);
+  std::string entry_value;
+  for (int i = 0; i < 10; ++i) {
+    builder.AddValue(MakeKey(i), MakeValue(i), &entry_value);
+  }
+  std::string buffer;
+  builder.Finish(buffer);
+
+  ValueColumns columns;
+  size_t columns_offset = 0;
+  ASSERT_TRUE(columns.Initialize(buffer.data(), buffer.size(),
+                                 &columns_offset));
+  // Truncated
+  for (size_t size = 0; size < buffer.size(); ++size) {
+    std::string truncated = buffer.substr(buffer.size() - size);
+    ASSERT_FALSE(columns.Initialize(truncated.data(), truncated.size(),
+                                    &columns_offset));
+    ASSERT_FALSE(columns.Valid());
+  }
+  // Bad number of rows
+  std::string bad = buffer;
+  EncodeFixed32(&bad[bad.size() - 3 * sizeof(uint32_t)], 1000);
+  ASSERT_FALSE(columns.Initialize(bad.data(), bad.size(), &columns_offset));
+  // Bad size
+  bad = buffer;
+  EncodeFixed32(&bad[bad.size() - sizeof(uint32_t)], 1);
+  ASSERT_FALSE(columns.Initialize(bad.data(), bad.size(), &columns_offset));
+}
+
+class ValueColumnsBlockTest
+    : public testing::Test,
+      public testing::WithParamInterface<std::tuple<int, bool, bool>> {
+ public:
+  int restartInterval() const { return std::get<0>(GetParam()); }
+  BlockBasedTableOptions::DataBlockIndexType indexType() const {
+    return std::get<1>(GetParam())
+               ? BlockBasedTableOptions::kDataBlockBinaryAndHash
+               : BlockBasedTableOptions::kDataBlockBinarySearch;
+  }
+  bool useRestartKeyPrefixes() const { return std::get<2>(GetParam()); }
+};
+
+TEST_P(ValueColumnsBlockTest, Iterate) {
+  CommaSplitter splitter;
+  BlockBuilder builder(restartInterval(), true /* use_delta_encoding */,
+                       false /* use_value_delta_encoding */, indexType(),
+                       0.75 /* data_block_hash_table_util_ratio */,
+                       useRestartKeyPrefixes(), &splitter);
+  // Few enough keys for the hash index to support a restart per key
+  const int kNumKeys = 200;
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  for (int i = 0; i < kNumKeys; ++i) {
+    keys.push_back(MakeKey(i, i % 7 == 6 ? kTypeMerge : kTypeValue));
+    values.push_back(i % 10 == 9 ? "!inline" + ToString(i) : MakeValue(i));
+    builder.Add(keys.back(), values.back());
+  }
+  BlockContents contents;
+  contents.data = builder.Finish();
+  Block reader(std::move(contents));
+  ASSERT_EQ(reader.IndexType(), indexType());
+
+  std::unique_ptr<DataBlockIter> iter(reader.NewDataIterator(
+      BytewiseComparator(), kDisableGlobalSequenceNumber));
+  auto check_entry = [&](int i) {
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(iter->key().ToString(), keys[i]);
+    ASSERT_EQ(iter->value().ToString(), values[i]);
+    bool split = i % 10 != 9 && i % 7 != 6;
+    ASSERT_EQ(iter->IsValueAssembled(), split);
+    if (split) {
+      // Not pinned even if the block is
+      ASSERT_FALSE(iter->IsValuePinned());
+    }
+    std::string projected;
+    ASSERT_EQ(iter->ProjectValue({1, 2}, &projected), split);
+    if (split) {
+      ASSERT_EQ(projected, Project(values[i], {1, 2}));
+    }
+  };
+
+  int i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++i) {
+    check_entry(i);
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(i, kNumKeys);
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+    check_entry(--i);
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(i, 0);
+
+  Random rnd(301);
+  for (int n = 0; n < 100; ++n) {
+    i = static_cast<int>(rnd.Uniform(kNumKeys));
+    iter->Seek(keys[i]);
+    check_entry(i);
+    iter->SeekForPrev(keys[i]);
+    check_entry(i);
+    ASSERT_TRUE(iter->SeekForGet(keys[i]));
+    check_entry(i);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(P, ValueColumnsBlockTest,
+                        ::testing::Combine(::testing::Values(1, 16),
+                                           ::testing::Bool(),
+                                           ::testing::Bool()));
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -170,6 +170,16 @@ class InternalIteratorBase : public Cleanable {
   // REQUIRES: Same as for value().
   virtual bool IsValuePinned() const { return false; }
 
+  // If the iterator can read the given columns of the current value (see
+  // ReadOptions::value_columns) without reading the whole value, appends
+  // them to *projected and returns true. Otherwise returns false, and the
+  // caller has to split value() itself.
+  // REQUIRES: Same as for value().
+  virtual bool ProjectValue(const std::vector<uint32_t>& /*columns*/,
+                            std::string* /*projected*/) const {
+    return false;
+  }
+
   virtual Status GetProperty(std::string /*prop_name*/, std::string* /*prop*/) {
     return Status::NotSupported("");
   }
@@ -144,6 +144,11 @@ class IteratorWrapperBase {
     assert(Valid());
     return iter_->IsValuePinned();
   }
+  bool ProjectValue(const std::vector<uint32_t>& columns,
+                    std::string* projected) const {
+    assert(Valid());
+    return iter_->ProjectValue(columns, projected);
+  }
 
   bool IsValuePrepared() const {
     return result_.value_prepared;
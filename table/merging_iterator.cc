@@ -279,6 +279,12 @@ class MergingIterator : public InternalIterator {
            current_->IsValuePinned();
   }
 
+  bool ProjectValue(const std::vector<uint32_t>& columns,
+                    std::string* projected) const override {
+    assert(Valid());
+    return current_->ProjectValue(columns, projected);
+  }
+
  private:
   // Clears heaps for both directions, used when changing direction or seeking
   void ClearHeaps();
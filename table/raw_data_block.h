@@ -0,0 +1,73 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "rocksdb/cleanable.h"
+#include "rocksdb/compression_type.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "table/internal_iterator.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A data block of a table as it is stored in the file, i.e. possibly
+// compressed, along with the entries it holds. A table builder of the same
+// format can append it to its output without decoding, re-encoding and
+// recompressing it. See TableBuilder::AddRawDataBlock().
+//
+// A block released from its RawDataBlockIterator frees its contents and
+// entries through its cleanups.
+struct RawDataBlock : public Cleanable {
+  // The block contents as stored, without the block trailer
+  Slice contents;
+  CompressionType compression_type = kNoCompression;
+  // The format_version of the table the block was read from
+  uint32_t format_version = 0;
+  // The internal keys and values of the block, with no global sequence
+  // number applied. Owned by the RawDataBlockIterator that read the block,
+  // or by the block once released from it.
+  InternalIterator* entries = nullptr;
+};
+
+// Iterates over the data blocks of a table, reading each of them as stored in
+// the file. Used by compactions to pass whole data blocks of their input
+// files through to their outputs.
+class RawDataBlockIterator : public Cleanable {
+ public:
+  virtual ~RawDataBlockIterator() {}
+
+  // An iterator is either positioned at a data block that was read
+  // successfully, or not valid.
+  virtual bool Valid() const = 0;
+
+  // Positions at the first data block of the table.
+  virtual void SeekToFirst() = 0;
+
+  // Positions at the first data block that may hold keys at or after the
+  // internal key `target`.
+  virtual void Seek(const Slice& target) = 0;
+
+  // REQUIRES: Valid()
+  virtual void Next() = 0;
+
+  // The current data block, valid until the iterator is moved.
+  // REQUIRES: Valid()
+  virtual const RawDataBlock& block() const = 0;
+
+  // Moves the current data block out of the iterator, for the caller to keep
+  // it after moving the iterator. block() must not be called again before the
+  // iterator is moved.
+  // REQUIRES: Valid()
+  virtual std::unique_ptr<RawDataBlock> ReleaseBlock() = 0;
+
+  // Returns the error reading the index or a data block, if any.
+  virtual Status status() const = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
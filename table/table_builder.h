@@ -21,10 +21,12 @@
 #include "options/cf_options.h"
 #include "rocksdb/options.h"
 #include "rocksdb/table_properties.h"
+#include "table/raw_data_block.h"
 #include "trace_replay/block_cache_tracer.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+class FilePrefetchBuffer;
 class Slice;
 class Status;
 
@@ -98,6 +100,10 @@ struct TableReaderOptions {
   std::string cur_db_session_id;
 
   uint64_t cur_file_num;
+
+  // If not null, holds the tail of the file, whose read was submitted before
+  // the file was passed to NewTableReader(). Only used by BlockBasedTable.
+  FilePrefetchBuffer* tail_prefetch_buffer = nullptr;
 };
 
 struct TableBuilderOptions {
@@ -177,6 +183,16 @@ class TableBuilder {
   // REQUIRES: Finish(), Abandon() have not been called
   virtual void Add(const Slice& key, const Slice& value) = 0;
 
+  // Add a whole data block read from another table, with its contents copied
+  // as stored. Returns false, without adding anything, if the block cannot be
+  // copied into this table, e.g. because the formats or compression types
+  // differ; its entries can then be added one by one.
+  // REQUIRES: the keys of the block are after any previously added key
+  // REQUIRES: Finish(), Abandon() have not been called
+  virtual bool AddRawDataBlock(const RawDataBlock& /*block*/) {
+    return false;
+  }
+
   // Return non-ok iff some error has been detected.
   virtual Status status() const = 0;
 
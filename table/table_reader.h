@@ -14,6 +14,7 @@
 #include "table/get_context.h"
 #include "table/internal_iterator.h"
 #include "table/multiget_context.h"
+#include "table/raw_data_block.h"
 #include "table/table_reader_caller.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -82,6 +83,31 @@ class TableReader {
   virtual uint64_t ApproximateSize(const Slice& start, const Slice& end,
                                    TableReaderCaller caller) = 0;
 
+  struct Anchor {
+    Anchor(const Slice& _user_key, size_t _range_size)
+        : user_key(_user_key.ToString()), range_size(_range_size) {}
+    std::string user_key;
+    size_t range_size;
+  };
+
+  // Samples user keys of the table that split it into ranges of about the
+  // same size, in ascending order. The range size of each anchor is the
+  // approximate data size between the previous anchor (or the start of the
+  // table) and it. The last anchor is at or after the largest key of the
+  // table, so the range sizes add up to about the data size of the table.
+  virtual Status ApproximateKeyAnchors(const ReadOptions& /*read_options*/,
+                                       std::vector<Anchor>& /*anchors*/) {
+    return Status::NotSupported("ApproximateKeyAnchors() not supported.");
+  }
+
+  // Returns an iterator over the data blocks of the table as stored, or
+  // nullptr if the table format does not support copying them into another
+  // table. The caller should delete the result.
+  virtual RawDataBlockIterator* NewRawDataBlockIterator(
+      const ReadOptions& /*read_options*/) {
+    return nullptr;
+  }
+
   // Set up the table for Compaction. Might change some parameters with
   // posix_fadvise
   virtual void SetupForCompaction() = 0;
@@ -120,6 +146,36 @@ class TableReader {
     }
   }
 
+  // State of a lookup between StartMultiGet() and FinishMultiGet()
+  struct MultiGetState {
+    virtual ~MultiGetState() {}
+  };
+
+  // Split-phase variant of MultiGet(), which lets the caller overlap the I/O
+  // of lookups in several tables. StartMultiGet() does the part of the lookup
+  // that does not need the data blocks and submits the reads of the data
+  // blocks without waiting for them (see FSRandomAccessFile::ReadAsync()).
+  // FinishMultiGet() waits for the reads and completes the lookup; the keys
+  // are only resolved by then. FinishMultiGet() must be called exactly once
+  // with the returned state, while readOptions and the keys of mget_range
+  // are still alive.
+  //
+  // The default implementation does all of the work in FinishMultiGet().
+  // Table readers overriding StartMultiGet() must override FinishMultiGet().
+  virtual std::unique_ptr<MultiGetState> StartMultiGet(
+      const ReadOptions& readOptions, const MultiGetContext::Range* mget_range,
+      const SliceTransform* prefix_extractor, bool skip_filters = false) {
+    return std::unique_ptr<MultiGetState>(new DeferredMultiGetState(
+        readOptions, *mget_range, prefix_extractor, skip_filters));
+  }
+
+  virtual void FinishMultiGet(MultiGetState* state) {
+    DeferredMultiGetState* deferred =
+        static_cast<DeferredMultiGetState*>(state);
+    MultiGet(deferred->read_options, &deferred->range,
+             deferred->prefix_extractor, deferred->skip_filters);
+  }
+
   // Prefetch data corresponding to a give range of keys
   // Typically this functionality is required for table implementations that
   // persists the data on a non volatile storage medium like disk/SSD
@@ -142,6 +198,24 @@ class TableReader {
                                 TableReaderCaller /*caller*/) {
     return Status::NotSupported("VerifyChecksum() not supported");
   }
+
+ private:
+  // A MultiGet() deferred to FinishMultiGet()
+  struct DeferredMultiGetState : public MultiGetState {
+    DeferredMultiGetState(const ReadOptions& _read_options,
+                          const MultiGetContext::Range& _range,
+                          const SliceTransform* _prefix_extractor,
+                          bool _skip_filters)
+        : read_options(_read_options),
+          range(_range, _range.begin(), _range.end()),
+          prefix_extractor(_prefix_extractor),
+          skip_filters(_skip_filters) {}
+
+    const ReadOptions& read_options;
+    MultiGetContext::Range range;
+    const SliceTransform* prefix_extractor;
+    bool skip_filters;
+  };
 };
 
 }  // namespace ROCKSDB_NAMESPACE
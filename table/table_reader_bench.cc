@@ -275,6 +275,11 @@ DEFINE_bool(mmap_read, true, "Whether use mmap read");
 DEFINE_string(table_factory, "block_based",
               "Table factory to use: `block_based` (default), `plain_table` or "
               "`cuckoo_hash`.");
+DEFINE_string(index_type, "binary_search",
+              "Index type of `block_based` tables: `binary_search` (default), "
+              "`two_level` or `interpolation`.");
+DEFINE_int32(index_block_restart_interval, 1,
+             "Restart interval of the index blocks of `block_based` tables.");
 DEFINE_string(time_unit, "microsecond",
               "The time unit used for measuring performance. User can specify "
               "`microsecond` (default) or `nanosecond`");
@@ -324,7 +329,23 @@ int main(int argc, char** argv) {
     exit(1);
 #endif  // ROCKSDB_LITE
   } else if (FLAGS_table_factory == "block_based") {
-    tf.reset(new ROCKSDB_NAMESPACE::BlockBasedTableFactory());
+    ROCKSDB_NAMESPACE::BlockBasedTableOptions table_options;
+    if (FLAGS_index_type == "binary_search") {
+      table_options.index_type =
+          ROCKSDB_NAMESPACE::BlockBasedTableOptions::kBinarySearch;
+    } else if (FLAGS_index_type == "two_level") {
+      table_options.index_type =
+          ROCKSDB_NAMESPACE::BlockBasedTableOptions::kTwoLevelIndexSearch;
+    } else if (FLAGS_index_type == "interpolation") {
+      table_options.index_type =
+          ROCKSDB_NAMESPACE::BlockBasedTableOptions::kInterpolationSearch;
+    } else {
+      fprintf(stderr, "Invalid index type %s\n", FLAGS_index_type.c_str());
+      exit(1);
+    }
+    table_options.index_block_restart_interval =
+        FLAGS_index_block_restart_interval;
+    tf.reset(new ROCKSDB_NAMESPACE::BlockBasedTableFactory(table_options));
   } else {
     fprintf(stderr, "Invalid table type %s\n", FLAGS_table_factory.c_str());
   }
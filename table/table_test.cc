@@ -52,6 +52,7 @@
 #include "table/block_based/block_based_table_reader.h"
 #include "table/block_based/block_builder.h"
 #include "table/block_based/flush_block_policy.h"
+#include "table/block_based/interpolation_index.h"
 #include "table/block_fetcher.h"
 #include "table/format.h"
 #include "table/get_context.h"
@@ -1690,8 +1691,11 @@ TEST_P(BlockBasedTableTest, BasicBlockBasedTableProperties) {
     block_builder.Add(item.first, item.second);
   }
   Slice content = block_builder.Finish();
+  // Since format_version 6, each restart key has an 8-byte prefix in the block
+  size_t restart_key_prefixes_size =
+      table_options.format_version >= 6 ? kvmap.size() * sizeof(uint64_t) : 0;
   ASSERT_EQ(content.size() + BlockBasedTable::kBlockTrailerSize +
-                diff_internal_user_bytes,
+                diff_internal_user_bytes + restart_key_prefixes_size,
             props.data_size);
   c.ResetTableReader();
 }
@@ -2559,6 +2563,123 @@ TEST_P(BlockBasedTableTest, HashIndexTest) {
   IndexTest(table_options);
 }
 
+TEST_P(BlockBasedTableTest, InterpolationIndexTest) {
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.index_type = BlockBasedTableOptions::kInterpolationSearch;
+  IndexTest(table_options);
+}
+
+TEST_P(BlockBasedTableTest, InterpolationIndexSeek) {
+  // Non-uniformly distributed keys: a cubic curve, and a dense cluster in the
+  // middle of it. All the values are even, so that the odd ones fall between
+  // the keys.
+  std::vector<uint64_t> values;
+  for (uint64_t i = 0; i < 1500; ++i) {
+    values.push_back(i * i * i * 2);
+  }
+  for (uint64_t i = 0; i < 500; ++i) {
+    values.push_back((uint64_t{1} << 30) + i * 2);
+  }
+  auto make_user_key = [](uint64_t value) {
+    // Big-endian, so that the bytewise order is the numeric order
+    std::string user_key = "key";
+    for (int shift = 56; shift >= 0; shift -= 8) {
+      user_key.push_back(static_cast<char>(value >> shift));
+    }
+    return user_key;
+  };
+
+  for (const Comparator* ucmp :
+       {BytewiseComparator(), ReverseBytewiseComparator()}) {
+    for (int restart_interval : {1, 8}) {
+      Options options;
+      BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+      table_options.index_type = BlockBasedTableOptions::kInterpolationSearch;
+      table_options.index_block_restart_interval = restart_interval;
+      // One key per data block, so that the index block is big
+      table_options.block_size = 64;
+      options.table_factory.reset(new BlockBasedTableFactory(table_options));
+
+      TableConstructor c(ucmp);
+      Random rnd(301);
+      std::vector<std::string> user_keys;
+      for (uint64_t value : values) {
+        user_keys.push_back(make_user_key(value));
+        c.Add(InternalKey(user_keys.back(), 0, kTypeValue).Encode().ToString(),
+              rnd.RandomString(100));
+      }
+      auto user_key_less = [ucmp](const std::string& a, const std::string& b) {
+        return ucmp->Compare(a, b) < 0;
+      };
+      std::sort(user_keys.begin(), user_keys.end(), user_key_less);
+
+      std::vector<std::string> keys;
+      stl_wrappers::KVMap kvmap;
+      const InternalKeyComparator icmp(ucmp);
+      const ImmutableOptions ioptions(options);
+      const MutableCFOptions moptions(options);
+      c.Finish(options, ioptions, moptions, table_options, icmp, &keys,
+               &kvmap);
+      auto reader = c.GetTableReader();
+
+      int num_index_seeks = 0;
+      int num_narrowed_seeks = 0;
+      SyncPoint::GetInstance()->SetCallBack(
+          "IndexBlockIter::InterpolationSeekBounds", [&](void* arg) {
+            int64_t* bounds = static_cast<int64_t*>(arg);
+            ++num_index_seeks;
+            if (bounds[1] - bounds[0] <=
+                2 * InterpolationIndex::Builder::kMaxError + 2) {
+              ++num_narrowed_seeks;
+            }
+          });
+      SyncPoint::GetInstance()->EnableProcessing();
+
+      std::unique_ptr<InternalIterator> iter(reader->NewIterator(
+          ReadOptions(), moptions.prefix_extractor.get(), /*arena=*/nullptr,
+          /*skip_filters=*/false, TableReaderCaller::kUncategorized));
+      for (uint64_t value : values) {
+        for (uint64_t target_value : {value, value + 1}) {
+          std::string target = make_user_key(target_value);
+          auto expected = std::lower_bound(user_keys.begin(), user_keys.end(),
+                                           target, user_key_less);
+          iter->Seek(InternalKey(target, kMaxSequenceNumber, kValueTypeForSeek)
+                         .Encode());
+          ASSERT_OK(iter->status());
+          if (expected == user_keys.end()) {
+            ASSERT_FALSE(iter->Valid());
+          } else {
+            ASSERT_TRUE(iter->Valid());
+            ASSERT_EQ(*expected, ExtractUserKey(iter->key()).ToString());
+          }
+        }
+      }
+      SyncPoint::GetInstance()->DisableProcessing();
+      SyncPoint::GetInstance()->ClearAllCallBacks();
+
+      if (ucmp == BytewiseComparator()) {
+        // Most index seeks only search a few restart points
+        ASSERT_GT(num_index_seeks, 0);
+        ASSERT_GT(num_narrowed_seeks, num_index_seeks * 9 / 10);
+      } else {
+        // No model without the bytewise comparator
+        ASSERT_EQ(num_index_seeks, 0);
+      }
+
+      size_t num_keys = 0;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        ASSERT_EQ(user_keys[num_keys], ExtractUserKey(iter->key()).ToString());
+        ++num_keys;
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(user_keys.size(), num_keys);
+
+      iter.reset();
+      c.ResetTableReader();
+    }
+  }
+}
+
 TEST_P(BlockBasedTableTest, PartitionIndexTest) {
   const int max_index_keys = 5;
   const int est_max_index_key_value_size = 32;
@@ -3049,6 +3170,168 @@ TEST_P(BlockBasedTableTest, TracingGetTest) {
   c.ResetTableReader();
 }
 
+TEST_P(BlockBasedTableTest, ApproximateKeyAnchors) {
+  Random rnd(301);
+  TableConstructor c(BytewiseComparator(), true /* convert_to_internal_key_ */);
+  for (int i = 0; i < 4000; i++) {
+    char key[16];
+    snprintf(key, sizeof(key), "k%04d", i);
+    c.Add(key, rnd.RandomString(200));
+  }
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  Options options;
+  options.compression = kNoCompression;
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  const ImmutableOptions ioptions(options);
+  const MutableCFOptions moptions(options);
+  c.Finish(options, ioptions, moptions, table_options,
+           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+
+  std::vector<TableReader::Anchor> anchors;
+  ASSERT_OK(c.GetTableReader()->ApproximateKeyAnchors(ReadOptions(), anchors));
+  // About 200 data blocks are sampled every other block
+  ASSERT_GT(anchors.size(), 64);
+  ASSERT_LE(anchors.size(), 128);
+  uint64_t total_size = 0;
+  for (size_t i = 0; i < anchors.size(); i++) {
+    if (i > 0) {
+      ASSERT_LT(anchors[i - 1].user_key, anchors[i].user_key);
+    }
+    ASSERT_GT(anchors[i].range_size, 0);
+    total_size += anchors[i].range_size;
+  }
+  ASSERT_GE(anchors.back().user_key, "k3999");
+  ASSERT_EQ(total_size, c.GetTableReader()->GetTableProperties()->data_size);
+  c.ResetTableReader();
+}
+
+TEST_P(BlockBasedTableTest, AddRawDataBlock) {
+  Random rnd(301);
+  TableConstructor c(BytewiseComparator(), true /* convert_to_internal_key_ */);
+  for (int i = 0; i < 1000; i++) {
+    char key[16];
+    snprintf(key, sizeof(key), "k%04d", i * 10);
+    // Compressible, so that the blocks are stored compressed if a compression
+    // library is available: blocks are only copied into tables of the same
+    // compression type.
+    c.Add(key, rnd.RandomString(20) + std::string(180, 'x'));
+  }
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  Options options;
+  options.compression = kNoCompression;
+  for (CompressionType type : GetSupportedCompressions()) {
+    if (type != kNoCompression) {
+      options.compression = type;
+      break;
+    }
+  }
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  const ImmutableOptions ioptions(options);
+  const MutableCFOptions moptions(options);
+  c.Finish(options, ioptions, moptions, table_options,
+           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+
+  test::StringSink* sink = new test::StringSink();
+  std::unique_ptr<FSWritableFile> holder(sink);
+  std::unique_ptr<WritableFileWriter> file_writer(new WritableFileWriter(
+      std::move(holder), "" /* don't care */, FileOptions()));
+  InternalKeyComparator ikc(options.comparator);
+  IntTblPropCollectorFactories int_tbl_prop_collector_factories;
+  std::string column_family_name;
+  std::unique_ptr<TableBuilder> builder(options.table_factory->NewTableBuilder(
+      TableBuilderOptions(ioptions, moptions, ikc,
+                          &int_tbl_prop_collector_factories,
+                          options.compression, CompressionOptions(),
+                          kUnknownColumnFamily, column_family_name, -1),
+      file_writer.get()));
+
+  // Copies every other data block, adds the entries of the others one by one,
+  // and adds keys between some blocks
+  std::vector<std::string> expected_keys;
+  std::unique_ptr<RawDataBlockIterator> raw_iter(
+      c.GetTableReader()->NewRawDataBlockIterator(ReadOptions()));
+  ASSERT_NE(raw_iter, nullptr);
+  int num_blocks = 0;
+  int num_copied_blocks = 0;
+  for (raw_iter->SeekToFirst(); raw_iter->Valid(); raw_iter->Next()) {
+    InternalIterator* entries = raw_iter->block().entries;
+    std::unique_ptr<RawDataBlock> released;
+    if (num_blocks % 2 == 0) {
+      // A block released from the iterator owns its entries.
+      released = raw_iter->ReleaseBlock();
+      entries = released->entries;
+      ASSERT_TRUE(builder->AddRawDataBlock(*released));
+      num_copied_blocks++;
+    } else {
+      for (entries->SeekToFirst(); entries->Valid(); entries->Next()) {
+        builder->Add(entries->key(), entries->value());
+      }
+    }
+    for (entries->SeekToFirst(); entries->Valid(); entries->Next()) {
+      expected_keys.push_back(ExtractUserKey(entries->key()).ToString());
+    }
+    if (num_blocks % 3 == 0) {
+      std::string key = expected_keys.back() + "x";
+      builder->Add(InternalKey(key, 0, kTypeValue).Encode(), "val");
+      expected_keys.push_back(key);
+    }
+    num_blocks++;
+  }
+  ASSERT_OK(raw_iter->status());
+  ASSERT_GT(num_copied_blocks, 10);
+  ASSERT_OK(builder->Finish());
+  ASSERT_OK(file_writer->Flush());
+  ASSERT_EQ(expected_keys.size(), builder->NumEntries());
+
+  std::unique_ptr<FSRandomAccessFile> source(
+      new test::StringSource(sink->contents(), 73342, false));
+  std::unique_ptr<RandomAccessFileReader> file_reader(
+      new RandomAccessFileReader(std::move(source), "test"));
+  std::unique_ptr<TableReader> table_reader;
+  ASSERT_OK(ioptions.table_factory->NewTableReader(
+      TableReaderOptions(ioptions, moptions.prefix_extractor.get(),
+                         EnvOptions(), ikc),
+      std::move(file_reader), sink->contents().size(), &table_reader));
+  ASSERT_OK(table_reader->VerifyChecksum(ReadOptions(),
+                                         TableReaderCaller::kUserVerifyChecksum));
+
+  // Iterates, seeks and gets through the index and the filter
+  std::unique_ptr<InternalIterator> iter(table_reader->NewIterator(
+      ReadOptions(), moptions.prefix_extractor.get(), /*arena=*/nullptr,
+      /*skip_filters=*/false, TableReaderCaller::kUncategorized));
+  size_t i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_LT(i, expected_keys.size());
+    ASSERT_EQ(expected_keys[i++], ExtractUserKey(iter->key()).ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(expected_keys.size(), i);
+  for (const auto& key : expected_keys) {
+    iter->Seek(InternalKey(key, kMaxSequenceNumber, kTypeValue).Encode());
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(key, ExtractUserKey(iter->key()).ToString());
+
+    PinnableSlice value;
+    GetContext get_context(options.comparator, nullptr, nullptr, nullptr,
+                           GetContext::kNotFound, key, &value, nullptr,
+                           nullptr, true, nullptr, nullptr);
+    ASSERT_OK(table_reader->Get(
+        ReadOptions(), InternalKey(key, kMaxSequenceNumber, kTypeValue).Encode(),
+        &get_context, moptions.prefix_extractor.get()));
+    ASSERT_EQ(GetContext::kFound, get_context.State());
+  }
+  ASSERT_EQ(expected_keys.size(),
+            table_reader->GetTableProperties()->num_entries);
+  iter.reset();
+  table_reader.reset();
+  raw_iter.reset();
+  c.ResetTableReader();
+}
+
 TEST_P(BlockBasedTableTest, TracingApproximateOffsetOfTest) {
   TableConstructor c(BytewiseComparator());
   Options options;
@@ -0,0 +1,21 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Worker process of a LocalCompactionService, for DBs using the default
+// comparator and no merge operator or compaction filter.
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/utilities/local_compaction_service.h"
+
+int main(int argc, char** argv) {
+  return ROCKSDB_NAMESPACE::RunCompactionWorker(argc, argv);
+}
+#else
+#include <stdio.h>
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr, "Not supported in lite mode.\n");
+  return 1;
+}
+#endif  // ROCKSDB_LITE
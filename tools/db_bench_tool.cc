@@ -52,6 +52,7 @@
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/filter_policy.h"
+#include "rocksdb/key_hotness_tracker.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/options.h"
 #include "rocksdb/perf_context.h"
@@ -63,6 +64,7 @@
 #include "rocksdb/stats_history.h"
 #include "rocksdb/table.h"
 #include "rocksdb/utilities/object_registry.h"
+#include "rocksdb/utilities/local_compaction_service.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
 #include "rocksdb/utilities/options_type.h"
 #include "rocksdb/utilities/options_util.h"
@@ -235,6 +237,11 @@ IF_ROCKSDB_LITE("",
     "\twaitforcompaction - pause until compaction is (probably) done\n"
 )
     "\tflush - flush the memtable\n"
+IF_ROCKSDB_LITE("",
+    "\trecoverwal  -- reopen the DB and report the time taken to replay "
+    "its WALs, after writing random keys until they reach "
+    "recoverwal_size_mb\n"
+)
     "\tstats       -- Print DB stats\n"
     "\tresetstats  -- Reset DB stats\n"
     "\tlevelstats  -- Print the number of files and bytes per level\n"
@@ -512,6 +519,18 @@ static const bool FLAGS_subcompactions_dummy
     __attribute__((__unused__)) = RegisterFlagValidator(&FLAGS_subcompactions,
                                                     &ValidateUint32Range);
 
+DEFINE_string(compaction_worker, "",
+              "If set, compactions run in worker processes started with this "
+              "space separated command, e.g. the path of the "
+              "compaction_worker tool, through a LocalCompactionService. "
+              "Compare the latency percentiles reported with --histogram "
+              "with and without it to measure the impact of compactions on "
+              "the foreground operations.");
+
+DEFINE_int32(compaction_workers, 4,
+             "Maximum number of compaction worker processes running at the "
+             "same time with --compaction_worker.");
+
 DEFINE_int32(max_background_flushes,
              ROCKSDB_NAMESPACE::Options().max_background_flushes,
              "The maximum number of concurrent background flushes"
@@ -643,6 +662,11 @@ DEFINE_bool(block_align,
             ROCKSDB_NAMESPACE::BlockBasedTableOptions().block_align,
             "Align data blocks on page size");
 
+DEFINE_bool(learn_auto_readahead,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions().learn_auto_readahead,
+            "Start auto-readahead of iterators with the readahead size learned "
+            "from earlier iterators over the same table file region");
+
 DEFINE_int64(prepopulate_block_cache, 0,
              "Pre-populate hot/warm blocks in block cache. 0 to disable and 1 "
              "to insert during flush");
@@ -673,11 +697,32 @@ DEFINE_int32(file_opening_threads,
              "If open_files is set to -1, this option set the number of "
              "threads that will be used to open files during DB::Open()");
 
+DEFINE_int32(file_opening_batch_size,
+             ROCKSDB_NAMESPACE::Options().file_opening_batch_size,
+             "Number of files that each file opening thread opens together, "
+             "reading their tails with asynchronous reads");
+
 DEFINE_bool(new_table_reader_for_compaction_inputs, true,
              "If true, uses a separate file handle for compaction inputs");
 
 DEFINE_int32(compaction_readahead_size, 0, "Compaction readahead size");
 
+DEFINE_int32(compaction_async_io_depth,
+             ROCKSDB_NAMESPACE::Options().compaction_async_io_depth,
+             "Number of asynchronous reads in flight per compaction input "
+             "file when compaction_readahead_size is set. 0 means compaction "
+             "readahead is synchronous.");
+
+DEFINE_bool(pipelined_compaction,
+            ROCKSDB_NAMESPACE::Options().pipelined_compaction,
+            "Run each compaction as a pipeline of threads reading its input, "
+            "building its output blocks, and compressing and writing them");
+
+DEFINE_bool(compaction_block_passthrough,
+            ROCKSDB_NAMESPACE::Options().compaction_block_passthrough,
+            "Copy the data blocks of compaction inputs that no other input "
+            "overlaps to the outputs as stored");
+
 DEFINE_int32(log_readahead_size, 0, "WAL and manifest readahead size");
 
 DEFINE_int32(random_access_max_buffer_size, 1024 * 1024,
@@ -1068,6 +1113,10 @@ DEFINE_bool(adaptive_readahead, false,
             "carry forward internal auto readahead size from one file to next "
             "file at each level during iteration");
 
+DEFINE_bool(async_io, false,
+            "When set true, RocksDB does asynchronous reads for internal auto "
+            "readahead prefetching.");
+
 static enum ROCKSDB_NAMESPACE::CompressionType StringToCompressionType(
     const char* ctype) {
   assert(ctype);
@@ -1164,6 +1213,12 @@ DEFINE_string(simulate_hybrid_fs_file, "",
               "File for Store Metadata for Simulate hybrid FS. Empty means "
               "disable the feature. Now, if it is set, "
               "bottommost_temperature is set to kWarm.");
+DEFINE_int32(simulate_hybrid_fs_hot_key_prefix_len, 0,
+             "If positive, together with --simulate_hybrid_fs_file, the keys "
+             "read are tracked by ranges of keys sharing their first "
+             "simulate_hybrid_fs_hot_key_prefix_len bytes, and compactions "
+             "write the keys not read within the last hour to kWarm files, "
+             "instead of the bottommost files.");
 
 static std::shared_ptr<ROCKSDB_NAMESPACE::Env> env_guard;
 
@@ -1224,6 +1279,12 @@ DEFINE_bool(
     "Enable the unordered write feature, which provides higher throughput but "
     "relaxes the guarantees around atomic reads and immutable snapshots");
 
+DEFINE_bool(enable_staged_writes,
+            ROCKSDB_NAMESPACE::Options().enable_staged_writes,
+            "Stage writes on per-core queues, which a committer thread "
+            "commits together, instead of grouping writers in the write "
+            "thread");
+
 DEFINE_bool(allow_concurrent_memtable_write, true,
             "Allow multi-writers to update mem tables in parallel.");
 
@@ -1374,6 +1435,17 @@ DEFINE_uint64(wal_size_limit_MB, 0, "Set the size limit for the WAL Files"
               " in MB.");
 DEFINE_uint64(max_total_wal_size, 0, "Set total max WAL size");
 
+DEFINE_int32(wal_recovery_threads,
+             ROCKSDB_NAMESPACE::Options().wal_recovery_threads,
+             "Number of threads inserting WAL records into the memtables "
+             "when the DB is opened");
+
+DEFINE_uint64(recoverwal_size_mb, 0,
+              "For recoverwal: write random keys until the live WALs are "
+              "at least this large before reopening the DB. Set "
+              "write_buffer_size large enough for the WALs not to be "
+              "flushed.");
+
 DEFINE_bool(mmap_read, ROCKSDB_NAMESPACE::Options().allow_mmap_reads,
             "Allow reads to occur via mmap-ing files");
 
@@ -3463,6 +3535,10 @@ class Benchmark {
 #endif
       } else if (name == "flush") {
         Flush();
+#ifndef ROCKSDB_LITE
+      } else if (name == "recoverwal") {
+        RecoverWal();
+#endif  // ROCKSDB_LITE
       } else if (name == "crc32c") {
         method = &Benchmark::Crc32c;
       } else if (name == "xxhash") {
@@ -3691,6 +3767,13 @@ class Benchmark {
       fprintf(stdout, "Secondary instance updated  %" PRIu64 " times.\n",
               secondary_db_updates_);
     }
+    if (compaction_service_) {
+      fprintf(stdout,
+              "Compaction jobs run by workers: %" PRIu64
+              ", run locally after worker failures: %" PRIu64 "\n",
+              compaction_service_->GetNumRemoteJobs(),
+              compaction_service_->GetNumLocalFallbacks());
+    }
 #endif  // ROCKSDB_LITE
   }
 
@@ -3700,6 +3783,7 @@ class Benchmark {
   std::atomic<int> secondary_update_stopped_{0};
 #ifndef ROCKSDB_LITE
   uint64_t secondary_db_updates_ = 0;
+  std::shared_ptr<LocalCompactionService> compaction_service_;
 #endif  // ROCKSDB_LITE
   struct ThreadArg {
     Benchmark* bm;
@@ -3991,6 +4075,16 @@ class Benchmark {
     options.max_background_jobs = FLAGS_max_background_jobs;
     options.max_background_compactions = FLAGS_max_background_compactions;
     options.max_subcompactions = static_cast<uint32_t>(FLAGS_subcompactions);
+#ifndef ROCKSDB_LITE
+    if (!FLAGS_compaction_worker.empty()) {
+      LocalCompactionServiceOptions service_options;
+      service_options.worker_command =
+          StringSplit(FLAGS_compaction_worker, ' ');
+      service_options.max_workers = FLAGS_compaction_workers;
+      compaction_service_ = NewLocalCompactionService(service_options);
+      options.compaction_service = compaction_service_;
+    }
+#endif  // ROCKSDB_LITE
     options.max_background_flushes = FLAGS_max_background_flushes;
     options.compaction_style = FLAGS_compaction_style_e;
     options.compaction_pri = FLAGS_compaction_pri_e;
@@ -4031,9 +4125,13 @@ class Benchmark {
     }
     options.bloom_locality = FLAGS_bloom_locality;
     options.max_file_opening_threads = FLAGS_file_opening_threads;
+    options.file_opening_batch_size = FLAGS_file_opening_batch_size;
     options.new_table_reader_for_compaction_inputs =
         FLAGS_new_table_reader_for_compaction_inputs;
     options.compaction_readahead_size = FLAGS_compaction_readahead_size;
+    options.compaction_async_io_depth = FLAGS_compaction_async_io_depth;
+    options.pipelined_compaction = FLAGS_pipelined_compaction;
+    options.compaction_block_passthrough = FLAGS_compaction_block_passthrough;
     options.log_readahead_size = FLAGS_log_readahead_size;
     options.random_access_max_buffer_size = FLAGS_random_access_max_buffer_size;
     options.writable_file_max_buffer_size = FLAGS_writable_file_max_buffer_size;
@@ -4184,6 +4282,7 @@ class Benchmark {
       block_based_options.enable_index_compression =
           FLAGS_enable_index_compression;
       block_based_options.block_align = FLAGS_block_align;
+      block_based_options.learn_auto_readahead = FLAGS_learn_auto_readahead;
       BlockBasedTableOptions::PrepopulateBlockCache prepopulate_block_cache =
           block_based_options.prepopulate_block_cache;
       switch (FLAGS_prepopulate_block_cache) {
@@ -4268,12 +4367,21 @@ class Benchmark {
       FLAGS_level0_slowdown_writes_trigger;
     options.compression = FLAGS_compression_type_e;
     if (FLAGS_simulate_hybrid_fs_file != "") {
-      options.bottommost_temperature = Temperature::kWarm;
+      if (FLAGS_simulate_hybrid_fs_hot_key_prefix_len > 0) {
+        KeyHotnessTrackerOptions tracker_options;
+        tracker_options.range_prefix_length =
+            static_cast<size_t>(FLAGS_simulate_hybrid_fs_hot_key_prefix_len);
+        options.key_hotness_tracker = NewKeyHotnessTracker(tracker_options);
+        options.cold_key_temperature = Temperature::kWarm;
+      } else {
+        options.bottommost_temperature = Temperature::kWarm;
+      }
     }
     options.sample_for_compression = FLAGS_sample_for_compression;
     options.WAL_ttl_seconds = FLAGS_wal_ttl_seconds;
     options.WAL_size_limit_MB = FLAGS_wal_size_limit_MB;
     options.max_total_wal_size = FLAGS_max_total_wal_size;
+    options.wal_recovery_threads = FLAGS_wal_recovery_threads;
 
     if (FLAGS_min_level_to_compress >= 0) {
       assert(FLAGS_min_level_to_compress <= FLAGS_num_levels);
@@ -4303,6 +4411,7 @@ class Benchmark {
         FLAGS_enable_write_thread_adaptive_yield;
     options.enable_pipelined_write = FLAGS_enable_pipelined_write;
     options.unordered_write = FLAGS_unordered_write;
+    options.enable_staged_writes = FLAGS_enable_staged_writes;
     options.write_thread_max_yield_usec = FLAGS_write_thread_max_yield_usec;
     options.write_thread_slow_yield_usec = FLAGS_write_thread_slow_yield_usec;
     options.rate_limit_delay_max_milliseconds =
@@ -5515,6 +5624,7 @@ class Benchmark {
     }
 
     options.adaptive_readahead = FLAGS_adaptive_readahead;
+    options.async_io = FLAGS_async_io;
     Iterator* iter = db->NewIterator(options);
     int64_t i = 0;
     int64_t bytes = 0;
@@ -5611,6 +5721,7 @@ class Benchmark {
   void ReadReverse(ThreadState* thread, DB* db) {
     ReadOptions options(FLAGS_verify_checksum, true);
     options.adaptive_readahead = FLAGS_adaptive_readahead;
+    options.async_io = FLAGS_async_io;
     Iterator* iter = db->NewIterator(options);
     int64_t i = 0;
     int64_t bytes = 0;
@@ -6402,6 +6513,7 @@ class Benchmark {
     options.tailing = FLAGS_use_tailing_iterator;
     options.readahead_size = FLAGS_readahead_size;
     options.adaptive_readahead = FLAGS_adaptive_readahead;
+    options.async_io = FLAGS_async_io;
     std::unique_ptr<char[]> ts_guard;
     Slice ts;
     if (user_timestamp_size_ > 0) {
@@ -6699,6 +6811,7 @@ class Benchmark {
       read_options.timestamp = &ts;
     }
     read_options.adaptive_readahead = FLAGS_adaptive_readahead;
+    read_options.async_io = FLAGS_async_io;
     Iterator* iter = db_.db->NewIterator(read_options);
 
     fprintf(stderr, "num reads to do %" PRIu64 "\n", reads_);
@@ -7300,6 +7413,7 @@ class Benchmark {
     DB* db = SelectDB(thread);
     ReadOptions read_opts(FLAGS_verify_checksum, true);
     read_opts.adaptive_readahead = FLAGS_adaptive_readahead;
+    read_opts.async_io = FLAGS_async_io;
     std::unique_ptr<char[]> ts_guard;
     Slice ts;
     if (user_timestamp_size_ > 0) {
@@ -8059,6 +8173,64 @@ class Benchmark {
     fprintf(stdout, "flush memtable\n");
   }
 
+#ifndef ROCKSDB_LITE
+  uint64_t GetLiveWalSize() {
+    VectorLogPtr wal_files;
+    Status s = db_.db->GetSortedWalFiles(wal_files);
+    if (!s.ok()) {
+      fprintf(stderr, "GetSortedWalFiles failed: %s\n", s.ToString().c_str());
+      exit(1);
+    }
+    uint64_t size = 0;
+    for (const auto& wal : wal_files) {
+      if (wal->Type() == kAliveLogFile) {
+        size += wal->SizeFileBytes();
+      }
+    }
+    return size;
+  }
+
+  void RecoverWal() {
+    if (db_.db == nullptr) {
+      fprintf(stderr, "recoverwal is not supported with multiple DBs\n");
+      exit(1);
+    }
+
+    const uint64_t target_wal_size = FLAGS_recoverwal_size_mb << 20;
+    uint64_t wal_size = GetLiveWalSize();
+    if (wal_size < target_wal_size) {
+      Random64 rand(FLAGS_seed);
+      RandomGenerator gen;
+      std::unique_ptr<const char[]> key_guard;
+      Slice key = AllocateKey(&key_guard);
+      while (wal_size < target_wal_size) {
+        for (int i = 0; i < 1000; ++i) {
+          GenerateKeyFromInt(rand.Next() % FLAGS_num, FLAGS_num, &key);
+          Status s = db_.db->Put(write_options_, key, gen.Generate());
+          if (!s.ok()) {
+            fprintf(stderr, "put error: %s\n", s.ToString().c_str());
+            exit(1);
+          }
+        }
+        wal_size = GetLiveWalSize();
+      }
+    }
+
+    db_.DeleteDBs();
+    const uint64_t start = FLAGS_env->NowMicros();
+    Open(&open_options_);
+    const uint64_t elapsed = FLAGS_env->NowMicros() - start;
+
+    const double wal_size_mb = static_cast<double>(wal_size) / 1048576.0;
+    fprintf(stdout,
+            "recoverwal   : %.3f seconds to recover %.1f MB of WALs "
+            "(%.1f MB/s) with %d threads\n",
+            elapsed / 1000000.0, wal_size_mb,
+            elapsed > 0 ? wal_size_mb * 1000000.0 / elapsed : 0.0,
+            open_options_.wal_recovery_threads);
+  }
+#endif  // ROCKSDB_LITE
+
   void ResetStats() {
     if (db_.db != nullptr) {
       db_.db->ResetStats();
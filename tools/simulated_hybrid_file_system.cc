@@ -8,6 +8,7 @@
 #include "tools/simulated_hybrid_file_system.h"
 
 #include <algorithm>
+#include <cinttypes>
 #include <sstream>
 #include <string>
 
@@ -49,6 +50,7 @@ SimulatedHybridFileSystem::SimulatedHybridFileSystem(
       rate_limiter_(NewGenericRateLimiter(
           kDummyBytesPerUs * kUsPerSec /* rate_bytes_per_sec */,
           1000 /* refill_period_us */)),
+      read_stats_(std::make_shared<SimulatedHybridReadStats>()),
       metadata_file_name_(metadata_file_name),
       name_("SimulatedHybridFileSystem: " + std::string(target()->Name())) {
   IOStatus s = base->FileExists(metadata_file_name, IOOptions(), nullptr);
@@ -77,6 +79,12 @@ SimulatedHybridFileSystem::SimulatedHybridFileSystem(
 // SimulatedHybridFileSystem::SimulatedHybridFileSystem() for format of the
 // file.
 SimulatedHybridFileSystem::~SimulatedHybridFileSystem() {
+  fprintf(stderr,
+          "Simulated hybrid file system reads: %" PRIu64 " (%" PRIu64
+          " bytes) from warm files, %" PRIu64 " (%" PRIu64
+          " bytes) from other files\n",
+          read_stats_->warm_reads.load(), read_stats_->warm_bytes.load(),
+          read_stats_->other_reads.load(), read_stats_->other_bytes.load());
   std::string metadata;
   for (const auto& f : warm_file_set_) {
     metadata += f;
@@ -102,7 +110,8 @@ IOStatus SimulatedHybridFileSystem::NewRandomAccessFile(
   assert(temperature == file_opts.temperature);
   IOStatus s = target()->NewRandomAccessFile(fname, file_opts, result, dbg);
   result->reset(
-      new SimulatedHybridRaf(std::move(*result), rate_limiter_, temperature));
+      new SimulatedHybridRaf(std::move(*result), rate_limiter_, read_stats_,
+                             temperature));
   return s;
 }
 
@@ -134,6 +143,7 @@ IOStatus SimulatedHybridFileSystem::DeleteFile(const std::string& fname,
 IOStatus SimulatedHybridRaf::Read(uint64_t offset, size_t n,
                                   const IOOptions& options, Slice* result,
                                   char* scratch, IODebugContext* dbg) const {
+  read_stats_->Record(temperature_, 1, n);
   if (temperature_ == Temperature::kWarm) {
     Env::Default()->SleepForMicroseconds(kLatencyAddedPerRequestUs);
     RequestRateLimit(n);
@@ -144,6 +154,11 @@ IOStatus SimulatedHybridRaf::Read(uint64_t offset, size_t n,
 IOStatus SimulatedHybridRaf::MultiRead(FSReadRequest* reqs, size_t num_reqs,
                                        const IOOptions& options,
                                        IODebugContext* dbg) {
+  uint64_t bytes = 0;
+  for (size_t i = 0; i < num_reqs; i++) {
+    bytes += reqs[i].len;
+  }
+  read_stats_->Record(temperature_, num_reqs, bytes);
   if (temperature_ == Temperature::kWarm) {
     for (size_t i = 0; i < num_reqs; i++) {
       RequestRateLimit(reqs[i].len);
@@ -157,6 +172,7 @@ IOStatus SimulatedHybridRaf::MultiRead(FSReadRequest* reqs, size_t num_reqs,
 IOStatus SimulatedHybridRaf::Prefetch(uint64_t offset, size_t n,
                                       const IOOptions& options,
                                       IODebugContext* dbg) {
+  read_stats_->Record(temperature_, 1, n);
   if (temperature_ == Temperature::kWarm) {
     RequestRateLimit(n);
     Env::Default()->SleepForMicroseconds(kLatencyAddedPerRequestUs);
@@ -7,12 +7,32 @@
 
 #ifndef ROCKSDB_LITE
 
+#include <atomic>
 #include <utility>
 
 #include "rocksdb/file_system.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+// Read requests served by the files of a SimulatedHybridFileSystem, by
+// temperature.
+struct SimulatedHybridReadStats {
+  std::atomic<uint64_t> warm_reads{0};
+  std::atomic<uint64_t> warm_bytes{0};
+  std::atomic<uint64_t> other_reads{0};
+  std::atomic<uint64_t> other_bytes{0};
+
+  void Record(Temperature temperature, uint64_t num_reads, uint64_t bytes) {
+    if (temperature == Temperature::kWarm) {
+      warm_reads.fetch_add(num_reads, std::memory_order_relaxed);
+      warm_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    } else {
+      other_reads.fetch_add(num_reads, std::memory_order_relaxed);
+      other_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+  }
+};
+
 // A FileSystem simulates hybrid file system by ingesting latency and limit
 // IOPs.
 // This class is only used for development purpose and should not be used
@@ -22,7 +42,8 @@ namespace ROCKSDB_NAMESPACE {
 // When the object is destroyed, the list of warm files are written to a
 // file, which can be used to reopen a FileSystem and still recover the
 // list. This is to allow the information to preserve between db_bench
-// runs.
+// runs. The number of reads from warm and other files is printed to stderr
+// too.
 class SimulatedHybridFileSystem : public FileSystemWrapper {
  public:
   // metadata_file_name stores metadata of the files, so that it can be
@@ -51,6 +72,7 @@ class SimulatedHybridFileSystem : public FileSystemWrapper {
   // Limit 100 requests per second. Rate limiter is designed to byte but
   // we use it as fixed bytes is one request.
   std::shared_ptr<RateLimiter> rate_limiter_;
+  std::shared_ptr<SimulatedHybridReadStats> read_stats_;
   std::mutex mutex_;
   std::unordered_set<std::string> warm_file_set_;
   std::string metadata_file_name_;
@@ -63,9 +85,11 @@ class SimulatedHybridRaf : public FSRandomAccessFileOwnerWrapper {
  public:
   SimulatedHybridRaf(std::unique_ptr<FSRandomAccessFile>&& t,
                      std::shared_ptr<RateLimiter> rate_limiter,
+                     std::shared_ptr<SimulatedHybridReadStats> read_stats,
                      Temperature temperature)
       : FSRandomAccessFileOwnerWrapper(std::move(t)),
         rate_limiter_(rate_limiter),
+        read_stats_(read_stats),
         temperature_(temperature) {}
 
   ~SimulatedHybridRaf() override {}
@@ -82,6 +106,7 @@ class SimulatedHybridRaf : public FSRandomAccessFileOwnerWrapper {
 
  private:
   std::shared_ptr<RateLimiter> rate_limiter_;
+  std::shared_ptr<SimulatedHybridReadStats> read_stats_;
   Temperature temperature_;
 
   void RequestRateLimit(int64_t num_requests) const;
@@ -0,0 +1,72 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/bloom_impl.h"
+
+#include <atomic>
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+bool CpuSupportsAvx2() {
+#if defined(HAVE_AVX2)
+  return true;
+#elif defined(ROCKSDB_BLOOM_AVX2_FN)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+const bool kCpuSupportsAvx2 = CpuSupportsAvx2();
+
+std::atomic<bool> use_portable_batch_probes{false};
+
+#ifdef ROCKSDB_BLOOM_AVX2_FN
+// A separate function, so that HashMayMatchPreparedAvx2 is inlined into the
+// loop even when the rest of the build does not target AVX2
+ROCKSDB_BLOOM_AVX2_FN void BatchHashMayMatchPreparedAvx2(
+    size_t num_keys, const uint32_t* h2s, const uint32_t* byte_offsets,
+    int num_probes, const char* data, bool* may_match) {
+  for (size_t i = 0; i < num_keys; ++i) {
+    may_match[i] = FastLocalBloomImpl::HashMayMatchPreparedAvx2(
+        h2s[i], num_probes, data + byte_offsets[i]);
+  }
+}
+#endif  // ROCKSDB_BLOOM_AVX2_FN
+
+}  // namespace
+
+void FastLocalBloomImpl::BatchHashMayMatchPrepared(
+    size_t num_keys, const uint32_t* h2s, const uint32_t* byte_offsets,
+    int num_probes, const char* data, bool* may_match) {
+#ifdef ROCKSDB_BLOOM_AVX2_FN
+  if (kCpuSupportsAvx2 &&
+      !use_portable_batch_probes.load(std::memory_order_relaxed)) {
+    BatchHashMayMatchPreparedAvx2(num_keys, h2s, byte_offsets, num_probes,
+                                  data, may_match);
+    return;
+  }
+#endif  // ROCKSDB_BLOOM_AVX2_FN
+  for (size_t i = 0; i < num_keys; ++i) {
+    may_match[i] = HashMayMatchPreparedPortable(h2s[i], num_probes,
+                                                data + byte_offsets[i]);
+  }
+}
+
+const char* FastLocalBloomImpl::GetBatchProbeImplName() {
+  return kCpuSupportsAvx2 &&
+                 !use_portable_batch_probes.load(std::memory_order_relaxed)
+             ? "avx2"
+             : "portable";
+}
+
+void FastLocalBloomImpl::TEST_SetPortableBatchProbes(bool portable) {
+  use_portable_batch_probes.store(portable, std::memory_order_relaxed);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
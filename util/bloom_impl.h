@@ -17,7 +17,16 @@
 #include "rocksdb/slice.h"
 #include "util/hash.h"
 
+// HashMayMatchPreparedAvx2 is compiled for AVX2 (and used directly) when
+// the whole build targets AVX2, and otherwise where the compiler can target
+// AVX2 for a single function, to be used after a runtime CPU check.
 #ifdef HAVE_AVX2
+#define ROCKSDB_BLOOM_AVX2_FN
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ROCKSDB_BLOOM_AVX2_FN __attribute__((__target__("avx2")))
+#endif
+
+#ifdef ROCKSDB_BLOOM_AVX2_FN
 #include <immintrin.h>
 #endif
 
@@ -226,8 +235,30 @@ class FastLocalBloomImpl {
 
   static inline bool HashMayMatchPrepared(uint32_t h2, int num_probes,
                                           const char *data_at_cache_line) {
-    uint32_t h = h2;
 #ifdef HAVE_AVX2
+    return HashMayMatchPreparedAvx2(h2, num_probes, data_at_cache_line);
+#else
+    return HashMayMatchPreparedPortable(h2, num_probes, data_at_cache_line);
+#endif
+  }
+
+  static inline bool HashMayMatchPreparedPortable(
+      uint32_t h2, int num_probes, const char *data_at_cache_line) {
+    uint32_t h = h2;
+    for (int i = 0; i < num_probes; ++i, h *= uint32_t{0x9e3779b9}) {
+      // 9-bit address within 512 bit cache line
+      int bitpos = h >> (32 - 9);
+      if ((data_at_cache_line[bitpos >> 3] & (char(1) << (bitpos & 7))) == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+#ifdef ROCKSDB_BLOOM_AVX2_FN
+  ROCKSDB_BLOOM_AVX2_FN static inline bool HashMayMatchPreparedAvx2(
+      uint32_t h2, int num_probes, const char *data_at_cache_line) {
+    uint32_t h = h2;
     int rem_probes = num_probes;
 
     // NOTE: For better performance for num_probes in {1, 2, 9, 10, 17, 18,
@@ -327,17 +358,24 @@ class FastLocalBloomImpl {
       h *= 0xab25f4c1;
       rem_probes -= 8;
     }
-#else
-    for (int i = 0; i < num_probes; ++i, h *= uint32_t{0x9e3779b9}) {
-      // 9-bit address within 512 bit cache line
-      int bitpos = h >> (32 - 9);
-      if ((data_at_cache_line[bitpos >> 3] & (char(1) << (bitpos & 7))) == 0) {
-        return false;
-      }
-    }
-    return true;
-#endif
   }
+#endif  // ROCKSDB_BLOOM_AVX2_FN
+
+  // Batched HashMayMatchPrepared: sets may_match[i] for the key with hash h2
+  // h2s[i] and cache line at byte_offsets[i] (from PrepareHash) of data.
+  // Uses HashMayMatchPreparedAvx2 if the CPU supports AVX2 (checked at
+  // runtime, so also in builds not targeting AVX2), with one check per batch.
+  static void BatchHashMayMatchPrepared(size_t num_keys, const uint32_t *h2s,
+                                        const uint32_t *byte_offsets,
+                                        int num_probes, const char *data,
+                                        bool *may_match);
+
+  // Name of the instruction set BatchHashMayMatchPrepared uses on this CPU
+  static const char *GetBatchProbeImplName();
+
+  // For tests and benchmarks: makes BatchHashMayMatchPrepared use the
+  // portable implementation (or the best supported one again).
+  static void TEST_SetPortableBatchProbes(bool portable);
 };
 
 // A legacy Bloom filter implementation with no locality of probes (slow).
@@ -27,8 +27,10 @@ int main() {
 #include "table/block_based/filter_policy_internal.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
+#include "util/bloom_impl.h"
 #include "util/gflags_compat.h"
 #include "util/hash.h"
+#include "util/random.h"
 
 using GFLAGS_NAMESPACE::ParseCommandLineFlags;
 
@@ -1271,6 +1273,52 @@ static void SetTestingLevel(int levelish, FilterBuildingContext* ctx) {
   }
 }
 
+TEST(FastLocalBloomTest, BatchHashMayMatchPrepared) {
+  // Random filter data with about one bit in three set, so that keys fail
+  // at various probes
+  const uint32_t kLenBytes = 64 * 1000;
+  std::unique_ptr<char[]> data(new char[kLenBytes]);
+  Random rnd(301);
+  for (uint32_t i = 0; i < kLenBytes; ++i) {
+    data[i] = static_cast<char>(rnd.Next() & rnd.Next());
+  }
+
+  // More than a MultiGet batch
+  const size_t kMaxKeys = 40;
+  std::array<uint32_t, kMaxKeys> h2s;
+  std::array<uint32_t, kMaxKeys> byte_offsets;
+  bool may_match[kMaxKeys];
+  for (bool portable : {false, true}) {
+    FastLocalBloomImpl::TEST_SetPortableBatchProbes(portable);
+    size_t num_matches = 0;
+    size_t num_mismatches = 0;
+    for (int num_probes = 1; num_probes <= 24; ++num_probes) {
+      for (size_t num_keys = 0; num_keys <= kMaxKeys; num_keys += 3) {
+        for (size_t i = 0; i < num_keys; ++i) {
+          h2s[i] = rnd.Next();
+          FastLocalBloomImpl::PrepareHash(rnd.Next(), kLenBytes, data.get(),
+                                          &byte_offsets[i]);
+        }
+        FastLocalBloomImpl::BatchHashMayMatchPrepared(
+            num_keys, h2s.data(), byte_offsets.data(), num_probes, data.get(),
+            may_match);
+        for (size_t i = 0; i < num_keys; ++i) {
+          ASSERT_EQ(may_match[i], FastLocalBloomImpl::HashMayMatchPrepared(
+                                      h2s[i], num_probes,
+                                      data.get() + byte_offsets[i]))
+              << "impl " << FastLocalBloomImpl::GetBatchProbeImplName()
+              << " num_probes " << num_probes << " key " << i << " of "
+              << num_keys;
+          (may_match[i] ? num_matches : num_mismatches)++;
+        }
+      }
+    }
+    ASSERT_GT(num_matches, 0);
+    ASSERT_GT(num_mismatches, 0);
+  }
+  FastLocalBloomImpl::TEST_SetPortableBatchProbes(false);
+}
+
 TEST(RibbonTest, RibbonTestLevelThreshold) {
   BlockBasedTableOptions opts;
   FilterBuildingContext ctx(opts);
@@ -25,6 +25,7 @@ int main() {
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/mock_block_based_table.h"
 #include "table/plain/plain_table_bloom.h"
+#include "util/bloom_impl.h"
 #include "util/cast_util.h"
 #include "util/gflags_compat.h"
 #include "util/hash.h"
@@ -140,6 +141,7 @@ using ROCKSDB_NAMESPACE::BuiltinFilterBitsBuilder;
 using ROCKSDB_NAMESPACE::CachableEntry;
 using ROCKSDB_NAMESPACE::Cache;
 using ROCKSDB_NAMESPACE::EncodeFixed32;
+using ROCKSDB_NAMESPACE::FastLocalBloomImpl;
 using ROCKSDB_NAMESPACE::FastRange32;
 using ROCKSDB_NAMESPACE::FilterBitsReader;
 using ROCKSDB_NAMESPACE::FilterBuildingContext;
@@ -221,6 +223,7 @@ struct FilterInfo {
 enum TestMode {
   kSingleFilter,
   kBatchPrepared,
+  kBatchPreparedPortable,
   kBatchUnprepared,
   kFiftyOneFilter,
   kEightyTwentyFilter,
@@ -228,8 +231,9 @@ enum TestMode {
 };
 
 static const std::vector<TestMode> allTestModes = {
-    kSingleFilter,   kBatchPrepared,      kBatchUnprepared,
-    kFiftyOneFilter, kEightyTwentyFilter, kRandomFilter,
+    kSingleFilter,       kBatchPrepared,  kBatchPreparedPortable,
+    kBatchUnprepared,    kFiftyOneFilter, kEightyTwentyFilter,
+    kRandomFilter,
 };
 
 static const std::vector<TestMode> quickTestModes = {
@@ -247,6 +251,8 @@ const char *TestModeToString(TestMode tm) {
       return "Single filter";
     case kBatchPrepared:
       return "Batched, prepared";
+    case kBatchPreparedPortable:
+      return "Batched, prepared, portable probes";
     case kBatchUnprepared:
       return "Batched, unprepared";
     case kFiftyOneFilter:
@@ -364,6 +370,10 @@ void FilterBench::Go() {
     working_mem_size_mb /= 10.0;
   }
 
+  if (!FLAGS_use_plain_table_bloom && FLAGS_impl == 2) {
+    std::cout << "Batched probes use: "
+              << FastLocalBloomImpl::GetBatchProbeImplName() << std::endl;
+  }
   std::cout << "Building..." << std::endl;
 
   std::unique_ptr<BuiltinFilterBitsBuilder> builder;
@@ -612,9 +622,14 @@ double FilterBench::RandomQueryTest(uint32_t inside_threshold, bool dry_run,
   std::unique_ptr<Slice[]> batch_slices;
   std::unique_ptr<Slice *[]> batch_slice_ptrs;
   std::unique_ptr<bool[]> batch_results;
-  if (mode == kBatchPrepared || mode == kBatchUnprepared) {
+  const bool batch_prepared =
+      mode == kBatchPrepared || mode == kBatchPreparedPortable;
+  if (batch_prepared || mode == kBatchUnprepared) {
     batch_size = static_cast<uint32_t>(kms_.size());
   }
+  // For comparison with the SIMD probes of batched queries, if available
+  FastLocalBloomImpl::TEST_SetPortableBatchProbes(mode ==
+                                                  kBatchPreparedPortable);
 
   batch_slices.reset(new Slice[batch_size]);
   batch_slice_ptrs.reset(new Slice *[batch_size]);
@@ -652,7 +667,7 @@ double FilterBench::RandomQueryTest(uint32_t inside_threshold, bool dry_run,
     }
     // TODO: implement batched interface to full block reader
     // TODO: implement batched interface to plain table bloom
-    if (mode == kBatchPrepared && !FLAGS_use_full_block_reader &&
+    if (batch_prepared && !FLAGS_use_full_block_reader &&
         !FLAGS_use_plain_table_bloom) {
       for (uint32_t i = 0; i < batch_size; ++i) {
         batch_results[i] = false;
@@ -716,6 +731,7 @@ double FilterBench::RandomQueryTest(uint32_t inside_threshold, bool dry_run,
 
   uint64_t elapsed_nanos = timer.ElapsedNanos();
   double ns = double(elapsed_nanos) / max_queries;
+  FastLocalBloomImpl::TEST_SetPortableBatchProbes(false);
 
   if (!FLAGS_quick) {
     if (dry_run) {
@@ -785,6 +801,8 @@ int main(int argc, char **argv) {
         << "  \"Batched, prepared\" - several queries at once against a"
         << "\n     randomly chosen filter, using multi-query interface."
         << std::endl
+        << "  \"Batched, prepared, portable probes\" - same, but without"
+        << "\n     SIMD probes (format_version 5 Bloom filter)." << std::endl
         << "  \"Batched, unprepared\" - similar, but using serial calls"
         << "\n     to single query interface." << std::endl
         << "  \"Random filter\" - a filter is chosen at random as target"
@@ -0,0 +1,205 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/utilities/async_reader.h"
+
+#include <algorithm>
+#include <deque>
+#include <string>
+
+#include "rocksdb/snapshot.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+class AsyncReaderImpl : public AsyncReader {
+ public:
+  AsyncReaderImpl(DB* db, const ReadOptions& read_options,
+                  size_t max_batch_size)
+      : db_(db),
+        read_options_(read_options),
+        cached_read_options_(read_options),
+        max_batch_size_(max_batch_size) {
+    // Lookups that would need I/O fail with Status::Incomplete()
+    cached_read_options_.read_tier = kBlockCacheTier;
+    read_options_.async_io = true;
+  }
+
+  ~AsyncReaderImpl() override {
+    while (!suspended_.empty()) {
+      Lookup lookup = std::move(suspended_.front());
+      suspended_.pop_front();
+      PinnableSlice value;
+      lookup.callback(Status::Aborted("AsyncReader destroyed"), &value);
+    }
+  }
+
+  void Get(ColumnFamilyHandle* column_family, const Slice& key,
+           GetCallback callback) override {
+    PinnableSlice value;
+    Status s = db_->Get(cached_read_options_, column_family, key, &value);
+    if (!s.IsIncomplete()) {
+      callback(s, &value);
+      return;
+    }
+    // Resumed by the next Poll(), which reads as of now
+    suspended_.emplace_back(column_family, key, CurrentSnapshot(),
+                            std::move(callback));
+  }
+
+  void MultiGet(ColumnFamilyHandle* column_family,
+                const std::vector<Slice>& keys,
+                MultiGetCallback callback) override {
+    struct MultiGetState {
+      std::vector<Status> statuses;
+      std::vector<PinnableSlice> values;
+      size_t num_pending;
+      MultiGetCallback callback;
+    };
+    if (keys.empty()) {
+      std::vector<Status> statuses;
+      std::vector<PinnableSlice> values;
+      callback(&statuses, &values);
+      return;
+    }
+    std::shared_ptr<MultiGetState> state(new MultiGetState);
+    state->statuses.resize(keys.size());
+    state->values.resize(keys.size());
+    state->num_pending = keys.size();
+    state->callback = std::move(callback);
+    // All keys are read as of the same point in time, whether they are found
+    // at once or resumed by Poll().
+    std::shared_ptr<ManagedSnapshot> snapshot = CurrentSnapshot();
+    ReadOptions read_options = cached_read_options_;
+    if (snapshot != nullptr) {
+      read_options.snapshot = snapshot->snapshot();
+    }
+    for (size_t i = 0; i < keys.size(); ++i) {
+      GetCallback get_callback = [state, i](const Status& s,
+                                            PinnableSlice* value) {
+        state->statuses[i] = s;
+        state->values[i] = std::move(*value);
+        if (--state->num_pending == 0) {
+          state->callback(&state->statuses, &state->values);
+        }
+      };
+      PinnableSlice value;
+      Status s = db_->Get(read_options, column_family, keys[i], &value);
+      if (s.IsIncomplete()) {
+        suspended_.emplace_back(column_family, keys[i], snapshot,
+                                std::move(get_callback));
+      } else {
+        get_callback(s, &value);
+      }
+    }
+  }
+
+  size_t Poll() override {
+    // Lookups that the callbacks submit are left for the next Poll()
+    size_t num_to_resume = suspended_.size();
+    size_t num_completed = 0;
+    std::vector<Lookup> batch;
+    std::vector<ColumnFamilyHandle*> column_families;
+    std::vector<Slice> keys;
+    while (num_to_resume > 0) {
+      // A batch holds consecutive lookups that read as of the same snapshot
+      const std::shared_ptr<ManagedSnapshot> snapshot =
+          suspended_.front().snapshot;
+      batch.clear();
+      column_families.clear();
+      keys.clear();
+      while (batch.size() < std::min(num_to_resume, max_batch_size_) &&
+             suspended_.front().snapshot == snapshot) {
+        batch.push_back(std::move(suspended_.front()));
+        suspended_.pop_front();
+        column_families.push_back(batch.back().column_family);
+      }
+      for (const Lookup& lookup : batch) {
+        keys.emplace_back(lookup.key);
+      }
+      const size_t batch_size = batch.size();
+      ReadOptions read_options = read_options_;
+      if (snapshot != nullptr) {
+        read_options.snapshot = snapshot->snapshot();
+      }
+      std::vector<PinnableSlice> values(batch_size);
+      std::vector<Status> statuses(batch_size);
+      db_->MultiGet(read_options, batch_size, column_families.data(),
+                    keys.data(), values.data(), statuses.data());
+      for (size_t i = 0; i < batch_size; ++i) {
+        batch[i].callback(statuses[i], &values[i]);
+      }
+      num_to_resume -= batch_size;
+      num_completed += batch_size;
+    }
+    return num_completed;
+  }
+
+  size_t NumSuspended() const override { return suspended_.size(); }
+
+ private:
+  struct Lookup {
+    Lookup(ColumnFamilyHandle* _column_family, const Slice& _key,
+           std::shared_ptr<ManagedSnapshot> _snapshot, GetCallback&& _callback)
+        : column_family(_column_family),
+          key(_key.data(), _key.size()),
+          snapshot(std::move(_snapshot)),
+          callback(std::move(_callback)) {}
+
+    ColumnFamilyHandle* column_family;
+    std::string key;
+    // Null if the lookup reads as of ReadOptions::snapshot
+    std::shared_ptr<ManagedSnapshot> snapshot;
+    GetCallback callback;
+  };
+
+  // Returns a snapshot as of now, unless the ReadOptions have one. Lookups
+  // share the snapshot while no writes happen, so that Poll() can batch them.
+  std::shared_ptr<ManagedSnapshot> CurrentSnapshot() {
+    if (read_options_.snapshot != nullptr) {
+      return nullptr;
+    }
+    std::shared_ptr<ManagedSnapshot> snapshot = snapshot_.lock();
+    if (snapshot == nullptr || snapshot->snapshot() == nullptr ||
+        snapshot->snapshot()->GetSequenceNumber() !=
+            db_->GetLatestSequenceNumber()) {
+      snapshot = std::make_shared<ManagedSnapshot>(db_);
+      snapshot_ = snapshot;
+    }
+    return snapshot;
+  }
+
+  DB* const db_;
+  // For resuming the suspended lookups
+  ReadOptions read_options_;
+  // For trying the lookups without I/O
+  ReadOptions cached_read_options_;
+  const size_t max_batch_size_;
+  std::deque<Lookup> suspended_;
+  // Released once the lookups that read as of it complete
+  std::weak_ptr<ManagedSnapshot> snapshot_;
+};
+}  // namespace
+
+Status NewAsyncReader(DB* db, const ReadOptions& read_options,
+                      size_t max_batch_size,
+                      std::unique_ptr<AsyncReader>* reader) {
+  if (db == nullptr || reader == nullptr) {
+    return Status::InvalidArgument("db and reader must be non-null");
+  }
+  if (read_options.read_tier != kReadAllTier) {
+    return Status::InvalidArgument("read_tier must be kReadAllTier");
+  }
+  if (max_batch_size == 0) {
+    return Status::InvalidArgument("max_batch_size must be positive");
+  }
+  reader->reset(new AsyncReaderImpl(db, read_options, max_batch_size));
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // !ROCKSDB_LITE
@@ -0,0 +1,240 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/utilities/async_reader.h"
+
+#include "db/db_test_util.h"
+#include "port/stack_trace.h"
+#include "rocksdb/filter_policy.h"
+#include "rocksdb/table.h"
+#include "test_util/testharness.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class AsyncReaderTest : public DBTestBase {
+ public:
+  AsyncReaderTest() : DBTestBase("async_reader_test", /*env_do_fsync=*/false) {}
+
+  // Flushes keys [0, kNumFlushed) to a table file, and leaves keys
+  // [kNumFlushed, kNumKeys) in the memtable, with a cold block cache
+  void Populate() {
+    Options options = CurrentOptions();
+    BlockBasedTableOptions table_options;
+    table_options.block_cache = NewLRUCache(1 << 20);
+    table_options.block_size = 256;
+    table_options.filter_policy.reset(NewBloomFilterPolicy(10));
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+    for (int i = 0; i < kNumKeys; ++i) {
+      if (i == kNumFlushed) {
+        ASSERT_OK(Flush());
+        Reopen(options);
+      }
+      ASSERT_OK(Put(Key(i), Value(i)));
+    }
+  }
+
+  static std::string Value(int i) { return "value" + ToString(i); }
+
+  static constexpr int kNumFlushed = 100;
+  static constexpr int kNumKeys = 110;
+};
+
+constexpr int AsyncReaderTest::kNumFlushed;
+constexpr int AsyncReaderTest::kNumKeys;
+
+TEST_F(AsyncReaderTest, Get) {
+  Populate();
+  std::unique_ptr<AsyncReader> reader;
+  ASSERT_OK(NewAsyncReader(db_, ReadOptions(), 16, &reader));
+
+  std::map<int, std::string> results;
+  auto get = [&](int i) {
+    reader->Get(db_->DefaultColumnFamily(), Key(i),
+                [&results, i](const Status& s, PinnableSlice* value) {
+                  results[i] = s.ok() ? value->ToString() : s.ToString();
+                });
+  };
+
+  // In the memtable
+  get(kNumFlushed);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(results[kNumFlushed], Value(kNumFlushed));
+
+  // Need blocks of the table file
+  for (int i = 0; i < kNumFlushed; i += 10) {
+    get(i);
+  }
+  ASSERT_EQ(reader->NumSuspended(), 10);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(reader->Poll(), 10);
+  ASSERT_EQ(reader->NumSuspended(), 0);
+  ASSERT_EQ(results.size(), 11);
+  for (int i = 0; i < kNumFlushed; i += 10) {
+    ASSERT_EQ(results[i], Value(i));
+  }
+
+  // The blocks are cached now
+  results.clear();
+  get(0);
+  ASSERT_EQ(results[0], Value(0));
+  ASSERT_EQ(reader->Poll(), 0);
+
+  // Not found, whether or not the filter rules it out
+  reader->Get(db_->DefaultColumnFamily(), "missing",
+              [&results](const Status& s, PinnableSlice* /*value*/) {
+                results[-1] = s.ToString();
+              });
+  reader->Poll();
+  ASSERT_EQ(results[-1], Status::NotFound().ToString());
+}
+
+TEST_F(AsyncReaderTest, MultiGet) {
+  Populate();
+  std::unique_ptr<AsyncReader> reader;
+  ASSERT_OK(NewAsyncReader(db_, ReadOptions(), 4, &reader));
+
+  std::vector<std::string> key_strings;
+  for (int i = 0; i < kNumKeys; i += 7) {
+    key_strings.push_back(Key(i));
+  }
+  key_strings.push_back("missing");
+  std::vector<Slice> keys(key_strings.begin(), key_strings.end());
+  int num_calls = 0;
+  reader->MultiGet(db_->DefaultColumnFamily(), keys,
+                   [&](std::vector<Status>* statuses,
+                       std::vector<PinnableSlice>* values) {
+                     ++num_calls;
+                     ASSERT_EQ(statuses->size(), keys.size());
+                     for (size_t i = 0; i + 1 < keys.size(); ++i) {
+                       ASSERT_OK((*statuses)[i]);
+                       ASSERT_EQ((*values)[i].ToString(),
+                                 Value(static_cast<int>(i) * 7));
+                     }
+                     ASSERT_TRUE(statuses->back().IsNotFound());
+                   });
+  ASSERT_EQ(num_calls, 0);
+  // Resumed with several MultiGet()s of at most 4 keys
+  ASSERT_GT(reader->Poll(), 4);
+  ASSERT_EQ(num_calls, 1);
+}
+
+TEST_F(AsyncReaderTest, ReadsAsOfSubmission) {
+  Populate();
+  std::unique_ptr<AsyncReader> reader;
+  ASSERT_OK(NewAsyncReader(db_, ReadOptions(), 16, &reader));
+
+  // Keys found at once in the memtable and keys needing I/O
+  std::vector<std::string> key_strings = {Key(0), Key(kNumFlushed), Key(50),
+                                          Key(kNumFlushed + 1)};
+  std::vector<Slice> keys(key_strings.begin(), key_strings.end());
+  std::vector<std::string> results;
+  reader->MultiGet(
+      db_->DefaultColumnFamily(), keys,
+      [&](std::vector<Status>* statuses, std::vector<PinnableSlice>* values) {
+        for (size_t i = 0; i < statuses->size(); ++i) {
+          results.push_back((*statuses)[i].ok() ? (*values)[i].ToString()
+                                                : (*statuses)[i].ToString());
+        }
+      });
+  std::string get_result;
+  reader->Get(db_->DefaultColumnFamily(), Key(60),
+              [&](const Status& s, PinnableSlice* value) {
+                get_result = s.ok() ? value->ToString() : s.ToString();
+              });
+  ASSERT_EQ(reader->NumSuspended(), 3);
+
+  // Writes before the lookups are resumed are not seen
+  for (const auto& key : key_strings) {
+    ASSERT_OK(Put(key, "new"));
+  }
+  ASSERT_OK(Delete(Key(60)));
+  ASSERT_EQ(reader->Poll(), 3);
+  ASSERT_EQ(results,
+            std::vector<std::string>({Value(0), Value(kNumFlushed), Value(50),
+                                      Value(kNumFlushed + 1)}));
+  ASSERT_EQ(get_result, Value(60));
+
+  // Lookups submitted after the writes see them
+  get_result.clear();
+  reader->Get(db_->DefaultColumnFamily(), Key(60),
+              [&](const Status& s, PinnableSlice* value) {
+                get_result = s.ok() ? value->ToString() : s.ToString();
+              });
+  reader->Poll();
+  ASSERT_EQ(get_result, Status::NotFound().ToString());
+}
+
+TEST_F(AsyncReaderTest, CallbacksSubmitLookups) {
+  Populate();
+  std::unique_ptr<AsyncReader> reader;
+  ASSERT_OK(NewAsyncReader(db_, ReadOptions(), 16, &reader));
+
+  // Each lookup submits the next one, which is left for the next Poll()
+  int num_done = 0;
+  std::function<void(int)> get = [&](int i) {
+    reader->Get(db_->DefaultColumnFamily(), Key(i),
+                [&, i](const Status& s, PinnableSlice* value) {
+                  ASSERT_OK(s);
+                  ASSERT_EQ(value->ToString(), Value(i));
+                  ++num_done;
+                  if (i + 50 < kNumFlushed) {
+                    get(i + 50);
+                  }
+                });
+  };
+  get(0);
+  ASSERT_EQ(reader->Poll(), 1);
+  ASSERT_EQ(num_done, 1);
+  ASSERT_EQ(reader->NumSuspended(), 1);
+  ASSERT_EQ(reader->Poll(), 1);
+  ASSERT_EQ(num_done, 2);
+}
+
+TEST_F(AsyncReaderTest, DestroyAbortsSuspendedLookups) {
+  Populate();
+  std::unique_ptr<AsyncReader> reader;
+  ASSERT_OK(NewAsyncReader(db_, ReadOptions(), 16, &reader));
+  Status status;
+  reader->Get(db_->DefaultColumnFamily(), Key(0),
+              [&status](const Status& s, PinnableSlice* /*value*/) {
+                status = s;
+              });
+  ASSERT_EQ(reader->NumSuspended(), 1);
+  reader.reset();
+  ASSERT_TRUE(status.IsAborted());
+}
+
+TEST_F(AsyncReaderTest, InvalidArguments) {
+  std::unique_ptr<AsyncReader> reader;
+  ReadOptions read_options;
+  ASSERT_TRUE(
+      NewAsyncReader(db_, read_options, 0, &reader).IsInvalidArgument());
+  read_options.read_tier = kBlockCacheTier;
+  ASSERT_TRUE(
+      NewAsyncReader(db_, read_options, 16, &reader).IsInvalidArgument());
+  ASSERT_TRUE(reader == nullptr);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr, "SKIPPED as AsyncReader is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // !ROCKSDB_LITE
@@ -0,0 +1,424 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/utilities/local_compaction_service.h"
+
+#ifndef OS_WIN
+#include <signal.h>
+#include <spawn.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+#include <cstring>
+#include <map>
+#include <set>
+
+#include "port/port.h"
+#include "rocksdb/db.h"
+#include "rocksdb/env.h"
+#include "rocksdb/system_clock.h"
+#include "test_util/sync_point.h"
+#include "util/mutexlock.h"
+#include "util/string_util.h"
+
+#ifndef OS_WIN
+extern char** environ;
+#endif
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Arguments appended to LocalCompactionServiceOptions::worker_command
+const char* const kDbArg = "--db=";
+const char* const kJobDirArg = "--job_dir=";
+
+// Files of a job directory, besides the output table files
+const char* const kInputFileName = "/input";
+const char* const kInputChildName = "input";
+const char* const kResultFileName = "/result";
+
+const char* const kJobDirPrefix = "/compaction_job_";
+
+// How often a running worker is checked for completion, timeout or
+// cancellation
+const int kWorkerPollMicros = 10 * 1000;
+
+Status DeleteJobDir(Env* env, const std::string& job_dir) {
+  std::vector<std::string> children;
+  Status s = env->GetChildren(job_dir, &children);
+  if (!s.ok()) {
+    return s;
+  }
+  for (const auto& child : children) {
+    s = env->DeleteFile(job_dir + "/" + child);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  return env->DeleteDir(job_dir);
+}
+
+// Deletes what a previous attempt of the job in `job_dir` left behind: its
+// output files, and its result if it got that far.
+Status ClearJobOutputs(Env* env, const std::string& job_dir) {
+  std::vector<std::string> children;
+  Status s = env->GetChildren(job_dir, &children);
+  if (!s.ok()) {
+    return s;
+  }
+  for (const auto& child : children) {
+    if (child == kInputChildName) {
+      continue;
+    }
+    s = env->DeleteFile(job_dir + "/" + child);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  return Status::OK();
+}
+
+// Whether the output files of the finished job in `job_dir` were all moved to
+// the DB.
+bool JobOutputsInstalled(Env* env, const std::string& job_dir) {
+  std::vector<std::string> children;
+  if (!env->GetChildren(job_dir, &children).ok()) {
+    return false;
+  }
+  for (const auto& child : children) {
+    if (EndsWith(child, ".sst")) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+#ifndef OS_WIN
+class LocalCompactionServiceImpl : public LocalCompactionService {
+ public:
+  explicit LocalCompactionServiceImpl(
+      const LocalCompactionServiceOptions& options)
+      : options_(options),
+        env_(options.env ? options.env : Env::Default()),
+        clock_(env_->GetSystemClock().get()),
+        cv_(&mutex_) {}
+
+  ~LocalCompactionServiceImpl() override {
+    CancelAllJobs();
+    MutexLock l(&mutex_);
+    while (num_running_ > 0) {
+      cv_.Wait();
+    }
+    for (const auto& job_dir : finished_job_dirs_) {
+      DeleteJobDir(env_, job_dir).PermitUncheckedError();
+    }
+  }
+
+  CompactionServiceJobStatus StartV2(
+      const CompactionServiceJobInfo& info,
+      const std::string& compaction_service_input) override {
+    if (options_.worker_command.empty()) {
+      return CompactionServiceJobStatus::kUseLocal;
+    }
+    uint64_t cancel_generation;
+    {
+      MutexLock l(&mutex_);
+      cancel_generation = cancel_generation_;
+    }
+    PurgeFinishedJobDirs();
+
+    const std::string& work_dir =
+        options_.work_dir.empty() ? info.db_name : options_.work_dir;
+    const std::string job_dir = work_dir + kJobDirPrefix + JobKey(info);
+    Status s = env_->CreateDirIfMissing(work_dir);
+    if (s.ok()) {
+      s = env_->CreateDirIfMissing(job_dir);
+    }
+    if (s.ok()) {
+      s = WriteStringToFile(env_, compaction_service_input,
+                            job_dir + kInputFileName, /*should_sync=*/false);
+    }
+    if (!s.ok()) {
+      DeleteJobDir(env_, job_dir).PermitUncheckedError();
+      return CompactionServiceJobStatus::kUseLocal;
+    }
+
+    MutexLock l(&mutex_);
+    jobs_[JobKey(info)] = Job{info.db_name, job_dir, cancel_generation};
+    return CompactionServiceJobStatus::kSuccess;
+  }
+
+  CompactionServiceJobStatus WaitForCompleteV2(
+      const CompactionServiceJobInfo& info,
+      std::string* compaction_service_result) override {
+    Job job;
+    {
+      MutexLock l(&mutex_);
+      auto it = jobs_.find(JobKey(info));
+      if (it == jobs_.end()) {
+        return CompactionServiceJobStatus::kFailure;
+      }
+      job = std::move(it->second);
+      jobs_.erase(it);
+
+      // Jobs get a worker in the order they were started. CancelAllJobs()
+      // skips the tickets of the jobs it cancels.
+      uint64_t ticket = 0;
+      if (!IsCanceled(job)) {
+        ticket = next_ticket_++;
+      }
+      while (!IsCanceled(job) && (ticket != next_ticket_to_run_ ||
+                                  num_running_ >= options_.max_workers)) {
+        cv_.Wait();
+      }
+      if (IsCanceled(job)) {
+        DeleteJobDir(env_, job.job_dir).PermitUncheckedError();
+        return CompactionServiceJobStatus::kFailure;
+      }
+      next_ticket_to_run_++;
+      num_running_++;
+      cv_.SignalAll();
+    }
+
+    CompactionServiceJobStatus job_status =
+        RunJob(job, compaction_service_result);
+
+    MutexLock l(&mutex_);
+    num_running_--;
+    cv_.SignalAll();
+    if (job_status == CompactionServiceJobStatus::kSuccess) {
+      num_remote_jobs_++;
+      finished_job_dirs_.insert(job.job_dir);
+    } else {
+      DeleteJobDir(env_, job.job_dir).PermitUncheckedError();
+      if (job_status == CompactionServiceJobStatus::kUseLocal) {
+        num_local_fallbacks_++;
+      }
+    }
+    return job_status;
+  }
+
+  void CancelAllJobs() override {
+    MutexLock l(&mutex_);
+    cancel_generation_++;
+    next_ticket_to_run_ = next_ticket_;
+    for (pid_t pid : running_pids_) {
+      kill(-pid, SIGKILL);
+    }
+    cv_.SignalAll();
+  }
+
+  uint64_t GetNumRemoteJobs() const override {
+    MutexLock l(&mutex_);
+    return num_remote_jobs_;
+  }
+
+  uint64_t GetNumLocalFallbacks() const override {
+    MutexLock l(&mutex_);
+    return num_local_fallbacks_;
+  }
+
+ private:
+  struct Job {
+    std::string db_name;
+    std::string job_dir;
+    // Value of cancel_generation_ when the job was started
+    uint64_t cancel_generation;
+  };
+
+  bool IsCanceled(const Job& job) const {
+    mutex_.AssertHeld();
+    return job.cancel_generation != cancel_generation_;
+  }
+
+  static std::string JobKey(const CompactionServiceJobInfo& info) {
+    return info.db_session_id + "_" +
+           ROCKSDB_NAMESPACE::ToString(info.job_id);
+  }
+
+  // Runs the job in worker processes until one succeeds, the attempts are
+  // exhausted, or the jobs are canceled.
+  CompactionServiceJobStatus RunJob(const Job& job, std::string* result) {
+    const std::string result_file = job.job_dir + kResultFileName;
+    // Each attempt starts from a job directory holding only the input, so
+    // that the outputs of a failed attempt are not taken for those of the
+    // next one, and the directory can be deleted once the outputs are
+    // installed.
+    for (int attempt = 0; attempt < std::max(options_.max_attempts, 1);
+         attempt++) {
+      if (!ClearJobOutputs(env_, job.job_dir).ok()) {
+        break;
+      }
+      bool canceled = false;
+      int exit_code = RunWorker(job, &canceled);
+      if (canceled) {
+        return CompactionServiceJobStatus::kFailure;
+      }
+      if (exit_code == 0 &&
+          ReadFileToString(env_, result_file, result).ok()) {
+        return CompactionServiceJobStatus::kSuccess;
+      }
+    }
+    return CompactionServiceJobStatus::kUseLocal;
+  }
+
+  // Runs a worker process for the job, and returns its exit code, or -1 if it
+  // could not be started, was killed or timed out.
+  int RunWorker(const Job& job, bool* canceled) {
+    std::vector<std::string> args = options_.worker_command;
+    args.push_back(kDbArg + job.db_name);
+    args.push_back(kJobDirArg + job.job_dir);
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+      argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid;
+    {
+      MutexLock l(&mutex_);
+      if (IsCanceled(job)) {
+        *canceled = true;
+        return -1;
+      }
+      // The worker gets a process group of its own, so that killing it also
+      // kills the processes it started, e.g. through a wrapper command.
+      posix_spawnattr_t attr;
+      posix_spawnattr_init(&attr);
+      posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+      posix_spawnattr_setpgroup(&attr, 0);
+      int err = posix_spawnp(&pid, argv[0], nullptr, &attr, argv.data(),
+                             environ);
+      posix_spawnattr_destroy(&attr);
+      if (err != 0) {
+        return -1;
+      }
+      running_pids_.insert(pid);
+    }
+    TEST_SYNC_POINT("LocalCompactionServiceImpl::RunWorker:Started");
+
+    const uint64_t deadline =
+        options_.job_timeout_seconds == 0
+            ? port::kMaxUint64
+            : clock_->NowMicros() + options_.job_timeout_seconds * 1000000;
+    int wait_status = 0;
+    bool killed = false;
+    while (waitpid(pid, &wait_status, WNOHANG) == 0) {
+      if (!killed && clock_->NowMicros() >= deadline) {
+        kill(-pid, SIGKILL);
+        killed = true;
+      }
+      clock_->SleepForMicroseconds(kWorkerPollMicros);
+    }
+
+    MutexLock l(&mutex_);
+    running_pids_.erase(pid);
+    *canceled = IsCanceled(job);
+    if (killed || !WIFEXITED(wait_status)) {
+      return -1;
+    }
+    return WEXITSTATUS(wait_status);
+  }
+
+  // Deletes the directories of the finished jobs whose outputs were moved to
+  // the DB. The directories are taken out of finished_job_dirs_ so that the
+  // file system is not accessed while holding mutex_, and the ones still in
+  // use are put back.
+  void PurgeFinishedJobDirs() {
+    std::set<std::string> job_dirs;
+    {
+      MutexLock l(&mutex_);
+      job_dirs.swap(finished_job_dirs_);
+    }
+    for (auto it = job_dirs.begin(); it != job_dirs.end();) {
+      if (JobOutputsInstalled(env_, *it) && DeleteJobDir(env_, *it).ok()) {
+        it = job_dirs.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (!job_dirs.empty()) {
+      MutexLock l(&mutex_);
+      finished_job_dirs_.insert(job_dirs.begin(), job_dirs.end());
+    }
+  }
+
+  const LocalCompactionServiceOptions options_;
+  Env* const env_;
+  SystemClock* const clock_;
+
+  mutable port::Mutex mutex_;
+  port::CondVar cv_;
+  // Incremented by CancelAllJobs(), which cancels the jobs started before
+  uint64_t cancel_generation_ = 0;
+  std::map<std::string, Job> jobs_;
+  std::set<pid_t> running_pids_;
+  std::set<std::string> finished_job_dirs_;
+  int num_running_ = 0;
+  uint64_t next_ticket_ = 0;
+  uint64_t next_ticket_to_run_ = 0;
+  uint64_t num_remote_jobs_ = 0;
+  uint64_t num_local_fallbacks_ = 0;
+};
+#endif  // !OS_WIN
+
+std::shared_ptr<LocalCompactionService> NewLocalCompactionService(
+    const LocalCompactionServiceOptions& options) {
+#ifdef OS_WIN
+  (void)options;
+  return nullptr;
+#else
+  return std::make_shared<LocalCompactionServiceImpl>(options);
+#endif  // OS_WIN
+}
+
+int RunCompactionWorker(
+    int argc, char** argv,
+    const CompactionServiceOptionsOverride& override_options) {
+  std::string db_name;
+  std::string job_dir;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], kDbArg, strlen(kDbArg)) == 0) {
+      db_name = argv[i] + strlen(kDbArg);
+    } else if (strncmp(argv[i], kJobDirArg, strlen(kJobDirArg)) == 0) {
+      job_dir = argv[i] + strlen(kJobDirArg);
+    }
+  }
+  if (db_name.empty() || job_dir.empty()) {
+    fprintf(stderr, "Usage: %s %s<db path> %s<job directory>\n", argv[0],
+            kDbArg, kJobDirArg);
+    return 1;
+  }
+
+  Env* env = override_options.env;
+  std::string input;
+  Status s = ReadFileToString(env, job_dir + kInputFileName, &input);
+  std::string result;
+  if (s.ok()) {
+    s = DB::OpenAndCompact(db_name, job_dir, input, &result, override_options);
+  }
+  if (s.ok()) {
+    // The service only reads a complete result
+    const std::string tmp_file = job_dir + kResultFileName + ".tmp";
+    s = WriteStringToFile(env, result, tmp_file, /*should_sync=*/true);
+    if (s.ok()) {
+      s = env->RenameFile(tmp_file, job_dir + kResultFileName);
+    }
+  }
+  if (!s.ok()) {
+    fprintf(stderr, "Compaction job %s failed: %s\n", job_dir.c_str(),
+            s.ToString().c_str());
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // !ROCKSDB_LITE
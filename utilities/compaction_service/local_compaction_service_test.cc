@@ -0,0 +1,236 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#if !defined(ROCKSDB_LITE) && !defined(OS_WIN)
+
+#include "rocksdb/utilities/local_compaction_service.h"
+
+#include <unistd.h>
+
+#include <cstring>
+
+#include "db/db_test_util.h"
+#include "port/stack_trace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// The test binary is its own worker, when started with this first argument
+const char* const kWorkerArg = "--compaction_worker";
+// Or with this one followed by the path of a file: the worker then fails
+// after writing a stray output file if the file does not exist, and creates
+// it, so that only the first attempt fails.
+const char* const kFailingWorkerArg = "--failing_compaction_worker";
+
+int RunFailingWorker(int argc, char** argv) {
+  Env* env = Env::Default();
+  if (env->FileExists(argv[2]).ok()) {
+    return RunCompactionWorker(argc, argv);
+  }
+  const char* const job_dir_arg = "--job_dir=";
+  for (int i = 3; i < argc; i++) {
+    if (strncmp(argv[i], job_dir_arg, strlen(job_dir_arg)) == 0) {
+      std::string output_file =
+          std::string(argv[i] + strlen(job_dir_arg)) + "/000999.sst";
+      WriteStringToFile(env, "partial", output_file).PermitUncheckedError();
+    }
+  }
+  WriteStringToFile(env, "", argv[2]).PermitUncheckedError();
+  return 1;
+}
+
+std::string SelfPath() {
+  char path[4096];
+  ssize_t len = readlink("/proc/self/exe", path, sizeof(path) - 1);
+  if (len <= 0) {
+    return "";
+  }
+  return std::string(path, static_cast<size_t>(len));
+}
+}  // namespace
+
+class LocalCompactionServiceTest : public DBTestBase {
+ public:
+  LocalCompactionServiceTest()
+      : DBTestBase("local_compaction_service_test", /*env_do_fsync=*/true) {}
+
+ protected:
+  void ReopenWithCompactionService(
+      const LocalCompactionServiceOptions& service_options) {
+    Options options = CurrentOptions();
+    options.disable_auto_compactions = true;
+    service_ = NewLocalCompactionService(service_options);
+    options.compaction_service = service_;
+    DestroyAndReopen(options);
+  }
+
+  void GenerateTestData() {
+    for (int i = 0; i < 10; i++) {
+      for (int j = 0; j < 20; j++) {
+        int key_id = j * 10 + i;
+        ASSERT_OK(Put(Key(key_id), "value" + ToString(key_id)));
+      }
+      ASSERT_OK(Flush());
+    }
+  }
+
+  void VerifyTestData() {
+    for (int i = 0; i < 200; i++) {
+      ASSERT_EQ("value" + ToString(i), Get(Key(i)));
+    }
+  }
+
+  int CountJobDirs() {
+    std::vector<std::string> children;
+    EXPECT_OK(env_->GetChildren(dbname_, &children));
+    int num_job_dirs = 0;
+    for (const auto& child : children) {
+      if (child.find("compaction_job_") == 0) {
+        num_job_dirs++;
+      }
+    }
+    return num_job_dirs;
+  }
+
+  std::shared_ptr<LocalCompactionService> service_;
+};
+
+TEST_F(LocalCompactionServiceTest, CompactInWorker) {
+  LocalCompactionServiceOptions service_options;
+  service_options.worker_command = {SelfPath(), kWorkerArg};
+  ReopenWithCompactionService(service_options);
+  GenerateTestData();
+  ASSERT_EQ("10", FilesPerLevel());
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel());
+  VerifyTestData();
+  ASSERT_EQ(1U, service_->GetNumRemoteJobs());
+  ASSERT_EQ(0U, service_->GetNumLocalFallbacks());
+
+  // The outputs were moved to the DB, and the job directory is deleted when
+  // the next job starts
+  GenerateTestData();
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  VerifyTestData();
+  ASSERT_EQ(2U, service_->GetNumRemoteJobs());
+  ASSERT_EQ(1, CountJobDirs());
+}
+
+TEST_F(LocalCompactionServiceTest, RetryAfterFailure) {
+  const std::string failed_file = dbname_ + "_worker_failed";
+  env_->DeleteFile(failed_file).PermitUncheckedError();
+  LocalCompactionServiceOptions service_options;
+  service_options.worker_command = {SelfPath(), kFailingWorkerArg,
+                                    failed_file};
+  ReopenWithCompactionService(service_options);
+  GenerateTestData();
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel());
+  VerifyTestData();
+  ASSERT_OK(env_->FileExists(failed_file));
+  ASSERT_EQ(1U, service_->GetNumRemoteJobs());
+  ASSERT_EQ(0U, service_->GetNumLocalFallbacks());
+
+  // The stray output of the failed attempt was deleted before the next one,
+  // so the job directory is deleted when the next job starts
+  GenerateTestData();
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  VerifyTestData();
+  ASSERT_EQ(2U, service_->GetNumRemoteJobs());
+  ASSERT_EQ(1, CountJobDirs());
+  ASSERT_OK(env_->DeleteFile(failed_file));
+}
+
+TEST_F(LocalCompactionServiceTest, FallBackToLocalAfterFailures) {
+  LocalCompactionServiceOptions service_options;
+  service_options.worker_command = {"false"};
+  service_options.max_attempts = 3;
+  ReopenWithCompactionService(service_options);
+  GenerateTestData();
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel());
+  VerifyTestData();
+  ASSERT_EQ(0U, service_->GetNumRemoteJobs());
+  ASSERT_EQ(1U, service_->GetNumLocalFallbacks());
+}
+
+TEST_F(LocalCompactionServiceTest, KillWorkerOnTimeout) {
+  LocalCompactionServiceOptions service_options;
+  service_options.worker_command = {"sh", "-c", "sleep 60"};
+  service_options.job_timeout_seconds = 1;
+  service_options.max_attempts = 1;
+  ReopenWithCompactionService(service_options);
+  GenerateTestData();
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  VerifyTestData();
+  ASSERT_EQ(1U, service_->GetNumLocalFallbacks());
+}
+
+TEST_F(LocalCompactionServiceTest, CancelAllJobs) {
+  LocalCompactionServiceOptions service_options;
+  service_options.worker_command = {"sh", "-c", "sleep 60"};
+  ReopenWithCompactionService(service_options);
+  GenerateTestData();
+
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"LocalCompactionServiceImpl::RunWorker:Started",
+        "LocalCompactionServiceTest::CancelAllJobs"}});
+  SyncPoint::GetInstance()->EnableProcessing();
+  port::Thread compaction([&] {
+    Status s = db_->CompactRange(CompactRangeOptions(), nullptr, nullptr);
+    ASSERT_TRUE(s.IsIncomplete());
+  });
+  TEST_SYNC_POINT("LocalCompactionServiceTest::CancelAllJobs");
+  service_->CancelAllJobs();
+  compaction.join();
+  SyncPoint::GetInstance()->DisableProcessing();
+  VerifyTestData();
+  ASSERT_EQ(0U, service_->GetNumRemoteJobs());
+  ASSERT_EQ(0U, service_->GetNumLocalFallbacks());
+}
+
+TEST_F(LocalCompactionServiceTest, RunJobsAfterCancelAllJobs) {
+  LocalCompactionServiceOptions service_options;
+  service_options.worker_command = {SelfPath(), kWorkerArg};
+  ReopenWithCompactionService(service_options);
+  GenerateTestData();
+
+  // Only the jobs started before are canceled
+  service_->CancelAllJobs();
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel());
+  VerifyTestData();
+  ASSERT_EQ(1U, service_->GetNumRemoteJobs());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  if (argc > 1 && strcmp(argv[1], ROCKSDB_NAMESPACE::kWorkerArg) == 0) {
+    return ROCKSDB_NAMESPACE::RunCompactionWorker(argc, argv);
+  }
+  if (argc > 2 && strcmp(argv[1], ROCKSDB_NAMESPACE::kFailingWorkerArg) == 0) {
+    return ROCKSDB_NAMESPACE::RunFailingWorker(argc, argv);
+  }
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as LocalCompactionService is not supported in ROCKSDB_LITE "
+          "or on Windows\n");
+  return 0;
+}
+
+#endif  // !ROCKSDB_LITE && !OS_WIN